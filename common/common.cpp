@@ -34,6 +34,7 @@
 #include <macros.h>
 #include <base_units.h>
 #include <reporter.h>
+#include <ki_mutex.h>
 
 #include <wx/process.h>
 #include <wx/config.h>
@@ -263,9 +264,13 @@ int ProcessExecute( const wxString& aCommandLine, int aFlags, wxProcess *callbac
 
 time_t GetNewTimeStamp()
 {
+    // Time stamps are also given by the threads loading the sheets of a schematic
+    static MUTEX timestamp_mutex;
     static time_t oldTimeStamp;
     time_t newTimeStamp;
 
+    MUTLOCK lock( timestamp_mutex );
+
     newTimeStamp = time( NULL );
 
     if( newTimeStamp <= oldTimeStamp )
@@ -388,7 +393,6 @@ wxString GetKicadConfigPath()
 }
 
 
-#include <ki_mutex.h>
 const wxString ExpandEnvVarSubstitutions( const wxString& aString )
 {
     // wxGetenv( wchar_t* ) is not re-entrant on linux.
@@ -28,6 +28,8 @@
 #include <cstdio>
 #include <cstdlib>         // bsearch()
 #include <cctype>
+#include <cstring>
+#include <algorithm>
 
 #include <macros.h>
 #include <fctsys.h>
@@ -54,6 +56,9 @@ void DSNLEXER::init()
 
     curOffset = 0;
 
+    dummy[0] = 0;
+    maxKeywordLength = 0;
+
 #if 1
     if( keywordCount > 11 )
     {
@@ -68,6 +73,7 @@ void DSNLEXER::init()
     for( ; it < end; ++it )
     {
         keyword_hash[it->name] = it->token;
+        maxKeywordLength = std::max( maxKeywordLength, strlen( it->name ) );
     }
 #endif
 }
@@ -80,6 +86,8 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
+    curTextBegin( NULL ),
+    curTextEnd( NULL ),
     keywords( aKeywordTable ),
     keywordCount( aKeywordCount )
 {
@@ -96,6 +104,8 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
+    curTextBegin( NULL ),
+    curTextEnd( NULL ),
     keywords( aKeywordTable ),
     keywordCount( aKeywordCount )
 {
@@ -113,6 +123,8 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
+    curTextBegin( NULL ),
+    curTextEnd( NULL ),
     keywords( aKeywordTable ),
     keywordCount( aKeywordCount )
 {
@@ -130,6 +142,8 @@ DSNLEXER::DSNLEXER( const std::string& aSExpression, const wxString& aSource ) :
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
+    curTextBegin( NULL ),
+    curTextEnd( NULL ),
     keywords( empty_keywords ),
     keywordCount( 0 )
 {
@@ -183,6 +197,8 @@ bool DSNLEXER::SyncLineReaderWith( DSNLEXER& aLexer )
     // Sync these parameters is not mandatory, but could help
     // for instance in debug
     curText = aLexer.curText;
+    curTextBegin = aLexer.curTextBegin;
+    curTextEnd = aLexer.curTextEnd;
     curOffset = aLexer.curOffset;
 
     return true;
@@ -191,6 +207,10 @@ bool DSNLEXER::SyncLineReaderWith( DSNLEXER& aLexer )
 
 void DSNLEXER::PushReader( LINE_READER* aLineReader )
 {
+    // The current token text can be in the storage of the previous reader, which
+    // may be already deleted (see PCB_PARSER::SetLineReader()): forget it.
+    setCurText( dummy, dummy );
+
     readerStack.push_back( aLineReader );
     reader = aLineReader;
     start  = (const char*) (*reader);
@@ -207,6 +227,8 @@ LINE_READER* DSNLEXER::PopReader()
 
     if( readerStack.size() )
     {
+        setCurText( dummy, dummy );     // the popped reader may be already deleted
+
         ret = reader;
         readerStack.pop_back();
 
@@ -269,6 +291,47 @@ inline int DSNLEXER::findToken( const std::string& tok )
 #endif
 
 
+int DSNLEXER::findToken( const char* aBegin, const char* aEnd )
+{
+    size_t len = aEnd - aBegin;
+
+    // no keyword can match a longer token
+    if( len > maxKeywordLength )
+        return DSN_SYMBOL;
+
+    // the text is copied to a buffer on the stack, to be nul terminated for the hashtable
+    char tok[64];
+
+    if( len >= sizeof( tok ) )
+        return findToken( std::string( aBegin, aEnd ) );
+
+    memcpy( tok, aBegin, len );
+    tok[len] = 0;
+
+    KEYWORD_MAP::const_iterator it = keyword_hash.find( tok );
+    if( it != keyword_hash.end() )
+        return it->second;
+
+    return DSN_SYMBOL;
+}
+
+
+const char* DSNLEXER::CurLine()
+{
+    const char* line = (const char*)(*reader);
+
+    // A line read by ReadLineView() is not in the line buffer of the reader,
+    // and is not nul terminated.
+    if( start != line && start != dummy )
+    {
+        curLine.assign( start, limit );
+        return curLine.c_str();
+    }
+
+    return line;
+}
+
+
 const char* DSNLEXER::Syntax( int aTok )
 {
     const char* ret;
@@ -554,6 +617,9 @@ int DSNLEXER::NextTok() throw( IO_ERROR )
     if( cur >= limit )
     {
 L_read:
+        // the view of the current token does not survive the next line
+        CurStr();
+
         // blank lines are returned as "\n" and will have a len of 1.
         // EOF will have a len of 0 and so is detectable.
         int len = readLine();
@@ -582,8 +648,7 @@ L_read:
                 while( limit[-1] == '\n' || limit[-1] == '\r' )
                     --limit;
 
-                curText.clear();
-                curText.append( start, limit );
+                setCurText( start, limit );
 
                 cur     = start;        // ensure a good curOffset below
                 curTok  = DSN_COMMENT;
@@ -606,7 +671,7 @@ L_read:
 
     if( *cur == '(' )
     {
-        curText = *cur;
+        setCurText( cur, cur+1 );
         curTok = DSN_LEFT;
         head = cur+1;
         goto exit;
@@ -614,7 +679,7 @@ L_read:
 
     if( *cur == ')' )
     {
-        curText = *cur;
+        setCurText( cur, cur+1 );
         curTok = DSN_RIGHT;
         head = cur+1;
         goto exit;
@@ -627,13 +692,26 @@ L_read:
         // a quoted string, will return DSN_STRING
         if( *cur == stringDelimiter )
         {
-            // copy the token, character by character so we can remove doubled up quotes.
-            curText.clear();
-
             ++cur;  // skip over the leading delimiter, which is always " in non-specctraMode
 
             head = cur;
 
+            // Most strings have no escape sequence: they are used in place.
+            while( head<limit && *head != '\\' && *head != '"' )
+                ++head;
+
+            if( head<limit && *head == '"' )
+            {
+                setCurText( cur, head );
+                curTok = DSN_STRING;
+                ++head;                     // omit this trailing double quote
+                goto exit;
+            }
+
+            // copy the token, character by character so we can decipher escape sequences.
+            curText.assign( cur, head );
+            curTextBegin = NULL;
+
             while( head<limit )
             {
                 // ESCAPE SEQUENCES:
@@ -719,7 +797,7 @@ L_read:
         */
         if( *cur == '-' && cur>start && !isSpace( cur[-1] ) )
         {
-            curText = '-';
+            setCurText( cur, cur+1 );
             curTok = DSN_DASH;
             head = cur+1;
             goto exit;
@@ -741,7 +819,7 @@ L_read:
                 THROW_PARSE_ERROR( errtxt, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
             }
 
-            curText = cc;
+            setCurText( cur, cur+1 );
 
             head = cur+1;
 
@@ -770,8 +848,7 @@ L_read:
                 THROW_PARSE_ERROR( errtxt, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
             }
 
-            curText.clear();
-            curText.append( cur, head );
+            setCurText( cur, head );
 
             ++head;     // skip over the trailing delimiter
 
@@ -780,26 +857,26 @@ L_read:
         }
     }           // specctraMode
 
-    // non-quoted token, read it into curText.
-    curText.clear();
-
+    // non-quoted token, used in place.
     head = cur;
     while( head<limit && !isSep( *head ) )
-        curText += *head++;
+        ++head;
 
-    if( isNumber( curText.c_str(), curText.c_str() + curText.size() ) )
+    setCurText( cur, head );
+
+    if( isNumber( cur, head ) )
     {
         curTok = DSN_NUMBER;
         goto exit;
     }
 
-    if( specctraMode && curText == "string_quote" )
+    if( specctraMode && head - cur == 12 && !memcmp( cur, "string_quote", 12 ) )
     {
         curTok = DSN_STRING_QUOTE;
         goto exit;
     }
 
-    curTok = findToken( curText );
+    curTok = findToken( cur, head );
 
 exit:   // single point of exit, no returns elsewhere please.
 
@@ -807,11 +884,79 @@ exit:   // single point of exit, no returns elsewhere please.
 
     next = head;
 
-    // printf("tok:\"%s\"\n", curText.c_str() );
+    // printf("tok:\"%s\"\n", CurText() );
     return curTok;
 }
 
 
+void DSNLEXER::CopyList( std::string* aText ) throw( IO_ERROR, PARSE_ERROR )
+{
+    wxASSERT( !specctraMode && prevTok == DSN_LEFT );
+
+    // The first token of a list is a keyword, which cannot need quotes
+    aText->assign( 1, '(' );
+    aText->append( CurStr() );
+
+    const char* cur = next;
+    int         depth = 1;
+    bool        inString = false;
+
+    for(;;)
+    {
+        if( cur >= limit )
+        {
+            if( readLine() == 0 )
+            {
+                wxString errtxt( _( "Un-terminated list" ) );
+                THROW_PARSE_ERROR( errtxt, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
+            }
+
+            cur = start;
+        }
+
+        const char* head = cur;
+
+        for( ; head < limit; ++head )
+        {
+            if( inString )
+            {
+                if( *head == '\\' )
+                {
+                    if( head + 1 < limit )
+                        ++head;     // an escaped character cannot end the string
+                }
+                else if( *head == stringDelimiter )
+                {
+                    inString = false;
+                }
+            }
+            else if( *head == stringDelimiter )
+            {
+                inString = true;
+            }
+            else if( *head == '(' )
+            {
+                ++depth;
+            }
+            else if( *head == ')' && --depth == 0 )
+            {
+                aText->append( cur, head + 1 );
+
+                prevTok = curTok;
+                curTok  = DSN_RIGHT;
+                setCurText( head, head + 1 );
+                curOffset = head - start;
+                next = head + 1;
+                return;
+            }
+        }
+
+        aText->append( cur, head );
+        cur = head;
+    }
+}
+
+
 wxArrayString* DSNLEXER::ReadCommentLines() throw( IO_ERROR )
 {
     wxArrayString*  ret = 0;
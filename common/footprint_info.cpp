@@ -29,11 +29,11 @@
 
 
 /**
-    No. concurrent threads doing "http(s) GET". More than 6 is not significantly
-    faster, less than 6 is likely slower. Main thread is in this count, so if
-    set to 1 then no temp threads are created.
+    No. concurrent tasks doing "http(s) GET". More than 6 is not significantly
+    faster, less than 6 is likely slower.  The local libraries are read by all
+    the threads of the THREAD_POOL.
 */
-#define READER_THREADS      6
+#define GITHUB_READER_THREADS   6
 
 /*
  * Functions to read footprint libraries and fill m_footprints by available footprints names
@@ -50,7 +50,8 @@
 #include <fp_lib_table.h>
 #include <fpid.h>
 #include <class_module.h>
-#include <boost/thread.hpp>
+#include <fp_lib_index.h>
+#include <thread_pool.h>
 #include <html_messagebox.h>
 
 
@@ -125,30 +126,81 @@ void FOOTPRINT_INFO::load()
 }
 
 
-void FOOTPRINT_LIST::loader_job( const wxString* aNicknameList, int aJobZ )
+void FOOTPRINT_LIST::loader_job( const wxString& aNickname )
 {
-    for( int i=0; i<aJobZ; ++i )
+    try
     {
-        const wxString& nickname = aNicknameList[i];
+        const FP_LIB_TABLE::ROW* row = m_lib_table->FindRow( aNickname );
 
-        try
+        // The information of the footprints of KiCad libraries is indexed, and only
+        // the footprint files modified since the index was stored are read.
+        if( IO_MGR::EnumFromStr( row->GetType() ) == IO_MGR::KICAD )
         {
-            wxArrayString fpnames = m_lib_table->FootprintEnumerate( nickname );
+            FP_LIB_INDEX index( row->GetFullURI( true ) );
+
+            try
+            {
+                index.Update();
+            }
+            catch( const IO_ERROR& ioe )
+            {
+                // The footprints which could be read are listed anyway
+                MUTLOCK lock( m_errors_lock );
+
+                ++m_error_count;
+                m_errors.push_back( new IO_ERROR( ioe ) );
+            }
 
-            for( unsigned ni=0;  ni<fpnames.GetCount();  ++ni )
+            const FP_LIB_INDEX::ENTRIES& entries = index.GetEntries();
+
+            for( FP_LIB_INDEX::ENTRIES::const_iterator it = entries.begin();
+                 it != entries.end();  ++it )
             {
-                FOOTPRINT_INFO* fpinfo = new FOOTPRINT_INFO( this, nickname, fpnames[ni] );
+                const FP_LIB_INDEX::ENTRY& entry = it->second;
 
-                addItem( fpinfo );
+                addItem( new FOOTPRINT_INFO( this, aNickname, it->first,
+                                             entry.m_padCount, entry.m_uniquePadCount,
+                                             entry.m_doc, entry.m_keywords ) );
             }
+
+            return;
         }
-        catch( const PARSE_ERROR& pe )
+
+        wxArrayString fpnames = m_lib_table->FootprintEnumerate( aNickname );
+
+        for( unsigned ni=0;  ni<fpnames.GetCount();  ++ni )
         {
-            // m_errors.push_back is not thread safe, lock its MUTEX.
-            MUTLOCK lock( m_errors_lock );
+            FOOTPRINT_INFO* fpinfo = new FOOTPRINT_INFO( this, aNickname, fpnames[ni] );
+
+            addItem( fpinfo );
+        }
+    }
+    catch( const PARSE_ERROR& pe )
+    {
+        // m_errors.push_back is not thread safe, lock its MUTEX.
+        MUTLOCK lock( m_errors_lock );
+
+        ++m_error_count;        // modify only under lock
+        m_errors.push_back( new IO_ERROR( pe ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        MUTLOCK lock( m_errors_lock );
 
-            ++m_error_count;        // modify only under lock
-            m_errors.push_back( new IO_ERROR( pe ) );
+        ++m_error_count;
+        m_errors.push_back( new IO_ERROR( ioe ) );
+    }
+
+    // Catch anything unexpected and map it into the expected.
+    // Likely even more important since this function runs on GUI-less
+    // worker threads.
+    catch( const std::exception& se )
+    {
+        // This is a round about way to do this, but who knows what THROW_IO_ERROR()
+        // may be tricked out to do someday, keep it in the game.
+        try
+        {
+            THROW_IO_ERROR( se.what() );
         }
         catch( const IO_ERROR& ioe )
         {
@@ -157,26 +209,6 @@ void FOOTPRINT_LIST::loader_job( const wxString* aNicknameList, int aJobZ )
             ++m_error_count;
             m_errors.push_back( new IO_ERROR( ioe ) );
         }
-
-        // Catch anything unexpected and map it into the expected.
-        // Likely even more important since this function runs on GUI-less
-        // worker threads.
-        catch( const std::exception& se )
-        {
-            // This is a round about way to do this, but who knows what THROW_IO_ERROR()
-            // may be tricked out to do someday, keep it in the game.
-            try
-            {
-                THROW_IO_ERROR( se.what() );
-            }
-            catch( const IO_ERROR& ioe )
-            {
-                MUTLOCK lock( m_errors_lock );
-
-                ++m_error_count;
-                m_errors.push_back( new IO_ERROR( ioe ) );
-            }
-        }
     }
 }
 
@@ -194,7 +226,7 @@ bool FOOTPRINT_LIST::ReadFootprintFiles( FP_LIB_TABLE* aTable, const wxString* a
 
     if( aNickname )
         // single footprint
-        loader_job( aNickname, 1 );
+        loader_job( *aNickname );
     else
     {
         std::vector< wxString > nicknames;
@@ -212,42 +244,37 @@ bool FOOTPRINT_LIST::ReadFootprintFiles( FP_LIB_TABLE* aTable, const wxString* a
         // none of them.
         LOCALE_IO   top_most_nesting;
 
-        // Something which will not invoke a thread copy constructor, one of many ways obviously:
-        typedef boost::ptr_vector< boost::thread >  MYTHREADS;
+        // One task per library on the shared thread pool: the local libraries use all
+        // the workers, the GitHub ones are limited to GITHUB_READER_THREADS requests at
+        // a time.  This thread runs tasks too while waiting.
+        TASK_GROUP  localJobs;
+        TASK_GROUP  githubJobs( GITHUB_READER_THREADS );
 
-        MYTHREADS threads;
-
-        unsigned jobz = (nicknames.size() + READER_THREADS - 1) / READER_THREADS;
-
-        // Give each thread JOBZ nicknames to process.  The last portion of, or if the entire
-        // size() is small, I'll do myself.
-        for( unsigned i=0; i<nicknames.size();  )
+        for( unsigned i=0; i<nicknames.size();  ++i )
         {
-            if( i + jobz >= nicknames.size() )  // on the last iteration of this for(;;)
+            const wxString& nickname = nicknames[i];
+            bool            github = false;
+
+            try
             {
-                jobz = nicknames.size() - i;
+                const FP_LIB_TABLE::ROW* row = aTable->FindRow( nickname );
 
-                // Only a little bit to do, I'll do it myself on current thread.
-                // I am part of the READER_THREADS count.
-                loader_job( &nicknames[i], jobz );
+                github = IO_MGR::EnumFromStr( row->GetType() ) == IO_MGR::GITHUB;
             }
-            else
+            catch( const IO_ERROR& )
             {
-                // Delegate the job to a temporary thread created here.
-                threads.push_back( new boost::thread( &FOOTPRINT_LIST::loader_job,
-                        this, &nicknames[i], jobz ) );
+                // loader_job() reports it
             }
 
-            i += jobz;
+            ( github ? githubJobs : localJobs ).Add( [this, &nickname]()
+                {
+                    loader_job( nickname );
+                } );
         }
 
-        // Wait for all the worker threads to complete, it does not matter in what order
-        // we wait for them as long as a full sweep is made.  Think of the great race,
-        // everyone must finish.
-        for( unsigned i=0;  i<threads.size();  ++i )
-        {
-            threads[i].join();
-        }
+        // loader_job() does not throw
+        localJobs.Wait();
+        githubJobs.Wait();
 
         m_list.sort();
     }
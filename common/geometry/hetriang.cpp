@@ -220,6 +220,41 @@ void TRIANGULATION::CreateDelaunay( NODES_CONTAINER::iterator aFirst,
 }
 
 
+bool TRIANGULATION::InsertNode( const NODE_PTR& aNode )
+{
+    if( m_leadingEdges.empty() )
+        return false;
+
+    DART dart = CreateDart();
+
+    if( !ttl::TRIANGULATION_HELPER::LocateTriangle<TTLtraits>( aNode, dart ) )
+        return false;
+
+    // A node lying on the boundary would leave a degenerate triangle there
+    DART side = dart;
+
+    for( int i = 0; i < 3; ++i )
+    {
+        if( !side.GetEdge()->GetTwinEdge() && TTLtraits::CrossProduct2D( side, aNode ) == 0.0 )
+            return false;
+
+        side.Alpha0().Alpha1();
+    }
+
+    NODE_PTR node( aNode );
+
+    return m_helper->InsertNode<TTLtraits>( dart, node );
+}
+
+
+void TRIANGULATION::RemoveNode( const EDGE_PTR& aEdge )
+{
+    DART dart( aEdge );
+
+    m_helper->RemoveNode<TTLtraits>( dart );
+}
+
+
 void TRIANGULATION::RemoveTriangle( EDGE_PTR& aEdge )
 {
   EDGE_PTR e1 = getLeadingEdgeInTriangle( aEdge );
@@ -31,6 +31,7 @@
 #include <pgm_base.h>
 
 #include <common.h>
+#include <thread_pool.h>
 
 /// Initialize aDst SEARCH_STACK with KIFACE (DSO) specific settings.
 /// A non-member function so it an be moved easily, plus it's nobody's business.
@@ -96,12 +97,16 @@ bool KIFACE_I::start_common( int aCtlBits )
     m_bm.Init();
     setSearchPaths( &m_bm.m_search, m_id );
 
+    THREAD_POOL::Startup();
+
     return true;
 }
 
 
 void KIFACE_I::end_common()
 {
+    THREAD_POOL::Shutdown();
+
     m_bm.End();
 }
 
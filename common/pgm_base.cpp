@@ -51,6 +51,7 @@
 #include <menus_helpers.h>
 #include <confirm.h>
 #include <dialog_env_var_config.h>
+#include <thread_pool.h>
 
 
 #define KICAD_COMMON                     wxT( "kicad_common" )
@@ -312,6 +313,9 @@ void PGM_BASE::destroy()
 
     delete m_locale;
     m_locale = 0;
+
+    // The pool of this module, if something used it
+    THREAD_POOL::Shutdown();
 }
 
 
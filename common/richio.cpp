@@ -28,6 +28,9 @@
 
 #include <richio.h>
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
 #if !defined( HAVE_FGETC_NOLOCK )
@@ -259,14 +262,16 @@ char* FILE_LINE_READER::ReadLine() throw( IO_ERROR )
 }
 
 
-STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ) :
+STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource,
+                                        unsigned aStartingLineNumber ) :
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     lines( aString ),
     ndx( 0 )
 {
     // Clipboard text should be nice and _use multiple lines_ so that
     // we can report _line number_ oriented error messages when parsing.
-    source = aSource;
+    source  = aSource;
+    lineNum = aStartingLineNumber;
 }
 
 
@@ -315,6 +320,159 @@ char* STRING_LINE_READER::ReadLine() throw( IO_ERROR )
 }
 
 
+const char* STRING_LINE_READER::ReadLineView( unsigned* aLength ) throw( IO_ERROR )
+{
+    size_t  nlOffset = lines.find( '\n', ndx );
+
+    if( nlOffset == std::string::npos )
+        length = lines.length() - ndx;
+    else
+        length = nlOffset - ndx + 1;     // include the newline, so +1
+
+    if( length >= maxLineLength )
+        THROW_IO_ERROR( _("Line length exceeded") );
+
+    // The last line is ended by the nul of the std::string, the other ones by '\n'
+    const char* ret = length ? lines.c_str() + ndx : NULL;
+
+    ndx += length;
+
+    ++lineNum;      // this gets incremented even if no bytes were read
+
+    *aLength = length;
+    return ret;
+}
+
+
+//-----<MMAP_LINE_READER>-------------------------------------------------
+
+MMAP_LINE_READER::MMAP_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber,
+            unsigned aMaxLineLength ) throw( IO_ERROR ) :
+    LINE_READER( aMaxLineLength ),
+    m_data( NULL ),
+    m_size( 0 ),
+    m_offset( 0 )
+{
+    FILE* fp = wxFopen( aFileName, wxT( "rb" ) );
+
+    if( !fp )
+    {
+        wxString msg = wxString::Format(
+            _( "Unable to open filename '%s' for reading" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+    source  = aFileName;
+    lineNum = aStartingLineNumber;
+
+    fseek( fp, 0, SEEK_END );
+    long size = ftell( fp );
+
+    if( size > 0 )
+    {
+        try
+        {
+            using namespace boost::interprocess;
+
+            m_mapping.reset( new file_mapping( aFileName.fn_str(), read_only ) );
+            m_region.reset( new mapped_region( *m_mapping, read_only ) );
+
+            m_data = static_cast<const char*>( m_region->get_address() );
+            m_size = m_region->get_size();
+        }
+        catch( const boost::interprocess::interprocess_exception& )
+        {
+            // The file cannot be mapped (special file, out of address space...):
+            // read it in one block instead.
+            m_region.reset();
+            m_mapping.reset();
+
+            m_buffer.resize( size );
+            fseek( fp, 0, SEEK_SET );
+            m_buffer.resize( fread( &m_buffer[0], 1, size, fp ) );
+
+            m_data = m_buffer.data();
+            m_size = m_buffer.size();
+        }
+    }
+
+    fclose( fp );
+}
+
+
+MMAP_LINE_READER::~MMAP_LINE_READER()
+{
+    // the region must be unmapped before the mapping is closed
+    m_region.reset();
+    m_mapping.reset();
+}
+
+
+const char* MMAP_LINE_READER::ReadLineView( unsigned* aLength ) throw( IO_ERROR )
+{
+    const char* begin = m_data + m_offset;
+    size_t      remaining = m_size - m_offset;
+    const char* nl = remaining ? (const char*) memchr( begin, '\n', remaining ) : NULL;
+    size_t      len = nl ? nl - begin + 1 : remaining;     // include the newline
+
+    if( len > maxLineLength )
+        THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+
+    m_offset += len;
+
+    // lineNum is incremented even if there was no line read, because this
+    // leads to better error reporting when we hit an end of file.
+    ++lineNum;
+
+    const char* ret = begin;
+
+    if( !len )
+    {
+        line[0] = 0;
+        ret = NULL;
+    }
+    else if( !nl )
+    {
+        // The last line has no '\n' and the mapping is not nul terminated:
+        // it is the only line which is copied.
+        copyToLine( begin, len );
+        ret = line;
+    }
+
+    length   = len;
+    *aLength = len;
+
+    return ret;
+}
+
+
+char* MMAP_LINE_READER::ReadLine() throw( IO_ERROR )
+{
+    unsigned    len;
+    const char* view = ReadLineView( &len );
+
+    if( view && view != line )
+        copyToLine( view, len );
+
+    return view ? line : NULL;
+}
+
+
+void MMAP_LINE_READER::copyToLine( const char* aText, unsigned aLength )
+{
+    // nothing of the previous line has to be kept by expandCapacity()
+    length = 0;
+
+    if( aLength+1 > capacity )
+        expandCapacity( aLength+1 );
+
+    memcpy( line, aText, aLength );
+    line[aLength] = 0;
+    length = aLength;
+}
+
+
 INPUTSTREAM_LINE_READER::INPUTSTREAM_LINE_READER( wxInputStream* aStream, const wxString& aSource ) :
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     m_stream( aStream )
@@ -438,10 +596,10 @@ int OUTPUTFORMATTER::sprint( const char* fmt, ... )  throw( IO_ERROR )
 }
 
 
-int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... ) throw( IO_ERROR )
-{
 #define NESTWIDTH           2   ///< how many spaces per nestLevel
 
+int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... ) throw( IO_ERROR )
+{
     va_list     args;
 
     va_start( args, fmt );
@@ -452,9 +610,9 @@ int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... ) throw( IO_ERRO
     for( int i=0; i<nestLevel;  ++i )
     {
         // no error checking needed, an exception indicates an error.
-        result = sprint( "%*c", NESTWIDTH, ' ' );
+        write( "  ", NESTWIDTH );
 
-        total += result;
+        total += NESTWIDTH;
     }
 
     // no error checking needed, an exception indicates an error.
@@ -467,6 +625,16 @@ int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... ) throw( IO_ERRO
 }
 
 
+void OUTPUTFORMATTER::Write( int nestLevel, const char* aText, int aCount ) throw( IO_ERROR )
+{
+    for( int i=0; i<nestLevel;  ++i )
+        write( "  ", NESTWIDTH );
+
+    if( aCount > 0 )
+        write( aText, aCount );
+}
+
+
 std::string OUTPUTFORMATTER::Quotes( const std::string& aWrapee ) throw( IO_ERROR )
 {
     static const char quoteThese[] = "\t ()\n\r";
@@ -0,0 +1,338 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file thread_pool.cpp
+ */
+
+#include <thread_pool.h>
+
+#include <boost/bind.hpp>
+
+
+typedef boost::thread_specific_ptr< std::pair<const THREAD_POOL*, unsigned> > WORKER_PTR;
+
+/**
+ * Function workerOfThread
+ * @return the pool and the index of the worker running on the current thread.  It is
+ * created by the first pool, so it is destroyed after the pools built later.
+ */
+static WORKER_PTR& workerOfThread()
+{
+    static WORKER_PTR worker;
+
+    return worker;
+}
+
+
+/// The process wide pool, see THREAD_POOL::Startup()
+static THREAD_POOL*     s_instance = NULL;
+static boost::mutex     s_instanceLock;
+
+
+void THREAD_POOL::Startup()
+{
+    GetInstance();
+}
+
+
+void THREAD_POOL::Shutdown()
+{
+    THREAD_POOL* pool;
+
+    {
+        boost::lock_guard<boost::mutex> lock( s_instanceLock );
+        pool = s_instance;
+        s_instance = NULL;
+    }
+
+    // Joins the workers, without holding the lock a running task could need
+    delete pool;
+}
+
+
+THREAD_POOL& THREAD_POOL::GetInstance()
+{
+    boost::lock_guard<boost::mutex> lock( s_instanceLock );
+
+    if( !s_instance )
+        s_instance = new THREAD_POOL( boost::thread::hardware_concurrency() );
+
+    return *s_instance;
+}
+
+
+THREAD_POOL::THREAD_POOL( unsigned aThreadCount ) :
+    m_queuedCount( 0 ),
+    m_nextQueue( 0 ),
+    m_stop( false )
+{
+    if( aThreadCount == 0 )
+        aThreadCount = 1;
+
+    workerOfThread();
+
+    // All the queues must exist before a worker can steal from them
+    for( unsigned ii = 0; ii < aThreadCount; ++ii )
+        m_queues.push_back( new QUEUE );
+
+    for( unsigned ii = 0; ii < aThreadCount; ++ii )
+        m_threads.create_thread( boost::bind( &THREAD_POOL::work, this, ii ) );
+}
+
+
+THREAD_POOL::~THREAD_POOL()
+{
+    {
+        boost::lock_guard<boost::mutex> lock( m_lock );
+        m_stop = true;
+    }
+
+    m_taskQueued.notify_all();
+    m_threads.join_all();
+}
+
+
+int THREAD_POOL::workerIndex() const
+{
+    const std::pair<const THREAD_POOL*, unsigned>* worker = workerOfThread().get();
+
+    if( worker && worker->first == this )
+        return worker->second;
+
+    return -1;
+}
+
+
+void THREAD_POOL::Submit( const TASK& aTask )
+{
+    int queue = workerIndex();
+
+    if( queue < 0 )
+    {
+        boost::lock_guard<boost::mutex> lock( m_lock );
+
+        queue = m_nextQueue;
+        m_nextQueue = ( m_nextQueue + 1 ) % m_queues.size();
+    }
+
+    {
+        boost::lock_guard<boost::mutex> lock( m_queues[queue].m_lock );
+        m_queues[queue].m_tasks.push_back( aTask );
+    }
+
+    {
+        boost::lock_guard<boost::mutex> lock( m_lock );
+        ++m_queuedCount;
+    }
+
+    m_taskQueued.notify_one();
+}
+
+
+bool THREAD_POOL::RunPendingTask()
+{
+    TASK task;
+
+    if( !takeTask( workerIndex(), task ) )
+        return false;
+
+    task();
+
+    return true;
+}
+
+
+bool THREAD_POOL::takeTask( int aIndex, TASK& aTask )
+{
+    unsigned count = m_queues.size();
+    unsigned first = aIndex < 0 ? 0 : aIndex;
+
+    for( unsigned ii = 0; ii < count; ++ii )
+    {
+        QUEUE&  queue = m_queues[( first + ii ) % count];
+        bool    own = aIndex >= 0 && ii == 0;
+
+        {
+            boost::lock_guard<boost::mutex> lock( queue.m_lock );
+
+            if( queue.m_tasks.empty() )
+                continue;
+
+            // The newest task of its own queue is the most likely to use the data the
+            // worker just used, the oldest task of another queue is the most likely to
+            // spawn other tasks.
+            if( own )
+            {
+                aTask = queue.m_tasks.back();
+                queue.m_tasks.pop_back();
+            }
+            else
+            {
+                aTask = queue.m_tasks.front();
+                queue.m_tasks.pop_front();
+            }
+        }
+
+        boost::lock_guard<boost::mutex> lock( m_lock );
+        --m_queuedCount;
+
+        return true;
+    }
+
+    return false;
+}
+
+
+void THREAD_POOL::work( unsigned aIndex )
+{
+    workerOfThread().reset( new std::pair<const THREAD_POOL*, unsigned>( this, aIndex ) );
+
+    TASK task;
+
+    while( true )
+    {
+        if( takeTask( aIndex, task ) )
+        {
+            task();
+            task = TASK();      // release the task data now
+            continue;
+        }
+
+        boost::unique_lock<boost::mutex> lock( m_lock );
+
+        while( m_queuedCount == 0 && !m_stop )
+            m_taskQueued.wait( lock );
+
+        if( m_stop )
+            break;
+    }
+}
+
+
+TASK_GROUP::TASK_GROUP( unsigned aMaxConcurrency, THREAD_POOL& aPool ) :
+    m_pool( aPool ),
+    m_maxConcurrency( aMaxConcurrency ),
+    m_runningCount( 0 )
+{
+}
+
+
+TASK_GROUP::~TASK_GROUP()
+{
+    try
+    {
+        Wait();
+    }
+    catch( ... )
+    {
+        // Errors are only reported by Wait()
+    }
+}
+
+
+void TASK_GROUP::Add( const THREAD_POOL::TASK& aTask )
+{
+    {
+        boost::lock_guard<boost::mutex> lock( m_lock );
+
+        if( m_maxConcurrency && m_runningCount >= m_maxConcurrency )
+        {
+            m_heldTasks.push_back( aTask );
+            return;
+        }
+
+        ++m_runningCount;
+    }
+
+    m_pool.Submit( boost::bind( &TASK_GROUP::run, this, aTask ) );
+}
+
+
+void TASK_GROUP::run( THREAD_POOL::TASK aTask )
+{
+    while( true )
+    {
+        try
+        {
+            aTask();
+        }
+        catch( ... )
+        {
+            boost::lock_guard<boost::mutex> lock( m_lock );
+
+            if( !m_error )
+                m_error = std::current_exception();
+        }
+
+        boost::lock_guard<boost::mutex> lock( m_lock );
+
+        // A held task takes the place of the finished one
+        if( m_heldTasks.empty() )
+        {
+            --m_runningCount;
+
+            // Notified with the lock held: the waiting thread can destroy the group as soon
+            // as it gets the lock.
+            m_finished.notify_all();
+            return;
+        }
+
+        aTask = m_heldTasks.front();
+        m_heldTasks.pop_front();
+    }
+}
+
+
+void TASK_GROUP::Wait()
+{
+    while( true )
+    {
+        {
+            boost::lock_guard<boost::mutex> lock( m_lock );
+
+            if( m_runningCount == 0 )
+                break;
+        }
+
+        // Help the workers, or else sleep until a task of the group finishes.  The sleep
+        // is short, because new tasks to help with do not wake this thread up.
+        if( m_pool.RunPendingTask() )
+            continue;
+
+        boost::unique_lock<boost::mutex> lock( m_lock );
+
+        if( m_runningCount )
+            m_finished.timed_wait( lock, boost::posix_time::milliseconds( 10 ) );
+    }
+
+    std::exception_ptr error;
+
+    {
+        boost::lock_guard<boost::mutex> lock( m_lock );
+        std::swap( error, m_error );
+    }
+
+    if( error )
+        std::rethrow_exception( error );
+}
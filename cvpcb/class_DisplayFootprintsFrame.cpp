@@ -513,13 +513,13 @@ void DISPLAY_FOOTPRINTS_FRAME::InitDisplay()
         if( GetBoard()->m_Modules.GetCount() )
         {
             // there is only one module in the list
-            GetBoard()->m_Modules.DeleteAll();
+            GetBoard()->DeleteAllModules();
         }
 
         MODULE* module = Get_Module( footprintName );
 
         if( module )
-            GetBoard()->m_Modules.PushBack( module );
+            GetBoard()->Add( module );
 
         Zoom_Automatique( false );
     }
@@ -527,7 +527,7 @@ void DISPLAY_FOOTPRINTS_FRAME::InitDisplay()
     {
         if( GetBoard()->m_Modules.GetCount() )
         {
-            GetBoard()->m_Modules.DeleteAll();
+            GetBoard()->DeleteAllModules();
             Zoom_Automatique( false );
             SetStatusText( wxEmptyString, 0 );
         }
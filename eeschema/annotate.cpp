@@ -174,6 +174,10 @@ void SCH_EDIT_FRAME::AnnotateComponents( bool              aAnnotateSchematic,
         wxLogWarning( msg );
     }
 
+    // The unit of annotated components can have changed in any sheet
+    for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+        screen->ConnectivityChanged();
+
     OnModify();
 
     // Update on screen references, that can be modified by previous calculations:
@@ -36,6 +36,9 @@
 #include <lib_pin.h>      // LIB_PIN::PinStringNum( m_PinNum )
 #include <sch_item_struct.h>
 
+class NET_CODE_SETS;
+class SHEET_CONNECTION_POINTS;
+
 class NETLIST_OBJECT_LIST;
 class SCH_COMPONENT;
 
@@ -314,6 +317,22 @@ public:
      */
     bool BuildNetListInfo( SCH_SHEET_LIST& aSheets );
 
+    /**
+     * Function AppendSheetItems
+     * adds to the list the connected objects of the items of a sheet, not connected yet.
+     * @param aSheet = the sheet path of the items, kept in the objects
+     */
+    void AppendSheetItems( SCH_SHEET_PATH& aSheet );
+
+    /**
+     * Function ConnectItems
+     * builds the net codes and the net names of the objects of the list, collected from
+     * all the sheets of the hierarchy by AppendSheetItems().  This is the second step of
+     * BuildNetListInfo().
+     * @return true if OK, false if the list is empty
+     */
+    bool ConnectItems();
+
     /**
      * Acces to an item in list
      */
@@ -379,22 +398,17 @@ public:
      */
     void SortListbySheet();
 
-    /**
-     * Counts number of pins connected on the same net.
-     * Used to count all pins connected to a no connect symbol
-     * @return the pin count of the net starting at aNetStart
-     * @param aNetStart = index in list of net objects of the first item
-     */
-    int CountPinsInNet( unsigned aNetStart );
-
     /**
      * Function TestforNonOrphanLabel
      * Sheet labels are expected to be connected to a hierarchical label.
      * Hierarchical labels are expected to be connected to a sheet label.
      * Global labels are expected to be not orphan (connected to at least one other global label.
      * this function tests the connection to an other suitable label
+     * @return false if the label at \a aNetItemRef is orphan
+     * @param aNetItemRef = index in list of the label
+     * @param aStartNet = index in list of net objects of the first item
      */
-    void TestforNonOrphanLabel( unsigned aNetItemRef, unsigned aStartNet );
+    bool TestforNonOrphanLabel( unsigned aNetItemRef, unsigned aStartNet );
 
     /**
      * Function TestforSimilarLabels
@@ -452,16 +466,23 @@ private:
      */
     void sheetLabelConnect( NETLIST_OBJECT* aSheetLabel );
 
-    void pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus, int start );
+    /**
+     * Search the items of the sheet of aRef having an end point at an end point of aRef,
+     * and merge their net code (or bus net code if aIsBus) with the one of aRef.
+     * aPoints indexes the items of the sheet of aRef, and aNetCodes records the merges
+     * of net codes (or of bus net codes) made while building the sheet connections.
+     */
+    void pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus,
+                              const SHEET_CONNECTION_POINTS& aPoints, NET_CODE_SETS& aNetCodes );
 
     /**
      * Search connections between a junction and segments
      * Propagate the junction net code to objects connected by this junction.
      * The junction must have a valid net code
-     * The list of objects is expected sorted by sheets.
-     * Search is done from index aIdxStart to the last element of list
+     * aPoints and aNetCodes are the same as for pointToPointConnect().
      */
-    void segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus, int aIdxStart );
+    void segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus,
+                                const SHEET_CONNECTION_POINTS& aPoints, NET_CODE_SETS& aNetCodes );
 
 
     /**
@@ -40,6 +40,7 @@
 #include <sch_marker.h>
 
 #include <../eeschema/general.h>
+#include <../eeschema/sch_screen_index.h>
 
 
 class LIB_PIN;
@@ -85,6 +86,18 @@ private:
     int     m_modification_sync;        ///< inequality with PART_LIBS::GetModificationHash()
                                         ///< will trigger ResolveAll().
 
+    unsigned m_connectivityRevision;    ///< see GetConnectivityRevision()
+
+    mutable SCH_SCREEN_INDEX m_index;   ///< the areas of the items of m_drawList
+    mutable bool m_indexValid;          ///< false if m_index must be built again
+
+    /**
+     * Function getIndex
+     * @return the spatial index of the draw items, built again if the items were changed
+     *         since the last call.
+     */
+    SCH_SCREEN_INDEX& getIndex() const;
+
     /**
      * Function addConnectedItemsToBlock
      * add items connected at \a aPosition to the block pick list.
@@ -141,6 +154,10 @@ public:
     {
         m_drawList.Append( aItem );
         --m_modification_sync;
+        m_indexValid = false;
+
+        if( aItem->Type() != SCH_MARKER_T )
+            ConnectivityChanged();
     }
 
     /**
@@ -153,8 +170,25 @@ public:
     {
         m_drawList.Append( aList );
         --m_modification_sync;
+        ConnectivityChanged();
     }
 
+    /**
+     * Function GetConnectivityRevision
+     * @return a number changed by each change of the items of the screen, and never used
+     *         by another screen, so the connected items cached for the sheets using this
+     *         screen (see SCH_CONNECTIVITY) are known to be out of date.
+     */
+    unsigned GetConnectivityRevision() const                { return m_connectivityRevision; }
+
+    /**
+     * Function ConnectivityChanged
+     * records that items of the screen were added, removed or modified.  The edit
+     * functions call it through SCH_EDIT_FRAME::OnModify().  The spatial index of the
+     * items is built again by the next draw or hit test.
+     */
+    void ConnectivityChanged();
+
     /**
      * Function GetCurItem
      * returns the currently selected SCH_ITEM, overriding BASE_SCREEN::GetCurItem().
@@ -165,9 +199,21 @@ public:
     /**
      * Function SetCurItem
      * sets the currently selected object, m_CurrentItem.
+     * <p>
+     * The interactive edit commands select the item they start on, and clear the selection
+     * when the item is placed, so the spatial index is built again when the selected item
+     * changes, as it may have been moved before the edit is recorded by
+     * ConnectivityChanged().
+     * </p>
      * @param aItem Any object derived from SCH_ITEM
      */
-    void SetCurItem( SCH_ITEM* aItem ) { BASE_SCREEN::SetCurItem( (EDA_ITEM*) aItem ); }
+    void SetCurItem( SCH_ITEM* aItem )
+    {
+        if( BASE_SCREEN::GetCurItem() )
+            m_indexValid = false;
+
+        BASE_SCREEN::SetCurItem( (EDA_ITEM*) aItem );
+    }
 
     /**
      * Function Clear
@@ -208,7 +254,7 @@ public:
 
     /**
      * Function Draw
-     * draws all the items in the screen to \a aCanvas.
+     * draws the items of the screen inside the clip box of \a aCanvas to \a aCanvas.
      * note: this function is useful only for schematic.
      * library editor and library viewer do not use a draw list, and therefore
      * draws nothing
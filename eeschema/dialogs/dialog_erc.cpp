@@ -449,6 +449,20 @@ void DIALOG_ERC::ChangeErrorLevel( wxCommandEvent& event )
 }
 
 
+/**
+ * Function logTestTime
+ * logs (with the trace mask traceErc) the time since \a aStartTime, in microseconds,
+ * spent by the ERC test \a aTest, and restarts the timer for the next test.
+ */
+static void logTestTime( const wxChar* aTest, unsigned& aStartTime )
+{
+    unsigned time = GetRunningMicroSecs();
+
+    wxLogTrace( traceErc, wxT( "ERC %s: %u usecs" ), aTest, time - aStartTime );
+    aStartTime = time;
+}
+
+
 void DIALOG_ERC::TestErc( wxArrayString* aMessagesList )
 {
     wxFileName fn;
@@ -473,6 +487,8 @@ void DIALOG_ERC::TestErc( wxArrayString* aMessagesList )
         return;
     }
 
+    unsigned startTime = GetRunningMicroSecs();
+
     SCH_SCREENS screens;
 
     // Erase all previous DRC markers.
@@ -487,97 +503,34 @@ void DIALOG_ERC::TestErc( wxArrayString* aMessagesList )
             screen->ClearUndoRedoList();
     }
 
+    logTestTime( wxT( "schematic cleanup" ), startTime );
+
     /* Test duplicate sheet names inside a given sheet, one cannot have sheets with
      * duplicate names (file names can be duplicated).
      */
     TestDuplicateSheetNames( true );
 
+    logTestTime( wxT( "duplicate sheet names" ), startTime );
+
     std::unique_ptr<NETLIST_OBJECT_LIST> objectsConnectedList( m_parent->BuildNetListBase() );
 
+    logTestTime( wxT( "netlist" ), startTime );
+
     // Reset the connection type indicator
     objectsConnectedList->ResetConnectionsType();
 
-    unsigned lastItemIdx;
-    unsigned nextItemIdx = lastItemIdx = 0;
-    int MinConn    = NOC;
-
-    /* The netlist generated by SCH_EDIT_FRAME::BuildNetListBase is sorted
-     * by net number, which means we can group netlist items into ranges
-     * that live in the same net. The range from nextItem to the current
-     * item (exclusive) needs to be checked against the current item. The
-     * lastItem variable is used as a helper to pass the last item's number
-     * from one loop iteration to the next, which simplifies the initial
-     * pass.
-     */
-
-    for( unsigned itemIdx = 0; itemIdx < objectsConnectedList->size(); itemIdx++ )
-    {
-        auto item = objectsConnectedList->GetItem( itemIdx );
-        auto lastItem = objectsConnectedList->GetItem( lastItemIdx );
-
-        auto lastNet = lastItem->GetNet();
-        auto net = item->GetNet();
+    // Test the pins and the hierarchical labels of each net
+    TestNets( objectsConnectedList.get(), m_tstUniqueGlobalLabels );
 
-        wxASSERT_MSG( lastNet <= net, wxT( "Netlist not correctly ordered" ) );
-
-        if( lastNet != net )
-        {
-            // New net found:
-            MinConn      = NOC;
-            nextItemIdx = itemIdx;
-        }
-
-        switch( item->m_Type )
-        {
-        // These items do not create erc problems
-        case NET_ITEM_UNSPECIFIED:
-        case NET_SEGMENT:
-        case NET_BUS:
-        case NET_JUNCTION:
-        case NET_LABEL:
-        case NET_BUSLABELMEMBER:
-        case NET_PINLABEL:
-        case NET_GLOBBUSLABELMEMBER:
-            break;
-
-        case NET_HIERLABEL:
-        case NET_HIERBUSLABELMEMBER:
-        case NET_SHEETLABEL:
-        case NET_SHEETBUSLABELMEMBER:
-            // ERC problems when pin sheets do not match hierarchical labels.
-            // Each pin sheet must match a hierarchical label
-            // Each hierarchical label must match a pin sheet
-            objectsConnectedList->TestforNonOrphanLabel( itemIdx, nextItemIdx );
-            break;
-        case NET_GLOBLABEL:
-            if( m_tstUniqueGlobalLabels )
-                objectsConnectedList->TestforNonOrphanLabel( itemIdx, nextItemIdx );
-            break;
-
-        case NET_NOCONNECT:
-
-            // ERC problems when a noconnect symbol is connected to more than one pin.
-            MinConn = NET_NC;
-
-            if( objectsConnectedList->CountPinsInNet( nextItemIdx ) > 1 )
-                Diagnose( item, NULL, MinConn, UNC );
-
-            break;
-
-        case NET_PIN:
-
-            // Look for ERC problems between pins:
-            TestOthersItems( objectsConnectedList.get(), itemIdx, nextItemIdx, &MinConn );
-            break;
-        }
-
-        lastItemIdx = itemIdx;
-    }
+    logTestTime( wxT( "nets" ), startTime );
 
     // Test similar labels (i;e. labels which are identical when
     // using case insensitive comparisons)
     if( m_TestSimilarLabels )
+    {
         objectsConnectedList->TestforSimilarLabels();
+        logTestTime( wxT( "similar labels" ), startTime );
+    }
 
     // Displays global results:
     updateMarkerCounts( &screens );
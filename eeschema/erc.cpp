@@ -41,8 +41,15 @@
 #include <sch_component.h>
 #include <sch_sheet.h>
 
+#include <thread_pool.h>
+#include <hashtables.h>
+
 #include <wx/ffile.h>
 
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+
 
 /* ERC tests :
  *  1 - conflicts between connected pins ( example: 2 connected outputs )
@@ -76,6 +83,9 @@
  *  This ensures a forgotten connection will be detected.
  */
 
+const wxChar traceErc[] = wxT( "KICAD_ERC" );
+
+
 /* Messages for conflicts :
  *  PIN_INPUT, PIN_OUTPUT, PIN_BIDI, PIN_TRISTATE, PIN_PASSIVE,
  *  PIN_UNSPECIFIED, PIN_POWER_IN, PIN_POWER_OUT, PIN_OPENCOLLECTOR,
@@ -369,159 +379,327 @@ void Diagnose( NETLIST_OBJECT* aNetItemRef, NETLIST_OBJECT* aNetItemTst,
 }
 
 
-void TestOthersItems( NETLIST_OBJECT_LIST* aList,
-                      unsigned aNetItemRef, unsigned aNetStart,
-                      int* aMinConnexion )
+/// A problem found by the ERC tests of a net, turned into a marker by Diagnose()
+struct ERC_DIAG
 {
-    unsigned netItemTst = aNetStart;
-    ELECTRICAL_PINTYPE jj;
-    int erc = OK;
+    NETLIST_OBJECT* m_ItemRef;
+    NETLIST_OBJECT* m_ItemTst;
+    int             m_MinConn;
+    int             m_Diag;
+
+    ERC_DIAG( NETLIST_OBJECT* aItemRef, NETLIST_OBJECT* aItemTst, int aMinConn, int aDiag ) :
+        m_ItemRef( aItemRef ), m_ItemTst( aItemTst ), m_MinConn( aMinConn ), m_Diag( aDiag )
+    {
+    }
+};
+
+typedef std::vector<ERC_DIAG> ERC_DIAGS;
+
+
+/// The items of a net in the list, and what the ERC tests of the net need to know
+struct ERC_NET
+{
+    unsigned    m_Start;                        ///< index of the first item of the net
+    unsigned    m_End;                          ///< index after the last item of the net
+    unsigned    m_PinCount;
+    unsigned    m_NoConnectCount;
+    unsigned    m_PinTypeCount[PINTYPE_COUNT];  ///< pin count by electrical type
+
+    ERC_NET( unsigned aStart ) :
+        m_Start( aStart ), m_End( aStart ), m_PinCount( 0 ), m_NoConnectCount( 0 )
+    {
+        std::fill( m_PinTypeCount, m_PinTypeCount + PINTYPE_COUNT, 0 );
+    }
+};
 
-    /* Analysis of the table of connections. */
-    ELECTRICAL_PINTYPE ref_elect_type = aList->GetItem( aNetItemRef )->m_ElectricalPinType;
-    int local_minconn = NOC;
+
+/**
+ * Function testPin
+ * performs the ERC tests of the pin \a aPin of the net \a aNet: the electrical conflicts
+ * with the next pins of the net, and the minimal connection of the pin.
+ * @param aNextConflict is the index of the first pin after aPin having a pin type
+ *                      in conflict with aPin in DiagErc, or -1.
+ * @param aHasConnectedDuplicate is true if an other instance of aPin (same component
+ *                               reference and pin number) is connected.
+ * @param aMinConnexion is the minimal connection found for the net ( NOD, DRV, NPI,
+ *                      NET_NC ).
+ */
+static void testPin( NETLIST_OBJECT_LIST* aList, const ERC_NET& aNet, unsigned aPin,
+                     int aNextConflict, bool aHasConnectedDuplicate, int* aMinConnexion,
+                     ERC_DIAGS& aDiags )
+{
+    NETLIST_OBJECT*    pin = aList->GetItem( aPin );
+    ELECTRICAL_PINTYPE ref_elect_type = pin->m_ElectricalPinType;
+    int                local_minconn = NOC;
 
     if( ref_elect_type == PIN_NC )
         local_minconn = NPI;
 
-    /* Test pins connected to NetItemRef */
-    for( ; ; netItemTst++ )
+    if( aNet.m_NoConnectCount )
+        local_minconn = std::max( NET_NC, local_minconn );
+
+    // The minimal connection is given by the types of the other pins of the net
+    for( int jj = 0; jj < PINTYPE_COUNT; jj++ )
     {
-        if( aNetItemRef == netItemTst )
-            continue;
+        unsigned count = aNet.m_PinTypeCount[jj];
+
+        if( jj == ref_elect_type )
+            count--;
+
+        if( count )
+            local_minconn = std::max( MinimalReq[ref_elect_type][jj], local_minconn );
+    }
+
+    if( aNextConflict >= 0 )
+    {
+        NETLIST_OBJECT* other = aList->GetItem( aNextConflict );
+        int             erc = DiagErc[ref_elect_type][other->m_ElectricalPinType];
 
-        // We examine only a given net. We stop the search if the net changes
-        if( ( netItemTst >= aList->size() ) // End of list
-            || ( aList->GetItemNet( aNetItemRef ) !=
-                 aList->GetItemNet( netItemTst ) ) ) // End of net
+        if( other->GetConnectionType() == UNCONNECTED )
         {
-            /* End net code found: minimum connection test. */
-            if( ( *aMinConnexion < NET_NC ) && ( local_minconn < NET_NC ) )
-            {
-                /* Not connected or not driven pin. */
-                bool seterr = true;
+            aDiags.push_back( ERC_DIAG( pin, other, 0, erc ) );
+            other->SetConnectionType( NOCONNECT_SYMBOL_PRESENT );
+        }
+    }
 
-                if( local_minconn == NOC &&
-                    aList->GetItemType( aNetItemRef ) == NET_PIN )
-                {
-                    /* This pin is not connected: for multiple part per
-                     * package, and duplicated pin,
-                     * search for an other instance of this pin
-                     * this will be flagged only if all instances of this pin
-                     * are not connected
-                     * TODO test also if instances connected are connected to
-                     * the same net
-                     */
-                    for( unsigned duplicate = 0; duplicate < aList->size(); duplicate++ )
-                    {
-                        if( aList->GetItemType( duplicate ) != NET_PIN )
-                            continue;
-
-                        if( duplicate == aNetItemRef )
-                            continue;
-
-                        if( aList->GetItem( aNetItemRef )->m_PinNum !=
-                            aList->GetItem( duplicate )->m_PinNum )
-                            continue;
-
-                        if( ( (SCH_COMPONENT*) aList->GetItem( aNetItemRef )->
-                             m_Link )->GetRef( &aList->GetItem( aNetItemRef )-> m_SheetPath ) !=
-                            ( (SCH_COMPONENT*) aList->GetItem( duplicate )->m_Link )
-                           ->GetRef( &aList->GetItem( duplicate )->m_SheetPath ) )
-                            continue;
-
-                        // Same component and same pin. Do dot create error for this pin
-                        // if the other pin is connected (i.e. if duplicate net has an other
-                        // item)
-                        if( (duplicate > 0)
-                          && ( aList->GetItemNet( duplicate ) ==
-                               aList->GetItemNet( duplicate - 1 ) ) )
-                            seterr = false;
-
-                        if( (duplicate < aList->size() - 1)
-                          && ( aList->GetItemNet( duplicate ) ==
-                               aList->GetItemNet( duplicate + 1 ) ) )
-                            seterr = false;
-                    }
-                }
+    if( ( *aMinConnexion < NET_NC ) && ( local_minconn < NET_NC ) )
+    {
+        /* Not connected or not driven pin.
+         * For multiple part per package, and duplicated pin, an unconnected pin is
+         * flagged only if all instances of this pin are not connected
+         * TODO test also if instances connected are connected to the same net
+         */
+        if( local_minconn != NOC || !aHasConnectedDuplicate )
+            aDiags.push_back( ERC_DIAG( pin, NULL, local_minconn, WAR ) );
+
+        *aMinConnexion = DRV;   // inhibiting other messages of this type for the net.
+    }
+}
 
-                if( seterr )
-                    Diagnose( aList->GetItem( aNetItemRef ), NULL, local_minconn, WAR );
 
-                *aMinConnexion = DRV;   // inhibiting other messages of this
-                                       // type for the net.
-            }
-            return;
+/**
+ * Function testNet
+ * performs the ERC tests of the items of the net \a aNet.
+ * @param aConnectedDuplicates tells, for each item of the list, if the item is a pin
+ *                             having an other connected instance.
+ */
+static void testNet( NETLIST_OBJECT_LIST* aList, const ERC_NET& aNet,
+                     bool aTestUniqueGlobalLabels,
+                     const std::vector<bool>& aConnectedDuplicates, ERC_DIAGS& aDiags )
+{
+    unsigned count = aNet.m_End - aNet.m_Start;
+
+    // The first pin after each pin in conflict with it, found from the end of the net
+    std::vector<int> nextConflicts( count, -1 );
+    int              nextPins[PINTYPE_COUNT];
+
+    std::fill( nextPins, nextPins + PINTYPE_COUNT, -1 );
+
+    for( unsigned ii = aNet.m_End; ii-- > aNet.m_Start; )
+    {
+        NETLIST_OBJECT* item = aList->GetItem( ii );
+
+        if( item->m_Type != NET_PIN )
+            continue;
+
+        int& next = nextConflicts[ii - aNet.m_Start];
+
+        for( int jj = 0; jj < PINTYPE_COUNT; jj++ )
+        {
+            if( nextPins[jj] >= 0 && DiagErc[item->m_ElectricalPinType][jj] != OK
+              && ( next < 0 || nextPins[jj] < next ) )
+                next = nextPins[jj];
         }
 
-        switch( aList->GetItemType( netItemTst ) )
+        nextPins[item->m_ElectricalPinType] = ii;
+    }
+
+    int minConn = NOC;
+
+    for( unsigned ii = aNet.m_Start; ii < aNet.m_End; ii++ )
+    {
+        NETLIST_OBJECT* item = aList->GetItem( ii );
+
+        switch( item->m_Type )
         {
+        // These items do not create erc problems
         case NET_ITEM_UNSPECIFIED:
         case NET_SEGMENT:
         case NET_BUS:
         case NET_JUNCTION:
         case NET_LABEL:
-        case NET_HIERLABEL:
         case NET_BUSLABELMEMBER:
+        case NET_PINLABEL:
+        case NET_GLOBBUSLABELMEMBER:
+            break;
+
+        case NET_HIERLABEL:
         case NET_HIERBUSLABELMEMBER:
-        case NET_SHEETBUSLABELMEMBER:
         case NET_SHEETLABEL:
+        case NET_SHEETBUSLABELMEMBER:
+            // ERC problems when pin sheets do not match hierarchical labels.
+            // Each pin sheet must match a hierarchical label
+            // Each hierarchical label must match a pin sheet
+            if( !aList->TestforNonOrphanLabel( ii, aNet.m_Start ) )
+                aDiags.push_back( ERC_DIAG( item, NULL, -1, WAR ) );
+
+            break;
+
         case NET_GLOBLABEL:
-        case NET_GLOBBUSLABELMEMBER:
-        case NET_PINLABEL:
+            if( aTestUniqueGlobalLabels && !aList->TestforNonOrphanLabel( ii, aNet.m_Start ) )
+                aDiags.push_back( ERC_DIAG( item, NULL, -1, WAR ) );
+
             break;
 
         case NET_NOCONNECT:
-            local_minconn = std::max( NET_NC, local_minconn );
+            // ERC problems when a noconnect symbol is connected to more than one pin.
+            minConn = NET_NC;
+
+            if( aNet.m_PinCount > 1 )
+                aDiags.push_back( ERC_DIAG( item, NULL, minConn, UNC ) );
+
             break;
 
         case NET_PIN:
-            jj = aList->GetItem( netItemTst )->m_ElectricalPinType;
-            local_minconn = std::max( MinimalReq[ref_elect_type][jj], local_minconn );
+            // Look for ERC problems between pins:
+            testPin( aList, aNet, ii, nextConflicts[ii - aNet.m_Start],
+                     aConnectedDuplicates[ii], &minConn, aDiags );
+            break;
+        }
+    }
+}
 
-            if( netItemTst <= aNetItemRef )
-                break;
 
-            if( erc == OK )
-            {
-                erc = DiagErc[ref_elect_type][jj];
+/**
+ * Function findConnectedDuplicates
+ * finds the pins having an other instance (a pin of the same component reference, with
+ * the same pin number) which is connected to other items.
+ * @return a flag for each item of \a aList
+ */
+static std::vector<bool> findConnectedDuplicates( NETLIST_OBJECT_LIST* aList )
+{
+    typedef std::unordered_map<wxString, unsigned, WXSTRING_HASH> PIN_COUNTS;
 
-                if( erc != OK )
-                {
-                    if( aList->GetConnectionType( netItemTst ) == UNCONNECTED )
-                    {
-                        Diagnose( aList->GetItem( aNetItemRef ),
-                                  aList->GetItem( netItemTst ),
-                                  0, erc );
-                        aList->SetConnectionType( netItemTst, NOCONNECT_SYMBOL_PRESENT );
-                    }
-                }
-            }
+    std::vector<wxString>   keys( aList->size() );
+    std::vector<bool>       connected( aList->size(), false );
+    PIN_COUNTS              connectedCounts;
 
-            break;
-        }
+    for( unsigned ii = 0; ii < aList->size(); ii++ )
+    {
+        NETLIST_OBJECT* item = aList->GetItem( ii );
+        SCH_COMPONENT*  component = item->GetComponentParent();
+
+        if( item->m_Type != NET_PIN || !component )
+            continue;
+
+        // References do not contain spaces
+        keys[ii] = component->GetRef( &item->m_SheetPath ) + wxT( " " ) + item->GetPinNumText();
+
+        // A pin is connected if its net has other items (the list is sorted by net code)
+        connected[ii] = ( ii > 0 && aList->GetItemNet( ii - 1 ) == item->GetNet() )
+                        || ( ii + 1 < aList->size()
+                             && aList->GetItemNet( ii + 1 ) == item->GetNet() );
+
+        unsigned& count = connectedCounts[keys[ii]];
+
+        if( connected[ii] )
+            count++;
+    }
+
+    std::vector<bool> duplicates( aList->size(), false );
+
+    for( unsigned ii = 0; ii < aList->size(); ii++ )
+    {
+        if( keys[ii].IsEmpty() )
+            continue;
+
+        unsigned count = connectedCounts[keys[ii]];
+
+        if( connected[ii] )
+            count--;
+
+        duplicates[ii] = count > 0;
     }
+
+    return duplicates;
 }
 
-int NETLIST_OBJECT_LIST::CountPinsInNet( unsigned aNetStart )
+
+void TestNets( NETLIST_OBJECT_LIST* aList, bool aTestUniqueGlobalLabels )
 {
-    int count = 0;
-    int curr_net = GetItemNet( aNetStart );
+    // Group the items by net: the list is sorted by net code
+    std::vector<ERC_NET> nets;
 
-    /* Test pins connected to NetItemRef */
-    for( unsigned item = aNetStart; item < size(); item++ )
+    for( unsigned ii = 0; ii < aList->size(); ii++ )
     {
-        // We examine only a given net. We stop the search if the net changes
-        if( curr_net != GetItemNet( item ) )   // End of net
-            break;
+        NETLIST_OBJECT* item = aList->GetItem( ii );
 
-        if( GetItemType( item ) == NET_PIN )
-            count++;
+        wxASSERT_MSG( ii == 0 || aList->GetItemNet( ii - 1 ) <= item->GetNet(),
+                      wxT( "Netlist not correctly ordered" ) );
+
+        if( nets.empty() || aList->GetItemNet( nets.back().m_Start ) != item->GetNet() )
+            nets.push_back( ERC_NET( ii ) );
+
+        ERC_NET& net = nets.back();
+
+        net.m_End = ii + 1;
+
+        if( item->m_Type == NET_PIN )
+        {
+            net.m_PinCount++;
+            net.m_PinTypeCount[item->m_ElectricalPinType]++;
+        }
+        else if( item->m_Type == NET_NOCONNECT )
+        {
+            net.m_NoConnectCount++;
+        }
+    }
+
+    // Component references are read (and possibly set) before the threads are started
+    std::vector<bool> connectedDuplicates = findConnectedDuplicates( aList );
+
+    // The nets are tested by batches of about ERC_BATCH_SIZE items, each batch storing
+    // its diags, which are turned into markers afterwards in the order of the list.
+    const unsigned ERC_BATCH_SIZE = 2000;
+
+    std::deque<ERC_DIAGS>   batchDiags;     // the diags of the running batches are not moved
+    TASK_GROUP              group;
+    unsigned                first = 0;
+
+    while( first < nets.size() )
+    {
+        unsigned last = first;
+        unsigned itemCount = 0;
+
+        while( last < nets.size() && itemCount < ERC_BATCH_SIZE )
+        {
+            itemCount += nets[last].m_End - nets[last].m_Start;
+            last++;
+        }
+
+        batchDiags.push_back( ERC_DIAGS() );
+
+        ERC_DIAGS* diags = &batchDiags.back();
+
+        group.Add( [=, &nets, &connectedDuplicates]()
+        {
+            for( unsigned ii = first; ii < last; ii++ )
+                testNet( aList, nets[ii], aTestUniqueGlobalLabels, connectedDuplicates, *diags );
+        } );
+
+        first = last;
     }
 
-    return count;
+    group.Wait();
+
+    for( const ERC_DIAGS& diags : batchDiags )
+    {
+        for( const ERC_DIAG& diag : diags )
+            Diagnose( diag.m_ItemRef, diag.m_ItemTst, diag.m_MinConn, diag.m_Diag );
+    }
 }
 
+
 bool WriteDiagnosticERC( const wxString& aFullFileName )
 {
     wxString    msg;
@@ -581,100 +759,132 @@ bool WriteDiagnosticERC( const wxString& aFullFileName )
 }
 
 
-void NETLIST_OBJECT_LIST::TestforNonOrphanLabel( unsigned aNetItemRef, unsigned aStartNet )
+bool NETLIST_OBJECT_LIST::TestforNonOrphanLabel( unsigned aNetItemRef, unsigned aStartNet )
 {
-    unsigned netItemTst = aStartNet;
-    int      erc = 1;
-
     // Review the list of labels connected to NetItemRef:
-    for( ; ; netItemTst++ )
+    for( unsigned netItemTst = aStartNet; netItemTst < size(); netItemTst++ )
     {
         if( netItemTst == aNetItemRef )
             continue;
 
         /* Is always in the same net? */
-        if( ( netItemTst == size() )
-          || ( GetItemNet( aNetItemRef ) != GetItemNet( netItemTst ) ) )
-        {
-            /* End Netcode found. */
-            if( erc )
-            {
-                /* Glabel or SheetLabel orphaned. */
-                Diagnose( GetItem( aNetItemRef ), NULL, -1, WAR );
-            }
-
-            return;
-        }
+        if( GetItemNet( aNetItemRef ) != GetItemNet( netItemTst ) )
+            break;
 
         if( GetItem( aNetItemRef )->IsLabelConnected( GetItem( netItemTst ) ) )
-            erc = 0;
+            return true;
 
         //same thing, different order.
         if( GetItem( netItemTst )->IsLabelConnected( GetItem( aNetItemRef ) ) )
-            erc = 0;
+            return true;
     }
+
+    /* Glabel or SheetLabel orphaned. */
+    return false;
 }
 
 
-// this code try to detect similar labels, i.e. labels which are identical
-// when they are compared using case insensitive coparisons.
+// this code detects similar labels, i.e. labels which are identical
+// when they are compared using case insensitive comparisons.
 
 
-// A helper struct to compare NETLIST_OBJECT items by sheetpath and label texts
-// for a std::set<NETLIST_OBJECT*> container
-// the full text is "sheetpath+label" for local labels and "label" for global labels
-struct compare_labels
-{
-    bool operator() ( const NETLIST_OBJECT* lab1, const NETLIST_OBJECT* lab2 )
-    {
-        wxString str1 = lab1->m_SheetPath.Path() + lab1->m_Label;
-        wxString str2 = lab2->m_SheetPath.Path() + lab2->m_Label;
+// Helper function to build the warning messages about Similar Labels:
+static void SimilarLabelsDiagnose( NETLIST_OBJECT* aItemA, NETLIST_OBJECT* aItemB );
 
-        return str1.Cmp( str2 ) < 0;
-    }
+
+// A label of the list, each label text appearing only once in a sheet path
+struct UNIQUE_LABEL
+{
+    NETLIST_OBJECT* m_Item;     // the first label of the list with this text in this sheet
+    wxString        m_Path;     // the sheet path of m_Item
 };
 
-struct compare_label_names
+
+// Two similar labels, reported by a marker
+struct SIMILAR_LABELS
 {
-    bool operator() ( const NETLIST_OBJECT* lab1, const NETLIST_OBJECT* lab2 )
+    const UNIQUE_LABEL* m_First;    // the first label in case sensitive order
+    const UNIQUE_LABEL* m_Second;
+    bool                m_Global;   // true for global labels compared in the full project
+
+    bool operator<( const SIMILAR_LABELS& aOther ) const
     {
-        return lab1->m_Label.Cmp( lab2->m_Label ) < 0;
+        if( m_Global != aOther.m_Global )
+            return m_Global;
+
+        int cmp = m_Global ? 0 : m_First->m_Path.Cmp( aOther.m_First->m_Path );
+
+        if( cmp == 0 )
+            cmp = m_First->m_Item->m_Label.Cmp( aOther.m_First->m_Item->m_Label );
+
+        if( cmp == 0 )
+            cmp = m_Second->m_Item->m_Label.Cmp( aOther.m_Second->m_Item->m_Label );
+
+        return cmp < 0;
     }
 };
 
-struct compare_paths
+
+// Helper function: adds to aSimilarLabels the pairs of labels of aGroup (labels which are
+// equal when using case insensitive comparisons), with at least one local label if
+// not aGlobal
+static void addSimilarLabels( std::vector<const UNIQUE_LABEL*>& aGroup, bool aGlobal,
+                              std::vector<SIMILAR_LABELS>& aSimilarLabels )
 {
-    bool operator() ( const NETLIST_OBJECT* lab1, const NETLIST_OBJECT* lab2 )
+    if( aGroup.size() < 2 )
+        return;
+
+    std::sort( aGroup.begin(), aGroup.end(),
+               []( const UNIQUE_LABEL* a, const UNIQUE_LABEL* b )
+               {
+                   return a->m_Item->m_Label.Cmp( b->m_Item->m_Label ) < 0;
+               } );
+
+    for( unsigned ii = 0; ii < aGroup.size(); ii++ )
     {
-        return lab1->m_SheetPath.Path().Cmp( lab2->m_SheetPath.Path() ) < 0;
-    }
-};
+        for( unsigned jj = ii + 1; jj < aGroup.size(); jj++ )
+        {
+            // global label versus global label is examined in the full project.
+            // in a sheet, at least one label must be local
+            if( !aGlobal && aGroup[ii]->m_Item->IsLabelGlobal()
+              && aGroup[jj]->m_Item->IsLabelGlobal() )
+                continue;
 
-// Helper functions to build the warning messages about Similar Labels:
-static int countIndenticalLabels( std::vector<NETLIST_OBJECT*>& aList, NETLIST_OBJECT* aLabel );
-static void SimilarLabelsDiagnose( NETLIST_OBJECT* aItemA, NETLIST_OBJECT* aItemB );
+            SIMILAR_LABELS similar = { aGroup[ii], aGroup[jj], aGlobal };
+            aSimilarLabels.push_back( similar );
+        }
+    }
+}
 
 
 void NETLIST_OBJECT_LIST::TestforSimilarLabels()
 {
     // Similar labels which are different when using case sensitive comparisons
     // but are equal when using case insensitive comparisons
+    typedef std::unordered_map<wxString, UNIQUE_LABEL, WXSTRING_HASH> UNIQUE_LABELS;
+    typedef std::unordered_map<wxString, int, WXSTRING_HASH> LABEL_COUNTS;
+    typedef std::unordered_map<wxString, std::vector<const UNIQUE_LABEL*>, WXSTRING_HASH>
+            LABEL_GROUPS;
 
-    // list of all labels (used the better item to build diag messages)
-    std::vector<NETLIST_OBJECT*> fullLabelList;
-    // list of all labels , each label appears only once (used to to detect similar labels)
-    std::set<NETLIST_OBJECT*, compare_labels> uniqueLabelList;
-    wxString msg;
+    // Labels by "sheetpath+label": only one label is kept for a given text inside a given
+    // sheet.
+    UNIQUE_LABELS   uniqueLabels;
+
+    // Count of identical labels (used to choose the better item to build diag messages):
+    //  for global labels: global labels in the full project, by "label"
+    //  for local labels: all labels in the current sheet, by "sheetpath+label"
+    LABEL_COUNTS    globalCounts;
+    LABEL_COUNTS    sheetCounts;
 
-    // Build a list of differents labels. If inside a given sheet there are
-    // more than one given label, only one label is stored.
     // not also the sheet labels are not taken in account for 2 reasons:
     //  * they are in the root sheet but they are seen only from the child sheet
     //  * any mismatch between child sheet hierarchical labels and the sheet label
     //    already detected by ERC
     for( unsigned netItem = 0; netItem < size(); ++netItem )
     {
-        switch( GetItemType( netItem ) )
+        NETLIST_OBJECT* item = GetItem( netItem );
+
+        switch( item->m_Type )
         {
         case NET_LABEL:
         case NET_BUSLABELMEMBER:
@@ -683,10 +893,19 @@ void NETLIST_OBJECT_LIST::TestforSimilarLabels()
         case NET_HIERLABEL:
         case NET_HIERBUSLABELMEMBER:
         case NET_GLOBLABEL:
-            // add this label in lists
-            uniqueLabelList.insert( GetItem( netItem ) );
-            fullLabelList.push_back( GetItem( netItem ) );
+        {
+            wxString path = item->m_SheetPath.Path();
+            wxString key = path + item->m_Label;
+
+            sheetCounts[key]++;
+
+            if( item->IsLabelGlobal() )
+                globalCounts[item->m_Label]++;
+
+            UNIQUE_LABEL label = { item, path };
+            uniqueLabels.insert( std::make_pair( key, label ) );
             break;
+        }
 
         case NET_SHEETLABEL:
         case NET_SHEETBUSLABELMEMBER:
@@ -695,120 +914,69 @@ void NETLIST_OBJECT_LIST::TestforSimilarLabels()
         }
     }
 
-    // build global labels and compare
-    std::set<NETLIST_OBJECT*, compare_label_names> loc_labelList;
-    std::set<NETLIST_OBJECT*>::const_iterator it;
+    // Group the labels which are equal when using case insensitive comparisons:
+    //  global labels in the full project (each label name appears only once)
+    //  labels inside a sheet path
+    LABEL_GROUPS globalGroups;
+    LABEL_GROUPS sheetGroups;
 
-    for( it = uniqueLabelList.begin(); it != uniqueLabelList.end(); ++it )
-    {
-        if( (*it)->IsLabelGlobal() )
-            loc_labelList.insert( *it );
-    }
+    std::unordered_map<wxString, const UNIQUE_LABEL*, WXSTRING_HASH> globalLabels;
 
-    // compare global labels (same label names appears only once in list)
-    for( it = loc_labelList.begin(); it != loc_labelList.end(); ++it )
+    for( UNIQUE_LABELS::const_iterator it = uniqueLabels.begin(); it != uniqueLabels.end(); ++it )
     {
-        std::set<NETLIST_OBJECT*>::const_iterator it_aux = it;
+        const UNIQUE_LABEL& label = it->second;
+        wxString            lower = label.m_Item->m_Label.Lower();
 
-        for( ++it_aux; it_aux != loc_labelList.end(); ++it_aux )
-        {
-            if( (*it)->m_Label.CmpNoCase( (*it_aux)->m_Label ) == 0 )
-            {
-                // Create new marker for ERC.
-                int cntA = countIndenticalLabels( fullLabelList, *it );
-                int cntB = countIndenticalLabels( fullLabelList, *it_aux );
-
-                if( cntA <= cntB )
-                    SimilarLabelsDiagnose( (*it), (*it_aux) );
-                else
-                    SimilarLabelsDiagnose( (*it_aux), (*it) );
-            }
-        }
-    }
+        sheetGroups[label.m_Path + wxT( "\n" ) + lower].push_back( &label );
 
-    // Build paths list
-    std::set<NETLIST_OBJECT*, compare_paths> pathsList;
+        if( !label.m_Item->IsLabelGlobal() )
+            continue;
 
-    for( it = uniqueLabelList.begin(); it != uniqueLabelList.end(); ++it )
-        pathsList.insert( *it );
+        // A global label name is represented by its first sheet
+        const UNIQUE_LABEL*& global = globalLabels[label.m_Item->m_Label];
 
-    // Examine each label inside a sheet path:
-    for( it = pathsList.begin(); it != pathsList.end(); ++it )
-    {
-        loc_labelList.clear();
+        if( !global || it->first.Cmp( global->m_Path + global->m_Item->m_Label ) < 0 )
+            global = &label;
+    }
 
-        std::set<NETLIST_OBJECT*>::const_iterator it_aux = uniqueLabelList.begin();
+    for( auto it = globalLabels.begin(); it != globalLabels.end(); ++it )
+        globalGroups[it->first.Lower()].push_back( it->second );
 
-        for( ; it_aux != uniqueLabelList.end(); ++it_aux )
-        {
-            if( (*it)->m_SheetPath.Path() == (*it_aux)->m_SheetPath.Path() )
-                loc_labelList.insert( *it_aux );
-        }
+    std::vector<SIMILAR_LABELS> similarLabels;
 
-        // at this point, loc_labelList contains labels of the current sheet path.
-        // Detect similar labels (same label names appears only once in list)
-        std::set<NETLIST_OBJECT*>::const_iterator ref_it;
+    for( auto it = globalGroups.begin(); it != globalGroups.end(); ++it )
+        addSimilarLabels( it->second, true, similarLabels );
 
-        for( ref_it = loc_labelList.begin(); ref_it != loc_labelList.end(); ++ref_it )
-        {
-            NETLIST_OBJECT* ref_item = *ref_it;
-            it_aux = ref_it;
+    for( auto it = sheetGroups.begin(); it != sheetGroups.end(); ++it )
+        addSimilarLabels( it->second, false, similarLabels );
 
-            for( ++it_aux; it_aux != loc_labelList.end(); ++it_aux )
-            {
-                // global label versus global label was already examined.
-                // here, at least one label must be local
-                if( ref_item->IsLabelGlobal() && (*it_aux)->IsLabelGlobal() )
-                    continue;
+    // Create the markers in the order of the labels, whatever the order of the hash tables
+    std::sort( similarLabels.begin(), similarLabels.end() );
 
-                if( ref_item->m_Label.CmpNoCase( (*it_aux)->m_Label ) == 0 )
-                {
-                    // Create new marker for ERC.
-                    int cntA = countIndenticalLabels( fullLabelList, ref_item );
-                    int cntB = countIndenticalLabels( fullLabelList, *it_aux );
-
-                    if( cntA <= cntB )
-                        SimilarLabelsDiagnose( ref_item, (*it_aux) );
-                    else
-                        SimilarLabelsDiagnose( (*it_aux), ref_item );
-                }
-            }
-        }
-    }
-}
-
-// Helper function: count the number of labels identical to aLabel
-//  for global label: global labels in the full project
-//  for local label: all labels in the current sheet
-static int countIndenticalLabels( std::vector<NETLIST_OBJECT*>& aList, NETLIST_OBJECT* aLabel )
-{
-    int count = 0;
-
-    if( aLabel->IsLabelGlobal() )
+    for( const SIMILAR_LABELS& similar : similarLabels )
     {
-        for( unsigned netItem = 0; netItem < aList.size(); ++netItem )
-        {
-            NETLIST_OBJECT* item = aList[netItem];
+        int cnt[2];
+        const UNIQUE_LABEL* labels[2] = { similar.m_First, similar.m_Second };
 
-            if( item->IsLabelGlobal() && item->m_Label == aLabel->m_Label )
-                count++;
-        }
-    }
-    else
-    {
-        for( unsigned netItem = 0; netItem < aList.size(); ++netItem )
+        for( int ii = 0; ii < 2; ii++ )
         {
-            NETLIST_OBJECT* item = aList[netItem];
+            const NETLIST_OBJECT* item = labels[ii]->m_Item;
 
-            if( item->m_Label == aLabel->m_Label &&
-                item->m_SheetPath.Path() == aLabel->m_SheetPath.Path() )
-                count++;
+            if( item->IsLabelGlobal() )
+                cnt[ii] = globalCounts[item->m_Label];
+            else
+                cnt[ii] = sheetCounts[labels[ii]->m_Path + item->m_Label];
         }
-    }
 
-    return count;
+        // Create new marker for ERC.
+        if( cnt[0] <= cnt[1] )
+            SimilarLabelsDiagnose( similar.m_First->m_Item, similar.m_Second->m_Item );
+        else
+            SimilarLabelsDiagnose( similar.m_Second->m_Item, similar.m_First->m_Item );
+    }
 }
 
+
 // Helper function: creates a marker for similar labels ERC warning
 static void SimilarLabelsDiagnose( NETLIST_OBJECT* aItemA, NETLIST_OBJECT* aItemB )
 {
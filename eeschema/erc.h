@@ -45,6 +45,9 @@ enum errortype
     UNC         // Error: unconnected pin
 };
 
+/// Trace mask of the ERC, which logs the time of each test
+extern const wxChar traceErc[];
+
 extern const wxString CommentERC_H[];
 extern const wxString CommentERC_V[];
 
@@ -86,17 +89,17 @@ void Diagnose( NETLIST_OBJECT* NetItemRef, NETLIST_OBJECT* NetItemTst,
                       int MinConnexion, int Diag );
 
 /**
- * Perform ERC testing for electrical conflicts between \a NetItemRef and other items
- * (mainly pin) on the same net.
- * @param aList = a reference to the list of connected objects
- * @param aNetItemRef = index in list of the current object
- * @param aNetStart = index in list of net objects of the first item
- * @param aMinConnexion = a pointer to a variable to store the minimal connection
- * found( NOD, DRV, NPI, NET_NC)
+ * Function TestNets
+ * performs the ERC tests of each net of \a aList: electrical conflicts between pins,
+ * pins not connected or not driven, no connect symbols connected to more than one pin,
+ * and hierarchical labels and sheet labels not connected together.
+ * The nets are tested on the thread pool, then the ERC markers are created in the order
+ * of the list, so the markers do not depend on the threads.
+ * @param aList = the list of connected objects, sorted by net code
+ * @param aTestUniqueGlobalLabels = true to also test global labels not connected to
+ *                                  other global labels
  */
-void TestOthersItems( NETLIST_OBJECT_LIST* aList,
-                             unsigned aNetItemRef, unsigned aNetStart,
-                             int* aMinConnexion );
+void TestNets( NETLIST_OBJECT_LIST* aList, bool aTestUniqueGlobalLabels );
 
 /**
  * Function TestDuplicateSheetNames( )
@@ -46,6 +46,7 @@
 #include <project_rescue.h>
 #include <eeschema_config.h>
 #include <sch_legacy_plugin.h>
+#include <sch_connectivity.h>
 
 
 //#define USE_SCH_LEGACY_IO_PLUGIN
@@ -280,6 +281,7 @@ bool SCH_EDIT_FRAME::OpenProjectFiles( const std::vector<wxString>& aFileSet, in
     {
         delete g_RootSheet;
         g_RootSheet = NULL;
+        m_connectivity->Clear();
 
         CreateScreens();
     }
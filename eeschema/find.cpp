@@ -403,6 +403,8 @@ void SCH_EDIT_FRAME::OnFindReplace( wxFindDialogEvent& aEvent )
 
             if( m_foundItems.ReplaceItem( sheet ) )
             {
+                // The item can be on another sheet than the current one
+                sheet->LastScreen()->ConnectivityChanged();
                 OnModify();
                 SaveUndoItemInUndoList( undoItem );
                 updateFindReplaceView( aEvent );
@@ -433,6 +435,7 @@ void SCH_EDIT_FRAME::OnFindReplace( wxFindDialogEvent& aEvent )
 
         if( m_foundItems.ReplaceItem( sheet ) )
         {
+            sheet->LastScreen()->ConnectivityChanged();
             OnModify();
             SaveUndoItemInUndoList( undoItem );
             updateFindReplaceView( aEvent );
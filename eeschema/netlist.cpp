@@ -35,6 +35,8 @@
 
 #include <netlist.h>
 #include <class_netlist_object.h>
+#include <netlist_connection_points.h>
+#include <sch_connectivity.h>
 #include <class_library.h>
 #include <lib_pin.h>
 #include <sch_junction.h>
@@ -157,14 +159,18 @@ void NETLIST_OBJECT_LIST::SortListbySheet()
 
 NETLIST_OBJECT_LIST* SCH_EDIT_FRAME::BuildNetListBase()
 {
-    // I own this list until I return it to the new owner.
-    std::unique_ptr<NETLIST_OBJECT_LIST> ret( new NETLIST_OBJECT_LIST() );
+    // Update the links of the components to their parts: the sheets using
+    // modified parts are collected again
+    SCH_SCREENS screens;
 
     // Creates the flattened sheet list:
     SCH_SHEET_LIST aSheets( g_RootSheet );
 
-    // Build netlist info
-    bool success = ret->BuildNetListInfo( aSheets );
+    // Build netlist info, from the connected items kept for the unchanged sheets.
+    // I own this list until I return it to the new owner.
+    std::unique_ptr<NETLIST_OBJECT_LIST> ret( m_connectivity->BuildNetList( aSheets ) );
+
+    bool success = !ret->empty();
 
     if( !success )
     {
@@ -182,18 +188,26 @@ NETLIST_OBJECT_LIST* SCH_EDIT_FRAME::BuildNetListBase()
 
 bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
 {
-    SCH_SHEET_PATH* sheet;
-
     // Fill list with connected items from the flattened sheet list
     for( unsigned i = 0; i < aSheets.size();  i++ )
-    {
-        sheet = &aSheets[i];
+        AppendSheetItems( aSheets[i] );
 
-        for( SCH_ITEM* item = sheet->LastScreen()->GetDrawItems(); item; item = item->Next() )
-        {
-            item->GetNetListItem( *this, sheet );
-        }
+    return ConnectItems();
+}
+
+
+void NETLIST_OBJECT_LIST::AppendSheetItems( SCH_SHEET_PATH& aSheet )
+{
+    for( SCH_ITEM* item = aSheet.LastScreen()->GetDrawItems(); item; item = item->Next() )
+    {
+        item->GetNetListItem( *this, &aSheet );
     }
+}
+
+
+bool NETLIST_OBJECT_LIST::ConnectItems()
+{
+    SCH_SHEET_PATH* sheet;
 
     if( size() == 0 )
         return false;
@@ -201,17 +215,30 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
     // Sort objects by Sheet
     SortListbySheet();
 
-    sheet = &(GetItem( 0 )->m_SheetPath);
+    sheet = NULL;
     m_lastNetCode = m_lastBusNetCode = 1;
 
-    for( unsigned ii = 0, istart = 0; ii < size(); ii++ )
+    // The connection points of the current sheet, and the merges of net codes
+    // (and bus net codes) made by the physical connections.  The items keep the code
+    // they were given until all the sheets are connected.
+    SHEET_CONNECTION_POINTS points;
+    NET_CODE_SETS           netCodes;
+    NET_CODE_SETS           busNetCodes;
+
+    for( unsigned ii = 0; ii < size(); ii++ )
     {
         NETLIST_OBJECT* net_item = GetItem( ii );
 
-        if( net_item->m_SheetPath != *sheet )   // Sheet change
+        if( !sheet || net_item->m_SheetPath != *sheet )   // Sheet change
         {
-            sheet  = &(net_item->m_SheetPath);
-            istart = ii;
+            sheet = &(net_item->m_SheetPath);
+
+            unsigned iend = ii + 1;
+
+            while( iend < size() && GetItem( iend )->m_SheetPath == *sheet )
+                iend++;
+
+            points.Build( *this, ii, iend );
         }
 
         switch( net_item->m_Type )
@@ -235,7 +262,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastNetCode++;
             }
 
-            pointToPointConnect( net_item, IS_WIRE, istart );
+            pointToPointConnect( net_item, IS_WIRE, points, netCodes );
             break;
 
         case NET_JUNCTION:
@@ -246,7 +273,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastNetCode++;
             }
 
-            segmentToPointConnect( net_item, IS_WIRE, istart );
+            segmentToPointConnect( net_item, IS_WIRE, points, netCodes );
 
             // Control of the junction, on BUS.
             if( net_item->m_BusNetCode == 0 )
@@ -255,7 +282,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastBusNetCode++;
             }
 
-            segmentToPointConnect( net_item, IS_BUS, istart );
+            segmentToPointConnect( net_item, IS_BUS, points, busNetCodes );
             break;
 
         case NET_LABEL:
@@ -268,7 +295,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastNetCode++;
             }
 
-            segmentToPointConnect( net_item, IS_WIRE, istart );
+            segmentToPointConnect( net_item, IS_WIRE, points, netCodes );
             break;
 
         case NET_SHEETBUSLABELMEMBER:
@@ -283,7 +310,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastBusNetCode++;
             }
 
-            pointToPointConnect( net_item, IS_BUS, istart );
+            pointToPointConnect( net_item, IS_BUS, points, busNetCodes );
             break;
 
         case NET_BUSLABELMEMBER:
@@ -296,11 +323,21 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastBusNetCode++;
             }
 
-            segmentToPointConnect( net_item, IS_BUS, istart );
+            segmentToPointConnect( net_item, IS_BUS, points, busNetCodes );
             break;
         }
     }
 
+    // Give to each item the final code of its net, as if the codes were propagated
+    // to all the items of the list for each connection found
+    for( unsigned ii = 0; ii < size(); ii++ )
+    {
+        NETLIST_OBJECT* net_item = GetItem( ii );
+
+        net_item->SetNet( netCodes.Find( net_item->GetNet() ) );
+        net_item->m_BusNetCode = busNetCodes.Find( net_item->m_BusNetCode );
+    }
+
 #if defined(NETLIST_DEBUG) && defined(DEBUG)
     std::cout << "\n\nafter sheet local\n\n";
     DumpNetTable();
@@ -701,140 +738,72 @@ void NETLIST_OBJECT_LIST::propagateNetCode( int aOldNetCode, int aNewNetCode, bo
 }
 
 
-void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus, int start )
+void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus,
+                                               const SHEET_CONNECTION_POINTS& aPoints,
+                                               NET_CODE_SETS& aNetCodes )
 {
-    int netCode;
+    // aIsBus == IS_WIRE: objects other than BUS and BUSLABELS
+    // aIsBus == IS_BUS: objects type BUS, BUSLABELS, and junctions.
+    int netCode = aNetCodes.Find( aIsBus ? aRef->m_BusNetCode : aRef->GetNet() );
 
-    if( aIsBus == false )    // Objects other than BUS and BUSLABELS
+    for( int ii = 0; ii < 2; ii++ )
     {
-        netCode = aRef->GetNet();
+        if( ii == 1 && aRef->m_End == aRef->m_Start )
+            break;
 
-        for( unsigned i = start; i < size(); i++ )
-        {
-            NETLIST_OBJECT* item = GetItem( i );
+        const SHEET_CONNECTION_POINTS::ITEMS* items =
+                aPoints.GetItemsAt( ii == 0 ? aRef->m_Start : aRef->m_End, aIsBus );
 
-            if( item->m_SheetPath != aRef->m_SheetPath )  //used to be > (why?)
-                continue;
+        if( !items )
+            continue;
 
-            switch( item->m_Type )
+        for( NETLIST_OBJECT* item : *items )
+        {
+            if( aIsBus == IS_WIRE )
             {
-            case NET_SEGMENT:
-            case NET_PIN:
-            case NET_LABEL:
-            case NET_HIERLABEL:
-            case NET_GLOBLABEL:
-            case NET_SHEETLABEL:
-            case NET_PINLABEL:
-            case NET_JUNCTION:
-            case NET_NOCONNECT:
-                if( aRef->m_Start == item->m_Start
-                    || aRef->m_Start == item->m_End
-                    || aRef->m_End   == item->m_Start
-                    || aRef->m_End   == item->m_End )
-                {
-                    if( item->GetNet() == 0 )
-                        item->SetNet( netCode );
-                    else
-                        propagateNetCode( item->GetNet(), netCode, IS_WIRE );
-                }
-                break;
-
-            case NET_BUS:
-            case NET_BUSLABELMEMBER:
-            case NET_SHEETBUSLABELMEMBER:
-            case NET_HIERBUSLABELMEMBER:
-            case NET_GLOBBUSLABELMEMBER:
-            case NET_ITEM_UNSPECIFIED:
-                break;
+                if( item->GetNet() == 0 )
+                    item->SetNet( netCode );
+                else
+                    aNetCodes.Merge( item->GetNet(), netCode );
             }
-        }
-    }
-    else    // Object type BUS, BUSLABELS, and junctions.
-    {
-        netCode = aRef->m_BusNetCode;
-
-        for( unsigned i = start; i < size(); i++ )
-        {
-            NETLIST_OBJECT* item = GetItem( i );
-
-            if( item->m_SheetPath != aRef->m_SheetPath )
-                continue;
-
-            switch( item->m_Type )
+            else
             {
-            case NET_ITEM_UNSPECIFIED:
-            case NET_SEGMENT:
-            case NET_PIN:
-            case NET_LABEL:
-            case NET_HIERLABEL:
-            case NET_GLOBLABEL:
-            case NET_SHEETLABEL:
-            case NET_PINLABEL:
-            case NET_NOCONNECT:
-                break;
-
-            case NET_BUS:
-            case NET_BUSLABELMEMBER:
-            case NET_SHEETBUSLABELMEMBER:
-            case NET_HIERBUSLABELMEMBER:
-            case NET_GLOBBUSLABELMEMBER:
-            case NET_JUNCTION:
-                if(  aRef->m_Start == item->m_Start
-                  || aRef->m_Start == item->m_End
-                  || aRef->m_End   == item->m_Start
-                  || aRef->m_End   == item->m_End )
-                {
-                    if( item->m_BusNetCode == 0 )
-                        item->m_BusNetCode = netCode;
-                    else
-                        propagateNetCode( item->m_BusNetCode, netCode, IS_BUS );
-                }
-                break;
+                if( item->m_BusNetCode == 0 )
+                    item->m_BusNetCode = netCode;
+                else
+                    aNetCodes.Merge( item->m_BusNetCode, netCode );
             }
         }
     }
 }
 
 
-void NETLIST_OBJECT_LIST::segmentToPointConnect( NETLIST_OBJECT* aJonction,
-                                                 bool aIsBus, int aIdxStart )
+void NETLIST_OBJECT_LIST::segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus,
+                                                 const SHEET_CONNECTION_POINTS& aPoints,
+                                                 NET_CODE_SETS& aNetCodes )
 {
-    for( unsigned i = aIdxStart; i < size(); i++ )
-    {
-        NETLIST_OBJECT* segment = GetItem( i );
+    int netCode = aNetCodes.Find( aIsBus ? aJonction->m_BusNetCode : aJonction->GetNet() );
 
-        // if different sheets, obviously no physical connection between elements.
-        if( segment->m_SheetPath != aJonction->m_SheetPath )
-            continue;
+    SHEET_CONNECTION_POINTS::ITEMS segments;
+
+    aPoints.GetSegmentsThrough( aJonction->m_Start, aIsBus, segments );
 
+    for( NETLIST_OBJECT* segment : segments )
+    {
+        // Propagation Netcode has all the objects of the same Netcode.
         if( aIsBus == IS_WIRE )
         {
-            if( segment->m_Type != NET_SEGMENT )
-                continue;
+            if( segment->GetNet() )
+                aNetCodes.Merge( segment->GetNet(), netCode );
+            else
+                segment->SetNet( netCode );
         }
         else
         {
-            if( segment->m_Type != NET_BUS )
-                continue;
-        }
-
-        if( IsPointOnSegment( segment->m_Start, segment->m_End, aJonction->m_Start ) )
-        {
-            // Propagation Netcode has all the objects of the same Netcode.
-            if( aIsBus == IS_WIRE )
-            {
-                if( segment->GetNet() )
-                    propagateNetCode( segment->GetNet(), aJonction->GetNet(), aIsBus );
-                else
-                    segment->SetNet( aJonction->GetNet() );
-            }
+            if( segment->m_BusNetCode )
+                aNetCodes.Merge( segment->m_BusNetCode, netCode );
             else
-            {
-                if( segment->m_BusNetCode )
-                    propagateNetCode( segment->m_BusNetCode, aJonction->m_BusNetCode, aIsBus );
-                else
-                    segment->m_BusNetCode = aJonction->m_BusNetCode;
-            }
+                segment->m_BusNetCode = netCode;
         }
     }
 }
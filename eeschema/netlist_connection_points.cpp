@@ -0,0 +1,188 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file netlist_connection_points.cpp
+ */
+
+#include <fctsys.h>
+#include <trigo.h>
+#include <algorithm>
+
+#include <class_netlist_object.h>
+#include <netlist_connection_points.h>
+
+
+int NET_CODE_SETS::Find( int aCode )
+{
+    if( aCode <= 0 || aCode >= (int) m_parent.size() )
+        return aCode;
+
+    // Path halving: each visited code is linked to its grand parent
+    while( m_parent[aCode] != aCode )
+    {
+        m_parent[aCode] = m_parent[m_parent[aCode]];
+        aCode = m_parent[aCode];
+    }
+
+    return aCode;
+}
+
+
+void NET_CODE_SETS::Merge( int aOldCode, int aNewCode )
+{
+    aOldCode = Find( aOldCode );
+    aNewCode = Find( aNewCode );
+
+    if( aOldCode == aNewCode || aOldCode <= 0 || aNewCode <= 0 )
+        return;
+
+    unsigned size = std::max( aOldCode, aNewCode ) + 1;
+
+    for( unsigned code = m_parent.size(); code < size; code++ )
+        m_parent.push_back( code );
+
+    // The net keeps the new code, like after NETLIST_OBJECT_LIST::propagateNetCode()
+    m_parent[aOldCode] = aNewCode;
+}
+
+
+void SHEET_CONNECTION_POINTS::INDEX::Clear()
+{
+    m_points.clear();
+    m_horizontal.clear();
+    m_vertical.clear();
+    m_oblique.clear();
+}
+
+
+void SHEET_CONNECTION_POINTS::addPoints( INDEX& aIndex, NETLIST_OBJECT* aItem )
+{
+    aIndex.m_points[pointKey( aItem->m_Start )].push_back( aItem );
+
+    if( aItem->m_End != aItem->m_Start )
+        aIndex.m_points[pointKey( aItem->m_End )].push_back( aItem );
+}
+
+
+void SHEET_CONNECTION_POINTS::addSegment( INDEX& aIndex, NETLIST_OBJECT* aItem )
+{
+    if( aItem->m_Start.y == aItem->m_End.y )
+        aIndex.m_horizontal[aItem->m_Start.y].push_back( aItem );
+    else if( aItem->m_Start.x == aItem->m_End.x )
+        aIndex.m_vertical[aItem->m_Start.x].push_back( aItem );
+    else
+        aIndex.m_oblique.push_back( aItem );
+}
+
+
+void SHEET_CONNECTION_POINTS::Build( const NETLIST_OBJECT_LIST& aList,
+                                     unsigned aStart, unsigned aEnd )
+{
+    m_wires.Clear();
+    m_buses.Clear();
+
+    for( unsigned ii = aStart; ii < aEnd; ii++ )
+    {
+        NETLIST_OBJECT* item = aList.GetItem( ii );
+
+        // The item types tested by pointToPointConnect() and segmentToPointConnect()
+        switch( item->m_Type )
+        {
+        case NET_SEGMENT:
+            addPoints( m_wires, item );
+            addSegment( m_wires, item );
+            break;
+
+        case NET_PIN:
+        case NET_LABEL:
+        case NET_HIERLABEL:
+        case NET_GLOBLABEL:
+        case NET_SHEETLABEL:
+        case NET_PINLABEL:
+        case NET_NOCONNECT:
+            addPoints( m_wires, item );
+            break;
+
+        case NET_JUNCTION:
+            addPoints( m_wires, item );
+            addPoints( m_buses, item );
+            break;
+
+        case NET_BUS:
+            addPoints( m_buses, item );
+            addSegment( m_buses, item );
+            break;
+
+        case NET_BUSLABELMEMBER:
+        case NET_SHEETBUSLABELMEMBER:
+        case NET_HIERBUSLABELMEMBER:
+        case NET_GLOBBUSLABELMEMBER:
+            addPoints( m_buses, item );
+            break;
+
+        case NET_ITEM_UNSPECIFIED:
+            break;
+        }
+    }
+}
+
+
+const SHEET_CONNECTION_POINTS::ITEMS* SHEET_CONNECTION_POINTS::GetItemsAt(
+        const wxPoint& aPosition, bool aIsBus ) const
+{
+    const POINT_MAP& points = aIsBus ? m_buses.m_points : m_wires.m_points;
+    POINT_MAP::const_iterator it = points.find( pointKey( aPosition ) );
+
+    return it != points.end() ? &it->second : NULL;
+}
+
+
+void SHEET_CONNECTION_POINTS::GetSegmentsThrough( const wxPoint& aPosition, bool aIsBus,
+                                                  ITEMS& aSegments ) const
+{
+    const INDEX& index = aIsBus ? m_buses : m_wires;
+
+    aSegments.clear();
+
+    auto test = [&]( const ITEMS& aCandidates )
+    {
+        for( NETLIST_OBJECT* segment : aCandidates )
+        {
+            if( IsPointOnSegment( segment->m_Start, segment->m_End, aPosition ) )
+                aSegments.push_back( segment );
+        }
+    };
+
+    LINE_MAP::const_iterator line = index.m_horizontal.find( aPosition.y );
+
+    if( line != index.m_horizontal.end() )
+        test( line->second );
+
+    line = index.m_vertical.find( aPosition.x );
+
+    if( line != index.m_vertical.end() )
+        test( line->second );
+
+    test( index.m_oblique );
+}
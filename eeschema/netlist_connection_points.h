@@ -0,0 +1,134 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file netlist_connection_points.h
+ * @brief Hashed connection points of a sheet, and net code merging, for the netlist builder.
+ */
+
+#ifndef NETLIST_CONNECTION_POINTS_H_
+#define NETLIST_CONNECTION_POINTS_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include <wx/gdicmn.h>
+
+class NETLIST_OBJECT;
+class NETLIST_OBJECT_LIST;
+
+
+/**
+ * Class NET_CODE_SETS
+ * merges net codes with a union-find, so connecting two groups of items does not rename
+ * the net code of every item of the list.
+ *
+ * Merge( aOldCode, aNewCode ) gives to the items of the net \a aOldCode the code
+ * \a aNewCode, as NETLIST_OBJECT_LIST::propagateNetCode() does, and Find() returns the
+ * code an item has after all the merges.  The code 0 (no net) is never merged.
+ */
+class NET_CODE_SETS
+{
+public:
+    /// @return the current code of the items which were given \a aCode
+    int Find( int aCode );
+
+    /// Gives the code of \a aNewCode to the items of the net \a aOldCode
+    void Merge( int aOldCode, int aNewCode );
+
+    void Clear()
+    {
+        m_parent.clear();
+    }
+
+private:
+    std::vector<int>    m_parent;       ///< codes not in the vector are not merged
+};
+
+
+/**
+ * Class SHEET_CONNECTION_POINTS
+ * indexes the items of one sheet of a #NETLIST_OBJECT_LIST by the coordinates of their
+ * connection points, so the items connected to an item are found without testing every
+ * item of the sheet.
+ *
+ * Wire items (segments, pins, labels, junctions, no connects) and bus items (bus, bus
+ * label members, junctions) are indexed separately, by their start and end points.  The
+ * wire and bus segments are also indexed by the line they lie on, to find the segments
+ * passing through a junction or a label.
+ */
+class SHEET_CONNECTION_POINTS
+{
+public:
+    typedef std::vector<NETLIST_OBJECT*>    ITEMS;
+
+    /**
+     * Function Build
+     * indexes the items of \a aList from \a aStart to \a aEnd (excluded), which must be the
+     * items of a single sheet.
+     */
+    void Build( const NETLIST_OBJECT_LIST& aList, unsigned aStart, unsigned aEnd );
+
+    /**
+     * Function GetItemsAt
+     * @return the wire or bus items having a start or end point at \a aPosition, or NULL.
+     *         An item having both its start and end points at \a aPosition is in the list
+     *         only once.
+     */
+    const ITEMS* GetItemsAt( const wxPoint& aPosition, bool aIsBus ) const;
+
+    /**
+     * Function GetSegmentsThrough
+     * fills \a aSegments with the wire segments (or bus segments, if \a aIsBus) having
+     * \a aPosition on them, as tested by IsPointOnSegment().
+     */
+    void GetSegmentsThrough( const wxPoint& aPosition, bool aIsBus, ITEMS& aSegments ) const;
+
+private:
+    typedef std::unordered_map<long long, ITEMS>    POINT_MAP;
+    typedef std::unordered_map<int, ITEMS>          LINE_MAP;
+
+    /// The index of the wire items, or of the bus items
+    struct INDEX
+    {
+        POINT_MAP   m_points;
+        LINE_MAP    m_horizontal;   ///< segments by y coordinate
+        LINE_MAP    m_vertical;     ///< segments by x coordinate
+        ITEMS       m_oblique;      ///< other segments, always tested
+
+        void Clear();
+    };
+
+    static long long pointKey( const wxPoint& aPosition )
+    {
+        return ( (long long) aPosition.x << 32 ) | (unsigned) aPosition.y;
+    }
+
+    static void addPoints( INDEX& aIndex, NETLIST_OBJECT* aItem );
+    static void addSegment( INDEX& aIndex, NETLIST_OBJECT* aItem );
+
+    INDEX   m_wires;
+    INDEX   m_buses;
+};
+
+#endif  // NETLIST_CONNECTION_POINTS_H_
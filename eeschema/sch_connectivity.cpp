@@ -0,0 +1,102 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file sch_connectivity.cpp
+ */
+
+#include <fctsys.h>
+
+#include <class_sch_screen.h>
+#include <sch_sheet_path.h>
+#include <sch_connectivity.h>
+
+
+bool SCH_CONNECTIVITY::SHEET_ITEMS::IsValid( SCH_SHEET_PATH& aSheet ) const
+{
+    // The same sheet objects (SCH_SHEET_PATH::operator==() compares the pointers),
+    // and the same screen, not edited since
+    return m_sheet == aSheet
+           && m_screen == aSheet.LastScreen()
+           && m_revision == m_screen->GetConnectivityRevision();
+}
+
+
+SCH_CONNECTIVITY::SCH_CONNECTIVITY() :
+    m_collectedSheets( 0 )
+{
+}
+
+
+void SCH_CONNECTIVITY::Clear()
+{
+    m_sheets.clear();
+}
+
+
+NETLIST_OBJECT_LIST* SCH_CONNECTIVITY::BuildNetList( SCH_SHEET_LIST& aSheets )
+{
+    std::unique_ptr<NETLIST_OBJECT_LIST> list( new NETLIST_OBJECT_LIST() );
+
+    // The items of the sheets of aSheets, the other ones are dropped
+    SHEET_MAP sheets;
+
+    m_collectedSheets = 0;
+
+    for( unsigned i = 0; i < aSheets.size(); i++ )
+    {
+        SCH_SHEET_PATH& sheet = aSheets[i];
+        wxString        path = sheet.Path();
+
+        std::unique_ptr<SHEET_ITEMS>    entry;
+        SHEET_MAP::iterator             it = m_sheets.find( path );
+
+        if( it != m_sheets.end() && it->second && it->second->IsValid( sheet ) )
+        {
+            entry = std::move( it->second );
+        }
+        else
+        {
+            entry.reset( new SHEET_ITEMS );
+            entry->m_sheet = sheet;
+            entry->m_screen = sheet.LastScreen();
+            entry->m_revision = entry->m_screen->GetConnectivityRevision();
+            entry->m_items.AppendSheetItems( sheet );
+            m_collectedSheets++;
+        }
+
+        // The connection of the list changes the objects, the kept ones are copied
+        list->reserve( list->size() + entry->m_items.size() );
+
+        for( NETLIST_OBJECT* item : entry->m_items )
+            list->push_back( new NETLIST_OBJECT( *item ) );
+
+        sheets[path] = std::move( entry );
+    }
+
+    m_sheets.swap( sheets );
+
+    list->ConnectItems();
+
+    return list.release();
+}
@@ -0,0 +1,96 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file sch_connectivity.h
+ * @brief Connected items of each sheet of the schematic, kept between netlist builds.
+ */
+
+#ifndef SCH_CONNECTIVITY_H_
+#define SCH_CONNECTIVITY_H_
+
+#include <memory>
+#include <unordered_map>
+
+#include <hashtables.h>
+#include <class_netlist_object.h>
+
+class SCH_SCREEN;
+class SCH_SHEET_LIST;
+
+
+/**
+ * Class SCH_CONNECTIVITY
+ * keeps the connected objects (pins, wires, labels ...) of each sheet instance of the
+ * schematic, as created by SCH_ITEM::GetNetListItem(), so building a netlist only collects
+ * again the objects of the sheets edited since the previous build.
+ *
+ * A sheet instance is collected again when its screen has a new connectivity revision
+ * (see SCH_SCREEN::ConnectivityChanged(), called by the edit, undo and cleanup functions),
+ * or when it does not use the same screen or the same sheets as before.
+ */
+class SCH_CONNECTIVITY
+{
+public:
+    SCH_CONNECTIVITY();
+
+    /**
+     * Function BuildNetList
+     * builds the connected objects of the hierarchy \a aSheets, like
+     * NETLIST_OBJECT_LIST::BuildNetListInfo(), from the objects kept for the unchanged
+     * sheets.
+     * @return the new list, owned by the caller.  It is empty if the schematic has no
+     *         connected items.
+     */
+    NETLIST_OBJECT_LIST* BuildNetList( SCH_SHEET_LIST& aSheets );
+
+    /// Forgets the objects of all the sheets
+    void Clear();
+
+    /// @return the number of sheets collected by the last BuildNetList()
+    unsigned GetCollectedSheetCount() const
+    {
+        return m_collectedSheets;
+    }
+
+private:
+    /// The objects of a sheet instance, and what they were collected from
+    struct SHEET_ITEMS
+    {
+        SCH_SHEET_PATH          m_sheet;
+        const SCH_SCREEN*       m_screen;
+        unsigned                m_revision;     ///< the connectivity revision of m_screen
+        NETLIST_OBJECT_LIST     m_items;        ///< not connected
+
+        /// @return true if the items are still the ones of aSheet
+        bool IsValid( SCH_SHEET_PATH& aSheet ) const;
+    };
+
+    typedef std::unordered_map< wxString, std::unique_ptr<SHEET_ITEMS>, WXSTRING_HASH >
+            SHEET_MAP;
+
+    SHEET_MAP   m_sheets;               ///< by sheet path ( SCH_SHEET_PATH::Path() )
+    unsigned    m_collectedSheets;
+};
+
+#endif  // SCH_CONNECTIVITY_H_
@@ -22,6 +22,7 @@
 
 #include <ctype.h>
 #include <algorithm>
+#include <unordered_map>
 
 #include <wx/mstream.h>
 #include <wx/filename.h>
@@ -31,6 +32,8 @@
 #include <kiway.h>
 #include <kicad_string.h>
 #include <richio.h>
+#include <hashtables.h>
+#include <thread_pool.h>
 #include <core/typeinfo.h>
 
 #include <general.h>
@@ -504,58 +507,283 @@ SCH_SHEET* SCH_LEGACY_PLUGIN::Load( const wxString& aFileName, KIWAY* aKiway,
 }
 
 
+/**
+ * Struct HIERARCHY
+ * holds the screens of the schematic files of a hierarchy loaded by loadHierarchy().
+ *
+ * The files are loaded by tasks of the thread pool: the task loading a file queues the
+ * files of the sheets of this file, each file being loaded only once.  The sheets get
+ * their screens when all the files are loaded, in the order of the hierarchy, so the
+ * screens are shared as if the files were loaded one after the other.
+ */
+struct SCH_LEGACY_PLUGIN::HIERARCHY
+{
+    /// A loaded file
+    struct FILE_SCREEN
+    {
+        SCH_SCREEN*         m_screen;
+        bool                m_used;     ///< true if m_screen is the screen of some sheets
+        std::exception_ptr  m_error;    ///< the error loading the file, thrown if it is used
+
+        FILE_SCREEN() :
+            m_screen( NULL ),
+            m_used( false )
+        {
+        }
+    };
+
+    /// The screen of the sheets having a file name, compared case insensitively like
+    /// SCH_SHEET::SearchHierarchy() does
+    struct SHEET_SCREEN
+    {
+        SCH_SCREEN* m_screen;
+        bool        m_attached;     ///< true if the sheets of m_screen have their screens
+
+        SHEET_SCREEN() :
+            m_screen( NULL ),
+            m_attached( false )
+        {
+        }
+    };
+
+    typedef std::unordered_map< wxString, FILE_SCREEN, WXSTRING_HASH >  FILE_MAP;
+    typedef std::unordered_map< wxString, SHEET_SCREEN, WXSTRING_HASH > SHEET_MAP;
+
+    SHEET_MAP       m_sheetScreens;     ///< by lower case full file name, not modified
+                                        ///< while the files are loaded
+    boost::mutex    m_lock;             ///< protects m_files
+    FILE_MAP        m_files;            ///< by full file name
+    TASK_GROUP      m_loads;            ///< destroyed first, waiting for the tasks
+};
+
+
+wxString SCH_LEGACY_PLUGIN::sheetFileName( SCH_SHEET* aSheet ) const
+{
+    // SCH_SCREEN objects store the full path and file name where the SCH_SHEET object only
+    // stores the file name and extension.  Add the project path to the file name and
+    // extension to compare it to the file names of the screens.
+    wxFileName fileName = aSheet->GetFileName();
+
+    if( !fileName.IsAbsolute() )
+        fileName.SetPath( m_path );
+
+    return fileName.GetFullPath();
+}
+
+
 // Everything below this comment is recursive.  Modify with care.
 
 void SCH_LEGACY_PLUGIN::loadHierarchy( SCH_SHEET* aSheet )
 {
-    SCH_SCREEN* screen = NULL;
+    if( aSheet->GetScreen() )
+        return;
 
-    if( !aSheet->GetScreen() )
-    {
-        // SCH_SCREEN objects store the full path and file name where the SCH_SHEET object only
-        // stores the file name and extension.  Add the project path to the file name and
-        // extension to compare when calling SCH_SHEET::SearchHierarchy().
-        wxFileName fileName = aSheet->GetFileName();
+    HIERARCHY hierarchy;
+
+    // The screens already in the hierarchy are not loaded again.  Like
+    // SCH_SHEET::SearchHierarchy(), the root sheet is not searched.
+    collectScreens( hierarchy, m_rootSheet );
 
-        if( !fileName.IsAbsolute() )
-            fileName.SetPath( m_path );
+    wxString    fileName = sheetFileName( aSheet );
+    std::unique_ptr< SCH_SCREEN > screen( new SCH_SCREEN( m_kiway ) );
+    SCH_SCREEN* rootScreen = screen.get();
 
-        m_rootSheet->SearchHierarchy( fileName.GetFullPath(), &screen );
+    screen->SetFileName( fileName );
 
-        if( screen )
+    if( aSheet != m_rootSheet )
+    {
+        HIERARCHY::SHEET_SCREEN& entry = hierarchy.m_sheetScreens[fileName.Lower()];
+
+        entry.m_screen = screen.get();
+        entry.m_attached = true;
+    }
+
+    try
+    {
+        hierarchy.m_loads.Add( [this, &hierarchy, rootScreen]()
         {
-            aSheet->SetScreen( screen );
+            loadScreen( hierarchy, rootScreen );
+        } );
+
+        hierarchy.m_loads.Wait();
+
+        aSheet->SetScreen( screen.release() );
+        attachScreens( hierarchy, aSheet );
+    }
+    catch( ... )
+    {
+        deleteUnusedScreens( hierarchy );
+        throw;
+    }
+
+    deleteUnusedScreens( hierarchy );
+}
+
+
+void SCH_LEGACY_PLUGIN::deleteUnusedScreens( HIERARCHY& aHierarchy )
+{
+    // The screens of the files not used after an error, and of the files loaded for sheets
+    // whose file name differs only by its case from the file name of a previous sheet.
+    // The used screens are owned by their sheets.
+    for( auto& file : aHierarchy.m_files )
+    {
+        if( !file.second.m_used )
+            delete file.second.m_screen;
+    }
+
+    aHierarchy.m_files.clear();
+}
+
+
+void SCH_LEGACY_PLUGIN::collectScreens( HIERARCHY& aHierarchy, SCH_SHEET* aSheet )
+{
+    if( !aSheet || !aSheet->GetScreen() )
+        return;
+
+    EDA_ITEM* item = aSheet->GetScreen()->GetDrawItems();
+
+    for( ; item; item = item->Next() )
+    {
+        if( item->Type() != SCH_SHEET_T )
+            continue;
+
+        SCH_SHEET* sheet = (SCH_SHEET*) item;
+
+        if( !sheet->GetScreen() )
+            continue;
+
+        HIERARCHY::SHEET_SCREEN& entry =
+                aHierarchy.m_sheetScreens[sheet->GetScreen()->GetFileName().Lower()];
+
+        if( entry.m_screen )
+            continue;
+
+        entry.m_screen = sheet->GetScreen();
+        entry.m_attached = true;
+        collectScreens( aHierarchy, sheet );
+    }
+}
+
+
+void SCH_LEGACY_PLUGIN::queueScreen( HIERARCHY& aHierarchy, const wxString& aFileName )
+{
+    if( aHierarchy.m_sheetScreens.count( aFileName.Lower() ) )
+        return;
+
+    HIERARCHY::FILE_SCREEN* file;
+
+    {
+        boost::lock_guard<boost::mutex> lock( aHierarchy.m_lock );
+
+        // The elements of an unordered_map are not moved by the insertion of other ones
+        file = &aHierarchy.m_files[aFileName];
+
+        if( file->m_screen )
+            return;
+
+        file->m_screen = new SCH_SCREEN( m_kiway );
+        file->m_screen->SetFileName( aFileName );
+    }
 
-            // Do not need to load the sub-sheets - this has already been done.
+    aHierarchy.m_loads.Add( [this, &aHierarchy, file]()
+    {
+        // The error is thrown by attachScreens() only if a sheet uses this file: the load of a
+        // file whose name differs only by its case from the file of a previous sheet can fail.
+        try
+        {
+            loadScreen( aHierarchy, file->m_screen );
         }
-        else
+        catch( ... )
         {
-            aSheet->SetScreen( new SCH_SCREEN( m_kiway ) );
-            aSheet->GetScreen()->SetFileName( fileName.GetFullPath() );
-            loadFile( fileName.GetFullPath(), aSheet->GetScreen() );
+            file->m_error = std::current_exception();
+        }
+    } );
+}
 
-            EDA_ITEM* item = aSheet->GetScreen()->GetDrawItems();
 
-            while( item )
-            {
-                if( item->Type() == SCH_SHEET_T )
-                {
-                    SCH_SHEET* sheet = (SCH_SHEET*) item;
+void SCH_LEGACY_PLUGIN::loadScreen( HIERARCHY& aHierarchy, SCH_SCREEN* aScreen )
+{
+    // Each file has its own parser, which keeps the version of the file
+    SCH_LEGACY_PLUGIN parser;
 
-                    // Set the parent to aSheet.  This effectively creates a method to find
-                    // the root sheet from any sheet so a pointer to the root sheet does not
-                    // need to be stored globally.  Note: this is not the same as a hierarchy.
-                    // Complex hierarchies can have multiple copies of a sheet.  This only
-                    // provides a simple tree to find the root sheet.
-                    sheet->SetParent( aSheet );
+    parser.init( m_kiway, m_props );
+    parser.loadFile( aScreen->GetFileName(), aScreen );
 
-                    // Recursion starts here.
-                    loadHierarchy( sheet );
-                }
+    // The files of the sheets are loaded by other tasks
+    EDA_ITEM* item = aScreen->GetDrawItems();
 
-                item = item->Next();
-            }
+    for( ; item; item = item->Next() )
+    {
+        if( item->Type() == SCH_SHEET_T )
+            queueScreen( aHierarchy, sheetFileName( (SCH_SHEET*) item ) );
+    }
+}
+
+
+void SCH_LEGACY_PLUGIN::attachScreens( HIERARCHY& aHierarchy, SCH_SHEET* aSheet )
+{
+    createBitmaps( aSheet->GetScreen() );
+
+    EDA_ITEM* item = aSheet->GetScreen()->GetDrawItems();
+
+    for( ; item; item = item->Next() )
+    {
+        if( item->Type() != SCH_SHEET_T )
+            continue;
+
+        SCH_SHEET* sheet = (SCH_SHEET*) item;
+        wxString   fileName = sheetFileName( sheet );
+
+        // Set the parent to aSheet.  This effectively creates a method to find
+        // the root sheet from any sheet so a pointer to the root sheet does not
+        // need to be stored globally.  Note: this is not the same as a hierarchy.
+        // Complex hierarchies can have multiple copies of a sheet.  This only
+        // provides a simple tree to find the root sheet.
+        sheet->SetParent( aSheet );
+
+        // The first sheet of the hierarchy having a file name gives its screen to the
+        // next ones
+        HIERARCHY::SHEET_SCREEN& entry = aHierarchy.m_sheetScreens[fileName.Lower()];
+
+        if( !entry.m_screen )
+        {
+            HIERARCHY::FILE_SCREEN& file = aHierarchy.m_files[fileName];
+
+            wxCHECK2_MSG( file.m_screen, continue, wxT( "Sheet file not loaded" ) );
+
+            if( file.m_error )
+                std::rethrow_exception( file.m_error );
+
+            file.m_used = true;
+            entry.m_screen = file.m_screen;
         }
+
+        sheet->SetScreen( entry.m_screen );
+
+        if( !entry.m_attached )
+        {
+            entry.m_attached = true;
+
+            // Recursion starts here.
+            attachScreens( aHierarchy, sheet );
+        }
+    }
+}
+
+
+void SCH_LEGACY_PLUGIN::createBitmaps( SCH_SCREEN* aScreen )
+{
+    EDA_ITEM* item = aScreen->GetDrawItems();
+
+    for( ; item; item = item->Next() )
+    {
+        if( item->Type() != SCH_BITMAP_T )
+            continue;
+
+        BITMAP_BASE* image = ( (SCH_BITMAP*) item )->GetImage();
+
+        if( image->GetImageData() && !image->GetBitmap() )
+            image->SetBitmap( new wxBitmap( *image->GetImageData() ) );
     }
 }
 
@@ -919,12 +1147,13 @@ SCH_BITMAP* SCH_LEGACY_PLUGIN::loadBitmap( FILE_LINE_READER& aReader )
                 if( strCompare( "EndData", line ) )
                 {
                     // all the PNG date is read.
-                    // We expect here m_image and m_bitmap are void
+                    // We expect here m_image and m_bitmap are void.  The files are loaded
+                    // by worker threads, which cannot create a wxBitmap: it is created from
+                    // the image by createBitmaps(), in the GUI thread.
                     wxImage* image = new wxImage();
                     wxMemoryInputStream istream( stream );
                     image->LoadFile( istream, wxBITMAP_TYPE_PNG );
                     bitmap->GetImage()->SetImage( image );
-                    bitmap->GetImage()->SetBitmap( new wxBitmap( *image ) );
                     break;
                 }
 
@@ -90,7 +90,16 @@ public:
     void TransferCache( PART_LIB& aTarget );
 
 private:
+    struct HIERARCHY;
+
     void loadHierarchy( SCH_SHEET* aSheet );
+    void collectScreens( HIERARCHY& aHierarchy, SCH_SHEET* aSheet );
+    void queueScreen( HIERARCHY& aHierarchy, const wxString& aFileName );
+    void loadScreen( HIERARCHY& aHierarchy, SCH_SCREEN* aScreen );
+    void attachScreens( HIERARCHY& aHierarchy, SCH_SHEET* aSheet );
+    static void createBitmaps( SCH_SCREEN* aScreen );
+    void deleteUnusedScreens( HIERARCHY& aHierarchy );
+    wxString sheetFileName( SCH_SHEET* aSheet ) const;
     void loadHeader( FILE_LINE_READER& aReader, SCH_SCREEN* aScreen );
     void loadPageSettings( FILE_LINE_READER& aReader, SCH_SCREEN* aScreen );
     void loadFile( const wxString& aFileName, SCH_SCREEN* aScreen );
@@ -54,6 +54,8 @@
 #include <sch_text.h>
 #include <lib_pin.h>
 
+#include <atomic>
+
 
 #define EESCHEMA_FILE_STAMP   "EESchema"
 
@@ -92,12 +94,19 @@ static GRID_TYPE SchematicGridList[] = {
 };
 
 
+/// The last revision given to a screen by SCH_SCREEN::ConnectivityChanged(), atomic
+/// because the screens of a hierarchy are loaded by several threads
+static std::atomic<unsigned> s_lastConnectivityRevision( 0 );
+
+
 SCH_SCREEN::SCH_SCREEN( KIWAY* aKiway ) :
     BASE_SCREEN( SCH_SCREEN_T ),
     KIWAY_HOLDER( aKiway ),
     m_paper( wxT( "A4" ) )
 {
     m_modification_sync = 0;
+    m_indexValid = false;
+    ConnectivityChanged();
 
     SetZoom( 32 );
 
@@ -138,6 +147,25 @@ void SCH_SCREEN::DecRefCount()
 }
 
 
+void SCH_SCREEN::ConnectivityChanged()
+{
+    m_connectivityRevision = ++s_lastConnectivityRevision;
+    m_indexValid = false;
+}
+
+
+SCH_SCREEN_INDEX& SCH_SCREEN::getIndex() const
+{
+    if( !m_indexValid )
+    {
+        m_index.Build( m_drawList.begin() );
+        m_indexValid = true;
+    }
+
+    return m_index;
+}
+
+
 void SCH_SCREEN::Clear()
 {
     FreeDrawList();
@@ -152,12 +180,17 @@ void SCH_SCREEN::Clear()
 void SCH_SCREEN::FreeDrawList()
 {
     m_drawList.DeleteAll();
+    ConnectivityChanged();
 }
 
 
 void SCH_SCREEN::Remove( SCH_ITEM* aItem )
 {
     m_drawList.Remove( aItem );
+    m_indexValid = false;
+
+    if( aItem->Type() != SCH_MARKER_T )
+        ConnectivityChanged();
 }
 
 
@@ -166,6 +199,10 @@ void SCH_SCREEN::DeleteItem( SCH_ITEM* aItem )
     wxCHECK_RET( aItem, wxT( "Cannot delete invalid item from screen." ) );
 
     SetModify();
+    m_indexValid = false;
+
+    if( aItem->Type() != SCH_MARKER_T )
+        ConnectivityChanged();
 
     if( aItem->Type() == SCH_SHEET_PIN_T )
     {
@@ -202,7 +239,11 @@ bool SCH_SCREEN::CheckIfOnDrawList( SCH_ITEM* aItem )
 
 SCH_ITEM* SCH_SCREEN::GetItem( const wxPoint& aPosition, int aAccuracy, KICAD_T aType ) const
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector<SCH_ITEM*> candidates;
+
+    getIndex().QueryPosition( aPosition, aAccuracy, candidates );
+
+    for( SCH_ITEM* item : candidates )
     {
         if( item->HitTest( aPosition, aAccuracy ) && (aType == NOT_USED) )
             return item;
@@ -263,6 +304,8 @@ void SCH_SCREEN::ExtractWires( DLIST< SCH_ITEM >& aList, bool aCreateCopy )
             break;
         }
     }
+
+    ConnectivityChanged();
 }
 
 
@@ -289,6 +332,7 @@ void SCH_SCREEN::ReplaceWires( DLIST< SCH_ITEM >& aWireList )
     }
 
     m_drawList.Append( aWireList );
+    ConnectivityChanged();
 }
 
 
@@ -551,6 +595,9 @@ void SCH_SCREEN::CheckComponentsToPartsLinks()
 
             m_modification_sync = mod_hash;     // note the last mod_hash
 
+            // The pins of the components can have changed
+            ConnectivityChanged();
+
             // guard against unneeded runs through this code path by printing trace
             DBG(printf("%s: resync-ing %s\n", __func__, TO_UTF8( GetFileName() ) );)
         }
@@ -567,15 +614,16 @@ void SCH_SCREEN::Draw( EDA_DRAW_PANEL* aCanvas, wxDC* aDC, GR_DRAWMODE aDrawMode
 
     CheckComponentsToPartsLinks();
 
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    // Only the items inside the clip box are drawn, in the draw list order
+    std::vector<SCH_ITEM*> items;
+
+    getIndex().Query( *aCanvas->GetClipBox(), items );
+
+    for( SCH_ITEM* item : items )
     {
         if( item->IsMoving() || item->IsResized() )
             continue;
 
-        // uncomment line below when there is a virtual
-        // EDA_ITEM::GetBoundingBox()
-        //      if( panel->GetClipBox().Intersects( Structs->GetBoundingBox()
-        // ) )
         item->Draw( aCanvas, aDC, wxPoint( 0, 0 ), aDrawMode, aColor );
     }
 }
@@ -631,11 +679,14 @@ void SCH_SCREEN::ClearDrawingState()
 LIB_PIN* SCH_SCREEN::GetPin( const wxPoint& aPosition, SCH_COMPONENT** aComponent,
                              bool aEndPointOnly ) const
 {
-    SCH_ITEM*       item;
     SCH_COMPONENT*  component = NULL;
     LIB_PIN*        pin = NULL;
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
+    std::vector<SCH_ITEM*> candidates;
+
+    getIndex().QueryPosition( aPosition, 0, candidates );
+
+    for( SCH_ITEM* item : candidates )
     {
         if( item->Type() != SCH_COMPONENT_T )
             continue;
@@ -705,7 +756,11 @@ SCH_SHEET_PIN* SCH_SCREEN::GetSheetLabel( const wxPoint& aPosition )
 {
     SCH_SHEET_PIN* sheetPin = NULL;
 
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector<SCH_ITEM*> candidates;
+
+    getIndex().QueryPosition( aPosition, 0, candidates );
+
+    for( SCH_ITEM* item : candidates )
     {
         if( item->Type() != SCH_SHEET_T )
             continue;
@@ -723,10 +778,13 @@ SCH_SHEET_PIN* SCH_SCREEN::GetSheetLabel( const wxPoint& aPosition )
 
 int SCH_SCREEN::CountConnectedItems( const wxPoint& aPos, bool aTestJunctions ) const
 {
-    SCH_ITEM* item;
-    int       count = 0;
+    int count = 0;
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
+    std::vector<SCH_ITEM*> candidates;
+
+    getIndex().QueryPosition( aPos, 0, candidates );
+
+    for( SCH_ITEM* item : candidates )
     {
         if( item->Type() == SCH_JUNCTION_T  && !aTestJunctions )
             continue;
@@ -755,6 +813,9 @@ void SCH_SCREEN::ClearAnnotation( SCH_SHEET_PATH* aSheetPath )
             component->ClearFlags();
         }
     }
+
+    // The unit of the components can be reset
+    ConnectivityChanged();
 }
 
 
@@ -959,6 +1020,9 @@ bool SCH_SCREEN::BreakSegment( const wxPoint& aPoint )
         brokenSegments = true;
     }
 
+    if( brokenSegments )
+        ConnectivityChanged();
+
     return brokenSegments;
 }
 
@@ -994,7 +1058,11 @@ bool SCH_SCREEN::BreakSegmentsOnJunctions()
 
 int SCH_SCREEN::GetNode( const wxPoint& aPosition, EDA_ITEMS& aList )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector<SCH_ITEM*> candidates;
+
+    getIndex().QueryPosition( aPosition, 0, candidates );
+
+    for( SCH_ITEM* item : candidates )
     {
         if( item->Type() == SCH_LINE_T && item->HitTest( aPosition )
             && (item->GetLayer() == LAYER_BUS || item->GetLayer() == LAYER_WIRE) )
@@ -1013,7 +1081,11 @@ int SCH_SCREEN::GetNode( const wxPoint& aPosition, EDA_ITEMS& aList )
 
 SCH_LINE* SCH_SCREEN::GetWireOrBus( const wxPoint& aPosition )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector<SCH_ITEM*> candidates;
+
+    getIndex().QueryPosition( aPosition, 0, candidates );
+
+    for( SCH_ITEM* item : candidates )
     {
         if( (item->Type() == SCH_LINE_T) && item->HitTest( aPosition )
             && (item->GetLayer() == LAYER_BUS || item->GetLayer() == LAYER_WIRE) )
@@ -1029,7 +1101,11 @@ SCH_LINE* SCH_SCREEN::GetWireOrBus( const wxPoint& aPosition )
 SCH_LINE* SCH_SCREEN::GetLine( const wxPoint& aPosition, int aAccuracy, int aLayer,
                                SCH_LINE_TEST_T aSearchType )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector<SCH_ITEM*> candidates;
+
+    getIndex().QueryPosition( aPosition, aAccuracy, candidates );
+
+    for( SCH_ITEM* item : candidates )
     {
         if( item->Type() != SCH_LINE_T )
             continue;
@@ -1062,7 +1138,11 @@ SCH_LINE* SCH_SCREEN::GetLine( const wxPoint& aPosition, int aAccuracy, int aLay
 
 SCH_TEXT* SCH_SCREEN::GetLabel( const wxPoint& aPosition, int aAccuracy )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector<SCH_ITEM*> candidates;
+
+    getIndex().QueryPosition( aPosition, aAccuracy, candidates );
+
+    for( SCH_ITEM* item : candidates )
     {
         switch( item->Type() )
         {
@@ -0,0 +1,137 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file sch_screen_index.cpp
+ */
+
+#include <fctsys.h>
+#include <algorithm>
+
+#include <general.h>
+#include <sch_item_struct.h>
+#include <sch_sheet.h>
+
+#include <sch_screen_index.h>
+
+
+/**
+ * Helper visitor for INDEX_TREE searches: collects the ordinals of the items found.
+ */
+struct SCH_INDEX_COLLECTOR
+{
+    SCH_INDEX_COLLECTOR( std::vector<int>& aResult ) :
+        m_result( aResult )
+    {
+    }
+
+    bool operator()( int aIndex )
+    {
+        m_result.push_back( aIndex );
+        return true;
+    }
+
+    std::vector<int>& m_result;
+};
+
+
+void SCH_SCREEN_INDEX::Clear()
+{
+    m_items.clear();
+    m_tree.RemoveAll();
+}
+
+
+void SCH_SCREEN_INDEX::Build( SCH_ITEM* aFirstItem )
+{
+    Clear();
+
+    int index = 0;
+
+    for( SCH_ITEM* item = aFirstItem; item; item = item->Next(), ++index )
+    {
+        EDA_RECT area = ItemArea( item );
+        int      mmin[2] = { area.GetX(), area.GetY() };
+        int      mmax[2] = { area.GetRight(), area.GetBottom() };
+
+        m_items.push_back( item );
+        m_tree.Insert( mmin, mmax, index );
+    }
+}
+
+
+EDA_RECT SCH_SCREEN_INDEX::ItemArea( const SCH_ITEM* aItem )
+{
+    EDA_RECT area = aItem->GetBoundingBox();
+
+    // The labels of the sheet pins are drawn outside of the sheet
+    if( aItem->Type() == SCH_SHEET_T )
+    {
+        SCH_SHEET_PINS& pins = ( (const SCH_SHEET*) aItem )->GetPins();
+
+        for( unsigned ii = 0; ii < pins.size(); ii++ )
+            area.Merge( pins[ii].GetBoundingBox() );
+    }
+
+    area.Normalize();
+
+    // Some bounding boxes do not include the whole pen width, or the size the hit
+    // tests use (the default line thickness, for no connects)
+    area.Inflate( std::max( aItem->GetPenSize(), GetDefaultLineThickness() ) + 1 );
+
+    return area;
+}
+
+
+void SCH_SCREEN_INDEX::Query( const EDA_RECT& aArea, std::vector<SCH_ITEM*>& aResult )
+{
+    std::vector<int>    found;
+    SCH_INDEX_COLLECTOR collector( found );
+    EDA_RECT            area = aArea;
+
+    area.Normalize();
+
+    int mmin[2] = { area.GetX(), area.GetY() };
+    int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+    m_tree.Search( mmin, mmax, collector );
+
+    std::sort( found.begin(), found.end() );
+
+    aResult.clear();
+    aResult.reserve( found.size() );
+
+    for( unsigned ii = 0; ii < found.size(); ii++ )
+        aResult.push_back( m_items[found[ii]] );
+}
+
+
+void SCH_SCREEN_INDEX::QueryPosition( const wxPoint& aPosition, int aAccuracy,
+                                      std::vector<SCH_ITEM*>& aResult )
+{
+    EDA_RECT area( aPosition, wxSize( 0, 0 ) );
+
+    area.Inflate( std::max( aAccuracy, 0 ) + 1 );
+
+    Query( area, aResult );
+}
@@ -0,0 +1,105 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file sch_screen_index.h
+ * @brief Spatial index of the draw items of a schematic screen.
+ */
+
+#ifndef SCH_SCREEN_INDEX_H_
+#define SCH_SCREEN_INDEX_H_
+
+#include <vector>
+
+#include <class_eda_rect.h>
+#include <geometry/rtree.h>
+
+class SCH_ITEM;
+
+
+/**
+ * Class SCH_SCREEN_INDEX
+ * holds an R-tree of the areas of the draw items of a SCH_SCREEN, so drawing a part of
+ * the sheet or hit testing a position only visits the items near it.
+ *
+ * Items are referenced by their ordinal in the draw list, and every query returns the
+ * items in the draw list order.  The items are drawn in the same order as before, and
+ * the hit test functions, which return the first item found, find the same one.
+ *
+ * The index is a snapshot of the draw list: SCH_SCREEN rebuilds it after any change.
+ */
+class SCH_SCREEN_INDEX
+{
+public:
+    SCH_SCREEN_INDEX() {}
+
+    /**
+     * Function Build
+     * (re)creates the index from the draw list starting at \a aFirstItem.
+     */
+    void Build( SCH_ITEM* aFirstItem );
+
+    /**
+     * Function Clear
+     * removes all the items from the index.
+     */
+    void Clear();
+
+    unsigned GetCount() const           { return m_items.size(); }
+
+    /**
+     * Function ItemArea
+     * @return the area covered by \a aItem, which contains the area drawn by the item and
+     *         every position it is hit by with no accuracy.  The pins of a sheet are
+     *         included.
+     */
+    static EDA_RECT ItemArea( const SCH_ITEM* aItem );
+
+    /**
+     * Function Query
+     * collects the items whose area intersects \a aArea.
+     * @param aArea is the search area.
+     * @param aResult receives the items, in the draw list order.
+     */
+    void Query( const EDA_RECT& aArea, std::vector<SCH_ITEM*>& aResult );
+
+    /**
+     * Function QueryPosition
+     * collects the items which can be hit at \a aPosition within \a aAccuracy, in the
+     * draw list order.
+     */
+    void QueryPosition( const wxPoint& aPosition, int aAccuracy,
+                        std::vector<SCH_ITEM*>& aResult );
+
+private:
+    typedef RTree<int, int, 2, float> INDEX_TREE;
+
+    /// Copying the tree is not supported
+    SCH_SCREEN_INDEX( const SCH_SCREEN_INDEX& );
+    SCH_SCREEN_INDEX& operator=( const SCH_SCREEN_INDEX& );
+
+    std::vector<SCH_ITEM*>  m_items;    ///< by ordinal
+    INDEX_TREE              m_tree;
+};
+
+#endif  // SCH_SCREEN_INDEX_H_
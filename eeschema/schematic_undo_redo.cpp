@@ -229,6 +229,26 @@ void SCH_EDIT_FRAME::SaveCopyInUndoList( const PICKED_ITEMS_LIST& aItemsList,
 }
 
 
+/**
+ * Function itemConnectivityChanged
+ * bumps the connectivity revision of the screen owning \a aItem, so the cached
+ * netlist items of that sheet are rebuilt.
+ */
+static void itemConnectivityChanged( SCH_ITEM* aItem )
+{
+    SCH_SCREENS screens;
+
+    for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+    {
+        if( screen->CheckIfOnDrawList( aItem ) )
+        {
+            screen->ConnectivityChanged();
+            return;
+        }
+    }
+}
+
+
 void SCH_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRedoCommand )
 {
     SCH_ITEM* item;
@@ -277,6 +297,11 @@ void SCH_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
         {
         case UR_CHANGED: /* Exchange old and new data for each item */
             item->SwapData( image );
+
+            // Find/Replace can change an item of another sheet than the current one
+            if( !GetScreen()->CheckIfOnDrawList( item ) )
+                itemConnectivityChanged( item );
+
             break;
 
         case UR_NEW:     /* new items are deleted */
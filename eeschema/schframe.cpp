@@ -52,6 +52,7 @@
 #include <eeschema_config.h>
 #include <sch_sheet.h>
 #include <sch_sheet_path.h>
+#include <sch_connectivity.h>
 
 #include <invoke_sch_dialog.h>
 #include <dialogs/dialog_schematic_find.h>
@@ -354,6 +355,7 @@ SCH_EDIT_FRAME::SCH_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent ):
     m_dlgFindReplace = NULL;
     m_findReplaceData = new wxFindReplaceData( wxFR_DOWN );
     m_undoItem = NULL;
+    m_connectivity = new SCH_CONNECTIVITY();
     m_hasAutoSave = true;
 
     SetForceHVLines( true );
@@ -442,11 +444,13 @@ SCH_EDIT_FRAME::~SCH_EDIT_FRAME()
 
     delete m_CurrentSheet;          // a SCH_SHEET_PATH, on the heap.
     delete m_undoItem;
+    delete m_connectivity;
     delete g_RootSheet;
     delete m_findReplaceData;
 
     m_CurrentSheet = NULL;
     m_undoItem = NULL;
+    m_connectivity = NULL;
     g_RootSheet = NULL;
     m_findReplaceData = NULL;
 }
@@ -754,6 +758,7 @@ void SCH_EDIT_FRAME::OnModify()
 {
     GetScreen()->SetModify();
     GetScreen()->SetSave();
+    GetScreen()->ConnectivityChanged();
 
     m_foundItems.SetForceSearch();
 }
@@ -64,6 +64,7 @@ class DIALOG_SCH_FIND;
 class wxFindDialogEvent;
 class wxFindReplaceData;
 class SCHLIB_FILTER;
+class SCH_CONNECTIVITY;
 
 
 /// enum used in RotationMiroir()
@@ -141,6 +142,8 @@ private:
     SCH_COLLECTOR           m_collectedItems;     ///< List of collected items.
     SCH_FIND_COLLECTOR      m_foundItems;         ///< List of find/replace items.
     SCH_ITEM*               m_undoItem;           ///< Copy of the current item being edited.
+    SCH_CONNECTIVITY*       m_connectivity;       ///< Connected items of the sheets, kept
+                                                  ///< between netlist builds.
     wxString                m_simulatorCommand;   ///< Command line used to call the circuit
                                                   ///< simulator (gnucap, spice, ...)
     wxString                m_netListerCommand;   ///< Command line to call a custom net list
@@ -496,7 +499,8 @@ public:
      * BuildNetListBase
      * netlist generation:
      * Creates a flat list which stores all connected objects, and mainly
-     * pins and labels.
+     * pins and labels.  Only the sheets edited since the previous call are
+     * read again, see SCH_CONNECTIVITY.
      * @return NETLIST_OBJECT_LIST* - caller owns the object.
      */
     NETLIST_OBJECT_LIST* BuildNetListBase();
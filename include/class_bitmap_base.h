@@ -89,6 +89,7 @@ public:
      */
     void RebuildBitmap() { *m_bitmap = wxBitmap( *m_image ); }
 
+    wxBitmap* GetBitmap() const { return m_bitmap; }
     void SetBitmap( wxBitmap* aBitMap )
     {
         delete m_bitmap;
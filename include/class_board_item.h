@@ -39,6 +39,10 @@
 #define FMT_IU     BOARD_ITEM::FormatInternalUnits
 #define FMT_ANGLE  BOARD_ITEM::FormatAngle
 
+/// Size of the buffers given to the BOARD_ITEM::FormatInternalUnits() char buffer versions,
+/// enough for two values and a separator.
+#define FMT_IU_BUFSIZE  48
+
 class BOARD;
 class EDA_DRAW_PANEL;
 
@@ -330,6 +334,25 @@ public:
 
     static std::string FormatInternalUnits( const wxSize& aSize );
 
+    /**
+     * Function FormatInternalUnits
+     * writes the same text as FormatInternalUnits( int ) into a caller buffer, without
+     * any allocation nor locale dependency.
+     *
+     * @param aBuffer receives the text and a terminating nul, and must hold at least
+     *                FMT_IU_BUFSIZE chars.
+     * @param aValue A coordinate value to convert.
+     * @return the length of the text.
+     */
+    static int FormatInternalUnits( char* aBuffer, int aValue );
+
+    /**
+     * Function FormatInternalUnits
+     * writes the two coordinates of \a aPoint separated by a space into a caller buffer.
+     * @see FormatInternalUnits( char*, int ).
+     */
+    static int FormatInternalUnits( char* aBuffer, const wxPoint& aPoint );
+
     /// @copydoc VIEW_ITEM::ViewGetLayers()
     virtual void ViewGetLayers( int aLayers[], int& aCount ) const;
 };
@@ -106,11 +106,15 @@ protected:
     int                 curOffset;              ///< offset within current line of the current token
 
     int                 curTok;                 ///< the current token obtained on last NextTok()
-    std::string         curText;                ///< the text of the current token
+    std::string         curText;                ///< the text of the current token, if curTextBegin is NULL
+    const char*         curTextBegin;           ///< the text of the current token where it lies in
+    const char*         curTextEnd;             ///< the input (a view), or NULL: see setCurText()
+    std::string         curLine;                ///< copy of a line read by ReadLineView(), for CurLine()
 
     const KEYWORD*      keywords;               ///< table sorted by CMake for bsearch()
     unsigned            keywordCount;           ///< count of keywords table
     KEYWORD_MAP         keyword_hash;           ///< fast, specialized "C string" hashtable
+    size_t              maxKeywordLength;       ///< longer tokens are not looked up
 
     void init();
 
@@ -118,13 +122,16 @@ protected:
     {
         if( reader )
         {
-            reader->ReadLine();
+            unsigned len;
 
-            unsigned len = reader->Length();
+            // The line can stay in the storage of the reader (e.g. a memory mapped file)
+            // instead of being copied to its line buffer.  Otherwise start may have
+            // changed, since ReadLine() can resize and relocate reader's line buffer.
+            start = reader->ReadLineView( &len );
 
-            // start may have changed in ReadLine(), which can resize and
-            // relocate reader's line buffer.
-            start = reader->Line();
+            // at EOF, keep a valid (empty) line for CurLine()
+            if( !start )
+                start = reader->Line();
 
             next  = start;
             limit = next + len;
@@ -144,6 +151,25 @@ protected:
      */
     int findToken( const std::string& aToken );
 
+    /**
+     * Function findToken
+     * looks up the text between @a aBegin and @a aEnd in the keywords table, like
+     * findToken( const std::string& ), without copying it to curText.
+     */
+    int findToken( const char* aBegin, const char* aEnd );
+
+    /**
+     * Function setCurText
+     * makes the text between @a aBegin and @a aEnd the text of the current token,
+     * without copying it: curText is only filled when CurStr() is used.
+     * The text must stay valid until the next readLine().
+     */
+    void setCurText( const char* aBegin, const char* aEnd )
+    {
+        curTextBegin = aBegin;
+        curTextEnd   = aEnd;
+    }
+
     bool isStringTerminator( char cc )
     {
         if( !space_in_quoted_tokens && cc==' ' )
@@ -389,6 +415,21 @@ public:
      */
     wxArrayString* ReadCommentLines() throw( IO_ERROR );
 
+    /**
+     * Function CopyList
+     * skips the list whose opening parenthesis and first token were read by the last
+     * two NextTok() calls, and copies its text, from this parenthesis to the matching
+     * closing one, to @a aText.  The list is not split in tokens: only its parentheses
+     * and quoted strings are looked for, which is much faster than reading it with
+     * NextTok().  The copy can be parsed later by another DSNLEXER, e.g. on another
+     * thread.  Only the non-specctra mode is supported.
+     * Upon return, the current token is the closing parenthesis of the list.
+     *
+     * @param aText receives the text of the list.
+     * @throw PARSE_ERROR if the end of the input is reached before the end of the list.
+     */
+    void CopyList( std::string* aText ) throw( IO_ERROR, PARSE_ERROR );
+
     /**
      * Function IsSymbol
      * tests a token to see if it is a symbol.  This means it cannot be a
@@ -478,7 +519,7 @@ public:
      */
     const char* CurText()
     {
-        return curText.c_str();
+        return CurStr().c_str();
     }
 
     /**
@@ -487,9 +528,40 @@ public:
      */
     const std::string& CurStr()
     {
+        if( curTextBegin )
+        {
+            curText.assign( curTextBegin, curTextEnd );
+            curTextBegin = NULL;
+        }
+
         return curText;
     }
 
+    /**
+     * Function CurTextInPlace
+     * returns the current token's text without copying it, if possible.  The text is
+     * NOT nul terminated, but it is always followed by a character which cannot be a
+     * part of a number (a separator, a quote or a nul), so it can be given as is to
+     * strtod() or strtol().
+     * @param aEnd, if not NULL, receives the end of the text.
+     * @return const char* - the beginning of the text.
+     */
+    const char* CurTextInPlace( const char** aEnd = NULL )
+    {
+        if( !curTextBegin )
+        {
+            if( aEnd )
+                *aEnd = curText.c_str() + curText.size();
+
+            return curText.c_str();
+        }
+
+        if( aEnd )
+            *aEnd = curTextEnd;
+
+        return curTextBegin;
+    }
+
     /**
      * Function FromUTF8
      * returns the current token text as a wxString, assuming that the input
@@ -497,7 +569,10 @@ public:
      */
     wxString FromUTF8()
     {
-        return wxString::FromUTF8( curText.c_str() );
+        const char* end;
+        const char* begin = CurTextInPlace( &end );
+
+        return wxString::FromUTF8( begin, end - begin );
     }
 
     /**
@@ -514,10 +589,7 @@ public:
      * returns the current line of text, from which the CurText() would return
      * its token.
      */
-    const char* CurLine()
-    {
-        return (const char*)(*reader);
-    }
+    const char* CurLine();
 
     /**
      * Function CurFilename
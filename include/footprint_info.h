@@ -75,6 +75,22 @@ public:
 #endif
     }
 
+    /// Constructor for a footprint whose information is already known, e.g. indexed.
+    FOOTPRINT_INFO( FOOTPRINT_LIST* aOwner, const wxString& aNickname,
+                    const wxString& aFootprintName, int aPadCount, int aUniquePadCount,
+                    const wxString& aDoc, const wxString& aKeywords ) :
+        m_owner( aOwner ),
+        m_loaded( true ),
+        m_nickname( aNickname ),
+        m_fpname( aFootprintName ),
+        m_num( 0 ),
+        m_pad_count( aPadCount ),
+        m_unique_pad_count( aUniquePadCount ),
+        m_doc( aDoc ),
+        m_keywords( aKeywords )
+    {
+    }
+
     const wxString& GetDoc()
     {
         ensure_loaded();
@@ -174,13 +190,12 @@ class FOOTPRINT_LIST
 
     /**
      * Function loader_job
-     * loads footprints from @a aNicknameList and calls AddItem() on to help fill
-     * m_list.
+     * loads footprints from the library @a aNickname and calls AddItem() on to help fill
+     * m_list.  It runs as a task of the THREAD_POOL, and reports its errors in m_errors.
      *
-     * @param aNicknameList is a wxString[] holding libraries to load all footprints from.
-     * @param aJobZ is the size of the job, i.e. the count of nicknames.
+     * @param aNickname is the library to load all footprints from.
      */
-    void loader_job( const wxString* aNicknameList, int aJobZ );
+    void loader_job( const wxString& aNickname );
 
     void addItem( FOOTPRINT_INFO* aItem )
     {
@@ -36,6 +36,9 @@
 // but the errorText needs to be wide char so wxString rules.
 #include <wx/wx.h>
 #include <stdio.h>
+#include <memory>
+
+namespace boost { namespace interprocess { class file_mapping; class mapped_region; } }
 
 
 /**
@@ -286,6 +289,25 @@ public:
      */
     virtual char* ReadLine() throw( IO_ERROR ) = 0;
 
+    /**
+     * Function ReadLineView
+     * reads a line of text like ReadLine(), but may return it where it lies in the
+     * storage of the reader instead of copying it to the line buffer.  Such a line is
+     * not writable and not nul terminated (it ends with its '\n', or with a nul if it
+     * is the last line), and Line() does not return it.  It stays valid until the next
+     * read.  The default implementation calls ReadLine().
+     * @param aLength receives the number of bytes of the line.
+     * @return const char* - The beginning of the read line, or NULL if EOF.
+     * @throw IO_ERROR when a line is too long.
+     */
+    virtual const char* ReadLineView( unsigned* aLength ) throw( IO_ERROR )
+    {
+        const char* ret = ReadLine();
+
+        *aLength = length;
+        return ret;
+    }
+
     /**
      * Function GetSource
      * returns the name of the source of the lines in an abstract sense.
@@ -434,8 +456,12 @@ public:
      *
      * @param aSource describes the source of aString for error reporting purposes
      *  can be anything meaninful, such as wxT( "clipboard" ).
+     *
+     * @param aStartingLineNumber is the initial line number to report on error, when
+     *  aString is a part of a larger text.
      */
-    STRING_LINE_READER( const std::string& aString, const wxString& aSource );
+    STRING_LINE_READER( const std::string& aString, const wxString& aSource,
+                        unsigned aStartingLineNumber = 0 );
 
     /**
      * Constructor STRING_LINE_READER( const STRING_LINE_READER& )
@@ -446,6 +472,65 @@ public:
     STRING_LINE_READER( const STRING_LINE_READER& aStartingPoint );
 
     char* ReadLine() throw( IO_ERROR );    // see LINE_READER::ReadLine() description
+
+    const char* ReadLineView( unsigned* aLength ) throw( IO_ERROR );
+};
+
+
+/**
+ * Class MMAP_LINE_READER
+ * is a LINE_READER that maps a whole file in memory, so ReadLineView() returns the
+ * lines in place, without reading the file character by character nor copying the
+ * lines.  ReadLine() copies the lines to the line buffer like the other LINE_READERs.
+ *
+ * The file is read in binary mode: '\r' characters of line ends are kept.  If the
+ * file cannot be mapped, it is read in memory in one block instead.
+ */
+class MMAP_LINE_READER : public LINE_READER
+{
+protected:
+    std::unique_ptr<boost::interprocess::file_mapping>  m_mapping;
+    std::unique_ptr<boost::interprocess::mapped_region> m_region;
+    std::string     m_buffer;       ///< file contents, when the file is not mapped
+
+    const char*     m_data;         ///< file contents
+    size_t          m_size;         ///< file size
+    size_t          m_offset;       ///< offset of the next line in m_data
+
+    /// copies aLength bytes of aText to the line buffer, and nul terminates it
+    void copyToLine( const char* aText, unsigned aLength );
+
+public:
+
+    /**
+     * Constructor MMAP_LINE_READER
+     * opens and maps @a aFileName.
+     *
+     * @param aFileName is the name of the file to open and to use for error reporting purposes.
+     * @param aStartingLineNumber is the initial line number to report on error.
+     * @param aMaxLineLength is the maximum length of a line.
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened.
+     */
+    MMAP_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber = 0,
+            unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX ) throw( IO_ERROR );
+
+    ~MMAP_LINE_READER();
+
+    char* ReadLine() throw( IO_ERROR );   // see LINE_READER::ReadLine() description
+
+    const char* ReadLineView( unsigned* aLength ) throw( IO_ERROR );
+
+    /**
+     * Function Rewind
+     * goes back to the beginning of the file and resets the line number to zero.
+     */
+    void Rewind()
+    {
+        m_offset = 0;
+        lineNum = 0;
+    }
 };
 
 
@@ -562,6 +647,18 @@ public:
      */
     int PRINTF_FUNC Print( int nestLevel, const char* fmt, ... ) throw( IO_ERROR );
 
+    /**
+     * Function Write
+     * writes already formatted text to the output stream.  It is the fast version of
+     * Print() for text built by the caller, such as numbers written by hand.
+     *
+     * @param nestLevel The multiple of spaces to precede the output with.
+     * @param aText is the text to write.
+     * @param aCount is the number of bytes of aText to write.
+     * @throw IO_ERROR, if there is a problem outputting, such as a full disk.
+     */
+    void Write( int nestLevel, const char* aText, int aCount ) throw( IO_ERROR );
+
     /**
      * Function GetQuoteChar
      * performs quote character need determination.
@@ -0,0 +1,196 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file thread_pool.h
+ * @brief Process wide pool of worker threads running small tasks.
+ */
+
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <deque>
+#include <exception>
+#include <functional>
+
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/thread.hpp>
+
+
+/**
+ * Class THREAD_POOL
+ * runs tasks on a fixed set of worker threads.
+ *
+ * Each worker has its own task queue.  A task submitted by a worker goes to the queue of
+ * this worker, which runs its newest task first; a worker without tasks steals the oldest
+ * task of another worker, so uneven tasks (a big library among small ones) are spread
+ * over all the workers.  Tasks submitted by other threads are dealt to the workers in
+ * turn.
+ *
+ * Tasks are grouped and waited for with TASK_GROUP.
+ */
+class THREAD_POOL
+{
+public:
+    typedef std::function<void()>   TASK;
+
+    /**
+     * Function GetInstance
+     * @return the process wide pool, with one worker per hardware thread.  The pool is
+     * created by Startup(), or else by the first call.
+     */
+    static THREAD_POOL& GetInstance();
+
+    /**
+     * Function Startup
+     * creates the process wide pool.  It is called when a KIFACE starts.
+     */
+    static void Startup();
+
+    /**
+     * Function Shutdown
+     * stops the workers of the process wide pool and destroys it.  It is called when a
+     * KIFACE or the program ends: the pool must not be left to the static destructors,
+     * which can run where joining threads deadlocks (under the loader lock on Windows).
+     * No task of the pool can be running or queued.
+     */
+    static void Shutdown();
+
+    /**
+     * Constructor
+     * starts @a aThreadCount workers (at least one).
+     */
+    THREAD_POOL( unsigned aThreadCount );
+
+    /// Stops the workers, after they finish their current task
+    ~THREAD_POOL();
+
+    unsigned GetThreadCount() const { return m_queues.size(); }
+
+    /**
+     * Function Submit
+     * queues a task.  The task must not throw exceptions, see TASK_GROUP for that.
+     */
+    void Submit( const TASK& aTask );
+
+    /**
+     * Function RunPendingTask
+     * runs one of the queued tasks on the calling thread, to help the workers while
+     * waiting for some tasks to finish.
+     * @return false if no task was queued.
+     */
+    bool RunPendingTask();
+
+private:
+    struct QUEUE
+    {
+        boost::mutex        m_lock;
+        std::deque<TASK>    m_tasks;
+    };
+
+    /// Copying a pool is not supported
+    THREAD_POOL( const THREAD_POOL& );
+    THREAD_POOL& operator=( const THREAD_POOL& );
+
+    /// Thread function of the worker aIndex
+    void work( unsigned aIndex );
+
+    /**
+     * Function takeTask
+     * takes the newest task of the queue aIndex, or else the oldest task of another queue
+     * (the oldest task of any queue if aIndex is -1).
+     * @return false if all the queues are empty.
+     */
+    bool takeTask( int aIndex, TASK& aTask );
+
+    /// Returns the index of the calling thread in the workers, or -1 for another thread
+    int workerIndex() const;
+
+    boost::ptr_vector<QUEUE>    m_queues;       ///< one per worker
+    boost::thread_group         m_threads;
+
+    boost::mutex                m_lock;         ///< protects the members below
+    boost::condition_variable   m_taskQueued;
+    unsigned                    m_queuedCount;  ///< tasks in all the queues
+    unsigned                    m_nextQueue;    ///< queue of the next task of another thread
+    bool                        m_stop;
+};
+
+
+/**
+ * Class TASK_GROUP
+ * runs tasks on a THREAD_POOL and waits for them.
+ *
+ * A group can limit the number of its tasks running at the same time, e.g. for tasks
+ * waiting for a network server; the other tasks are held by the group until a running
+ * task finishes.  Groups can be nested: a task can create a group and wait for it.
+ *
+ * The first exception thrown by a task of the group is rethrown by Wait().
+ */
+class TASK_GROUP
+{
+public:
+    /**
+     * Constructor
+     * @param aMaxConcurrency is the maximum number of tasks of the group running at
+     *                        the same time, 0 for no limit.
+     * @param aPool is the pool running the tasks.
+     */
+    TASK_GROUP( unsigned aMaxConcurrency = 0, THREAD_POOL& aPool = THREAD_POOL::GetInstance() );
+
+    /// Waits for the tasks of the group, ignoring their errors
+    ~TASK_GROUP();
+
+    /**
+     * Function Add
+     * adds a task to the group, and queues it on the pool if the group allows it.
+     */
+    void Add( const THREAD_POOL::TASK& aTask );
+
+    /**
+     * Function Wait
+     * waits for all the tasks of the group to finish.  The calling thread runs tasks of
+     * the pool meanwhile.
+     * @throw the first exception thrown by a task of the group.
+     */
+    void Wait();
+
+private:
+    /// Copying a group is not supported
+    TASK_GROUP( const TASK_GROUP& );
+    TASK_GROUP& operator=( const TASK_GROUP& );
+
+    /// Runs a task of the group on the pool, and the held tasks after it
+    void run( THREAD_POOL::TASK aTask );
+
+    THREAD_POOL&                    m_pool;
+    unsigned                        m_maxConcurrency;
+
+    boost::mutex                    m_lock;         ///< protects the members below
+    boost::condition_variable       m_finished;
+    std::deque<THREAD_POOL::TASK>   m_heldTasks;    ///< tasks waiting for a running one
+    unsigned                        m_runningCount; ///< tasks queued on the pool or running
+    std::exception_ptr              m_error;
+};
+
+#endif  // THREAD_POOL_H_
@@ -469,6 +469,17 @@ public:
     /// The reverse operation of removeTriangle
     void ReverseSplitTriangle( EDGE_PTR& aEdge );
 
+    // Functions for updating an existing Delaunay triangulation
+
+    /// Inserts a node and swaps edges to keep the triangulation Delaunay.
+    /// Returns false, leaving the triangulation unchanged, if the node is not strictly inside
+    /// the triangulation boundary.
+    bool InsertNode( const NODE_PTR& aNode );
+
+    /// Removes the source node of a CCW half-edge and swaps edges to keep the triangulation
+    /// Delaunay.
+    void RemoveNode( const EDGE_PTR& aEdge );
+
     /// Creates an arbitrary CCW dart
     DART CreateDart();
 
@@ -208,6 +208,7 @@ public:
 
     bool m_show_microwave_tools;
     bool m_show_layer_manager_tools;
+    bool m_saveBoardSnapshot;               // write a binary snapshot of the board when saving it
 
     virtual ~PCB_EDIT_FRAME();
 
@@ -1415,7 +1416,9 @@ public:
      * The old fillings are removed
      * @param aActiveWindow = the current active window, if a progress bar is shown
      *                      = NULL to do not display a progress bar
-     * @param aVerbose = true to show error messages
+     * @param aVerbose = true to show error messages, false to stop at the first zone
+     *                 which cannot be filled
+     * @return error level (0 = no error), also when the fill is aborted by the user
      */
     int Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose = true );
 
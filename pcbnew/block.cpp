@@ -627,7 +627,7 @@ void PCB_EDIT_FRAME::Block_Delete()
         {
             MODULE* module = (MODULE*) item;
             module->ClearFlags();
-            module->UnLink();
+            m_Pcb->Remove( module );
             m_Pcb->m_Status_Pcb = 0;
         }
         break;
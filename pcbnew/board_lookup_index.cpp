@@ -0,0 +1,262 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file board_lookup_index.cpp
+ */
+
+#include <fctsys.h>
+#include <convert_to_biu.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+
+#include <board_lookup_index.h>
+
+
+/// Size of the cells of the pad grid, most pads are in one to four cells
+static const int PAD_CELL_SIZE = Millimeter2iu( 1.0 );
+
+/// Pads covering more cells are kept out of the grid
+static const int MAX_PAD_CELLS = 16;
+
+
+/// Returns the index of the cell containing a coordinate, rounded down for negative ones
+static int cellIndex( int aCoord )
+{
+    return aCoord >= 0 ? aCoord / PAD_CELL_SIZE : -( ( -aCoord - 1 ) / PAD_CELL_SIZE ) - 1;
+}
+
+
+BOARD_LOOKUP_INDEX::BOARD_LOOKUP_INDEX() :
+    m_padsValid( false )
+{
+    ResetCounts();
+}
+
+
+void BOARD_LOOKUP_INDEX::AddModule( MODULE* aModule )
+{
+    // Added again without being removed (e.g. by an undo): the keys must not be duplicated
+    if( HasModule( aModule ) )
+    {
+        UpdateModule( aModule );
+        m_padsValid = false;
+        return;
+    }
+
+    MODULE_KEYS& keys = m_moduleKeys[aModule];
+
+    keys.m_reference = aModule->GetReference();
+    keys.m_path = aModule->GetPath().Lower();
+
+    m_byReference.insert( std::make_pair( keys.m_reference, aModule ) );
+    m_byPath.insert( std::make_pair( keys.m_path, aModule ) );
+
+    m_padsValid = false;
+}
+
+
+void BOARD_LOOKUP_INDEX::eraseModule( MODULE_MAP& aMap, const wxString& aKey,
+                                      const MODULE* aModule )
+{
+    std::pair<MODULE_MAP::iterator, MODULE_MAP::iterator> range = aMap.equal_range( aKey );
+
+    for( MODULE_MAP::iterator it = range.first; it != range.second; ++it )
+    {
+        if( it->second == aModule )
+        {
+            aMap.erase( it );
+            return;
+        }
+    }
+}
+
+
+void BOARD_LOOKUP_INDEX::RemoveModule( const MODULE* aModule )
+{
+    std::unordered_map<const MODULE*, MODULE_KEYS>::iterator it = m_moduleKeys.find( aModule );
+
+    if( it != m_moduleKeys.end() )
+    {
+        eraseModule( m_byReference, it->second.m_reference, aModule );
+        eraseModule( m_byPath, it->second.m_path, aModule );
+        m_moduleKeys.erase( it );
+    }
+
+    m_padsValid = false;
+}
+
+
+void BOARD_LOOKUP_INDEX::UpdateModule( MODULE* aModule )
+{
+    std::unordered_map<const MODULE*, MODULE_KEYS>::iterator it = m_moduleKeys.find( aModule );
+
+    // Not on the board (yet)
+    if( it == m_moduleKeys.end() )
+        return;
+
+    MODULE_KEYS& keys = it->second;
+
+    if( keys.m_reference != aModule->GetReference() )
+    {
+        eraseModule( m_byReference, keys.m_reference, aModule );
+        keys.m_reference = aModule->GetReference();
+        m_byReference.insert( std::make_pair( keys.m_reference, aModule ) );
+    }
+
+    wxString path = aModule->GetPath().Lower();
+
+    if( keys.m_path != path )
+    {
+        eraseModule( m_byPath, keys.m_path, aModule );
+        keys.m_path = path;
+        m_byPath.insert( std::make_pair( keys.m_path, aModule ) );
+    }
+}
+
+
+void BOARD_LOOKUP_INDEX::Clear()
+{
+    m_byReference.clear();
+    m_byPath.clear();
+    m_moduleKeys.clear();
+    m_padCells.clear();
+    m_bigPads.clear();
+    m_padsValid = false;
+}
+
+
+MODULE* BOARD_LOOKUP_INDEX::FindModule( const wxString& aKey, bool aByPath,
+                                        bool& aAmbiguous ) const
+{
+    const MODULE_MAP& map = aByPath ? m_byPath : m_byReference;
+    std::pair<MODULE_MAP::const_iterator, MODULE_MAP::const_iterator> range =
+            map.equal_range( aByPath ? aKey.Lower() : aKey );
+
+    aAmbiguous = false;
+
+    if( range.first == range.second )
+        return NULL;
+
+    MODULE_MAP::const_iterator next = range.first;
+
+    if( ++next != range.second )
+    {
+        aAmbiguous = true;
+        return NULL;
+    }
+
+    return range.first->second;
+}
+
+
+void BOARD_LOOKUP_INDEX::buildPads( const BOARD* aBoard )
+{
+    m_padCells.clear();
+    m_bigPads.clear();
+
+    unsigned moduleRank = 0;
+
+    for( MODULE* module = aBoard->m_Modules;  module;  module = module->Next(), ++moduleRank )
+    {
+        unsigned padRank = 0;
+
+        for( D_PAD* pad = module->Pads();  pad;  pad = pad->Next(), ++padRank )
+        {
+            PAD_ENTRY   entry = { pad, moduleRank, padRank };
+
+            // The square containing the bounding circle of D_PAD::HitTest()
+            wxPoint     center = pad->ShapePos();
+            int         radius = pad->GetBoundingRadius();
+            int         xmin = cellIndex( center.x - radius );
+            int         xmax = cellIndex( center.x + radius );
+            int         ymin = cellIndex( center.y - radius );
+            int         ymax = cellIndex( center.y + radius );
+
+            if( ( xmax - xmin + 1 ) * ( ymax - ymin + 1 ) > MAX_PAD_CELLS )
+            {
+                m_bigPads.push_back( entry );
+                continue;
+            }
+
+            for( int x = xmin;  x <= xmax;  ++x )
+            {
+                for( int y = ymin;  y <= ymax;  ++y )
+                    m_padCells[cellKey( x, y )].push_back( entry );
+            }
+        }
+    }
+
+    m_padsValid = true;
+}
+
+
+D_PAD* BOARD_LOOKUP_INDEX::FindPad( const BOARD* aBoard, const wxPoint& aPosition,
+                                    LSET aLayerMask )
+{
+    if( !m_padsValid )
+        buildPads( aBoard );
+
+    const PAD_ENTRY* best = NULL;
+
+    PAD_GRID::const_iterator cell =
+            m_padCells.find( cellKey( cellIndex( aPosition.x ), cellIndex( aPosition.y ) ) );
+
+    // Keep the hit pad which comes first in the board lists
+    auto test = [&]( const PAD_ENTRY& aEntry )
+    {
+        if( best && ( best->m_moduleRank < aEntry.m_moduleRank ||
+                      ( best->m_moduleRank == aEntry.m_moduleRank &&
+                        best->m_padRank < aEntry.m_padRank ) ) )
+            return;
+
+        if( !( aEntry.m_pad->GetLayerSet() & aLayerMask ).any() )
+            return;
+
+        if( aEntry.m_pad->HitTest( aPosition ) )
+            best = &aEntry;
+    };
+
+    if( cell != m_padCells.end() )
+    {
+        for( const PAD_ENTRY& entry : cell->second )
+            test( entry );
+    }
+
+    for( const PAD_ENTRY& entry : m_bigPads )
+        test( entry );
+
+    return best ? best->m_pad : NULL;
+}
+
+
+void BOARD_LOOKUP_INDEX::ResetCounts()
+{
+    for( int ii = 0; ii < BOARD_LOOKUP_COUNT; ++ii )
+    {
+        m_counts[ii][0] = 0;
+        m_counts[ii][1] = 0;
+    }
+}
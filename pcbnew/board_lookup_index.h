@@ -0,0 +1,156 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file board_lookup_index.h
+ * @brief Hash indices of the footprints and pads of a board.
+ */
+
+#ifndef BOARD_LOOKUP_INDEX_H_
+#define BOARD_LOOKUP_INDEX_H_
+
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+#include <hashtables.h>
+#include <class_board.h>
+
+
+/**
+ * Class BOARD_LOOKUP_INDEX
+ * indexes the footprints of a #BOARD by reference and by path (the time stamp searched by
+ * BOARD::FindModule()), and its pads by position, so the lookups of the board do not walk
+ * its lists.
+ *
+ * The footprint keys are kept in sync by BOARD::Add() and Remove(), and by the changes of
+ * reference and path (see BOARD::ModuleKeysChanged()): footprints must not be unlinked
+ * from the board list directly.  The pad index is dropped by any change of the footprints
+ * of the board or of their pads, and rebuilt by the next pad lookup.  Pads of footprints
+ * which are not on the board (being loaded, or used as temporary shapes by the DRC and the
+ * zone filling threads) do not drop it.
+ *
+ * The index also counts the lookups of the board, see BOARD::GetLookupCount().
+ */
+class BOARD_LOOKUP_INDEX
+{
+public:
+    BOARD_LOOKUP_INDEX();
+
+    /// Indexes a footprint added to the board, or updates its keys if it is already indexed
+    void AddModule( MODULE* aModule );
+
+    /// Forgets a footprint removed from the board
+    void RemoveModule( const MODULE* aModule );
+
+    /// Indexes a footprint again, after a change of its reference or path
+    void UpdateModule( MODULE* aModule );
+
+    /// Forgets all the footprints and pads
+    void Clear();
+
+    /// Returns true if \a aModule has been added to the board (and not removed since)
+    bool HasModule( const MODULE* aModule ) const
+    {
+        return m_moduleKeys.count( aModule ) != 0;
+    }
+
+    /**
+     * Function FindModule
+     * @param aKey is the reference, or the path if \a aByPath is true (case insensitive).
+     * @param aAmbiguous is set to true if several footprints have the key: the index does
+     *                   not know the order of the board list, the caller must scan it.
+     * @return the footprint with the key, or NULL if none (or several) have it.
+     */
+    MODULE* FindModule( const wxString& aKey, bool aByPath, bool& aAmbiguous ) const;
+
+    /// Drops the pad index after a change of the pads of the board
+    void InvalidatePads()
+    {
+        m_padsValid = false;
+    }
+
+    /**
+     * Function FindPad
+     * @return the pad of \a aBoard which is the same as BOARD::GetPad( aPosition, aLayerMask )
+     *         used to find by scanning all the footprints: the first pad of the first
+     *         footprint containing \a aPosition on one of the layers of \a aLayerMask.
+     */
+    D_PAD* FindPad( const BOARD* aBoard, const wxPoint& aPosition, LSET aLayerMask );
+
+    /// Counts a lookup answered by the index, or by a scan of the board lists
+    void Count( BOARD_LOOKUP_T aLookup, bool aScan ) const
+    {
+        ++m_counts[aLookup][aScan];
+    }
+
+    unsigned GetCount( BOARD_LOOKUP_T aLookup, bool aScan ) const
+    {
+        return m_counts[aLookup][aScan];
+    }
+
+    void ResetCounts();
+
+private:
+    typedef std::unordered_multimap<wxString, MODULE*, WXSTRING_HASH>   MODULE_MAP;
+
+    /// The keys a footprint is stored with, to remove it after they change
+    struct MODULE_KEYS
+    {
+        wxString    m_reference;
+        wxString    m_path;         ///< lower case
+    };
+
+    /// A pad in a grid cell, with its rank in the board lists at the time of indexing
+    struct PAD_ENTRY
+    {
+        D_PAD*      m_pad;
+        unsigned    m_moduleRank;
+        unsigned    m_padRank;
+    };
+
+    typedef std::unordered_map<long long, std::vector<PAD_ENTRY> >  PAD_GRID;
+
+    static void eraseModule( MODULE_MAP& aMap, const wxString& aKey, const MODULE* aModule );
+
+    /// Returns the key of the grid cell of a coordinate
+    static long long cellKey( int aCellX, int aCellY )
+    {
+        return ( (long long) aCellX << 32 ) | (unsigned) aCellY;
+    }
+
+    /// Fills the pad grid with the pads of aBoard
+    void buildPads( const BOARD* aBoard );
+
+    MODULE_MAP      m_byReference;
+    MODULE_MAP      m_byPath;
+    std::unordered_map<const MODULE*, MODULE_KEYS>  m_moduleKeys;
+
+    PAD_GRID                m_padCells;
+    std::vector<PAD_ENTRY>  m_bigPads;      ///< pads spanning too many cells, always tested
+    std::atomic<bool>       m_padsValid;
+
+    mutable std::atomic<unsigned>   m_counts[BOARD_LOOKUP_COUNT][2];
+};
+
+#endif  // BOARD_LOOKUP_INDEX_H_
@@ -45,6 +45,7 @@
 #include <reporter.h>
 
 #include <board_netlist_updater.h>
+#include <netlist_lookup.h>
 
 #include <wxPcbStruct.h>
 
@@ -77,13 +78,17 @@ void BOARD_NETLIST_UPDATER::pushUndo( BOARD_ITEM* aItem, UNDO_REDO_T aCommandTyp
 
     if( aCommandType == UR_CHANGED )
     {
-        if( m_undoList->FindItem ( aItem ) >= 0 ) // add only once
+        if( m_undoItems.count( aItem ) )   // add only once
+        {
+            delete aCopy;
             return;
+        }
 
         picker.SetLink( aCopy ? aCopy : aItem->Clone() );
     }
 
     m_undoList->PushItem( picker );
+    m_undoItems.insert( aItem );
 }
 
 wxPoint BOARD_NETLIST_UPDATER::estimateComponentInsertionPosition()
@@ -213,6 +218,7 @@ MODULE* BOARD_NETLIST_UPDATER::replaceComponent( NETLIST& aNetlist, MODULE *aPcb
                 newFootprint->SetPath( aPcbComponent->GetPath() );
 
             aPcbComponent->CopyNetlistSettings( newFootprint, false );
+            m_lookup->RemoveModule( aPcbComponent );
             m_board->Remove( aPcbComponent );
             m_board->Add( newFootprint, ADD_APPEND );
 
@@ -331,11 +337,18 @@ bool BOARD_NETLIST_UPDATER::updateComponentPadConnections( MODULE *aPcbComponent
 
     bool changed = false;
     MODULE* copy = (MODULE*) aPcbComponent->Clone();
+    NETLIST_LOOKUP::PIN_MAP pins;
+
+    NETLIST_LOOKUP::MapPins( aNewComponent, pins );
 
     // At this point, the component footprint is updated.  Now update the nets.
     for( D_PAD *pad = aPcbComponent->Pads(); pad; pad = pad->Next() )
     {
-        COMPONENT_NET net = aNewComponent->GetNet( pad->GetPadName() );
+        NETLIST_LOOKUP::PIN_MAP::const_iterator pin = pins.find( pad->GetPadName() );
+        COMPONENT_NET net;
+
+        if( pin != pins.end() )
+            net = *pin->second;
 
         if( !net.IsValid() )                // New footprint pad has no net.
         {
@@ -440,10 +453,7 @@ bool BOARD_NETLIST_UPDATER::deleteUnusedComponents( NETLIST& aNetlist )
         if( module->IsLocked() )
             continue;
 
-        if( m_lookupByTimestamp )
-            component = aNetlist.GetComponentByTimeStamp( module->GetPath() );
-        else
-            component = aNetlist.GetComponentByReference( module->GetReference() );
+        component = m_lookup->FindComponent( module, m_lookupByTimestamp );
 
         if( component == NULL )
         {
@@ -459,6 +469,7 @@ bool BOARD_NETLIST_UPDATER::deleteUnusedComponents( NETLIST& aNetlist )
             if( !m_isDryRun )
             {
                 pushUndo( module, UR_DELETED );
+                m_lookup->RemoveModule( module );
                 m_board->Remove( module );
             }
         }
@@ -568,22 +579,28 @@ bool BOARD_NETLIST_UPDATER::testConnectivity( NETLIST& aNetlist )
 
     wxString msg;
     wxString padname;
+    NETLIST_LOOKUP::PAD_NAMES padNames;
+
+    // The references have been updated, index the footprints again
+    NETLIST_LOOKUP lookup( m_board, aNetlist );
 
     for( int i = 0; i < (int) aNetlist.GetCount(); i++ )
     {
         const COMPONENT* component = aNetlist.GetComponent( i );
-        MODULE* footprint = m_board->FindModuleByReference( component->GetReference() );
+        MODULE* footprint = lookup.FindModule( component->GetReference(), false );
 
         if( footprint == NULL )    // It can be missing in partial designs
             continue;
 
+        NETLIST_LOOKUP::MapPadNames( footprint, padNames );
+
         // Explore all pins/pads in component
         for( unsigned jj = 0; jj < component->GetNetCount(); jj++ )
         {
             COMPONENT_NET net = component->GetNet( jj );
             padname = net.GetPinName();
 
-            if( footprint->FindPadByName( padname ) )
+            if( padNames.count( padname.Lower() ) )
                 continue;   // OK, pad found
 
             // not found: bad footprint, report error
@@ -625,10 +642,13 @@ bool BOARD_NETLIST_UPDATER::UpdateNetlist( NETLIST& aNetlist )
     m_errorCount = 0;
     m_warningCount = 0;
 
+    m_lookup.reset( new NETLIST_LOOKUP( m_board, aNetlist ) );
+
+    // The ratsnest is rebuilt once, after all the changes
+    RATSNEST_UPDATES_OFF ratsnestUpdatesOff( m_board, !m_isDryRun );
+
     if( !m_isDryRun )
-    {
         m_board->SetStatus( 0 );
-    }
 
 
     for( int i = 0; i < (int) aNetlist.GetCount();  i++ )
@@ -644,9 +664,9 @@ bool BOARD_NETLIST_UPDATER::UpdateNetlist( NETLIST& aNetlist )
         m_reporter->Report( msg, REPORTER::RPT_INFO );
 
         if( aNetlist.IsFindByTimeStamp() )
-            footprint = m_board->FindModule( component->GetTimeStamp(), true );
+            footprint = m_lookup->FindModule( component->GetTimeStamp(), true );
         else
-            footprint = m_board->FindModule( component->GetReference() );
+            footprint = m_lookup->FindModule( component->GetReference(), false );
 
         if( footprint )        // An existing footprint.
         {
@@ -662,6 +682,10 @@ bool BOARD_NETLIST_UPDATER::UpdateNetlist( NETLIST& aNetlist )
         if( footprint )
         {
             updateComponentParameters( footprint, component );
+
+            // Index a new footprint with its final reference and path
+            m_lookup->AddModule( footprint );
+
             updateComponentPadConnections( footprint, component );
         }
     }
@@ -682,6 +706,7 @@ bool BOARD_NETLIST_UPDATER::UpdateNetlist( NETLIST& aNetlist )
         m_frame->SaveCopyInUndoList( *m_undoList, UR_UNSPECIFIED, wxPoint(0, 0) );
         m_frame->OnModify();
 
+        ratsnestUpdatesOff.Restore();
         m_frame->Compile_Ratsnest( NULL, true );
         m_board->GetRatsnest()->ProcessBoard();
 
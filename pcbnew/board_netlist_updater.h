@@ -41,6 +41,10 @@ class COMPONENT;
 class MODULE;
 class PICKED_ITEMS_LIST;
 class PCB_EDIT_FRAME;
+class NETLIST_LOOKUP;
+
+#include <memory>
+#include <unordered_set>
 
 #include <class_undoredo_container.h>
 
@@ -68,6 +72,8 @@ class PCB_EDIT_FRAME;
  * - After all of the footprints have been added, updated, and net names properly set,
  *   any extra unlock footprints are removed from the #BOARD.
  *
+ * Footprints, components and pins are matched with the hash tables of a #NETLIST_LOOKUP,
+ * and the ratsnest is rebuilt once at the end of the update.
  */
 class BOARD_NETLIST_UPDATER
 {
@@ -146,6 +152,8 @@ private:
 	bool testConnectivity( NETLIST& aNetlist );
 
 	PICKED_ITEMS_LIST *m_undoList;
+	std::unordered_set<const BOARD_ITEM*> m_undoItems;   ///< the items of m_undoList
+	std::unique_ptr<NETLIST_LOOKUP> m_lookup;
 	PCB_EDIT_FRAME *m_frame;
 	BOARD *m_board;
 	REPORTER *m_reporter;
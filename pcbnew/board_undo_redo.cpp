@@ -326,6 +326,9 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( BOARD_ITEM*    aItem,
             return;
     }
 
+    // The item is about to be modified: it has to be tested by the next incremental DRC
+    GetBoard()->MarkItemChanged( aItem );
+
     PICKED_ITEMS_LIST* commandToUndo = new PICKED_ITEMS_LIST();
 
     commandToUndo->m_TransformPoint = aTransformPoint;
@@ -439,6 +442,8 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( const PICKED_ITEMS_LIST& aItemsList,
 
         wxASSERT( item );
 
+        GetBoard()->MarkItemChanged( item );
+
         switch( command )
         {
         case UR_CHANGED:
@@ -540,6 +545,10 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
 
         item->ClearFlags();
 
+        // Record the item (and for modules, the pads which are going to be swapped
+        // out) as changed for the next incremental DRC
+        GetBoard()->MarkItemChanged( item );
+
         // see if we must rebuild ratsnets and pointers lists
         switch( item->Type() )
         {
@@ -656,6 +665,10 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
         }
         break;
         }
+
+        // After SwapData() a module has new pads, they have to be recorded too
+        if( item->Type() == PCB_MODULE_T )
+            GetBoard()->MarkItemChanged( item );
     }
 
     if( not_found )
@@ -39,10 +39,13 @@
 #include <wxBasePcbFrame.h>
 #include <msgpanel.h>
 #include <pcb_netlist.h>
+#include <netlist_lookup.h>
+#include <board_lookup_index.h>
 #include <reporter.h>
 #include <base_units.h>
 #include <ratsnest_data.h>
 #include <ratsnest_viewitem.h>
+#include <connectivity_graph.h>
 #include <worksheet_viewitem.h>
 
 #include <pcbnew.h>
@@ -107,6 +110,11 @@ BOARD::BOARD() :
 
     // Initialize ratsnest
     m_ratsnest = new RN_DATA( this );
+    m_ratsnestUpdates = true;
+    m_recordChangedItems = false;
+
+    m_connectivity = new CONNECTIVITY_GRAPH();
+    m_lookupIndex = new BOARD_LOOKUP_INDEX();
 }
 
 
@@ -119,6 +127,8 @@ BOARD::~BOARD()
     }
 
     delete m_ratsnest;
+    delete m_connectivity;
+    delete m_lookupIndex;
 
     m_FullRatsnest.clear();
     m_LocalRatsnest.clear();
@@ -916,6 +926,7 @@ void BOARD::Add( BOARD_ITEM* aBoardItem, int aControl )
             m_Modules.PushFront( (MODULE*) aBoardItem );
 
         aBoardItem->SetParent( this );
+        m_lookupIndex->AddModule( (MODULE*) aBoardItem );
 
         // Because the list of pads has changed, reset the status
         // This indicate the list of pad and nets must be recalculated before use
@@ -948,7 +959,11 @@ void BOARD::Add( BOARD_ITEM* aBoardItem, int aControl )
         break;
     }
 
-    m_ratsnest->Add( aBoardItem );
+    if( aBoardItem->Type() != PCB_MARKER_T && aBoardItem->Type() != PCB_NETINFO_T )
+        MarkItemChanged( aBoardItem );
+
+    if( m_ratsnestUpdates )
+        m_ratsnest->Add( aBoardItem );
 }
 
 
@@ -993,6 +1008,7 @@ BOARD_ITEM* BOARD::Remove( BOARD_ITEM* aBoardItem )
 
     case PCB_MODULE_T:
         m_Modules.Remove( (MODULE*) aBoardItem );
+        m_lookupIndex->RemoveModule( (MODULE*) aBoardItem );
         break;
 
     case PCB_TRACE_T:
@@ -1017,12 +1033,74 @@ BOARD_ITEM* BOARD::Remove( BOARD_ITEM* aBoardItem )
         wxFAIL_MSG( wxT( "BOARD::Remove() needs more ::Type() support" ) );
     }
 
-    m_ratsnest->Remove( aBoardItem );
+    if( aBoardItem->Type() != PCB_MARKER_T && aBoardItem->Type() != PCB_NETINFO_T )
+        MarkItemChanged( aBoardItem );
+
+    // The item can be deleted, the graph must not keep it
+    m_connectivity->Remove( aBoardItem );
+
+    if( m_ratsnestUpdates )
+        m_ratsnest->Remove( aBoardItem );
 
     return aBoardItem;
 }
 
 
+void BOARD::MarkItemChanged( const BOARD_ITEM* aItem )
+{
+    // The item is about to be moved, or deleted
+    if( aItem->Type() == PCB_MODULE_T || aItem->Type() == PCB_PAD_T )
+        m_lookupIndex->InvalidatePads();
+
+    if( !m_recordChangedItems )
+        return;
+
+    m_changedItems.insert( aItem );
+
+    if( aItem->Type() == PCB_MODULE_T )
+    {
+        const MODULE* module = static_cast<const MODULE*>( aItem );
+
+        for( const D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+            m_changedItems.insert( pad );
+    }
+}
+
+
+unsigned BOARD::GetLookupCount( BOARD_LOOKUP_T aLookup, bool aScans ) const
+{
+    return m_lookupIndex->GetCount( aLookup, aScans );
+}
+
+
+void BOARD::ResetLookupCounts()
+{
+    m_lookupIndex->ResetCounts();
+}
+
+
+void BOARD::ModuleKeysChanged( MODULE* aModule )
+{
+    m_lookupIndex->UpdateModule( aModule );
+}
+
+
+void BOARD::PadsChanged( const MODULE* aModule )
+{
+    // Footprints being loaded and temporary ones can be changed by other threads, but they
+    // are not in the index
+    if( m_lookupIndex->HasModule( aModule ) )
+        m_lookupIndex->InvalidatePads();
+}
+
+
+void BOARD::DeleteAllModules()
+{
+    m_lookupIndex->Clear();
+    m_Modules.DeleteAll();
+}
+
+
 void BOARD::DeleteMARKERs()
 {
     // the vector does not know how to delete the MARKER_PCB, it holds pointers
@@ -1384,13 +1462,22 @@ NETINFO_ITEM* BOARD::FindNet( int aNetcode ) const
 
 NETINFO_ITEM* BOARD::FindNet( const wxString& aNetname ) const
 {
+    m_lookupIndex->Count( LOOKUP_NET_NAME, false );
+
     return m_NetInfo.GetNetItem( aNetname );
 }
 
 
 MODULE* BOARD::FindModuleByReference( const wxString& aReference ) const
 {
-    MODULE* found = nullptr;
+    bool    ambiguous;
+    MODULE* found = m_lookupIndex->FindModule( aReference, false, ambiguous );
+
+    m_lookupIndex->Count( LOOKUP_REFERENCE, ambiguous );
+
+    // Only a duplicated reference needs the scan, to find the first footprint having it
+    if( !ambiguous )
+        return found;
 
     // search only for MODULES
     static const KICAD_T scanTypes[] = { PCB_MODULE_T, EOT };
@@ -1420,6 +1507,14 @@ MODULE* BOARD::FindModule( const wxString& aRefOrTimeStamp, bool aSearchByTimeSt
 {
     if( aSearchByTimeStamp )
     {
+        bool    ambiguous;
+        MODULE* found = m_lookupIndex->FindModule( aRefOrTimeStamp, true, ambiguous );
+
+        m_lookupIndex->Count( LOOKUP_TIME_STAMP, ambiguous );
+
+        if( !ambiguous )
+            return found;
+
         for( MODULE* module = m_Modules;  module;  module = module->Next() )
         {
             if( aRefOrTimeStamp.CmpNoCase( module->GetPath() ) == 0 )
@@ -1597,15 +1692,9 @@ D_PAD* BOARD::GetPad( const wxPoint& aPosition, LSET aLayerSet )
     if( !aLayerSet.any() )
         aLayerSet = LSET::AllCuMask();
 
-    for( MODULE* module = m_Modules;  module;  module = module->Next() )
-    {
-        D_PAD* pad = module->GetPad( aPosition, aLayerSet );
+    m_lookupIndex->Count( LOOKUP_PAD_POSITION, false );
 
-        if( pad )
-            return pad;
-    }
-
-    return NULL;
+    return m_lookupIndex->FindPad( this, aPosition, aLayerSet );
 }
 
 
@@ -1615,20 +1704,16 @@ D_PAD* BOARD::GetPad( TRACK* aTrace, ENDPOINT_T aEndPoint )
 
     LSET lset( aTrace->GetLayer() );
 
-    for( MODULE* module = m_Modules;  module;  module = module->Next() )
-    {
-        D_PAD*  pad = module->GetPad( aPosition, lset );
+    m_lookupIndex->Count( LOOKUP_PAD_POSITION, false );
 
-        if( pad )
-            return pad;
-    }
-
-    return NULL;
+    return m_lookupIndex->FindPad( this, aPosition, lset );
 }
 
 
 D_PAD* BOARD::GetPadFast( const wxPoint& aPosition, LSET aLayerSet )
 {
+    m_lookupIndex->Count( LOOKUP_PAD_POSITION, true );
+
     for( unsigned i=0; i<GetPadCount();  ++i )
     {
         D_PAD* pad = m_NetInfo.GetPad(i);
@@ -2397,6 +2482,14 @@ void BOARD::ReplaceNetlist( NETLIST& aNetlist, bool aDeleteSinglePadNets,
 
     m_Status_Pcb = 0;
 
+    // The footprints and the pins are looked for in hash tables: the linear searches
+    // of FindModule() and COMPONENT::GetNet() are too slow for big designs.
+    NETLIST_LOOKUP          lookup( this, aNetlist );
+    NETLIST_LOOKUP::PIN_MAP pins;
+
+    // The caller rebuilds the ratsnest once all the footprints are updated
+    RATSNEST_UPDATES_OFF ratsnestUpdatesOff( this, !aNetlist.IsDryRun() );
+
     for( i = 0;  i < aNetlist.GetCount();  i++ )
     {
         COMPONENT* component = aNetlist.GetComponent( i );
@@ -2413,9 +2506,9 @@ void BOARD::ReplaceNetlist( NETLIST& aNetlist, bool aDeleteSinglePadNets,
         }
 
         if( aNetlist.IsFindByTimeStamp() )
-            footprint = FindModule( aNetlist.GetComponent( i )->GetTimeStamp(), true );
+            footprint = lookup.FindModule( component->GetTimeStamp(), true );
         else
-            footprint = FindModule( aNetlist.GetComponent( i )->GetReference() );
+            footprint = lookup.FindModule( component->GetReference(), false );
 
         if( footprint == NULL )        // A new footprint.
         {
@@ -2503,6 +2596,7 @@ void BOARD::ReplaceNetlist( NETLIST& aNetlist, bool aDeleteSinglePadNets,
                         // will be used
                         footprint->CopyNetlistSettings( newFootprint, false );
 
+                        lookup.RemoveModule( footprint );
                         Remove( footprint );
                         Add( newFootprint, ADD_APPEND );
                         footprint = newFootprint;
@@ -2563,10 +2657,20 @@ void BOARD::ReplaceNetlist( NETLIST& aNetlist, bool aDeleteSinglePadNets,
         if( footprint == NULL )
             continue;
 
+        // Index a new footprint with its final reference and path.  Nothing changes for an
+        // existing one, which keeps its key in the lookup mode.
+        lookup.AddModule( footprint );
+
+        NETLIST_LOOKUP::MapPins( component, pins );
+
         // At this point, the component footprint is updated.  Now update the nets.
         for( D_PAD* pad = footprint->Pads();  pad;  pad = pad->Next() )
         {
-            COMPONENT_NET net = component->GetNet( pad->GetPadName() );
+            NETLIST_LOOKUP::PIN_MAP::const_iterator pin = pins.find( pad->GetPadName() );
+            COMPONENT_NET net;
+
+            if( pin != pins.end() )
+                net = *pin->second;
 
             if( !net.IsValid() )                // Footprint pad had no net.
             {
@@ -2628,10 +2732,7 @@ void BOARD::ReplaceNetlist( NETLIST& aNetlist, bool aDeleteSinglePadNets,
             if( module->IsLocked() )
                 continue;
 
-            if( aNetlist.IsFindByTimeStamp() )
-                component = aNetlist.GetComponentByTimeStamp( module->GetPath() );
-            else
-                component = aNetlist.GetComponentByReference( module->GetReference() );
+            component = lookup.FindComponent( module, aNetlist.IsFindByTimeStamp() );
 
             if( component == NULL )
             {
@@ -2644,7 +2745,11 @@ void BOARD::ReplaceNetlist( NETLIST& aNetlist, bool aDeleteSinglePadNets,
                 }
 
                 if( !aNetlist.IsDryRun() )
-                    module->DeleteStructure();
+                {
+                    lookup.RemoveModule( module );
+                    Remove( module );
+                    delete module;
+                }
             }
         }
     }
@@ -2734,21 +2839,28 @@ void BOARD::ReplaceNetlist( NETLIST& aNetlist, bool aDeleteSinglePadNets,
     if( aReporter )
     {
         wxString padname;
+        NETLIST_LOOKUP::PAD_NAMES padNames;
+
+        // The references have been updated, index the footprints again
+        NETLIST_LOOKUP updated( this, aNetlist );
+
         for( i = 0; i < aNetlist.GetCount(); i++ )
         {
             const COMPONENT* component = aNetlist.GetComponent( i );
-            MODULE* footprint = FindModuleByReference( component->GetReference() );
+            MODULE* footprint = updated.FindModule( component->GetReference(), false );
 
             if( footprint == NULL )    // It can be missing in partial designs
                 continue;
 
+            NETLIST_LOOKUP::MapPadNames( footprint, padNames );
+
             // Explore all pins/pads in component
             for( unsigned jj = 0; jj < component->GetNetCount(); jj++ )
             {
                 COMPONENT_NET net = component->GetNet( jj );
                 padname = net.GetPinName();
 
-                if( footprint->FindPadByName( padname ) )
+                if( padNames.count( padname.Lower() ) )
                     continue;   // OK, pad found
 
                 // not found: bad footprint, report error
@@ -2777,6 +2889,8 @@ void BOARD::ReplaceNetlist( NETLIST& aNetlist, bool aDeleteSinglePadNets,
         }
     }
 
+    ratsnestUpdatesOff.Restore();
+
     std::swap( newFootprints, *aNewFootprints );
 }
 
@@ -31,6 +31,8 @@
 #define CLASS_BOARD_H_
 
 
+#include <set>
+
 #include <dlist.h>
 
 #include <common.h>                         // PAGE_INFO
@@ -57,7 +59,23 @@ class MSG_PANEL_ITEM;
 class NETLIST;
 class REPORTER;
 class RN_DATA;
+class CONNECTIVITY_GRAPH;
 class SHAPE_POLY_SET;
+class BOARD_LOOKUP_INDEX;
+
+
+/**
+ * Enum BOARD_LOOKUP_T
+ * gives the lookups of a BOARD counted by GetLookupCount().
+ */
+enum BOARD_LOOKUP_T
+{
+    LOOKUP_REFERENCE,       ///< FindModuleByReference(), FindModule() by reference
+    LOOKUP_TIME_STAMP,      ///< FindModule() by time stamp
+    LOOKUP_PAD_POSITION,    ///< GetPad() and GetPadFast() by position
+    LOOKUP_NET_NAME,        ///< FindNet() by name
+    BOARD_LOOKUP_COUNT
+};
 
 
 /**
@@ -187,6 +205,9 @@ private:
     EDA_RECT                m_BoundingBox;
     NETINFO_LIST            m_NetInfo;              ///< net info list (name, design constraints ..
     RN_DATA*                m_ratsnest;
+    bool                    m_ratsnestUpdates;      ///< Add() and Remove() update m_ratsnest
+    CONNECTIVITY_GRAPH*     m_connectivity;         ///< clusters of connected copper items
+    BOARD_LOOKUP_INDEX*     m_lookupIndex;          ///< modules and pads by key and position
 
     BOARD_DESIGN_SETTINGS   m_designSettings;
     ZONE_SETTINGS           m_zoneSettings;
@@ -201,6 +222,13 @@ private:
     /// Number of unconnected nets in the current rats nest.
     int                     m_unconnectedNetCount;
 
+    /// Items added, removed or modified since the last call to ClearChangedItems().
+    std::set<const BOARD_ITEM*> m_changedItems;
+
+    /// false until the first full DRC: MarkItemChanged() does not record the items loaded
+    /// or edited before, which would only be tested again by the full DRC
+    bool                    m_recordChangedItems;
+
     /**
      * Function chainMarkedSegments
      * is used by MarkTrace() to set the BUSY flag of connected segments of the trace
@@ -308,6 +336,68 @@ public:
         return m_ratsnest;
     }
 
+    /**
+     * Function SetRatsnestUpdates
+     * enables or disables the update of the ratsnest by Add() and Remove().  A batch of
+     * changes, like a netlist update, disables it and rebuilds the ratsnest once with
+     * RN_DATA::ProcessBoard() when it is done.
+     */
+    void SetRatsnestUpdates( bool aEnable )
+    {
+        m_ratsnestUpdates = aEnable;
+    }
+
+    bool GetRatsnestUpdates() const
+    {
+        return m_ratsnestUpdates;
+    }
+
+    /**
+     * Function GetLookupCount
+     * returns the number of lookups of a kind since the last call to ResetLookupCounts().
+     * @param aLookup is the kind of lookup.
+     * @param aScans is false to count the lookups answered by the hash indices of the board,
+     *               true to count the ones which walked the board lists.
+     */
+    unsigned GetLookupCount( BOARD_LOOKUP_T aLookup, bool aScans ) const;
+
+    /**
+     * Function ResetLookupCounts
+     * sets the counts of GetLookupCount() to zero.
+     */
+    void ResetLookupCounts();
+
+    /**
+     * Function ModuleKeysChanged
+     * updates the index of FindModule() and FindModuleByReference() after a change of the
+     * reference or of the path of \a aModule.  Called by MODULE and TEXTE_MODULE.
+     */
+    void ModuleKeysChanged( MODULE* aModule );
+
+    /**
+     * Function PadsChanged
+     * drops the index of GetPad() after a pad of \a aModule has been added, removed, moved
+     * or reshaped, if \a aModule is on the board.  Called by MODULE and D_PAD.
+     */
+    void PadsChanged( const MODULE* aModule );
+
+    /**
+     * Function DeleteAllModules
+     * deletes all the footprints of the board, without updating the ratsnest.
+     */
+    void DeleteAllModules();
+
+    /**
+     * Function GetConnectivity()
+     * returns the clusters of copper items physically connected together.
+     * @return CONNECTIVITY_GRAPH* is updated by PCB_BASE_FRAME::TestConnections() and
+     * PCB_BASE_FRAME::TestNetConnection().
+     */
+    CONNECTIVITY_GRAPH* GetConnectivity() const
+    {
+        return m_connectivity;
+    }
+
     /**
      * Function DeleteMARKERs
      * deletes ALL MARKERS from the board.
@@ -343,6 +433,39 @@ public:
         return (int) m_markers.size();
     }
 
+    /**
+     * Function MarkItemChanged
+     * records that aItem was added, removed or is about to be modified, so the
+     * incremental DRC only has to test the changed items.
+     * The pads of a module are recorded with the module.  Nothing is recorded before the
+     * first call to ClearChangedItems().
+     * @param aItem The item which changes.
+     */
+    void MarkItemChanged( const BOARD_ITEM* aItem );
+
+    /**
+     * Function GetChangedItems
+     * @return the items recorded by MarkItemChanged() since the last call to
+     * ClearChangedItems().  This set can contain items which have been removed
+     * and deleted since, so they must only be compared to other pointers.
+     */
+    const std::set<const BOARD_ITEM*>& GetChangedItems() const
+    {
+        return m_changedItems;
+    }
+
+    /**
+     * Function ClearChangedItems
+     * forgets the items recorded by MarkItemChanged(), and starts recording the changed
+     * items if not yet done.  The DRC calls it after testing the whole board, so the
+     * items are not recorded until the incremental DRC can use them.
+     */
+    void ClearChangedItems()
+    {
+        m_changedItems.clear();
+        m_recordChangedItems = true;
+    }
+
     /**
      * Function SetAuxOrigin
      * sets the origin point used for plotting.
@@ -950,6 +1073,9 @@ public:
      * - After all of the footprints have been added, updated, and net names properly set,
      *   any extra unlock footprints are removed from the #BOARD.
      *
+     * The ratsnest is not updated by the changes: the caller rebuilds it once with
+     * RN_DATA::ProcessBoard() afterwards.
+     *
      * @param aNetlist is the new netlist to revise the contents of the #BOARD with.
      * @param aDeleteSinglePadNets if true, remove nets counting only one pad
      *                             and set net code to 0 for these pads
@@ -1193,15 +1319,6 @@ public:
     int Test_Drc_Areas_Outlines_To_Areas_Outlines( ZONE_CONTAINER* aArea_To_Examine,
                                                    bool            aCreate_Markers );
 
-    /****** function relative to ratsnest calculations: */
-
-    /**
-     * Function Test_Connection_To_Copper_Areas
-     * init .m_ZoneSubnet parameter in tracks and pads according to the connections to areas found
-     * @param aNetcode = netcode to analyze. if -1, analyze all nets
-     */
-    void Test_Connections_To_Copper_Areas( int aNetcode = -1 );
-
     /**
      * Function GetViaByPosition
      * finds the first via at \a aPosition on \a aLayer.
@@ -1413,4 +1530,51 @@ public:
     TRACK* CreateLockPoint( wxPoint& aPosition, TRACK* aSegment, PICKED_ITEMS_LIST* aList );
 };
 
+
+/**
+ * Class RATSNEST_UPDATES_OFF
+ * disables the update of the ratsnest by BOARD::Add() and BOARD::Remove() within a
+ * scope.  Its destructor restores the previous setting, even if an exception is
+ * thrown by the batch of changes.
+ */
+class RATSNEST_UPDATES_OFF
+{
+public:
+    /**
+     * Constructor
+     * @param aBoard is the board to change.
+     * @param aDisable is false to leave the setting as it is (e.g. for a dry run).
+     */
+    RATSNEST_UPDATES_OFF( BOARD* aBoard, bool aDisable = true ) :
+        m_board( aBoard ),
+        m_enabled( aBoard->GetRatsnestUpdates() ),
+        m_active( aDisable )
+    {
+        if( m_active )
+            m_board->SetRatsnestUpdates( false );
+    }
+
+    ~RATSNEST_UPDATES_OFF()
+    {
+        Restore();
+    }
+
+    /**
+     * Function Restore
+     * restores the previous setting before the end of the scope.
+     */
+    void Restore()
+    {
+        if( m_active )
+            m_board->SetRatsnestUpdates( m_enabled );
+
+        m_active = false;
+    }
+
+private:
+    BOARD*  m_board;
+    bool    m_enabled;      ///< setting before the constructor
+    bool    m_active;
+};
+
 #endif      // CLASS_BOARD_H_
@@ -86,84 +86,112 @@ wxString BOARD_ITEM::GetLayerName() const
 }
 
 
-std::string BOARD_ITEM::FormatInternalUnits( int aValue )
+/**
+ * Function formatIUPrintf
+ * is the general purpose version of BOARD_ITEM::FormatInternalUnits( char*, int ),
+ * used when the internal units are not nanometers.
+ */
+static int formatIUPrintf( char* aBuffer, int aValue )
 {
-#if 1
-
-    char    buf[50];
     int     len;
     double  mm = aValue / IU_PER_MM;
 
     if( mm != 0.0 && fabs( mm ) <= 0.0001 )
     {
-        len = sprintf( buf, "%.10f", mm );
+        len = snprintf( aBuffer, FMT_IU_BUFSIZE, "%.10f", mm );
 
-        while( --len > 0 && buf[len] == '0' )
-            buf[len] = '\0';
+        while( --len > 0 && aBuffer[len] == '0' )
+            aBuffer[len] = '\0';
 
-        if( buf[len] == '.' )
-            buf[len] = '\0';
+        if( aBuffer[len] == '.' )
+            aBuffer[len] = '\0';
         else
             ++len;
     }
     else
     {
-        len = sprintf( buf, "%.10g", mm );
+        len = snprintf( aBuffer, FMT_IU_BUFSIZE, "%.10g", mm );
     }
 
-    return std::string( buf, len );
+    return len;
+}
 
-#else
 
-    // Assume aValue is in nanometers, and that we want the result in millimeters,
-    // and that int is 32 bits wide.  Then perform an alternative algorithm.
-    // Can be used to verify that the above algorithm is correctly generating text.
-    // Convert aValue into an integer string, then insert a decimal point manually.
-    // Results are the same as above general purpose algorithm.
+int BOARD_ITEM::FormatInternalUnits( char* aBuffer, int aValue )
+{
+    if( IU_PER_MM != 1e6 )
+        return formatIUPrintf( aBuffer, aValue );
 
-    wxASSERT( sizeof(int) == 4 );
+    // aValue is in nanometers: the text in millimeters is the integer with a decimal
+    // point inserted 6 digits from the end, and the trailing zeros of the fractional
+    // part removed.  An int has at most 10 digits, so this is exactly what the %.10g
+    // and %.10f formats of formatIUPrintf() give, without their cost.
+    char*       out = aBuffer;
+    unsigned    value = aValue;
 
-    if( aValue == 0 )
-        return std::string( 1, '0' );
-    else
+    if( aValue < 0 )
     {
-        char    buf[50];
-        int     len = sprintf( buf, aValue > 0 ? "%06d" : "%07d", aValue );     // optionally pad w/leading zeros
+        *out++ = '-';
+        value = 0u - value;     // also right for INT_MIN
+    }
 
-        std::string ret( buf, len );
+    unsigned    integer  = value / 1000000;
+    unsigned    fraction = value % 1000000;
+    char        digits[10];
+    int         count = 0;
 
-        std::string::iterator it = ret.end() - 1;           // last byte
+    do
+    {
+        digits[count++] = '0' + integer % 10;
+        integer /= 10;
+    } while( integer );
+
+    while( count )
+        *out++ = digits[--count];
+
+    if( fraction )
+    {
+        count = 6;
 
-        // insert '.' at 6 positions from end, dividing by 10e6 (a million), nm => mm
-        std::string::iterator decpoint = ret.end() - 6;
+        while( fraction % 10 == 0 )
+        {
+            fraction /= 10;
+            --count;
+        }
 
-        // truncate trailing zeros, up to decimal point position
-        for(  ; *it=='0' && it >= decpoint;  --it )
-            ret.erase( it );    // does not invalidate iterators it or decpoint
+        *out++ = '.';
 
-        if( it >= decpoint )
+        for( int ii = count - 1; ii >= 0; --ii )
         {
-            ret.insert( decpoint, '.' );
-
-            // decpoint is invalidated here, after insert()
-
-#if 1       // want a leading zero when decimal point is in first position?
-            if( ret[0] == '.' )
-            {
-                // insert leading zero ahead of decimal point.
-                ret.insert( ret.begin(), '0' );
-            }
-            else if( ret[0]=='-' && ret[1]=='.' )
-            {
-                ret.insert( ret.begin() + 1, '0' );
-            }
-#endif
+            out[ii] = '0' + fraction % 10;
+            fraction /= 10;
         }
 
-        return ret;
+        out += count;
     }
 
-#endif
+    *out = '\0';
+
+    return out - aBuffer;
+}
+
+
+int BOARD_ITEM::FormatInternalUnits( char* aBuffer, const wxPoint& aPoint )
+{
+    int len = FormatInternalUnits( aBuffer, aPoint.x );
+
+    aBuffer[len++] = ' ';
+
+    return len + FormatInternalUnits( aBuffer + len, aPoint.y );
+}
+
+
+std::string BOARD_ITEM::FormatInternalUnits( int aValue )
+{
+    char    buf[FMT_IU_BUFSIZE];
+    int     len = FormatInternalUnits( buf, aValue );
+
+    return std::string( buf, len );
 }
 
 
@@ -179,13 +207,19 @@ std::string BOARD_ITEM::FormatAngle( double aAngle )
 
 std::string BOARD_ITEM::FormatInternalUnits( const wxPoint& aPoint )
 {
-    return FormatInternalUnits( aPoint.x ) + " " + FormatInternalUnits( aPoint.y );
+    char    buf[FMT_IU_BUFSIZE];
+    int     len = FormatInternalUnits( buf, aPoint );
+
+    return std::string( buf, len );
 }
 
 
 std::string BOARD_ITEM::FormatInternalUnits( const wxSize& aSize )
 {
-    return FormatInternalUnits( aSize.GetWidth() ) + " " + FormatInternalUnits( aSize.GetHeight() );
+    char    buf[FMT_IU_BUFSIZE];
+    int     len = FormatInternalUnits( buf, wxPoint( aSize.GetWidth(), aSize.GetHeight() ) );
+
+    return std::string( buf, len );
 }
 
 
@@ -98,6 +98,21 @@ public:
         return m_item;
     }
 
+    /**
+     * Function SetAuxItem
+     * sets the other item involved in the DRC error, if any.
+     * The incremental DRC uses both items to find the markers made obsolete by an edit.
+     */
+    void SetAuxItem( const BOARD_ITEM* aItem )
+    {
+        m_auxItem = aItem;
+    }
+
+    const BOARD_ITEM* GetAuxItem() const
+    {
+        return m_auxItem;
+    }
+
     bool HitTest( const wxPoint& aPosition ) const
     {
         return HitTestMarker( aPosition );
@@ -135,6 +150,9 @@ public:
 protected:
     ///> Pointer to BOARD_ITEM that causes DRC error.
     const BOARD_ITEM* m_item;
+
+    ///> Pointer to the other BOARD_ITEM involved in the DRC error, if any.
+    const BOARD_ITEM* m_auxItem;
 };
 
 #endif      //  CLASS_MARKER_PCB_H
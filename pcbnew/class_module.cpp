@@ -271,6 +271,26 @@ void MODULE::Copy( MODULE* aModule )
 
     // Ensure auxiliary data is up to date
     CalculateBoundingBox();
+
+    // The reference, the path and the pads have changed
+    BOARD* board = GetBoard();
+
+    if( board )
+    {
+        board->ModuleKeysChanged( this );
+        board->PadsChanged( this );
+    }
+}
+
+
+void MODULE::SetPath( const wxString& aPath )
+{
+    m_Path = aPath;
+
+    BOARD* board = GetBoard();
+
+    if( board )
+        board->ModuleKeysChanged( this );
 }
 
 
@@ -296,6 +316,10 @@ void MODULE::Add( BOARD_ITEM* aBoardItem, bool doAppend )
             m_Pads.PushBack( static_cast<D_PAD*>( aBoardItem ) );
         else
             m_Pads.PushFront( static_cast<D_PAD*>( aBoardItem ) );
+
+        if( GetBoard() )
+            GetBoard()->PadsChanged( this );
+
         break;
 
     default:
@@ -327,6 +351,10 @@ BOARD_ITEM* MODULE::Remove( BOARD_ITEM* aBoardItem )
         return m_Drawings.Remove( aBoardItem );
 
     case PCB_PAD_T:
+        // The pad can be deleted, it must not stay in the pad index of the board
+        if( GetBoard() )
+            GetBoard()->PadsChanged( this );
+
         return m_Pads.Remove( static_cast<D_PAD*>( aBoardItem ) );
 
     default:
@@ -177,7 +177,7 @@ public:
     void SetKeywords( const wxString& aKeywords ) { m_KeyWord = aKeywords; }
 
     const wxString& GetPath() const { return m_Path; }
-    void SetPath( const wxString& aPath ) { m_Path = aPath; }
+    void SetPath( const wxString& aPath );
 
     int GetLocalSolderMaskMargin() const { return m_LocalSolderMaskMargin; }
     void SetLocalSolderMaskMargin( int aMargin ) { m_LocalSolderMaskMargin = aMargin; }
@@ -37,6 +37,7 @@
 #include <gr_basic.h>
 #include <class_netclass.h>
 #include <class_board_item.h>
+#include <hashtables.h>
 
 
 
@@ -684,6 +685,12 @@ private:
     NETNAMES_MAP m_netNames;        ///< map of <wxString, NETINFO_ITEM*>, is NETINFO_ITEM owner
     NETCODES_MAP m_netCodes;        ///< map of <int, NETINFO_ITEM*> is NOT owner
 
+#ifndef SWIG
+    /// Hashed copy of m_netNames for GetNetItem( const wxString& ), m_netNames stays a
+    /// std::map for the python scripts.
+    std::unordered_map<wxString, NETINFO_ITEM*, WXSTRING_HASH> m_netNamesIndex;
+#endif
+
     D_PADS  m_PadsFullList;         ///< contains all pads, sorted by pad's netname.
                                     ///< can be used in ratsnest calculations.
 
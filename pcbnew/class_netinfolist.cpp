@@ -64,6 +64,7 @@ void NETINFO_LIST::clear()
 
     m_PadsFullList.clear();
     m_netNames.clear();
+    m_netNamesIndex.clear();
     m_netCodes.clear();
     m_newNetCode = 0;
 }
@@ -82,9 +83,10 @@ NETINFO_ITEM* NETINFO_LIST::GetNetItem( int aNetCode ) const
 
 NETINFO_ITEM* NETINFO_LIST::GetNetItem( const wxString& aNetName ) const
 {
-    NETNAMES_MAP::const_iterator result = m_netNames.find( aNetName );
+    std::unordered_map<wxString, NETINFO_ITEM*, WXSTRING_HASH>::const_iterator result =
+            m_netNamesIndex.find( aNetName );
 
-    if( result != m_netNames.end() )
+    if( result != m_netNamesIndex.end() )
         return (*result).second;
 
     return NULL;
@@ -93,24 +95,39 @@ NETINFO_ITEM* NETINFO_LIST::GetNetItem( const wxString& aNetName ) const
 
 void NETINFO_LIST::RemoveNet( NETINFO_ITEM* aNet )
 {
-    for( NETCODES_MAP::iterator i = m_netCodes.begin(); i != m_netCodes.end(); ++i )
+    // The net is normally stored with its code and name, the maps are scanned only if
+    // they have been changed since it was added.
+    NETCODES_MAP::iterator code = m_netCodes.find( aNet->GetNet() );
+
+    if( code == m_netCodes.end() || code->second != aNet )
     {
-        if ( i->second == aNet )
+        for( code = m_netCodes.begin(); code != m_netCodes.end(); ++code )
         {
-            m_netCodes.erase(i);
-            break;
+            if( code->second == aNet )
+                break;
         }
     }
 
-    for( NETNAMES_MAP::iterator i = m_netNames.begin(); i != m_netNames.end(); ++i )
+    if( code != m_netCodes.end() )
+        m_netCodes.erase( code );
+
+    NETNAMES_MAP::iterator name = m_netNames.find( aNet->GetNetname() );
+
+    if( name == m_netNames.end() || name->second != aNet )
     {
-        if ( i->second == aNet )
+        for( name = m_netNames.begin(); name != m_netNames.end(); ++name )
         {
-            m_netNames.erase(i);
-            break;
+            if( name->second == aNet )
+                break;
         }
     }
 
+    if( name != m_netNames.end() )
+    {
+        m_netNamesIndex.erase( name->first );
+        m_netNames.erase( name );
+    }
+
     m_newNetCode = std::min( m_newNetCode, aNet->m_NetCode - 1 );
 }
 
@@ -139,6 +156,7 @@ void NETINFO_LIST::AppendNet( NETINFO_ITEM* aNewElement )
 
     // add an entry for fast look up by a net name using a map
     m_netNames.insert( std::make_pair( aNewElement->GetNetname(), aNewElement ) );
+    m_netNamesIndex.insert( std::make_pair( aNewElement->GetNetname(), aNewElement ) );
     m_netCodes.insert( std::make_pair( aNewElement->GetNet(), aNewElement ) );
 }
 
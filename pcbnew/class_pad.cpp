@@ -267,6 +267,8 @@ void D_PAD::SetDrawCoord()
 
     RotatePoint( &m_Pos.x, &m_Pos.y, angle );
     m_Pos += module->GetPosition();
+
+    boardPadsChanged();
 }
 
 
@@ -298,6 +300,8 @@ void D_PAD::SetOrientation( double aAngle )
 {
     NORMALIZE_ANGLE_POS( aAngle );
     m_Orient = aAngle;
+
+    boardPadsChanged();
 }
 
 
@@ -455,6 +459,8 @@ void D_PAD::Copy( D_PAD* source )
 
     SetSubRatsnest( 0 );
     SetSubNet( 0 );
+
+    boardPadsChanged();
 }
 
 
@@ -866,6 +872,23 @@ void D_PAD::Rotate( const wxPoint& aRotCentre, double aAngle )
     NORMALIZE_ANGLE_360( m_Orient );
 
     SetLocalCoord();
+    boardPadsChanged();
+}
+
+
+void D_PAD::UnLink()
+{
+    boardPadsChanged();
+    BOARD_ITEM::UnLink();
+}
+
+
+void D_PAD::boardPadsChanged() const
+{
+    BOARD* board = GetBoard();
+
+    if( board && GetParent() )
+        board->PadsChanged( GetParent() );
 }
 
 
@@ -154,13 +154,18 @@ public:
      * @return the shape of this pad.
      */
     PAD_SHAPE_T GetShape() const                { return m_padShape; }
-    void SetShape( PAD_SHAPE_T aShape )         { m_padShape = aShape; m_boundingRadius = -1; }
+    void SetShape( PAD_SHAPE_T aShape )
+    {
+        m_padShape = aShape;
+        m_boundingRadius = -1;
+        boardPadsChanged();
+    }
 
-    void SetPosition( const wxPoint& aPos )     { m_Pos = aPos; }   // was overload
+    void SetPosition( const wxPoint& aPos )     { m_Pos = aPos; boardPadsChanged(); }
     const wxPoint& GetPosition() const          { return m_Pos; }   // was overload
 
-    void SetY( int y )                          { m_Pos.y = y; }
-    void SetX( int x )                          { m_Pos.x = x; }
+    void SetY( int y )                          { m_Pos.y = y; boardPadsChanged(); }
+    void SetX( int x )                          { m_Pos.x = x; boardPadsChanged(); }
 
     void SetPos0( const wxPoint& aPos )         { m_Pos0 = aPos; }
     const wxPoint& GetPos0() const              { return m_Pos0; }
@@ -168,21 +173,37 @@ public:
     void SetY0( int y )                         { m_Pos0.y = y; }
     void SetX0( int x )                         { m_Pos0.x = x; }
 
-    void SetSize( const wxSize& aSize )         { m_Size = aSize;  m_boundingRadius = -1; }
+    void SetSize( const wxSize& aSize )
+    {
+        m_Size = aSize;
+        m_boundingRadius = -1;
+        boardPadsChanged();
+    }
+
     const wxSize& GetSize() const               { return m_Size; }
 
-    void SetDelta( const wxSize& aSize )        { m_DeltaSize = aSize;  m_boundingRadius = -1; }
+    void SetDelta( const wxSize& aSize )
+    {
+        m_DeltaSize = aSize;
+        m_boundingRadius = -1;
+        boardPadsChanged();
+    }
+
     const wxSize& GetDelta() const              { return m_DeltaSize; }
 
     void SetDrillSize( const wxSize& aSize )    { m_Drill = aSize; }
     const wxSize& GetDrillSize() const          { return m_Drill; }
 
-    void SetOffset( const wxPoint& aOffset )    { m_Offset = aOffset; }
+    void SetOffset( const wxPoint& aOffset )    { m_Offset = aOffset; boardPadsChanged(); }
     const wxPoint& GetOffset() const            { return m_Offset; }
 
 
     void Flip( const wxPoint& aCentre );        // Virtual function
 
+    /// @copydoc BOARD_ITEM::UnLink()
+    /// The pad is also dropped from the pad index of the board, it can be deleted.
+    void UnLink();
+
 
     /**
      * Function SetOrientation
@@ -221,7 +242,7 @@ public:
      */
     void GetOblongDrillGeometry( wxPoint& aStartPoint, wxPoint& aEndPoint, int& aWidth ) const;
 
-    void SetLayerSet( LSET aLayerMask )         { m_layerMask = aLayerMask; }
+    void SetLayerSet( LSET aLayerMask )         { m_layerMask = aLayerMask; boardPadsChanged(); }
     LSET GetLayerSet() const                    { return m_layerMask; }
 
     void SetAttribute( PAD_ATTR_T aAttribute );
@@ -455,6 +476,7 @@ public:
             aRadiusScale = 0.0;
 
         m_padRoundRectRadiusScale = std::min( aRadiusScale, 0.5 );
+        boardPadsChanged();
     }
 
     /**
@@ -498,6 +520,7 @@ public:
     {
         m_Pos += aMoveVector;
         SetLocalCoord();
+        boardPadsChanged();
     }
 
     void Rotate( const wxPoint& aRotCentre, double aAngle );
@@ -576,6 +599,13 @@ private:
      */
     int boundingRadius() const;
 
+    /**
+     * Function boardPadsChanged
+     * tells the board of the pad that the pad geometry has changed, so its pad index is
+     * rebuilt before the next lookup.
+     */
+    void boardPadsChanged() const;
+
 private:    // Private variable members:
 
     // Actually computed and cached on demand by the accessor
@@ -142,6 +142,30 @@ void TEXTE_MODULE::Copy( TEXTE_MODULE* source )
     m_Italic = source->m_Italic;
     m_Bold   = source->m_Bold;
     m_Text   = source->m_Text;
+
+    referenceChanged();
+}
+
+
+void TEXTE_MODULE::SetText( const wxString& aText )
+{
+    EDA_TEXT::SetText( aText );
+
+    referenceChanged();
+}
+
+
+void TEXTE_MODULE::referenceChanged()
+{
+    MODULE* module = static_cast<MODULE*>( m_Parent );
+
+    if( m_Type != TEXT_is_REFERENCE || !module || module->Type() != PCB_MODULE_T )
+        return;
+
+    BOARD* board = module->GetBoard();
+
+    if( board )
+        board->ModuleKeysChanged( module );
 }
 
 
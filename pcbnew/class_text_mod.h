@@ -114,6 +114,9 @@ public:
 
     void Copy( TEXTE_MODULE* source ); // copy structure
 
+    /// Changes the text, and the key of the footprint in its board if this is the reference
+    virtual void SetText( const wxString& aText );
+
     int GetLength() const;        // text length
 
     /**
@@ -192,6 +195,9 @@ public:
 #endif
 
 private:
+    /// Tells the board of the parent footprint a reference text has changed
+    void referenceChanged();
+
     /* Note: orientation in 1/10 deg relative to the footprint
      * Physical orient is m_Orient + m_Parent->m_Orient
      */
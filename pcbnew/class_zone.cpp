@@ -66,6 +66,7 @@ ZONE_CONTAINER::ZONE_CONTAINER( BOARD* aBoard ) :
     m_cornerRadius = 0;
     SetLocalFlags( 0 );                         // flags tempoarry used in zone calculations
     m_Poly     = new CPolyLine();               // Outlines
+    m_fillCache = NULL;
     aBoard->GetZoneSettings().ExportSetting( *this );
 }
 
@@ -74,6 +75,7 @@ ZONE_CONTAINER::ZONE_CONTAINER( const ZONE_CONTAINER& aZone ) :
     BOARD_CONNECTED_ITEM( aZone )
 {
     m_smoothedPoly = NULL;
+    m_fillCache = NULL;         // the copy will be filled from scratch
 
     // Should the copy be on the same net?
     SetNetCode( aZone.GetNetCode() );
@@ -109,6 +111,7 @@ ZONE_CONTAINER::~ZONE_CONTAINER()
 {
     delete m_Poly;
     m_Poly = NULL;
+    delete m_fillCache;
 }
 
 
@@ -33,6 +33,7 @@
 
 
 #include <vector>
+#include <map>
 #include <gr_basic.h>
 #include <class_board_item.h>
 #include <class_board_connected_item.h>
@@ -47,6 +48,7 @@ class EDA_DRAW_PANEL;
 class PCB_EDIT_FRAME;
 class BOARD;
 class ZONE_CONTAINER;
+class ZONE_OBSTACLE_INDEX;
 class MSG_PANEL_ITEM;
 
 
@@ -69,6 +71,40 @@ struct SEGMENT
 };
 
 
+/**
+ * Struct ZONE_FILL_CACHE
+ * keeps the intermediate results of the last fill of a copper zone, so that the
+ * next fill only has to recompute the areas around the items which have changed.
+ */
+struct ZONE_FILL_CACHE
+{
+    /// The kinds of holes a board item can create in a zone
+    enum FEATURE_KIND
+    {
+        FEATURE_CLEARANCE,      ///< the item shape, inflated by its clearance
+        FEATURE_THERMAL         ///< the thermal relief of a pad
+    };
+
+    typedef std::pair<const BOARD_ITEM*, int>       FEATURE_KEY;
+    typedef std::map<FEATURE_KEY, SHAPE_POLY_SET>   FEATURE_MAP;
+
+    std::vector<CPolyPt>    m_outline;          ///< Corners of the smoothed zone outline
+    int                     m_minThickness;
+    int                     m_segsPerCircle;
+    SHAPE_POLY_SET          m_solidAreas;       ///< Outline deflated by m_minThickness / 2
+    SHAPE_POLY_SET          m_rawFill;          ///< m_solidAreas minus all the holes
+    FEATURE_MAP             m_features;         ///< The holes created by each item
+
+    /**
+     * Function AddFeature
+     * stores the polygons appended to aFeatures (from the aFirst-th one) as the
+     * hole created by aItem.  The item itself is never dereferenced by the cache.
+     */
+    void AddFeature( const BOARD_ITEM* aItem, FEATURE_KIND aKind,
+                     const SHAPE_POLY_SET& aFeatures, int aFirst );
+};
+
+
 /**
  * Class ZONE_CONTAINER
  * handles a list of polygons defining a copper zone.
@@ -278,12 +314,23 @@ public:
      * if not null:
      * Only the zone outline (with holes, if any) is stored in aOutlineBuffer
      * with holes linked. Therefore only one polygon is created
+     * @param aObstacles: the index of the items of aPcb which can cut the zone, or NULL
+     * to scan the whole board
      *
      * When aOutlineBuffer is not null, his function calls
      * AddClearanceAreasPolygonsToPolysList() to add holes for pads and tracks
      * and other items not in net.
      */
-    bool BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET* aOutlineBuffer = NULL );
+    bool BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET* aOutlineBuffer = NULL,
+                                        ZONE_OBSTACLE_INDEX* aObstacles = NULL );
+
+    /**
+     * Function BuildSmoothedPoly
+     * creates the corner-smoothed version of m_Poly, according to the smoothing settings.
+     * The zone is not modified, so this can be called while other zones are being filled.
+     * @return CPolyLine* - the new polygon, owned by the caller.
+     */
+    CPolyLine* BuildSmoothedPoly() const;
 
     /**
      * Function AddClearanceAreasPolygonsToPolysList
@@ -295,10 +342,14 @@ public:
      * BuildFilledSolidAreasPolygons() call this function just after creating the
      *  filled copper area polygon (without clearance areas
      * @param aPcb: the current board
+     * @param aObstacles: the index of the items of aPcb, or NULL to scan the board lists
+     * If the zone outline has not changed since the previous fill, only the areas
+     * around the holes which have changed are recomputed.
      * _NG version uses SHAPE_POLY_SET instead of Boost.Polygon
      */
     void AddClearanceAreasPolygonsToPolysList( BOARD* aPcb );
-    void AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb );
+    void AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb,
+                                                  ZONE_OBSTACLE_INDEX* aObstacles = NULL );
 
 
      /**
@@ -547,7 +598,8 @@ public:
 
 
 private:
-    void buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeatures );
+    void buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeatures,
+                               ZONE_OBSTACLE_INDEX* aObstacles, ZONE_FILL_CACHE* aFillData );
 
     CPolyLine*            m_Poly;                ///< Outline of the zone.
     CPolyLine*            m_smoothedPoly;        // Corner-smoothed version of m_Poly
@@ -616,6 +668,9 @@ private:
      * described by m_Poly can have many filled areas
      */
     SHAPE_POLY_SET m_FilledPolysList;
+
+    /// Data of the last fill, used to only recompute the areas changed since (can be NULL)
+    ZONE_FILL_CACHE*      m_fillCache;
 };
 
 
@@ -37,14 +37,31 @@
 
 // Helper classes to handle connection points
 #include <connect.h>
+#include <connectivity_graph.h>
 
-extern void Merge_SubNets_Connected_By_CopperAreas( BOARD* aPcb );
-extern void Merge_SubNets_Connected_By_CopperAreas( BOARD* aPcb, int aNetcode );
+#include <boost/unordered_map.hpp>
 
 // Local functions
 static void RebuildTrackChain( BOARD* pcb );
 
 
+/**
+ * Function findTrackRoot
+ * returns the representative of the cluster of track aIndex in the disjoint-set
+ * forest aParents, and shortens the path to it (path halving).
+ */
+static int findTrackRoot( std::vector<int>& aParents, int aIndex )
+{
+    while( aParents[aIndex] != aIndex )
+    {
+        aParents[aIndex] = aParents[aParents[aIndex]];
+        aIndex = aParents[aIndex];
+    }
+
+    return aIndex;
+}
+
+
 CONNECTIONS::CONNECTIONS( BOARD * aBrd )
 {
     m_brd = aBrd;
@@ -64,45 +81,6 @@ void CONNECTIONS::BuildPadsList( int aNetcode )
     m_brd->GetSortedPadListByXthenYCoord( m_sortedPads, aNetcode < 0 ? -1 : aNetcode );
 }
 
-/* Explores the list of pads and adds to m_PadsConnected member
- * of each pad pads connected to
- * Here, connections are due to intersecting pads, not tracks
- */
-void CONNECTIONS::SearchConnectionsPadsToIntersectingPads()
-{
-    std::vector<CONNECTED_POINT*> candidates;
-
-    BuildPadsCandidatesList();
-
-    for( unsigned ii = 0; ii < m_sortedPads.size(); ii++ )
-    {
-        D_PAD* pad = m_sortedPads[ii];
-
-        pad->m_PadsConnected.clear();
-        candidates.clear();
-
-        CollectItemsNearTo( candidates, pad->ShapePos(), pad->GetBoundingRadius() );
-
-        // add pads to pad.m_PadsConnected, if they are connected
-        for( unsigned jj = 0; jj < candidates.size(); jj++ )
-        {
-            CONNECTED_POINT* item = candidates[jj];
-
-            D_PAD* candidate_pad = item->GetPad();
-
-            if( pad == candidate_pad )
-                continue;
-
-            if( !( pad->GetLayerSet() & candidate_pad->GetLayerSet() ).any() )
-                continue;
-            if( pad->HitTest( item->GetPoint() ) )
-            {
-                pad->m_PadsConnected.push_back( candidate_pad );
-            }
-        }
-    }
-}
-
 /* Explores the list of pads
  * Adds to m_PadsConnected member of each track the pad(s) connected to
  * Adds to m_TracksConnected member of each pad the track(s) connected to
@@ -449,277 +427,6 @@ int CONNECTIONS::searchEntryPointInCandidatesList( const wxPoint& aPoint )
     return -1;
 }
 
-/* Used after a track change (delete a track ou add a track)
- * Connections to pads are recalculated
- * Note also aFirstTrack (and aLastTrack ) can be NULL
- */
-void CONNECTIONS::Build_CurrNet_SubNets_Connections( TRACK* aFirstTrack, TRACK* aLastTrack, int aNetcode )
-{
-    m_firstTrack = aFirstTrack;     // The first track used to build m_Candidates
-    m_lastTrack = aLastTrack;       // The last track used to build m_Candidates
-
-    // Pads subnets are expected already cleared, because this function
-    // does not know the full list of pads
-    BuildTracksCandidatesList( aFirstTrack, aLastTrack );
-    TRACK* curr_track;
-    for( curr_track = aFirstTrack; curr_track != NULL; curr_track = curr_track->Next() )
-    {
-        // Clear track subnet id (Pads subnets are cleared outside this function)
-        curr_track->SetSubNet( 0 );
-        curr_track->m_TracksConnected.clear();
-        curr_track->m_PadsConnected.clear();
-
-        // Update connections between tracks:
-        SearchConnectedTracks( curr_track );
-        curr_track->m_TracksConnected = m_connected;
-
-        if( curr_track == aLastTrack )
-            break;
-    }
-
-    // Update connections between tracks and pads
-    BuildPadsList( aNetcode );
-    SearchTracksConnectedToPads();
-
-    // Update connections between intersecting pads (no tracks)
-    SearchConnectionsPadsToIntersectingPads();
-
-    // Creates sub nets (clusters) for the current net:
-    Propagate_SubNets();
-}
-
-
-/**
- * Change a subnet value to a new value, in m_sortedPads pad list
- * After that, 2 cluster (or subnets) are merged into only one.
- * Note: the resulting subnet value is the smallest between aOldSubNet et aNewSubNet
- */
-int CONNECTIONS::Merge_PadsSubNets( int aOldSubNet, int aNewSubNet )
-{
-    int    change_count = 0;
-
-    if( aOldSubNet == aNewSubNet )
-        return 0;
-
-    if( (aOldSubNet > 0) && (aOldSubNet < aNewSubNet) )
-        std::swap( aOldSubNet, aNewSubNet );
-
-    // Examine connections between intersecting pads
-    for( unsigned ii = 0; ii < m_sortedPads.size(); ii++ )
-    {
-        D_PAD * curr_pad = m_sortedPads[ii];
-        if( curr_pad->GetSubNet() != aOldSubNet )
-            continue;
-
-        change_count++;
-        curr_pad->SetSubNet( aNewSubNet );
-    }
-
-    return change_count;
-}
-
-/*
- * Change a subnet value to a new value, for tracks and pads which are connected to.
- * The result is merging 2 clusters (or subnets) into only one cluster.
- * Note: the resulting sub net value is the smallest between aOldSubNet et aNewSubNet
- */
-int CONNECTIONS::Merge_SubNets( int aOldSubNet, int aNewSubNet )
-{
-    TRACK* curr_track;
-    int    change_count = 0;
-
-    if( aOldSubNet == aNewSubNet )
-        return 0;
-
-    if( (aOldSubNet > 0) && (aOldSubNet < aNewSubNet) )
-        std::swap( aOldSubNet, aNewSubNet );
-
-    curr_track = (TRACK*)m_firstTrack;
-
-    for( ; curr_track != NULL; curr_track = curr_track->Next() )
-    {
-        if( curr_track->GetSubNet() != aOldSubNet )
-        {
-            if( curr_track == m_lastTrack )
-                break;
-
-            continue;
-        }
-
-        change_count++;
-        curr_track->SetSubNet( aNewSubNet );
-
-        for( unsigned ii = 0; ii < curr_track->m_PadsConnected.size(); ii++ )
-        {
-            D_PAD * pad = curr_track->m_PadsConnected[ii];
-            if( pad->GetSubNet() == aOldSubNet )
-            {
-                pad->SetSubNet( curr_track->GetSubNet() );
-            }
-        }
-
-        if( curr_track == m_lastTrack )
-            break;
-    }
-
-    return change_count;
-}
-
-
-/* Test a list of track segments, to create or propagate a sub netcode to pads and
- * segments connected together.
- * The track list must be sorted by nets, and all segments
- * from m_firstTrack to m_lastTrack have the same net
- * When 2 items are connected (a track to a pad, or a track to an other track),
- * they are grouped in a cluster.
- * The .m_Subnet member is the cluster identifier (subnet id)
- * For a given net, if all tracks are created, there is only one cluster.
- * but if not all tracks are created, there are more than one cluster,
- * and some ratsnests will be left active.
- * A ratsnest is active when it "connect" 2 items having different subnet id
- */
-void CONNECTIONS::Propagate_SubNets()
-{
-    int sub_netcode = 1;
-
-    TRACK* curr_track = (TRACK*)m_firstTrack;
-    if( curr_track )
-        curr_track->SetSubNet( sub_netcode );
-
-    // Examine connections between tracks and pads
-    for( ; curr_track != NULL; curr_track = curr_track->Next() )
-    {
-        // First: handling connections to pads
-        for( unsigned ii = 0; ii < curr_track->m_PadsConnected.size(); ii++ )
-        {
-            D_PAD * pad = curr_track->m_PadsConnected[ii];
-
-            if( curr_track->GetSubNet() )        // the track segment is already a cluster member
-            {
-                if( pad->GetSubNet() > 0 )
-                {
-                    // The pad is already a cluster member, so we can merge the 2 clusters
-                    Merge_SubNets( pad->GetSubNet(), curr_track->GetSubNet() );
-                }
-                else
-                {
-                    /* The pad is not yet attached to a cluster , so we can add this pad to
-                     * the cluster */
-                    pad->SetSubNet( curr_track->GetSubNet() );
-                }
-            }
-            else                              // the track segment is not attached to a cluster
-            {
-                if( pad->GetSubNet() > 0 )
-                {
-                    // it is connected to a pad in a cluster, merge this track
-                    curr_track->SetSubNet( pad->GetSubNet() );
-                }
-                else
-                {
-                    /* it is connected to a pad not in a cluster, so we must create a new
-                     * cluster (only with the 2 items: the track and the pad) */
-                    sub_netcode++;
-                    curr_track->SetSubNet( sub_netcode );
-                    pad->SetSubNet( curr_track->GetSubNet() );
-                }
-            }
-        }
-
-        // Test connections between segments
-        for( unsigned ii = 0; ii < curr_track->m_TracksConnected.size(); ii++ )
-        {
-            BOARD_CONNECTED_ITEM* track = curr_track->m_TracksConnected[ii];
-
-            if( curr_track->GetSubNet() )   // The current track is already a cluster member
-            {
-                // The other track is already a cluster member, so we can merge the 2 clusters
-                if( track->GetSubNet() )
-                {
-                    Merge_SubNets( track->GetSubNet(), curr_track->GetSubNet() );
-                }
-                else
-                {
-                    // The other track is not yet attached to a cluster , so we can add this
-                    // other track to the cluster
-                    track->SetSubNet( curr_track->GetSubNet() );
-                }
-            }
-            else        // the current track segment is not yet attached to a cluster
-            {
-                if( track->GetSubNet() )
-                {
-                    // The other track is already a cluster member, so we can add
-                    // the current segment to the cluster
-                    curr_track->SetSubNet( track->GetSubNet() );
-                }
-                else
-                {
-                    // it is connected to an other segment not in a cluster, so we must
-                    // create a new cluster (only with the 2 track segments)
-                    sub_netcode++;
-                    curr_track->SetSubNet( sub_netcode );
-                    track->SetSubNet( curr_track->GetSubNet() );
-                }
-            }
-        }
-
-        if( curr_track == m_lastTrack )
-            break;
-    }
-
-    // Examine connections between intersecting pads, and propagate
-    // sub_netcodes to intersecting pads
-    for( unsigned ii = 0; ii < m_sortedPads.size(); ii++ )
-    {
-        D_PAD* curr_pad = m_sortedPads[ii];
-
-        for( unsigned jj = 0; jj < curr_pad->m_PadsConnected.size(); jj++ )
-        {
-            D_PAD* pad = curr_pad->m_PadsConnected[jj];
-
-            if( curr_pad->GetSubNet() )   // the current pad is already attached to a cluster
-            {
-                if( pad->GetSubNet() > 0 )
-                {
-                    // The pad is already a cluster member, so we can merge the 2 clusters
-                    // Store the initial subnets, which will be modified by Merge_PadsSubNets
-                    int subnet1 = pad->GetSubNet();
-                    int subnet2 = curr_pad->GetSubNet();
-
-                    // merge subnets of pads only, even those not connected by tracks
-                    Merge_PadsSubNets( subnet1, subnet2 );
-
-                    // merge subnets of tracks (and pads, which are already merged)
-                    Merge_SubNets( subnet1, subnet2 );
-                }
-                else
-                {
-                    // The pad is not yet attached to a cluster,
-                    // so we can add this pad to the cluster
-                    pad->SetSubNet( curr_pad->GetSubNet() );
-                }
-            }
-            else   // the current pad is not attached to a cluster
-            {
-                if( pad->GetSubNet() > 0 )
-                {
-                    // the connected pad is in a cluster,
-                    // so we can add the current pad to the cluster
-                    curr_pad->SetSubNet( pad->GetSubNet() );
-                }
-                else
-                {
-                    // the connected pad is not in a cluster,
-                    // so we must create a new cluster, with the 2 pads.
-                    sub_netcode++;
-                    curr_pad->SetSubNet( sub_netcode );
-                    pad->SetSubNet( curr_pad->GetSubNet() );
-                }
-            }
-        }
-    }
-}
 
 /*
  * Test all connections of the board,
@@ -738,45 +445,12 @@ void PCB_BASE_FRAME::TestConnections()
         pad->SetSubNet( 0 );
     }
 
-    m_Pcb->Test_Connections_To_Copper_Areas();
-
-    // Test existing connections net by net
-    // note some nets can have no tracks, and pads intersecting
-    // so Build_CurrNet_SubNets_Connections must be called for each net
-    CONNECTIONS connections( m_Pcb );
-
-    int last_net_tested = 0;
-    int current_net_code = 0;
-
-    for( TRACK* track = m_Pcb->m_Track; track; )
-    {
-        // At this point, track is the first track of a given net
-        current_net_code = track->GetNetCode();
-
-        // Get last track of the current net
-        TRACK* lastTrack = track->GetEndNetCode( current_net_code );
-
-        if( current_net_code > 0 )  // do not spend time if net code = 0 ( dummy net )
-        {
-            // Test all previous nets having no tracks
-            for( int net = last_net_tested+1; net < current_net_code; net++ )
-                connections.Build_CurrNet_SubNets_Connections( NULL, NULL, net );
-
-            connections.Build_CurrNet_SubNets_Connections( track, lastTrack, current_net_code );
-            last_net_tested = current_net_code;
-        }
-
-        track = lastTrack->Next();    // this is now the first track of the next net
-    }
-
-    // Test last nets without tracks, if any
-    int netsCount = m_Pcb->GetNetCount();
-    for( int net = last_net_tested+1; net < netsCount; net++ )
-        connections.Build_CurrNet_SubNets_Connections( NULL, NULL, net );
-
-    Merge_SubNets_Connected_By_CopperAreas( m_Pcb );
+    // Build the clusters of connected items, and store them in the subnet
+    // of pads and tracks
+    CONNECTIVITY_GRAPH* connectivity = m_Pcb->GetConnectivity();
 
-    return;
+    connectivity->Build( m_Pcb );
+    connectivity->SetSubNets();
 }
 
 
@@ -799,26 +473,12 @@ void PCB_BASE_FRAME::TestNetConnection( wxDC* aDC, int aNetCode )
             pad->SetSubNet( 0 );
     }
 
-    m_Pcb->Test_Connections_To_Copper_Areas( aNetCode );
-
-    // Search for the first and the last segment relative to the given net code
-    if( m_Pcb->m_Track )
-    {
-        CONNECTIONS connections( m_Pcb );
-
-        TRACK* lastTrack = NULL;
-        TRACK* firstTrack = m_Pcb->m_Track.GetFirst()->GetStartNetCode( aNetCode );
-
-        if( firstTrack )
-            lastTrack = firstTrack->GetEndNetCode( aNetCode );
+    // Only the items of this net are examined again: the clusters of the other
+    // nets are kept
+    CONNECTIVITY_GRAPH* connectivity = m_Pcb->GetConnectivity();
 
-        if( firstTrack && lastTrack ) // i.e. if there are segments
-        {
-            connections.Build_CurrNet_SubNets_Connections( firstTrack, lastTrack, aNetCode );
-        }
-    }
-
-    Merge_SubNets_Connected_By_CopperAreas( m_Pcb, aNetCode );
+    connectivity->UpdateNet( m_Pcb, aNetCode );
+    connectivity->SetSubNets( aNetCode );
 
     // rebuild the active ratsnest for this net
     DrawGeneralRatsnest( aDC, aNetCode );
@@ -891,57 +551,56 @@ void PCB_BASE_FRAME::RecalculateAllTracksNetcode()
             t->SetNetCode( t->m_PadsConnected[0]->GetNetCode() );
     }
 
-    // Pass 2: build connections between track ends
+    // Pass 2: build connections between track ends, and group the connected
+    // tracks in clusters
+    std::vector<TRACK*> tracks;
+    boost::unordered_map<const TRACK*, int> trackIndices;
+
     for( TRACK* t = m_Pcb->m_Track;  t;  t = t->Next() )
     {
-        connections.SearchConnectedTracks( t );
-        connections.GetConnectedTracks( t );
+        trackIndices[t] = tracks.size();
+        tracks.push_back( t );
     }
 
-    // Propagate net codes from a segment to other connected segments
-    bool new_pass_request = true;   // set to true if a track has its netcode changed from 0
-                                    // to a known netcode to re-evaluate netcodes
-                                    // of connected items
-    while( new_pass_request )
+    std::vector<int> parents( tracks.size() );
+
+    for( unsigned ii = 0; ii < tracks.size(); ii++ )
+        parents[ii] = ii;
+
+    for( unsigned ii = 0; ii < tracks.size(); ii++ )
     {
-        new_pass_request = false;
+        TRACK* t = tracks[ii];
 
-        for( TRACK* t = m_Pcb->m_Track;  t;  t = t->Next() )
-        {
-            int netcode = t->GetNetCode();
+        connections.SearchConnectedTracks( t );
+        connections.GetConnectedTracks( t );
 
-            if( netcode == 0 )
-            {
-                // try to find a connected item having a netcode
-                for( unsigned kk = 0; kk < t->m_TracksConnected.size(); kk++ )
-                {
-                    int altnetcode = t->m_TracksConnected[kk]->GetNetCode();
-                    if( altnetcode )
-                    {
-                        new_pass_request = true;
-                        netcode = altnetcode;
-                        t->SetNetCode(netcode);
-                        break;
-                    }
-                }
-            }
+        for( unsigned kk = 0; kk < t->m_TracksConnected.size(); kk++ )
+        {
+            int root = findTrackRoot( parents, ii );
+            int other = findTrackRoot( parents, trackIndices[t->m_TracksConnected[kk]] );
 
-            if( netcode )    // this track has a netcode
-            {
-                // propagate this netcode to connected tracks having no netcode
-                for( unsigned kk = 0; kk < t->m_TracksConnected.size(); kk++ )
-                {
-                    int altnetcode = t->m_TracksConnected[kk]->GetNetCode();
-                    if( altnetcode == 0 )
-                    {
-                        t->m_TracksConnected[kk]->SetNetCode(netcode);
-                        new_pass_request = true;
-                    }
-                }
-            }
+            parents[std::max( root, other )] = std::min( root, other );
         }
     }
 
+    // Propagate net codes to the tracks having no netcode: each cluster gets the
+    // netcode of its first track connected to a pad
+    std::vector<int> netcodes( tracks.size(), 0 );
+
+    for( unsigned ii = 0; ii < tracks.size(); ii++ )
+    {
+        int root = findTrackRoot( parents, ii );
+
+        if( netcodes[root] == 0 )
+            netcodes[root] = tracks[ii]->GetNetCode();
+    }
+
+    for( unsigned ii = 0; ii < tracks.size(); ii++ )
+    {
+        if( tracks[ii]->GetNetCode() == 0 )
+            tracks[ii]->SetNetCode( netcodes[findTrackRoot( parents, ii )] );
+    }
+
     // Sort the track list by net codes:
     RebuildTrackChain( m_Pcb );
 }
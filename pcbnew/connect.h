@@ -119,22 +119,6 @@ public:
      */
     std::vector<D_PAD*>& GetPadsList() { return m_sortedPads; }
 
-    /**
-     * Function Build_CurrNet_SubNets_Connections
-     * should be called after a track change (delete or add a track):
-     * Connections to pads and to tracks are recalculated
-     *   If a track is deleted, the other pointers to pads do not change.
-     *   When a new track is added in track list, its pointers to pads are already initialized
-     * Builds the subnets inside a net (tracks from aFirstTrack to aFirstTrack).
-     * subnets are clusters of pads and tracks that are connected together.
-     * When all tracks are created relative to the net, there is only a cluster
-     * when not tracks there are a cluster per pad
-     * @param aFirstTrack = first track of the given net
-     * @param aLastTrack = last track of the given net
-     * @param aNetcode = the netcode of the given net
-     */
-    void Build_CurrNet_SubNets_Connections( TRACK* aFirstTrack, TRACK* aLastTrack, int aNetcode );
-
     /**
      * Function BuildTracksCandidatesList
      * Fills m_Candidates with all connecting points (track ends or via location)
@@ -172,15 +156,6 @@ public:
         aTrack->m_TracksConnected = m_connected;
     }
 
-    /**
-     * function SearchConnectionsPadsToIntersectingPads
-     * Explores the list of pads and adds to m_PadsConnected member
-     * of each pad pads connected to
-     * Here, connections are due to intersecting pads, not tracks
-     * m_sortedPads must be initialized
-     */
-    void SearchConnectionsPadsToIntersectingPads();
-
     /**
      * function SearchTracksConnectedToPads
      * Explores the list of pads.
@@ -207,22 +182,6 @@ public:
     void CollectItemsNearTo( std::vector<CONNECTED_POINT*>& aList,
                             const wxPoint& aPosition, int aDistMax );
 
-    /**
-     * Function Propagate_SubNets
-     * Test a list of tracks, to create or propagate a sub netcode to pads and
-     * segments connected together.
-     * The track list must be sorted by nets, and all segments
-     * from m_firstTrack to m_lastTrack have the same net.
-     * When 2 items are connected (a track to a pad, or a track to an other track),
-     * they are grouped in a cluster.
-     * For pads, this is the .m_physical_connexion member which is a cluster identifier
-     * For tracks, this is the .m_Subnet member which is a cluster identifier
-     * For a given net, if all tracks are created, there is only one cluster.
-     * but if not all tracks are created, there are more than one cluster,
-     * and some ratsnests will be left active.
-     */
-    void Propagate_SubNets();
-
 private:
     /**
      * function searchEntryPointInCandidatesList
@@ -235,29 +194,6 @@ private:
      */
     int searchEntryPointInCandidatesList( const wxPoint & aPoint);
 
-    /**
-     * Function Merge_SubNets
-     * Change a subnet old value to a new value, for tracks and pads which are connected to
-     * tracks from m_firstTrack to m_lastTrack and their connected pads.
-     * and modify the subnet parameter (change the old value to the new value).
-     * After that, 2 cluster (or subnets) are merged into only one.
-     * Note: the resulting sub net value is the smallest between aOldSubNet and aNewSubNet
-     * @return modification count
-     * @param aOldSubNet = subnet value to modify
-     * @param aNewSubNet = new subnet value for each item which have old_val as subnet value
-     */
-    int Merge_SubNets( int aOldSubNet, int aNewSubNet );
-
-    /**
-     * Function Merge_PadsSubNets
-     * Change a subnet value to a new value, in m_sortedPads pad list
-     * After that, 2 cluster (or subnets) are merged into only one.
-     * Note: the resulting subnet value is the smallest between aOldSubNet et aNewSubNet
-     * @return modification count
-     * @param aOldSubNet = subnet value to modify
-     * @param aNewSubNet = new subnet value for each item which have old_val as subnet value
-     */
-    int Merge_PadsSubNets( int aOldSubNet, int aNewSubNet );
 };
 
 #endif      //  ifndef CONNECT_H
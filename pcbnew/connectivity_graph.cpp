@@ -0,0 +1,713 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file connectivity_graph.cpp
+ */
+
+#include <fctsys.h>
+#include <common.h>
+#include <trigo.h>
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_pad.h>
+#include <class_zone.h>
+
+#include <connectivity_graph.h>
+
+
+/**
+ * Helper visitor for INDEX_TREE searches: collects the nodes found.
+ */
+struct CONNECTIVITY_COLLECTOR
+{
+    CONNECTIVITY_COLLECTOR( std::vector<int>& aResult ) :
+        m_result( aResult )
+    {
+    }
+
+    bool operator()( int aIndex )
+    {
+        m_result.push_back( aIndex );
+        return true;
+    }
+
+    std::vector<int>& m_result;
+};
+
+
+/**
+ * Function getTrackEnds
+ * fills aEnds with the connection points of a track (both ends) or a via (its position).
+ * @return the number of points.
+ */
+static int getTrackEnds( const TRACK* aTrack, wxPoint aEnds[2] )
+{
+    aEnds[0] = aTrack->GetStart();
+
+    if( aTrack->Type() == PCB_VIA_T )
+        return 1;
+
+    aEnds[1] = aTrack->GetEnd();
+
+    return 2;
+}
+
+
+CONNECTIVITY_GRAPH::CONNECTIVITY_GRAPH()
+{
+}
+
+
+void CONNECTIVITY_GRAPH::Clear()
+{
+    m_nodes.clear();
+    m_freeNodes.clear();
+    m_itemNodes.clear();
+    m_nets.clear();
+
+    for( int layer = 0; layer < MAX_CU_LAYERS; ++layer )
+        m_trees[layer].RemoveAll();
+}
+
+
+void CONNECTIVITY_GRAPH::Build( BOARD* aBoard )
+{
+    Clear();
+
+    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+            addItem( pad );
+    }
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+        addItem( track );
+
+    for( int ii = 0; ii < aBoard->GetAreaCount(); ++ii )
+        addItem( aBoard->GetArea( ii ) );
+}
+
+
+void CONNECTIVITY_GRAPH::Add( BOARD_ITEM* aItem )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_MODULE_T:
+        for( D_PAD* pad = static_cast<MODULE*>( aItem )->Pads(); pad; pad = pad->Next() )
+            Add( pad );
+
+        break;
+
+    case PCB_PAD_T:
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+    case PCB_ZONE_AREA_T:
+        // The item can have moved, or can have changed of net
+        Remove( aItem );
+        addItem( static_cast<BOARD_CONNECTED_ITEM*>( aItem ) );
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+void CONNECTIVITY_GRAPH::Remove( const BOARD_ITEM* aItem )
+{
+    ITEM_NODES::iterator it = m_itemNodes.find( aItem );
+
+    if( it != m_itemNodes.end() )
+    {
+        for( unsigned ii = 0; ii < it->second.size(); ++ii )
+            removeNode( it->second[ii] );
+
+        m_itemNodes.erase( it );
+    }
+    else if( aItem->Type() == PCB_MODULE_T )
+    {
+        const MODULE* module = static_cast<const MODULE*>( aItem );
+
+        for( const D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+            Remove( pad );
+    }
+}
+
+
+void CONNECTIVITY_GRAPH::UpdateNet( BOARD* aBoard, int aNetCode )
+{
+    boost::unordered_map<int, NET>::iterator it = m_nets.find( aNetCode );
+
+    if( it != m_nets.end() )
+    {
+        std::vector<const BOARD_ITEM*> items;
+
+        for( unsigned ii = 0; ii < it->second.m_nodes.size(); ++ii )
+            items.push_back( m_nodes[it->second.m_nodes[ii]].m_item );
+
+        // Zones have a node per outline
+        std::sort( items.begin(), items.end() );
+        items.erase( std::unique( items.begin(), items.end() ), items.end() );
+
+        // The last removal erases the net
+        for( unsigned ii = 0; ii < items.size(); ++ii )
+            Remove( items[ii] );
+    }
+
+    if( aNetCode <= 0 )
+        return;
+
+    NETINFO_ITEM* net = aBoard->FindNet( aNetCode );
+
+    if( net )
+    {
+        for( unsigned ii = 0; ii < net->m_PadInNetList.size(); ++ii )
+            Add( net->m_PadInNetList[ii] );
+    }
+
+    // Tracks are sorted by net code
+    if( aBoard->m_Track )
+    {
+        for( TRACK* track = aBoard->m_Track.GetFirst()->GetStartNetCode( aNetCode ); track;
+             track = track->Next() )
+        {
+            if( track->GetNetCode() != aNetCode )
+                break;
+
+            Add( track );
+        }
+    }
+
+    for( int ii = 0; ii < aBoard->GetAreaCount(); ++ii )
+    {
+        ZONE_CONTAINER* zone = aBoard->GetArea( ii );
+
+        if( zone->GetNetCode() == aNetCode )
+            Add( zone );
+    }
+}
+
+
+bool CONNECTIVITY_GRAPH::IsConnected( const BOARD_CONNECTED_ITEM* aItem,
+                                      const BOARD_CONNECTED_ITEM* aOther )
+{
+    ITEM_NODES::const_iterator itemNodes = m_itemNodes.find( aItem );
+    ITEM_NODES::const_iterator otherNodes = m_itemNodes.find( aOther );
+
+    if( itemNodes == m_itemNodes.end() || otherNodes == m_itemNodes.end() )
+        return false;
+
+    int netCode = m_nodes[itemNodes->second[0]].m_netCode;
+
+    if( netCode != m_nodes[otherNodes->second[0]].m_netCode )
+        return false;
+
+    getNet( netCode );
+
+    for( unsigned ii = 0; ii < itemNodes->second.size(); ++ii )
+    {
+        int root = findRoot( itemNodes->second[ii] );
+
+        for( unsigned jj = 0; jj < otherNodes->second.size(); ++jj )
+        {
+            if( findRoot( otherNodes->second[jj] ) == root )
+                return true;
+        }
+    }
+
+    return false;
+}
+
+
+void CONNECTIVITY_GRAPH::GetConnectedItems( const BOARD_CONNECTED_ITEM* aItem,
+                                            std::vector<BOARD_CONNECTED_ITEM*>& aItems )
+{
+    aItems.clear();
+
+    ITEM_NODES::const_iterator it = m_itemNodes.find( aItem );
+
+    if( it == m_itemNodes.end() )
+        return;
+
+    NET* net = getNet( m_nodes[it->second[0]].m_netCode );
+
+    std::vector<int> roots;
+
+    for( unsigned ii = 0; ii < it->second.size(); ++ii )
+        roots.push_back( findRoot( it->second[ii] ) );
+
+    for( unsigned ii = 0; ii < net->m_nodes.size(); ++ii )
+    {
+        int node = net->m_nodes[ii];
+
+        if( std::find( roots.begin(), roots.end(), findRoot( node ) ) == roots.end() )
+            continue;
+
+        BOARD_CONNECTED_ITEM* item = m_nodes[node].m_item;
+
+        // Several outlines of a zone can be in the cluster
+        if( m_nodes[node].m_outline >= 0
+            && std::find( aItems.begin(), aItems.end(), item ) != aItems.end() )
+            continue;
+
+        aItems.push_back( item );
+    }
+}
+
+
+int CONNECTIVITY_GRAPH::GetUnconnectedCount( int aNetCode )
+{
+    if( aNetCode < 0 )
+    {
+        int count = 0;
+
+        for( boost::unordered_map<int, NET>::iterator it = m_nets.begin();
+             it != m_nets.end(); ++it )
+            count += GetUnconnectedCount( it->first );
+
+        return count;
+    }
+
+    NET* net = getNet( aNetCode );
+
+    if( net == NULL || net->m_clusters < 2 )
+        return 0;
+
+    return net->m_clusters - 1;
+}
+
+
+void CONNECTIVITY_GRAPH::SetSubNets( int aNetCode )
+{
+    if( aNetCode < 0 )
+    {
+        for( boost::unordered_map<int, NET>::iterator it = m_nets.begin();
+             it != m_nets.end(); ++it )
+            SetSubNets( it->first );
+
+        return;
+    }
+
+    NET* net = getNet( aNetCode );
+
+    if( net == NULL )
+        return;
+
+    // Subnet ids are numbered from 1, in the order clusters are met
+    boost::unordered_map<int, int> subnets;
+
+    for( unsigned ii = 0; ii < net->m_nodes.size(); ++ii )
+    {
+        const NODE& node = m_nodes[net->m_nodes[ii]];
+
+        if( node.m_outline >= 0 )
+            continue;
+
+        int root = findRoot( net->m_nodes[ii] );
+        int subnet = 0;
+
+        if( m_nodes[root].m_itemCount > 1 )
+        {
+            boost::unordered_map<int, int>::iterator it = subnets.find( root );
+
+            if( it == subnets.end() )
+            {
+                subnet = (int) subnets.size() + 1;
+                subnets[root] = subnet;
+            }
+            else
+            {
+                subnet = it->second;
+            }
+        }
+
+        node.m_item->SetSubNet( subnet );
+        node.m_item->SetZoneSubNet( node.m_onZone ? subnet : 0 );
+    }
+}
+
+
+void CONNECTIVITY_GRAPH::addItem( BOARD_CONNECTED_ITEM* aItem )
+{
+    if( aItem->GetNetCode() <= 0 )
+        return;
+
+    LSET allCu = LSET::AllCuMask();
+
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:
+    {
+        D_PAD*   pad = static_cast<D_PAD*>( aItem );
+        EDA_RECT area = pad->GetBoundingBox();
+
+        // Other pads are connected to the pad position, which can be off the shape
+        area.Merge( pad->GetPosition() );
+        addNode( pad, -1, area, pad->GetLayerSet() & allCu );
+        break;
+    }
+
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+    {
+        TRACK*   track = static_cast<TRACK*>( aItem );
+        EDA_RECT area( track->GetStart(), wxSize( 0, 0 ) );
+
+        area.Merge( track->GetEnd() );
+        area.Inflate( ( track->GetWidth() + 1 ) / 2 );
+        addNode( track, -1, area, track->GetLayerSet() & allCu );
+        break;
+    }
+
+    case PCB_ZONE_AREA_T:
+    {
+        ZONE_CONTAINER* zone = static_cast<ZONE_CONTAINER*>( aItem );
+
+        if( !zone->IsOnCopperLayer() )
+            break;
+
+        const SHAPE_POLY_SET& polys = zone->GetFilledPolysList();
+
+        for( int outline = 0; outline < polys.OutlineCount(); ++outline )
+        {
+            BOX2I    bbox = polys.COutline( outline ).BBox();
+            EDA_RECT area( wxPoint( bbox.GetX(), bbox.GetY() ),
+                           wxSize( bbox.GetWidth(), bbox.GetHeight() ) );
+
+            addNode( zone, outline, area, LSET( zone->GetLayer() ) );
+        }
+
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+
+void CONNECTIVITY_GRAPH::addNode( BOARD_CONNECTED_ITEM* aItem, int aOutline,
+                                  const EDA_RECT& aArea, LSET aLayers )
+{
+    int index;
+
+    if( m_freeNodes.empty() )
+    {
+        index = m_nodes.size();
+        m_nodes.push_back( NODE() );
+    }
+    else
+    {
+        index = m_freeNodes.back();
+        m_freeNodes.pop_back();
+    }
+
+    NODE& node = m_nodes[index];
+    NET&  net = m_nets[aItem->GetNetCode()];
+
+    node.m_item = aItem;
+    node.m_outline = aOutline;
+    node.m_netCode = aItem->GetNetCode();
+    node.m_netIndex = net.m_nodes.size();
+    node.m_area = aArea;
+    node.m_area.Normalize();
+    node.m_layers = aLayers;
+
+    net.m_nodes.push_back( index );
+    m_itemNodes[aItem].push_back( index );
+
+    for( LSEQ cu = aLayers.CuStack(); cu; ++cu )
+        insert( m_trees[*cu], node.m_area, index );
+
+    // A modified net is rebuilt as a whole at the next query
+    if( net.m_dirty )
+        return;
+
+    resetNode( index );
+
+    if( node.m_padCount )
+        net.m_clusters++;
+
+    connect( index );
+}
+
+
+void CONNECTIVITY_GRAPH::removeNode( int aNode )
+{
+    NODE& node = m_nodes[aNode];
+
+    const int mmin[2] = { node.m_area.GetX(), node.m_area.GetY() };
+    const int mmax[2] = { node.m_area.GetRight(), node.m_area.GetBottom() };
+
+    for( LSEQ cu = node.m_layers.CuStack(); cu; ++cu )
+        m_trees[*cu].Remove( mmin, mmax, aNode );
+
+    boost::unordered_map<int, NET>::iterator it = m_nets.find( node.m_netCode );
+    NET& net = it->second;
+
+    int last = net.m_nodes.back();
+
+    net.m_nodes[node.m_netIndex] = last;
+    m_nodes[last].m_netIndex = node.m_netIndex;
+    net.m_nodes.pop_back();
+
+    // Clusters cannot be split: the other nodes of the net are connected again later
+    if( net.m_nodes.empty() )
+        m_nets.erase( it );
+    else
+        net.m_dirty = true;
+
+    node.m_item = NULL;
+    m_freeNodes.push_back( aNode );
+}
+
+
+void CONNECTIVITY_GRAPH::resetNode( int aNode )
+{
+    NODE& node = m_nodes[aNode];
+
+    node.m_parent = aNode;
+    node.m_rank = 0;
+    node.m_padCount = node.m_item->Type() == PCB_PAD_T ? 1 : 0;
+    node.m_itemCount = node.m_outline < 0 ? 1 : 0;
+    node.m_onZone = false;
+}
+
+
+void CONNECTIVITY_GRAPH::connect( int aNode )
+{
+    NODE& node = m_nodes[aNode];
+    NET&  net = m_nets[node.m_netCode];
+
+    std::vector<int>       candidates;
+    CONNECTIVITY_COLLECTOR collector( candidates );
+
+    const int mmin[2] = { node.m_area.GetX(), node.m_area.GetY() };
+    const int mmax[2] = { node.m_area.GetRight(), node.m_area.GetBottom() };
+
+    for( LSEQ cu = node.m_layers.CuStack(); cu; ++cu )
+        m_trees[*cu].Search( mmin, mmax, collector );
+
+    // Items on several layers are found once per layer
+    std::sort( candidates.begin(), candidates.end() );
+    candidates.erase( std::unique( candidates.begin(), candidates.end() ), candidates.end() );
+
+    for( unsigned ii = 0; ii < candidates.size(); ++ii )
+    {
+        int   index = candidates[ii];
+        NODE& other = m_nodes[index];
+
+        if( index == aNode || other.m_netCode != node.m_netCode )
+            continue;
+
+        bool zone = node.m_outline >= 0 || other.m_outline >= 0;
+
+        // Items of the same cluster only have to be tested to know if they touch a zone
+        if( !zone && findRoot( aNode ) == findRoot( index ) )
+            continue;
+
+        if( !testConnection( node, other ) )
+            continue;
+
+        if( merge( aNode, index ) )
+            net.m_clusters--;
+
+        if( node.m_outline >= 0 )
+            other.m_onZone = true;
+
+        if( other.m_outline >= 0 )
+            node.m_onZone = true;
+    }
+}
+
+
+CONNECTIVITY_GRAPH::NET* CONNECTIVITY_GRAPH::getNet( int aNetCode )
+{
+    boost::unordered_map<int, NET>::iterator it = m_nets.find( aNetCode );
+
+    if( it == m_nets.end() )
+        return NULL;
+
+    NET& net = it->second;
+
+    if( net.m_dirty )
+    {
+        net.m_clusters = 0;
+
+        for( unsigned ii = 0; ii < net.m_nodes.size(); ++ii )
+        {
+            resetNode( net.m_nodes[ii] );
+
+            if( m_nodes[net.m_nodes[ii]].m_padCount )
+                net.m_clusters++;
+        }
+
+        net.m_dirty = false;
+
+        for( unsigned ii = 0; ii < net.m_nodes.size(); ++ii )
+            connect( net.m_nodes[ii] );
+    }
+
+    return &net;
+}
+
+
+int CONNECTIVITY_GRAPH::findRoot( int aNode )
+{
+    // Path halving
+    while( m_nodes[aNode].m_parent != aNode )
+    {
+        int parent = m_nodes[aNode].m_parent;
+
+        m_nodes[aNode].m_parent = m_nodes[parent].m_parent;
+        aNode = parent;
+    }
+
+    return aNode;
+}
+
+
+bool CONNECTIVITY_GRAPH::merge( int aNode, int aOther )
+{
+    int root = findRoot( aNode );
+    int otherRoot = findRoot( aOther );
+
+    if( root == otherRoot )
+        return false;
+
+    if( m_nodes[root].m_rank < m_nodes[otherRoot].m_rank )
+        std::swap( root, otherRoot );
+    else if( m_nodes[root].m_rank == m_nodes[otherRoot].m_rank )
+        m_nodes[root].m_rank++;
+
+    NODE& parent = m_nodes[root];
+    NODE& child = m_nodes[otherRoot];
+
+    bool padClustersMerged = parent.m_padCount > 0 && child.m_padCount > 0;
+
+    child.m_parent = root;
+    parent.m_padCount += child.m_padCount;
+    parent.m_itemCount += child.m_itemCount;
+
+    return padClustersMerged;
+}
+
+
+bool CONNECTIVITY_GRAPH::testConnection( const NODE& aNode, const NODE& aOther )
+{
+    const NODE* node = &aNode;
+    const NODE* other = &aOther;
+
+    // Sort the nodes: pads, then tracks and vias, then zones
+    if( other->m_item->Type() == PCB_PAD_T || node->m_outline >= 0 )
+        std::swap( node, other );
+
+    if( node->m_outline >= 0 )      // two zones: they are only joined by other items
+        return false;
+
+    if( other->m_outline >= 0 )
+    {
+        const ZONE_CONTAINER* zone = static_cast<const ZONE_CONTAINER*>( other->m_item );
+        const SHAPE_POLY_SET& polys = zone->GetFilledPolysList();
+
+        wxPoint ends[2];
+        int     count;
+
+        if( node->m_item->Type() == PCB_PAD_T )
+        {
+            // Zones are connected to the center of the pad shape, not to the pad position
+            ends[0] = static_cast<const D_PAD*>( node->m_item )->ShapePos();
+            count = 1;
+        }
+        else
+        {
+            count = getTrackEnds( static_cast<const TRACK*>( node->m_item ), ends );
+        }
+
+        for( int ii = 0; ii < count; ++ii )
+        {
+            if( polys.Contains( VECTOR2I( ends[ii].x, ends[ii].y ), other->m_outline ) )
+                return true;
+        }
+
+        return false;
+    }
+
+    if( node->m_item->Type() == PCB_PAD_T )
+    {
+        const D_PAD* pad = static_cast<const D_PAD*>( node->m_item );
+
+        if( other->m_item->Type() == PCB_PAD_T )
+        {
+            const D_PAD* otherPad = static_cast<const D_PAD*>( other->m_item );
+
+            return pad->HitTest( otherPad->GetPosition() )
+                   || otherPad->HitTest( pad->GetPosition() );
+        }
+
+        wxPoint ends[2];
+        int     count = getTrackEnds( static_cast<const TRACK*>( other->m_item ), ends );
+
+        for( int ii = 0; ii < count; ++ii )
+        {
+            if( pad->HitTest( ends[ii] ) )
+                return true;
+        }
+
+        return false;
+    }
+
+    // Two tracks or vias: their ends must be closer than half the width of one of them
+    const TRACK* track = static_cast<const TRACK*>( node->m_item );
+    const TRACK* otherTrack = static_cast<const TRACK*>( other->m_item );
+
+    int distMax = std::max( track->GetWidth(), otherTrack->GetWidth() ) / 2;
+
+    wxPoint ends[2], otherEnds[2];
+    int     count = getTrackEnds( track, ends );
+    int     otherCount = getTrackEnds( otherTrack, otherEnds );
+
+    for( int ii = 0; ii < count; ++ii )
+    {
+        for( int jj = 0; jj < otherCount; ++jj )
+        {
+            if( KiROUND( EuclideanNorm( otherEnds[jj] - ends[ii] ) ) <= distMax )
+                return true;
+        }
+    }
+
+    return false;
+}
+
+
+void CONNECTIVITY_GRAPH::insert( INDEX_TREE& aTree, const EDA_RECT& aArea, int aIndex )
+{
+    const int mmin[2] = { aArea.GetX(), aArea.GetY() };
+    const int mmax[2] = { aArea.GetRight(), aArea.GetBottom() };
+
+    aTree.Insert( mmin, mmax, aIndex );
+}
@@ -0,0 +1,210 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file connectivity_graph.h
+ * @brief Clusters of the copper items physically connected together.
+ */
+
+#ifndef CONNECTIVITY_GRAPH_H
+#define CONNECTIVITY_GRAPH_H
+
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include <class_eda_rect.h>
+#include <layers_id_colors_and_visibility.h>
+#include <geometry/rtree.h>
+
+class BOARD;
+class BOARD_ITEM;
+class BOARD_CONNECTED_ITEM;
+
+
+/**
+ * Class CONNECTIVITY_GRAPH
+ * groups the pads, tracks, vias and filled zone outlines of a board into clusters of
+ * items connected together by copper.
+ *
+ * Clusters are kept in a disjoint-set structure, and each item is stored in an R-tree
+ * of every copper layer it is on, so the items an item can touch are found with a
+ * box search.  Adding an item only merges its cluster with the clusters of the items
+ * it touches.  Removing an item marks its net as modified: the clusters of this net
+ * (and only this net) are rebuilt at the next query.
+ *
+ * Only items of the same net are connected together, and items of the "not connected"
+ * net (net code 0) are ignored.  The connection rules are the same as the legacy ones:
+ * - track and via ends closer than half the width of one of the tracks,
+ * - track and via ends inside a pad,
+ * - pads whose position is inside another pad,
+ * - pads (shape position), vias and track ends inside a filled zone outline.
+ *
+ * The graph does not watch the board: items must be (re)added by Add() after they
+ * are modified, and removed by Remove() before they are deleted.  BOARD::Remove()
+ * does it for the items it takes off the board; the legacy editing code, which unlinks
+ * items directly, calls PCB_BASE_FRAME::TestNetConnection() after a change, and
+ * UpdateNet() resynchronizes all the items of the net with the board.
+ */
+class CONNECTIVITY_GRAPH
+{
+public:
+    CONNECTIVITY_GRAPH();
+
+    /**
+     * Function Clear
+     * removes all the items from the graph.
+     */
+    void Clear();
+
+    /**
+     * Function Build
+     * (re)creates the graph from the pads, tracks, vias and copper zones of aBoard.
+     */
+    void Build( BOARD* aBoard );
+
+    /**
+     * Function Add
+     * adds an item to the graph, or updates it if it is already in the graph.
+     * Modules add their pads, zones add their filled outlines, other items are ignored.
+     * @param aItem is the item to add.
+     */
+    void Add( BOARD_ITEM* aItem );
+
+    /**
+     * Function Remove
+     * removes an item from the graph.  Modules remove their pads.
+     * Items found in the graph are not dereferenced, so an already deleted pad, track
+     * or zone can be removed.
+     * @param aItem is the item to remove.
+     */
+    void Remove( const BOARD_ITEM* aItem );
+
+    /**
+     * Function UpdateNet
+     * removes the items of a net and adds again the items of aBoard which belong to
+     * this net, so the graph follows items modified in place.
+     * @param aBoard is the board holding the items.
+     * @param aNetCode is the net to update.
+     */
+    void UpdateNet( BOARD* aBoard, int aNetCode );
+
+    /**
+     * Function IsConnected
+     * @return true if aItem and aOther are in the same cluster.  Two outlines of the same
+     * zone are only connected if an item joins them, so for zones the result is true
+     * if any of their outlines is connected to aOther.
+     */
+    bool IsConnected( const BOARD_CONNECTED_ITEM* aItem, const BOARD_CONNECTED_ITEM* aOther );
+
+    /**
+     * Function GetConnectedItems
+     * collects the pads, tracks, vias and zones of the cluster of aItem (aItem included).
+     * @param aItem is the reference item.
+     * @param aItems receives the items found.
+     */
+    void GetConnectedItems( const BOARD_CONNECTED_ITEM* aItem,
+                            std::vector<BOARD_CONNECTED_ITEM*>& aItems );
+
+    /**
+     * Function GetUnconnectedCount
+     * @return the number of connections missing to join all the pads of a net, i.e. the
+     * number of clusters holding pads minus one.
+     * @param aNetCode is the net to examine, or -1 to get the total for every net.
+     */
+    int GetUnconnectedCount( int aNetCode = -1 );
+
+    /**
+     * Function SetSubNets
+     * stores the cluster of each pad, track and via in its subnet member: items
+     * connected together share the same subnet id (from 1 to the number of clusters of
+     * the net), items connected to nothing have 0.  The zone subnet member is set to the
+     * subnet id for items connected to a zone, and to 0 for the others.
+     * @param aNetCode is the net to update, or -1 for every net.
+     */
+    void SetSubNets( int aNetCode = -1 );
+
+private:
+    typedef RTree<int, int, 2, float> INDEX_TREE;
+    typedef boost::unordered_map<const BOARD_ITEM*, std::vector<int> > ITEM_NODES;
+
+    struct NODE
+    {
+        BOARD_CONNECTED_ITEM*   m_item;         ///< NULL for a free slot
+        int                     m_outline;      ///< zone outline index, -1 for other items
+        int                     m_netCode;
+        int                     m_netIndex;     ///< position in the node list of the net
+        EDA_RECT                m_area;
+        LSET                    m_layers;       ///< copper layers the node is indexed on
+
+        int                     m_parent;
+        int                     m_rank;
+        int                     m_padCount;     ///< pads in the cluster (valid for roots)
+        int                     m_itemCount;    ///< pads and tracks in the cluster (roots)
+        bool                    m_onZone;       ///< connected to a zone outline
+    };
+
+    struct NET
+    {
+        NET() : m_clusters( 0 ), m_dirty( false ) {}
+
+        std::vector<int>    m_nodes;
+        int                 m_clusters;         ///< number of clusters holding pads
+        bool                m_dirty;            ///< clusters have to be rebuilt
+    };
+
+    /// Copying the trees is not supported
+    CONNECTIVITY_GRAPH( const CONNECTIVITY_GRAPH& );
+    CONNECTIVITY_GRAPH& operator=( const CONNECTIVITY_GRAPH& );
+
+    void addItem( BOARD_CONNECTED_ITEM* aItem );
+    void addNode( BOARD_CONNECTED_ITEM* aItem, int aOutline, const EDA_RECT& aArea,
+                  LSET aLayers );
+    void removeNode( int aNode );
+    void resetNode( int aNode );
+
+    /// Merges the cluster of aNode with the clusters of the items it touches
+    void connect( int aNode );
+
+    /// Returns the net of aNetCode, with its clusters up to date
+    NET* getNet( int aNetCode );
+
+    int findRoot( int aNode );
+
+    /// Returns true if two clusters holding pads were merged
+    bool merge( int aNode, int aOther );
+
+    static bool testConnection( const NODE& aNode, const NODE& aOther );
+
+    static void insert( INDEX_TREE& aTree, const EDA_RECT& aArea, int aIndex );
+
+    std::vector<NODE>       m_nodes;
+    std::vector<int>        m_freeNodes;
+
+    ITEM_NODES              m_itemNodes;    ///< nodes of each item (a zone has several)
+    boost::unordered_map<int, NET> m_nets;
+
+    INDEX_TREE              m_trees[MAX_CU_LAYERS];     ///< one tree per copper layer
+};
+
+#endif // CONNECTIVITY_GRAPH_H
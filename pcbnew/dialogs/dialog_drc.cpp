@@ -175,7 +175,14 @@ void DIALOG_DRC_CONTROL::OnStartdrcClick( wxCommandEvent& event )
                            true,        // DRC test for keepout areas enabled
                            reportName, make_report );
 
-    DelDRCMarkers();
+    bool changedItemsOnly = m_cbChangedItemsOnly->IsChecked();
+
+    // The incremental DRC updates the markers of the last run, and only deletes the
+    // obsolete ones
+    if( changedItemsOnly )
+        m_brdEditor->SetCurItem( NULL );    // the current item could be a deleted marker
+    else
+        DelDRCMarkers();
 
     wxBeginBusyCursor();
 
@@ -183,7 +190,12 @@ void DIALOG_DRC_CONTROL::OnStartdrcClick( wxCommandEvent& event )
     m_Messages->Clear();
     wxSafeYield();                          // Allows time slice to refresh the m_Messages window
     m_brdEditor->GetBoard()->m_Status_Pcb = 0; // Force full connectivity and ratsnest recalculations
-    m_tester->RunTests(m_Messages);
+
+    if( changedItemsOnly )
+        m_tester->RunIncrementalTests( m_Messages );
+    else
+        m_tester->RunTests( m_Messages );
+
     m_Notebook->ChangeSelection( 0 );       // display the 1at tab "...Markers ..."
 
 
@@ -113,6 +113,11 @@ DIALOG_DRC_CONTROL_BASE::DIALOG_DRC_CONTROL_BASE( wxWindow* parent, wxWindowID i
 	
 	bSizer7->Add( ReportFileSizer, 0, wxEXPAND|wxTOP|wxBOTTOM|wxRIGHT, 5 );
 	
+	m_cbChangedItemsOnly = new wxCheckBox( sbSizerOptions->GetStaticBox(), wxID_ANY, _("Test only the items changed since the last DRC"), wxDefaultPosition, wxDefaultSize, 0 );
+	m_cbChangedItemsOnly->SetToolTip( _("Keep the markers of the last DRC and only test the items added, moved or deleted since.\nZones are not refilled, and a full DRC is needed after a design rules change.") );
+	
+	bSizer7->Add( m_cbChangedItemsOnly, 0, wxALL, 5 );
+	
 	
 	sbSizerOptions->Add( bSizer7, 1, wxEXPAND, 5 );
 	
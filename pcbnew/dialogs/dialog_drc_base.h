@@ -64,6 +64,7 @@ class DIALOG_DRC_CONTROL_BASE : public DIALOG_SHIM
 		wxCheckBox* m_CreateRptCtrl;
 		wxTextCtrl* m_RptFilenameCtrl;
 		wxButton* m_BrowseButton;
+		wxCheckBox* m_cbChangedItemsOnly;
 		wxStaticText* m_staticText6;
 		wxTextCtrl* m_Messages;
 		wxButton* m_buttonRunDRC;
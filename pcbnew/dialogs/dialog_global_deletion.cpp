@@ -209,9 +209,8 @@ void DIALOG_GLOBAL_DELETION::AcceptPcbDelete()
                 pickersList.PushItem( itemPicker );
                 static_cast<MODULE*>( item )->RunOnChildren(
                         std::bind( &KIGFX::VIEW_ITEM::ViewRelease, _1 ) );
-                ratsnest->Remove( item );
                 item->ViewRelease();
-                item->UnLink();
+                pcb->Remove( item );        // updates the ratsnest and the footprint index
                 gen_rastnest = true;
             }
         }
@@ -28,6 +28,9 @@
  * @file drc.cpp
  */
 
+#include <algorithm>
+#include <map>
+
 #include <fctsys.h>
 #include <wxPcbStruct.h>
 #include <trigo.h>
@@ -39,20 +42,29 @@
 #include <class_pad.h>
 #include <class_zone.h>
 #include <class_pcb_text.h>
+#include <class_marker_pcb.h>
 #include <class_draw_panel_gal.h>
 #include <view/view.h>
 #include <geometry/seg.h>
+#include <ratsnest_data.h>
 
 #include <tool/tool_manager.h>
 #include <tools/common_actions.h>
 
 #include <pcbnew.h>
+#include <zones.h>
 #include <drc_stuff.h>
 
 #include <dialog_drc.h>
 #include <wx/progdlg.h>
 
 
+/* Extra distance added to the spatial index search areas, so that rounding in the
+ * clearance calculations can never make a test miss an item the list scan would find.
+ */
+static const int DRC_INDEX_MARGIN = 10;
+
+
 void DRC::ShowDRCDialog( wxWindow* aParent )
 {
     bool show_dlg_modal = true;
@@ -104,10 +116,17 @@ void DRC::DestroyDRCDialog( int aReason )
 }
 
 
-DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
+DRC::DRC( PCB_EDIT_FRAME* aPcbWindow ) :
+    DRC( aPcbWindow->GetBoard() )
 {
     m_pcbEditorFrame = aPcbWindow;
-    m_pcb = aPcbWindow->GetBoard();
+}
+
+
+DRC::DRC( BOARD* aBoard )
+{
+    m_pcbEditorFrame = NULL;
+    m_pcb = aBoard;
     m_drcDialog  = NULL;
 
     // establish initial values for everything:
@@ -115,6 +134,7 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
     m_doUnconnectedTest = true;     // enable unconnected tests
     m_doZonesTest = true;           // enable zone to items clearance tests
     m_doKeepoutTest = true;         // enable keepout areas to items clearance tests
+    m_useSpatialIndex = true;       // use a spatial index to find items to test
     m_abortDRC = false;
     m_drcInProgress = false;
 
@@ -123,6 +143,39 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
     // m_rptFilename set to empty by its constructor
 
     m_currentMarker = NULL;
+    m_testedBoard = NULL;
+    m_testErrorBase = 0;
+
+    m_segmAngle  = 0;
+    m_segmLength = 0;
+
+    m_xcliplo = 0;
+    m_ycliplo = 0;
+    m_xcliphi = 0;
+    m_ycliphi = 0;
+}
+
+
+DRC::DRC( const DRC& aMaster ) :
+    m_spatialIndex( aMaster.m_spatialIndex )
+{
+    m_pcbEditorFrame = aMaster.m_pcbEditorFrame;
+    m_pcb = aMaster.m_pcb;
+    m_drcDialog = NULL;
+
+    m_doPad2PadTest     = aMaster.m_doPad2PadTest;
+    m_doUnconnectedTest = aMaster.m_doUnconnectedTest;
+    m_doZonesTest       = aMaster.m_doZonesTest;
+    m_doKeepoutTest     = aMaster.m_doKeepoutTest;
+    m_useSpatialIndex   = aMaster.m_useSpatialIndex;
+    m_abortDRC = false;
+    m_drcInProgress = false;
+
+    m_doCreateRptFile = false;
+
+    m_currentMarker = NULL;
+    m_testedBoard = NULL;
+    m_testErrorBase = 0;
 
     m_segmAngle  = 0;
     m_segmLength = 0;
@@ -185,10 +238,14 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 {
     // be sure m_pcb is the current board, not a old one
     // ( the board can be reloaded )
-    m_pcb = m_pcbEditorFrame->GetBoard();
+    if( m_pcbEditorFrame )
+        m_pcb = m_pcbEditorFrame->GetBoard();
 
-    // Ensure ratsnest is up to date:
-    if( (m_pcb->m_Status_Pcb & LISTE_RATSNEST_ITEM_OK) == 0 )
+    m_testStats.clear();
+
+    // Ensure ratsnest is up to date (in batch mode, testUnconnected() builds
+    // the ratsnest data itself):
+    if( m_pcbEditorFrame && (m_pcb->m_Status_Pcb & LISTE_RATSNEST_ITEM_OK) == 0 )
     {
         if( aMessages )
         {
@@ -196,12 +253,27 @@ void DRC::RunTests( wxTextCtrl* aMessages )
             wxSafeYield();
         }
 
+        beginTest();
         m_pcbEditorFrame->Compile_Ratsnest( NULL, true );
+        endTest( wxT( "ratsnest" ), m_pcb->GetPadCount() );
     }
 
     // someone should have cleared the two lists before calling this.
 
-    if( !testNetClasses() )
+    if( m_useSpatialIndex )
+    {
+        beginTest();
+        m_spatialIndex.reset( new DRC_SPATIAL_INDEX );
+        m_spatialIndex->Build( m_pcb );
+        endTest( wxT( "spatial_index" ), m_spatialIndex->GetPadCount()
+                                         + m_spatialIndex->GetTrackCount() );
+    }
+
+    beginTest();
+    bool netclassesOk = testNetClasses();
+    endTest( wxT( "netclasses" ), m_pcb->GetDesignSettings().m_NetClasses.GetCount() + 1 );
+
+    if( !netclassesOk )
     {
         // testing the netclasses is a special case because if the netclasses
         // do not pass the BOARD_DESIGN_SETTINGS checks, then every member of a net
@@ -212,6 +284,8 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 
         // update the m_drcDialog listboxes
         updatePointers();
+        m_spatialIndex.reset();
+        m_testedBoard = NULL;
 
         return;
     }
@@ -225,7 +299,9 @@ void DRC::RunTests( wxTextCtrl* aMessages )
             wxSafeYield();
         }
 
+        beginTest();
         testPad2Pad();
+        endTest( wxT( "pad_clearances" ), m_pcb->GetPadCount() );
     }
 
     // test track and via clearances to other tracks, pads, and vias
@@ -235,7 +311,9 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
-    testTracks( aMessages ? aMessages->GetParent() : m_pcbEditorFrame, true );
+    beginTest();
+    testTracks( aMessages ? aMessages->GetParent() : m_pcbEditorFrame, m_pcbEditorFrame != NULL );
+    endTest( wxT( "track_clearances" ), m_pcb->m_Track.GetCount() );
 
     // Before testing segments and unconnected, refill all zones:
     // this is a good caution, because filled areas can be outdated.
@@ -245,8 +323,15 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
-    m_pcbEditorFrame->Fill_All_Zones( aMessages ? aMessages->GetParent() : m_pcbEditorFrame,
-                                  false );
+    beginTest();
+
+    if( m_pcbEditorFrame )
+        m_pcbEditorFrame->Fill_All_Zones( aMessages ? aMessages->GetParent() : m_pcbEditorFrame,
+                                          false );
+    else
+        fillAllZones();
+
+    endTest( wxT( "zone_fill" ), m_pcb->GetAreaCount() );
 
     // test zone clearances to other zones
     if( aMessages )
@@ -255,7 +340,9 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
+    beginTest();
     testZones();
+    endTest( wxT( "zones" ), m_pcb->GetAreaCount() );
 
     // find and gather unconnected pads.
     if( m_doUnconnectedTest )
@@ -266,7 +353,9 @@ void DRC::RunTests( wxTextCtrl* aMessages )
             aMessages->Refresh();
         }
 
+        beginTest();
         testUnconnected();
+        endTest( wxT( "unconnected" ), m_pcb->GetPadCount() );
     }
 
     // find and gather vias, tracks, pads inside keepout areas.
@@ -278,7 +367,9 @@ void DRC::RunTests( wxTextCtrl* aMessages )
             aMessages->Refresh();
         }
 
+        beginTest();
         testKeepoutAreas();
+        endTest( wxT( "keepout_areas" ), m_pcb->GetAreaCount() );
     }
 
     // find and gather vias, tracks, pads inside text boxes.
@@ -288,7 +379,17 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
+    beginTest();
     testTexts();
+    endTest( wxT( "texts" ), m_pcb->m_Drawings.GetCount() );
+
+    // the index is a snapshot of the board, do not keep it after the tests.
+    m_spatialIndex.reset();
+
+    // the markers now describe the whole board: the next incremental run only has
+    // to test the items changed from now on (zones were changed by the refill).
+    m_pcb->ClearChangedItems();
+    m_testedBoard = m_pcb;
 
     // update the m_drcDialog listboxes
     updatePointers();
@@ -311,10 +412,423 @@ void DRC::ListUnconnectedPads()
 }
 
 
+/**
+ * Function isClearanceMarker
+ * @return true if aMarker was created by the pad to pad or the track clearance
+ * tests, i.e. by the tests RunIncrementalTests() runs only for the changed items.
+ */
+static bool isClearanceMarker( const MARKER_PCB* aMarker )
+{
+    switch( aMarker->GetReporter().GetErrorCode() )
+    {
+    case DRCE_TRACK_NEAR_THROUGH_HOLE:
+    case DRCE_TRACK_NEAR_PAD:
+    case DRCE_TRACK_NEAR_VIA:
+    case DRCE_VIA_NEAR_VIA:
+    case DRCE_VIA_NEAR_TRACK:
+    case DRCE_TRACK_ENDS1:
+    case DRCE_TRACK_ENDS2:
+    case DRCE_TRACK_ENDS3:
+    case DRCE_TRACK_ENDS4:
+    case DRCE_TRACK_SEGMENTS_TOO_CLOSE:
+    case DRCE_TRACKS_CROSSING:
+    case DRCE_ENDS_PROBLEM1:
+    case DRCE_ENDS_PROBLEM2:
+    case DRCE_ENDS_PROBLEM3:
+    case DRCE_ENDS_PROBLEM4:
+    case DRCE_ENDS_PROBLEM5:
+    case DRCE_PAD_NEAR_PAD1:
+    case DRCE_VIA_HOLE_BIGGER:
+    case DRCE_MICRO_VIA_INCORRECT_LAYER_PAIR:
+    case DRCE_HOLE_NEAR_PAD:
+    case DRCE_TOO_SMALL_TRACK_WIDTH:
+    case DRCE_TOO_SMALL_VIA:
+    case DRCE_TOO_SMALL_MICROVIA:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+
+void DRC::removeMarkers( std::set<const BOARD_ITEM*>* aItems )
+{
+    KIGFX::VIEW* view = m_pcbEditorFrame ? m_pcbEditorFrame->GetGalCanvas()->GetView() : NULL;
+    std::vector<MARKER_PCB*> obsolete;
+    std::vector<bool> isObsolete( m_pcb->GetMARKERCount(), aItems == NULL );
+
+    if( aItems )
+    {
+        // A clearance marker is reported by one of its two items only, so when a marker
+        // is removed, both of its items must be tested again to find the conflicts it
+        // was hiding.  This can make other markers obsolete: iterate until the set of
+        // items to test is stable.
+        bool changed = true;
+
+        while( changed )
+        {
+            changed = false;
+
+            for( int ii = 0; ii < m_pcb->GetMARKERCount(); ++ii )
+            {
+                const MARKER_PCB* marker = m_pcb->GetMARKER( ii );
+
+                if( isObsolete[ii] )
+                    continue;
+
+                if( isClearanceMarker( marker )
+                    && !aItems->count( marker->GetItem() )
+                    && !aItems->count( marker->GetAuxItem() ) )
+                    continue;
+
+                isObsolete[ii] = true;
+
+                if( !isClearanceMarker( marker ) )
+                    continue;
+
+                if( marker->GetItem() && aItems->insert( marker->GetItem() ).second )
+                    changed = true;
+
+                if( marker->GetAuxItem() && aItems->insert( marker->GetAuxItem() ).second )
+                    changed = true;
+            }
+        }
+    }
+
+    for( int ii = 0; ii < m_pcb->GetMARKERCount(); ++ii )
+    {
+        if( isObsolete[ii] )
+            obsolete.push_back( m_pcb->GetMARKER( ii ) );
+    }
+
+    for( unsigned ii = 0; ii < obsolete.size(); ++ii )
+    {
+        if( view )
+            view->Remove( obsolete[ii] );
+
+        m_pcb->Delete( obsolete[ii] );
+    }
+}
+
+
+void DRC::RunIncrementalTests( wxTextCtrl* aMessages )
+{
+    // be sure m_pcb is the current board, not a old one
+    // ( the board can be reloaded )
+    if( m_pcbEditorFrame )
+        m_pcb = m_pcbEditorFrame->GetBoard();
+
+    // the unconnected pads are always searched again
+    for( unsigned ii = 0; ii < m_unconnected.size(); ++ii )
+        delete m_unconnected[ii];
+
+    m_unconnected.clear();
+
+    if( m_testedBoard != m_pcb )
+    {
+        // No results to update: test the whole board.
+        removeMarkers( NULL );
+        RunTests( aMessages );
+        return;
+    }
+
+    // Ensure ratsnest is up to date:
+    if( m_pcbEditorFrame && (m_pcb->m_Status_Pcb & LISTE_RATSNEST_ITEM_OK) == 0 )
+    {
+        if( aMessages )
+        {
+            aMessages->AppendText( _( "Compile ratsnest...\n" ) );
+            wxSafeYield();
+        }
+
+        m_pcbEditorFrame->Compile_Ratsnest( NULL, true );
+    }
+
+    // The items to test again.  Some of them can be deleted items: they are only used
+    // as keys, never dereferenced.
+    std::set<const BOARD_ITEM*> items = m_pcb->GetChangedItems();
+    m_pcb->ClearChangedItems();
+
+    m_spatialIndex.reset( new DRC_SPATIAL_INDEX );
+    m_spatialIndex->Build( m_pcb );
+
+    const int margin = m_spatialIndex->GetMaxClearance() + DRC_INDEX_MARGIN;
+    std::vector<int> found;
+
+    // Pads are tested against tracks by the track tests: the tracks near a changed
+    // pad have to be tested again.
+    for( std::set<const BOARD_ITEM*>::const_iterator it = items.begin(); it != items.end(); ++it )
+    {
+        int idx = m_spatialIndex->GetPadIndex( *it );
+
+        if( idx < 0 )
+            continue;
+
+        m_spatialIndex->QueryTracks( DRC_SPATIAL_INDEX::PadArea( m_spatialIndex->GetPad( idx ),
+                                                                 margin ),
+                                     LSET::AllCuMask(), found );
+
+        for( unsigned ii = 0; ii < found.size(); ++ii )
+            items.insert( m_spatialIndex->GetTrack( found[ii] ) );
+    }
+
+    if( aMessages )
+    {
+        aMessages->AppendText( _( "Remove obsolete markers...\n" ) );
+        wxSafeYield();
+    }
+
+    removeMarkers( &items );
+
+    // Flag the items still on the board, so each pair of them is tested only once,
+    // by the one with the lowest ordinal, like RunTests() does.
+    std::vector<bool> padToTest( m_spatialIndex->GetPadCount(), false );
+    std::vector<bool> trackToTest( m_spatialIndex->GetTrackCount(), false );
+
+    for( std::set<const BOARD_ITEM*>::const_iterator it = items.begin(); it != items.end(); ++it )
+    {
+        int idx = m_spatialIndex->GetPadIndex( *it );
+
+        if( idx >= 0 )
+            padToTest[idx] = true;
+
+        idx = m_spatialIndex->GetTrackIndex( *it );
+
+        if( idx >= 0 )
+            trackToTest[idx] = true;
+    }
+
+    if( m_doPad2PadTest )
+    {
+        if( aMessages )
+        {
+            aMessages->AppendText( _( "Pad clearances...\n" ) );
+            wxSafeYield();
+        }
+
+        // Like testPad2Pad(), test each pair of pads from the first one in the list sorted
+        // by X then Y coordinates, against the next ones in this order, so the incremental
+        // run reports the same markers as a full run.
+        std::vector<D_PAD*> sortedPads;
+
+        m_pcb->GetSortedPadListByXthenYCoord( sortedPads );
+
+        int maxSize = 0;
+
+        for( unsigned i = 0; i < sortedPads.size(); ++i )
+            maxSize = std::max( maxSize, sortedPads[i]->GetBoundingRadius() );
+
+        std::vector<int> rank( m_spatialIndex->GetPadCount(), -1 );
+
+        for( unsigned i = 0; i < sortedPads.size(); ++i )
+        {
+            int index = m_spatialIndex->GetPadIndex( sortedPads[i] );
+
+            if( index >= 0 )
+                rank[index] = i;
+        }
+
+        // The ranks of the pads to test against each reference pad (by rank).  The pairs
+        // of unchanged pads are not tested again.
+        std::map< int, std::vector<int> > refCandidates;
+
+        for( unsigned idx = 0; idx < padToTest.size(); ++idx )
+        {
+            if( !padToTest[idx] || rank[idx] < 0 )
+                continue;
+
+            D_PAD* pad = m_spatialIndex->GetPad( idx );
+            int    refRank = rank[idx];
+
+            m_spatialIndex->QueryPads( DRC_SPATIAL_INDEX::PadArea( pad, margin ), found );
+
+            for( unsigned ii = 0; ii < found.size(); ++ii )
+            {
+                int other = found[ii];
+                int otherRank = rank[other];
+
+                if( otherRank < 0 || otherRank == refRank )
+                    continue;
+
+                if( otherRank > refRank )
+                    refCandidates[refRank].push_back( otherRank );
+                else if( !padToTest[other] )
+                    refCandidates[otherRank].push_back( refRank );
+
+                // else the other pad is changed too, and tests this one
+            }
+        }
+
+        std::vector<D_PAD*> candidates;
+
+        for( std::map< int, std::vector<int> >::iterator it = refCandidates.begin();
+             it != refCandidates.end(); ++it )
+        {
+            std::vector<int>& ranks = it->second;
+
+            if( ranks.empty() )
+                continue;
+
+            std::sort( ranks.begin(), ranks.end() );
+            ranks.erase( std::unique( ranks.begin(), ranks.end() ), ranks.end() );
+
+            candidates.clear();
+
+            for( unsigned ii = 0; ii < ranks.size(); ++ii )
+                candidates.push_back( sortedPads[ ranks[ii] ] );
+
+            D_PAD* pad = sortedPads[it->first];
+            int    x_limit = maxSize + pad->GetClearance() +
+                             pad->GetBoundingRadius() + pad->GetPosition().x;
+
+            if( !doPadToPadsDrc( pad, &candidates[0], &candidates[0] + candidates.size(),
+                                 x_limit ) )
+            {
+                wxASSERT( m_currentMarker );
+                addMarkerToPcb( m_currentMarker );
+                m_currentMarker = NULL;
+            }
+        }
+    }
+
+    if( aMessages )
+    {
+        aMessages->AppendText( _( "Track clearances...\n" ) );
+        wxSafeYield();
+    }
+
+    std::vector<D_PAD*> pads;
+    std::vector<TRACK*> tracks;
+
+    for( unsigned idx = 0; idx < trackToTest.size(); ++idx )
+    {
+        if( !trackToTest[idx] )
+            continue;
+
+        TRACK*   track = m_spatialIndex->GetTrack( idx );
+        EDA_RECT area = DRC_SPATIAL_INDEX::TrackArea( track, margin );
+
+        m_spatialIndex->QueryPads( area, found );
+        pads.clear();
+
+        for( unsigned ii = 0; ii < found.size(); ++ii )
+            pads.push_back( m_spatialIndex->GetPad( found[ii] ) );
+
+        m_spatialIndex->QueryTracks( area, track->GetLayerSet(), found );
+        tracks.clear();
+
+        for( unsigned ii = 0; ii < found.size(); ++ii )
+        {
+            int other = found[ii];
+
+            if( other != (int) idx && !( other < (int) idx && trackToTest[other] ) )
+                tracks.push_back( m_spatialIndex->GetTrack( other ) );
+        }
+
+        if( !doTrackDrc( track, pads, tracks ) )
+        {
+            wxASSERT( m_currentMarker );
+            addMarkerToPcb( m_currentMarker );
+            m_currentMarker = NULL;
+        }
+    }
+
+    // The board level tests are cheap compared to the clearance tests: run them again.
+    if( testNetClasses() )
+    {
+        if( aMessages )
+        {
+            aMessages->AppendText( _( "Test zones...\n" ) );
+            wxSafeYield();
+        }
+
+        testZones();
+
+        if( m_doUnconnectedTest )
+        {
+            if( aMessages )
+            {
+                aMessages->AppendText( _( "Unconnected pads...\n" ) );
+                aMessages->Refresh();
+            }
+
+            testUnconnected();
+        }
+
+        if( m_doKeepoutTest )
+        {
+            if( aMessages )
+            {
+                aMessages->AppendText( _( "Keepout areas ...\n" ) );
+                aMessages->Refresh();
+            }
+
+            testKeepoutAreas();
+        }
+
+        if( aMessages )
+        {
+            aMessages->AppendText( _( "Test texts...\n" ) );
+            wxSafeYield();
+        }
+
+        testTexts();
+    }
+
+    m_spatialIndex.reset();
+
+    // update the m_drcDialog listboxes
+    updatePointers();
+
+    if( aMessages )
+        aMessages->AppendText( _( "Finished" ) );
+}
+
+
+void DRC::addMarkerToPcb( MARKER_PCB* aMarker )
+{
+    m_pcb->Add( aMarker );
+
+    if( m_pcbEditorFrame )
+        m_pcbEditorFrame->GetGalCanvas()->GetView()->Add( aMarker );
+}
+
+
+void DRC::beginTest()
+{
+    m_testErrorBase = GetErrorCount();
+    prof_start( &m_testTimer );
+}
+
+
+void DRC::endTest( const wxString& aName, int aItemCount )
+{
+    prof_end( &m_testTimer );
+
+    DRC_TEST_STATS stats;
+
+    stats.m_Name       = aName;
+    stats.m_ItemCount  = aItemCount;
+    stats.m_ErrorCount = GetErrorCount() - m_testErrorBase;
+    stats.m_Msecs      = m_testTimer.msecs();
+
+    m_testStats.push_back( stats );
+}
+
+
+int DRC::GetErrorCount() const
+{
+    return m_pcb->GetMARKERCount() + (int) m_unconnected.size();
+}
+
+
 void DRC::updatePointers()
 {
     // update my pointers, m_pcbEditorFrame is the only unchangeable one
-    m_pcb = m_pcbEditorFrame->GetBoard();
+    // (in batch mode, there is no frame and the board does not change)
+    if( m_pcbEditorFrame )
+        m_pcb = m_pcbEditorFrame->GetBoard();
 
     if( m_drcDialog )  // Use diag list boxes only in DRC dialog
     {
@@ -342,8 +856,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_CLEARANCE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_pcbEditorFrame->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -358,8 +871,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_TRACKWIDTH, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_pcbEditorFrame->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -373,8 +885,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_VIASIZE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_pcbEditorFrame->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -388,8 +899,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_VIADRILLSIZE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_pcbEditorFrame->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -403,8 +913,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_uVIASIZE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_pcbEditorFrame->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -418,8 +927,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_uVIADRILLSIZE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_pcbEditorFrame->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -457,7 +965,12 @@ void DRC::testPad2Pad()
 
     m_pcb->GetSortedPadListByXthenYCoord( sortedPads );
 
+    if( sortedPads.empty() )
+        return;
+
     // find the max size of the pads (used to stop the test)
+    // This also ensures the bounding radius of each pad is calculated before the pads
+    // are shared by the test threads.
     int max_size = 0;
 
     for( unsigned i = 0; i < sortedPads.size(); ++i )
@@ -470,23 +983,55 @@ void DRC::testPad2Pad()
             max_size = radius;
     }
 
-    // Test the pads
-    D_PAD** listEnd = &sortedPads[ sortedPads.size() ];
+    // When the spatial index is used, the candidates found near each pad are tested
+    // in the sorted list order, so rank[] gives the position in sortedPads of each
+    // indexed pad.
+    std::vector<int> rank;
 
-    for( unsigned i = 0; i< sortedPads.size(); ++i )
+    if( m_spatialIndex )
     {
-        D_PAD* pad = sortedPads[i];
+        rank.resize( m_spatialIndex->GetPadCount(), -1 );
 
-        int    x_limit = max_size + pad->GetClearance() +
-                         pad->GetBoundingRadius() + pad->GetPosition().x;
+        for( unsigned i = 0; i < sortedPads.size(); ++i )
+        {
+            int index = m_spatialIndex->GetPadIndex( sortedPads[i] );
+
+            if( index >= 0 )
+                rank[index] = i;
+        }
+    }
 
-        if( !doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit ) )
+    // Test the pads.
+    // Each pad is tested by one thread, which stores the marker (if any) in the pad slot.
+    // The markers are then added to the board in the pad order, like a sequential test does.
+    std::vector<MARKER_PCB*> markers( sortedPads.size(), (MARKER_PCB*) NULL );
+    int padCount = sortedPads.size();
+    int i;
+
+#ifdef USE_OPENMP
+    #pragma omp parallel private(i)
+#endif
+    {
+        DRC worker( *this );
+
+#ifdef USE_OPENMP
+        #pragma omp for schedule(dynamic, 64)
+#endif
+        for( i = 0; i < padCount; ++i )
         {
-            wxASSERT( m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_pcbEditorFrame->GetGalCanvas()->GetView()->Add( m_currentMarker );
-            m_currentMarker = 0;
+            if( !worker.doSortedPadDrc( sortedPads, rank, i, max_size ) )
+            {
+                wxASSERT( worker.m_currentMarker );
+                markers[i] = worker.m_currentMarker;
+                worker.m_currentMarker = 0;
+            }
         }
+    }   /* end of parallel section */
+
+    for( unsigned ii = 0; ii < markers.size(); ++ii )
+    {
+        if( markers[ii] )
+            addMarkerToPcb( markers[ii] );
     }
 }
 
@@ -496,10 +1041,21 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
     wxProgressDialog * progressDialog = NULL;
     const int delta = 500;  // This is the number of tests between 2 calls to the
                             // progress bar
-    int count = 0;
+
+    // The last segment is not used as reference, it is tested by all the others
+    std::vector<TRACK*> segments;
+
     for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
-        count++;
+        segments.push_back( segm );
+
+    // D_PAD::GetBoundingRadius() caches its value: compute it for every pad now, because
+    // the pads are shared by the test threads (testPad2Pad() does it when it is enabled).
+    const D_PADS& pads = m_pcb->GetPads();
 
+    for( unsigned ii = 0; ii < pads.size(); ++ii )
+        pads[ii]->GetBoundingRadius();
+
+    int count = segments.size();
     int deltamax = count/delta;
 
     if( aShowProgressBar && deltamax > 3 )
@@ -511,34 +1067,60 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
         progressDialog->Update( 0, wxEmptyString );
     }
 
-    int ii = 0;
-    count = 0;
+    // The segments are tested by blocks of delta segments, so the progress bar is
+    // updated by this thread between 2 blocks.
+    // Inside a block, each segment is tested by one thread, which stores the marker
+    // (if any) in the segment slot.  The markers are then added to the board in the
+    // segment order, like a sequential test does.
+    std::vector<MARKER_PCB*> markers;
 
-    for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
+    for( int first = 0, step = 0; first < count; first += delta, ++step )
     {
-        if ( ii++ > delta )
+        if( progressDialog && step > 0 )
         {
-            ii = 0;
-            count++;
-
-            if( progressDialog )
-            {
-                if( !progressDialog->Update( count, wxEmptyString ) )
-                    break;  // Aborted by user
+            if( !progressDialog->Update( step, wxEmptyString ) )
+                break;  // Aborted by user
 #ifdef __WXMAC__
-                // Work around a dialog z-order issue on OS X
-                if( count == deltamax )
-                    aActiveWindow->Raise();
+            // Work around a dialog z-order issue on OS X
+            if( step == deltamax )
+                aActiveWindow->Raise();
 #endif
-            }
         }
 
-        if( !doTrackDrc( segm, segm->Next(), true ) )
+        int last = std::min( first + delta, count );
+        int ii;
+
+        markers.assign( last - first, (MARKER_PCB*) NULL );
+
+#ifdef USE_OPENMP
+        #pragma omp parallel private(ii)
+#endif
         {
-            wxASSERT( m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_pcbEditorFrame->GetGalCanvas()->GetView()->Add( m_currentMarker );
-            m_currentMarker = 0;
+            DRC worker( *this );
+
+#ifdef USE_OPENMP
+            #pragma omp for schedule(dynamic, 16)
+#endif
+            for( ii = first; ii < last; ++ii )
+            {
+                TRACK* segm = segments[ii];
+
+                bool ok = m_spatialIndex ? worker.doTrackDrcIndexed( segm )
+                                         : worker.doTrackDrc( segm, segm->Next(), true );
+
+                if( !ok )
+                {
+                    wxASSERT( worker.m_currentMarker );
+                    markers[ii - first] = worker.m_currentMarker;
+                    worker.m_currentMarker = 0;
+                }
+            }
+        }   /* end of parallel section */
+
+        for( unsigned jj = 0; jj < markers.size(); ++jj )
+        {
+            if( markers[jj] )
+                addMarkerToPcb( markers[jj] );
         }
     }
 
@@ -549,6 +1131,12 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
 
 void DRC::testUnconnected()
 {
+    if( !m_pcbEditorFrame )
+    {
+        testUnconnectedRatsnestData();
+        return;
+    }
+
     if( (m_pcb->m_Status_Pcb & LISTE_RATSNEST_ITEM_OK) == 0 )
     {
         wxClientDC dc( m_pcbEditorFrame->GetCanvas() );
@@ -582,6 +1170,68 @@ void DRC::testUnconnected()
 }
 
 
+void DRC::testUnconnectedRatsnestData()
+{
+    // The legacy ratsnest is built by the editor frame: in batch mode, the missing
+    // connections are given by the ratsnest data of the board.
+    RN_DATA* ratsnest = m_pcb->GetRatsnest();
+
+    ratsnest->ProcessBoard();
+    ratsnest->Recalculate();
+
+    wxString msg;
+
+    for( int netcode = 1; netcode < ratsnest->GetNetCount(); ++netcode )
+    {
+        const std::vector<RN_EDGE_MST_PTR>* edges = ratsnest->GetNet( netcode ).GetUnconnected();
+
+        if( edges == NULL )
+            continue;
+
+        NETINFO_ITEM* net = m_pcb->FindNet( netcode );
+        wxString netname = net ? net->GetNetname() : wxString();
+
+        for( unsigned ii = 0; ii < edges->size(); ++ii )
+        {
+            const RN_NODE_PTR& source = (*edges)[ii]->GetSourceNode();
+            const RN_NODE_PTR& target = (*edges)[ii]->GetTargetNode();
+
+            wxPoint posStart( source->GetX(), source->GetY() );
+            wxPoint posEnd( target->GetX(), target->GetY() );
+
+            // The nodes are not always pads: they can be track ends or zones
+            D_PAD* padStart = m_pcb->GetPad( posStart, LSET::AllCuMask() );
+            D_PAD* padEnd   = m_pcb->GetPad( posEnd, LSET::AllCuMask() );
+
+            msg = padStart ? padStart->GetSelectMenuText() : wxString( _( "Track" ) );
+            msg += wxT( " net " ) + netname;
+
+            DRC_ITEM* uncItem = new DRC_ITEM( DRCE_UNCONNECTED_PADS,
+                                              msg,
+                                              padEnd ? padEnd->GetSelectMenuText()
+                                                     : wxString( _( "Track" ) ),
+                                              posStart, posEnd );
+
+            m_unconnected.push_back( uncItem );
+        }
+    }
+}
+
+
+void DRC::fillAllZones()
+{
+    // Same as PCB_EDIT_FRAME::Fill_All_Zones(), without the user interface
+    m_pcb->m_Zone.DeleteAll();
+
+    std::vector<ZONE_CONTAINER*> zones;
+
+    for( int ii = 0; ii < m_pcb->GetAreaCount(); ii++ )
+        zones.push_back( m_pcb->GetArea( ii ) );
+
+    BuildZonesFilledAreas( m_pcb, zones );
+}
+
+
 void DRC::testZones()
 {
     // Test copper areas for valid netcodes
@@ -611,8 +1261,7 @@ void DRC::testZones()
         {
             m_currentMarker = fillMarker( test_area,
                                           DRCE_SUSPICIOUS_NET_FOR_ZONE_OUTLINE, m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_pcbEditorFrame->GetGalCanvas()->GetView()->Add( m_currentMarker );
+            addMarkerToPcb( m_currentMarker );
             m_currentMarker = NULL;
         }
     }
@@ -624,6 +1273,9 @@ void DRC::testZones()
 
 void DRC::testKeepoutAreas()
 {
+    std::vector<TRACK*> tracks;
+    std::vector<int>    found;
+
     // Test keepout areas for vias, tracks and pads inside keepout areas
     for( int ii = 0; ii < m_pcb->GetAreaCount(); ii++ )
     {
@@ -632,8 +1284,29 @@ void DRC::testKeepoutAreas()
         if( !area->GetIsKeepout() )
             continue;
 
-        for( TRACK* segm = m_pcb->m_Track; segm != NULL; segm = segm->Next() )
+        // Gather the tracks to test, in board list order
+        tracks.clear();
+
+        if( m_spatialIndex )
+        {
+            EDA_RECT bbox = area->GetBoundingBox();
+            bbox.Inflate( DRC_INDEX_MARGIN );
+
+            m_spatialIndex->QueryTracks( bbox, LSET( area->GetLayer() ), found );
+
+            for( unsigned jj = 0; jj < found.size(); ++jj )
+                tracks.push_back( m_spatialIndex->GetTrack( found[jj] ) );
+        }
+        else
+        {
+            for( TRACK* segm = m_pcb->m_Track; segm != NULL; segm = segm->Next() )
+                tracks.push_back( segm );
+        }
+
+        for( unsigned jj = 0; jj < tracks.size(); ++jj )
         {
+            TRACK* segm = tracks[jj];
+
             if( segm->Type() == PCB_TRACE_T )
             {
                 if( ! area->GetDoNotAllowTracks()  )
@@ -647,8 +1320,7 @@ void DRC::testKeepoutAreas()
                 {
                     m_currentMarker = fillMarker( segm, NULL,
                                                   DRCE_TRACK_INSIDE_KEEPOUT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_pcbEditorFrame->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                    addMarkerToPcb( m_currentMarker );
                     m_currentMarker = 0;
                 }
             }
@@ -664,8 +1336,7 @@ void DRC::testKeepoutAreas()
                 {
                     m_currentMarker = fillMarker( segm, NULL,
                                                   DRCE_VIA_INSIDE_KEEPOUT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_pcbEditorFrame->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                    addMarkerToPcb( m_currentMarker );
                     m_currentMarker = 0;
                 }
             }
@@ -725,8 +1396,7 @@ void DRC::testTexts()
                         m_currentMarker = fillMarker( track, text,
                                                       DRCE_TRACK_INSIDE_TEXT,
                                                       m_currentMarker );
-                        m_pcb->Add( m_currentMarker );
-                        m_pcbEditorFrame->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                        addMarkerToPcb( m_currentMarker );
                         m_currentMarker = NULL;
                         break;
                     }
@@ -744,8 +1414,7 @@ void DRC::testTexts()
                     {
                         m_currentMarker = fillMarker( track, text,
                                                       DRCE_VIA_INSIDE_TEXT, m_currentMarker );
-                        m_pcb->Add( m_currentMarker );
-                        m_pcbEditorFrame->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                        addMarkerToPcb( m_currentMarker );
                         m_currentMarker = NULL;
                         break;
                     }
@@ -794,8 +1463,7 @@ void DRC::testTexts()
                 {
                     m_currentMarker = fillMarker( pad, text,
                                                   DRCE_PAD_INSIDE_TEXT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_pcbEditorFrame->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                    addMarkerToPcb( m_currentMarker );
                     m_currentMarker = NULL;
                     break;
                 }
@@ -805,6 +1473,36 @@ void DRC::testTexts()
 }
 
 
+bool DRC::doTrackDrcIndexed( TRACK* aRefSeg )
+{
+    std::vector<int>    found;
+    std::vector<D_PAD*> pads;
+    std::vector<TRACK*> tracks;
+
+    int      refIndex = m_spatialIndex->GetTrackIndex( aRefSeg );
+    EDA_RECT area = DRC_SPATIAL_INDEX::TrackArea( aRefSeg, m_spatialIndex->GetMaxClearance() +
+                                                           DRC_INDEX_MARGIN );
+
+    // pads are tested in board pad list order, whatever their layer (holes).
+    m_spatialIndex->QueryPads( area, found );
+
+    for( unsigned ii = 0; ii < found.size(); ++ii )
+        pads.push_back( m_spatialIndex->GetPad( found[ii] ) );
+
+    // only the tracks after aRefSeg in the board list are tested, in list order.
+    // Tracks on other layers than aRefSeg can not be in conflict with it.
+    m_spatialIndex->QueryTracks( area, aRefSeg->GetLayerSet(), found );
+
+    for( unsigned ii = 0; ii < found.size(); ++ii )
+    {
+        if( found[ii] > refIndex )
+            tracks.push_back( m_spatialIndex->GetTrack( found[ii] ) );
+    }
+
+    return doTrackDrc( aRefSeg, pads, tracks );
+}
+
+
 bool DRC::doTrackKeepoutDrc( TRACK* aRefSeg )
 {
     // Test keepout areas for vias, tracks and pads inside keepout areas
@@ -852,6 +1550,52 @@ bool DRC::doTrackKeepoutDrc( TRACK* aRefSeg )
 }
 
 
+bool DRC::doSortedPadDrc( std::vector<D_PAD*>& aSortedPads, const std::vector<int>& aRank,
+                          int aRefIdx, int aMaxSize )
+{
+    D_PAD* pad = aSortedPads[aRefIdx];
+
+    int    x_limit = aMaxSize + pad->GetClearance() +
+                     pad->GetBoundingRadius() + pad->GetPosition().x;
+
+    if( !m_spatialIndex )
+    {
+        D_PAD** listEnd = &aSortedPads[0] + aSortedPads.size();
+
+        return doPadToPadsDrc( pad, &aSortedPads[aRefIdx], listEnd, x_limit );
+    }
+
+    std::vector<int>    found;
+    std::vector<int>    ranks;
+    std::vector<D_PAD*> candidates;
+
+    EDA_RECT area = DRC_SPATIAL_INDEX::PadArea( pad, m_spatialIndex->GetMaxClearance() +
+                                                     DRC_INDEX_MARGIN );
+
+    m_spatialIndex->QueryPads( area, found );
+
+    for( unsigned ii = 0; ii < found.size(); ++ii )
+    {
+        int r = aRank[ found[ii] ];
+
+        // pads before this one in the sorted list were already tested against it
+        if( r >= aRefIdx )
+            ranks.push_back( r );
+    }
+
+    // The reference pad itself is always found
+    if( ranks.empty() )
+        return true;
+
+    std::sort( ranks.begin(), ranks.end() );
+
+    for( unsigned ii = 0; ii < ranks.size(); ++ii )
+        candidates.push_back( aSortedPads[ ranks[ii] ] );
+
+    return doPadToPadsDrc( pad, &candidates[0], &candidates[0] + candidates.size(), x_limit );
+}
+
+
 bool DRC::doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_limit )
 {
     const static LSET all_cu = LSET::AllCuMask();
@@ -984,3 +1728,122 @@ bool DRC::doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_li
 
     return true;
 }
+
+
+/**
+ * Function jsonString
+ * @return aText as a quoted JSON string, in UTF8.
+ */
+static std::string jsonString( const wxString& aText )
+{
+    std::string utf8 = TO_UTF8( aText );
+    std::string ret = "\"";
+
+    for( unsigned ii = 0; ii < utf8.size(); ++ii )
+    {
+        char c = utf8[ii];
+
+        switch( c )
+        {
+        case '"':   ret += "\\\"";  break;
+        case '\\':  ret += "\\\\";  break;
+        case '\n':  ret += "\\n";   break;
+        case '\r':  ret += "\\r";   break;
+        case '\t':  ret += "\\t";   break;
+
+        default:
+            if( (unsigned char) c < 0x20 )
+            {
+                char buf[8];
+                sprintf( buf, "\\u%04x", (unsigned char) c );
+                ret += buf;
+            }
+            else
+            {
+                ret += c;
+            }
+        }
+    }
+
+    return ret + "\"";
+}
+
+
+/**
+ * Function writeJsonDrcItem
+ * writes aItem as a JSON object.
+ */
+static void writeJsonDrcItem( FILE* aFile, const DRC_ITEM& aItem )
+{
+    fprintf( aFile, "    { \"code\": %d, \"description\": %s,\n", aItem.GetErrorCode(),
+             jsonString( aItem.GetErrorText() ).c_str() );
+
+    fprintf( aFile, "      \"items\": [ { \"text\": %s, \"x\": %.4f, \"y\": %.4f }",
+             jsonString( aItem.GetTextA() ).c_str(),
+             To_User_Unit( MILLIMETRES, aItem.GetPointA().x ),
+             To_User_Unit( MILLIMETRES, aItem.GetPointA().y ) );
+
+    if( aItem.HasSecondItem() )
+    {
+        fprintf( aFile, ",\n                 { \"text\": %s, \"x\": %.4f, \"y\": %.4f }",
+                 jsonString( aItem.GetTextB() ).c_str(),
+                 To_User_Unit( MILLIMETRES, aItem.GetPointB().x ),
+                 To_User_Unit( MILLIMETRES, aItem.GetPointB().y ) );
+    }
+
+    fprintf( aFile, " ] }" );
+}
+
+
+bool DRC::WriteJsonReport( const wxString& aFullFileName ) const
+{
+    FILE* fp = wxFopen( aFullFileName, wxT( "w" ) );
+
+    if( fp == NULL )
+        return false;
+
+    LOCALE_IO   toggle;     // use the C locale for the decimal separator
+    double      totalMsecs = 0.0;
+
+    fprintf( fp, "{\n  \"board\": %s,\n", jsonString( m_pcb->GetFileName() ).c_str() );
+    fprintf( fp, "  \"date\": %s,\n",
+             jsonString( wxDateTime::Now().Format( wxT( "%F %T" ) ) ).c_str() );
+    fprintf( fp, "  \"units\": \"mm\",\n" );
+
+    fprintf( fp, "  \"tests\": [\n" );
+
+    for( unsigned ii = 0; ii < m_testStats.size(); ++ii )
+    {
+        const DRC_TEST_STATS& stats = m_testStats[ii];
+
+        fprintf( fp, "    { \"name\": %s, \"items\": %d, \"errors\": %d, \"time_ms\": %.3f }%s\n",
+                 jsonString( stats.m_Name ).c_str(), stats.m_ItemCount, stats.m_ErrorCount,
+                 stats.m_Msecs, ii + 1 < m_testStats.size() ? "," : "" );
+
+        totalMsecs += stats.m_Msecs;
+    }
+
+    fprintf( fp, "  ],\n  \"total_time_ms\": %.3f,\n", totalMsecs );
+
+    fprintf( fp, "  \"markers\": [\n" );
+
+    for( int ii = 0; ii < m_pcb->GetMARKERCount(); ++ii )
+    {
+        writeJsonDrcItem( fp, m_pcb->GetMARKER( ii )->GetReporter() );
+        fprintf( fp, "%s\n", ii + 1 < m_pcb->GetMARKERCount() ? "," : "" );
+    }
+
+    fprintf( fp, "  ],\n  \"unconnected\": [\n" );
+
+    for( unsigned ii = 0; ii < m_unconnected.size(); ++ii )
+    {
+        writeJsonDrcItem( fp, *m_unconnected[ii] );
+        fprintf( fp, "%s\n", ii + 1 < m_unconnected.size() ? "," : "" );
+    }
+
+    fprintf( fp, "  ]\n}\n" );
+
+    fclose( fp );
+
+    return true;
+}
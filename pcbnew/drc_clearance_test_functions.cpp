@@ -136,7 +136,27 @@ bool convex2pointDRC( wxPoint* aTref, int aTrefCount, wxPoint aPcompare, int aDi
 
 bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
 {
-    TRACK*    track;
+    static const std::vector<D_PAD*> noPads;
+    static const std::vector<TRACK*> noTracks;
+
+    // The tracks are tested directly from the list: the online DRC calls this function
+    // for each move of the routed track, with the whole board track list.
+    if( !doTrackDrc( aRefSeg, testPads ? m_pcb->GetPads() : noPads, noTracks ) )
+        return false;
+
+    for( TRACK* track = aStart; track; track = track->Next() )
+    {
+        if( !checkClearanceSegmToSegm( aRefSeg, track ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+bool DRC::doTrackDrc( TRACK* aRefSeg, const std::vector<D_PAD*>& aPads,
+                      const std::vector<TRACK*>& aTracks )
+{
     wxPoint   delta;           // length on X and Y axis of segments
     LSET layerMask;
     int       net_code_ref;
@@ -258,62 +278,57 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     dummypad.SetLayerSet( LSET::AllCuMask() );     // Ensure the hole is on all layers
 
     // Compute the min distance to pads
-    if( testPads )
+    for( unsigned ii = 0;  ii < aPads.size();  ++ii )
     {
-        unsigned pad_count = m_pcb->GetPadCount();
+        D_PAD* pad = aPads[ii];
 
-        for( unsigned ii = 0;  ii<pad_count;  ++ii )
+        /* No problem if pads are on an other layer,
+         * But if a drill hole exists	(a pad on a single layer can have a hole!)
+         * we must test the hole
+         */
+        if( !( pad->GetLayerSet() & layerMask ).any() )
         {
-            D_PAD* pad = m_pcb->GetPad( ii );
-
-            /* No problem if pads are on an other layer,
-             * But if a drill hole exists	(a pad on a single layer can have a hole!)
-             * we must test the hole
+            /* We must test the pad hole. In order to use the function
+             * checkClearanceSegmToPad(),a pseudo pad is used, with a shape and a
+             * size like the hole
              */
-            if( !( pad->GetLayerSet() & layerMask ).any() )
-            {
-                /* We must test the pad hole. In order to use the function
-                 * checkClearanceSegmToPad(),a pseudo pad is used, with a shape and a
-                 * size like the hole
-                 */
-                if( pad->GetDrillSize().x == 0 )
-                    continue;
-
-                dummypad.SetSize( pad->GetDrillSize() );
-                dummypad.SetPosition( pad->GetPosition() );
-                dummypad.SetShape( pad->GetDrillShape()  == PAD_DRILL_SHAPE_OBLONG ?
-                                   PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
-                dummypad.SetOrientation( pad->GetOrientation() );
-
-                m_padToTestPos = dummypad.GetPosition() - origin;
-
-                if( !checkClearanceSegmToPad( &dummypad, aRefSeg->GetWidth(),
-                                              netclass->GetClearance() ) )
-                {
-                    m_currentMarker = fillMarker( aRefSeg, pad,
-                                                  DRCE_TRACK_NEAR_THROUGH_HOLE, m_currentMarker );
-                    return false;
-                }
-
+            if( pad->GetDrillSize().x == 0 )
                 continue;
-            }
 
-            // The pad must be in a net (i.e pt_pad->GetNet() != 0 )
-            // but no problem if the pad netcode is the current netcode (same net)
-            if( pad->GetNetCode()                       // the pad must be connected
-               && net_code_ref == pad->GetNetCode() )   // the pad net is the same as current net -> Ok
-                continue;
+            dummypad.SetSize( pad->GetDrillSize() );
+            dummypad.SetPosition( pad->GetPosition() );
+            dummypad.SetShape( pad->GetDrillShape()  == PAD_DRILL_SHAPE_OBLONG ?
+                               PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
+            dummypad.SetOrientation( pad->GetOrientation() );
 
-            // DRC for the pad
-            shape_pos = pad->ShapePos();
-            m_padToTestPos = shape_pos - origin;
+            m_padToTestPos = dummypad.GetPosition() - origin;
 
-            if( !checkClearanceSegmToPad( pad, aRefSeg->GetWidth(), aRefSeg->GetClearance( pad ) ) )
+            if( !checkClearanceSegmToPad( &dummypad, aRefSeg->GetWidth(),
+                                          netclass->GetClearance() ) )
             {
                 m_currentMarker = fillMarker( aRefSeg, pad,
-                                              DRCE_TRACK_NEAR_PAD, m_currentMarker );
+                                              DRCE_TRACK_NEAR_THROUGH_HOLE, m_currentMarker );
                 return false;
             }
+
+            continue;
+        }
+
+        // The pad must be in a net (i.e pt_pad->GetNet() != 0 )
+        // but no problem if the pad netcode is the current netcode (same net)
+        if( pad->GetNetCode()                       // the pad must be connected
+           && net_code_ref == pad->GetNetCode() )   // the pad net is the same as current net -> Ok
+            continue;
+
+        // DRC for the pad
+        shape_pos = pad->ShapePos();
+        m_padToTestPos = shape_pos - origin;
+
+        if( !checkClearanceSegmToPad( pad, aRefSeg->GetWidth(), aRefSeg->GetClearance( pad ) ) )
+        {
+            m_currentMarker = fillMarker( aRefSeg, pad,
+                                          DRCE_TRACK_NEAR_PAD, m_currentMarker );
+            return false;
         }
     }
 
@@ -324,237 +339,249 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     // At this point the reference segment is the X axis
 
     // Test the reference segment with other track segments
-    wxPoint segStartPoint;
-    wxPoint segEndPoint;
-    for( track = aStart; track; track = track->Next() )
+    for( unsigned ii = 0; ii < aTracks.size(); ++ii )
     {
-        // No problem if segments have the same net code:
-        if( net_code_ref == track->GetNetCode() )
-            continue;
+        if( !checkClearanceSegmToSegm( aRefSeg, aTracks[ii] ) )
+            return false;
+    }
 
-        // No problem if segment are on different layers :
-        if( !( layerMask & track->GetLayerSet() ).any() )
-            continue;
+    return true;
+}
 
-        // the minimum distance = clearance plus half the reference track
-        // width plus half the other track's width
-        int w_dist = aRefSeg->GetClearance( track );
-        w_dist += (aRefSeg->GetWidth() + track->GetWidth()) / 2;
 
-        // If the reference segment is a via, we test it here
-        if( aRefSeg->Type() == PCB_VIA_T )
-        {
-            delta = track->GetEnd() - track->GetStart();
-            segStartPoint = aRefSeg->GetStart() - track->GetStart();
+bool DRC::checkClearanceSegmToSegm( TRACK* aRefSeg, TRACK* aTrack )
+{
+    wxPoint origin = aRefSeg->GetStart();
+    wxPoint delta;
+    wxPoint segStartPoint;
+    wxPoint segEndPoint;
 
-            if( track->Type() == PCB_VIA_T )
-            {
-                // Test distance between two vias, i.e. two circles, trivial case
-                if( EuclideanNorm( segStartPoint ) < w_dist )
-                {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_VIA_NEAR_VIA, m_currentMarker );
-                    return false;
-                }
-            }
-            else    // test via to segment
-            {
-                // Compute l'angle du segment a tester;
-                double angle = ArcTangente( delta.y, delta.x );
+    // No problem if segments have the same net code:
+    if( aRefSeg->GetNetCode() == aTrack->GetNetCode() )
+        return true;
 
-                // Compute new coordinates ( the segment become horizontal)
-                RotatePoint( &delta, angle );
-                RotatePoint( &segStartPoint, angle );
+    // No problem if segment are on different layers :
+    if( !( aRefSeg->GetLayerSet() & aTrack->GetLayerSet() ).any() )
+        return true;
 
-                if( !checkMarginToCircle( segStartPoint, w_dist, delta.x ) )
-                {
-                    m_currentMarker = fillMarker( track, aRefSeg,
-                                                  DRCE_VIA_NEAR_TRACK, m_currentMarker );
-                    return false;
-                }
-            }
+    // the minimum distance = clearance plus half the reference track
+    // width plus half the other track's width
+    int w_dist = aRefSeg->GetClearance( aTrack );
+    w_dist += (aRefSeg->GetWidth() + aTrack->GetWidth()) / 2;
 
-            continue;
-        }
+    // If the reference segment is a via, we test it here
+    if( aRefSeg->Type() == PCB_VIA_T )
+    {
+        delta = aTrack->GetEnd() - aTrack->GetStart();
+        segStartPoint = aRefSeg->GetStart() - aTrack->GetStart();
 
-        /* We compute segStartPoint, segEndPoint = starting and ending point coordinates for
-         * the segment to test in the new axis : the new X axis is the
-         * reference segment.  We must translate and rotate the segment to test
-         */
-        segStartPoint = track->GetStart() - origin;
-        segEndPoint   = track->GetEnd() - origin;
-        RotatePoint( &segStartPoint, m_segmAngle );
-        RotatePoint( &segEndPoint, m_segmAngle );
-        if( track->Type() == PCB_VIA_T )
+        if( aTrack->Type() == PCB_VIA_T )
         {
-            if( checkMarginToCircle( segStartPoint, w_dist, m_segmLength ) )
-                continue;
-
-            m_currentMarker = fillMarker( aRefSeg, track,
-                                          DRCE_TRACK_NEAR_VIA, m_currentMarker );
-            return false;
+            // Test distance between two vias, i.e. two circles, trivial case
+            if( EuclideanNorm( segStartPoint ) < w_dist )
+            {
+                m_currentMarker = fillMarker( aRefSeg, aTrack,
+                                              DRCE_VIA_NEAR_VIA, m_currentMarker );
+                return false;
+            }
         }
-
-        /*	We have changed axis:
-         *  the reference segment is Horizontal.
-         *  3 cases : the segment to test can be parallel, perpendicular or have an other direction
-         */
-        if( segStartPoint.y == segEndPoint.y ) // parallel segments
+        else    // test via to segment
         {
-            if( abs( segStartPoint.y ) >= w_dist )
-                continue;
+            // Compute l'angle du segment a tester;
+            double angle = ArcTangente( delta.y, delta.x );
 
-            // Ensure segStartPoint.x <= segEndPoint.x
-            if( segStartPoint.x > segEndPoint.x )
-                std::swap( segStartPoint.x, segEndPoint.x );
+            // Compute new coordinates ( the segment become horizontal)
+            RotatePoint( &delta, angle );
+            RotatePoint( &segStartPoint, angle );
 
-            if( segStartPoint.x > (-w_dist) && segStartPoint.x < (m_segmLength + w_dist) )    /* possible error drc */
+            if( !checkMarginToCircle( segStartPoint, w_dist, delta.x ) )
             {
-                // the start point is inside the reference range
-                //      X........
-                //    O--REF--+
+                m_currentMarker = fillMarker( aTrack, aRefSeg,
+                                              DRCE_VIA_NEAR_TRACK, m_currentMarker );
+                return false;
+            }
+        }
 
-                // Fine test : we consider the rounded shape of each end of the track segment:
-                if( segStartPoint.x >= 0 && segStartPoint.x <= m_segmLength )
-                {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_TRACK_ENDS1, m_currentMarker );
-                    return false;
-                }
+        return true;
+    }
 
-                if( !checkMarginToCircle( segStartPoint, w_dist, m_segmLength ) )
-                {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_TRACK_ENDS2, m_currentMarker );
-                    return false;
-                }
-            }
+    /* We compute segStartPoint, segEndPoint = starting and ending point coordinates for
+     * the segment to test in the new axis : the new X axis is the
+     * reference segment.  We must translate and rotate the segment to test
+     */
+    segStartPoint = aTrack->GetStart() - origin;
+    segEndPoint   = aTrack->GetEnd() - origin;
+    RotatePoint( &segStartPoint, m_segmAngle );
+    RotatePoint( &segEndPoint, m_segmAngle );
+    if( aTrack->Type() == PCB_VIA_T )
+    {
+        if( checkMarginToCircle( segStartPoint, w_dist, m_segmLength ) )
+            return true;
 
-            if( segEndPoint.x > (-w_dist) && segEndPoint.x < (m_segmLength + w_dist) )
-            {
-                // the end point is inside the reference range
-                //  .....X
-                //    O--REF--+
-                // Fine test : we consider the rounded shape of the ends
-                if( segEndPoint.x >= 0 && segEndPoint.x <= m_segmLength )
-                {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_TRACK_ENDS3, m_currentMarker );
-                    return false;
-                }
+        m_currentMarker = fillMarker( aRefSeg, aTrack,
+                                      DRCE_TRACK_NEAR_VIA, m_currentMarker );
+        return false;
+    }
 
-                if( !checkMarginToCircle( segEndPoint, w_dist, m_segmLength ) )
-                {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_TRACK_ENDS4, m_currentMarker );
-                    return false;
-                }
-            }
+    /*	We have changed axis:
+     *  the reference segment is Horizontal.
+     *  3 cases : the segment to test can be parallel, perpendicular or have an other direction
+     */
+    if( segStartPoint.y == segEndPoint.y ) // parallel segments
+    {
+        if( abs( segStartPoint.y ) >= w_dist )
+            return true;
 
-            if( segStartPoint.x <=0 && segEndPoint.x >= 0 )
-            {
-            // the segment straddles the reference range (this actually only
-            // checks if it straddles the origin, because the other cases where already
-            // handled)
-            //  X.............X
+        // Ensure segStartPoint.x <= segEndPoint.x
+        if( segStartPoint.x > segEndPoint.x )
+            std::swap( segStartPoint.x, segEndPoint.x );
+
+        if( segStartPoint.x > (-w_dist) && segStartPoint.x < (m_segmLength + w_dist) )    /* possible error drc */
+        {
+            // the start point is inside the reference range
+            //      X........
             //    O--REF--+
-                m_currentMarker = fillMarker( aRefSeg, track,
-                                              DRCE_TRACK_SEGMENTS_TOO_CLOSE, m_currentMarker );
+
+            // Fine test : we consider the rounded shape of each end of the track segment:
+            if( segStartPoint.x >= 0 && segStartPoint.x <= m_segmLength )
+            {
+                m_currentMarker = fillMarker( aRefSeg, aTrack,
+                                              DRCE_TRACK_ENDS1, m_currentMarker );
                 return false;
             }
-        }
-        else if( segStartPoint.x == segEndPoint.x ) // perpendicular segments
-        {
-            if( ( segStartPoint.x <= (-w_dist) ) || ( segStartPoint.x >= (m_segmLength + w_dist) ) )
-                continue;
-
-            // Test if segments are crossing
-            if( segStartPoint.y > segEndPoint.y )
-                std::swap( segStartPoint.y, segEndPoint.y );
 
-            if( (segStartPoint.y < 0) && (segEndPoint.y > 0) )
+            if( !checkMarginToCircle( segStartPoint, w_dist, m_segmLength ) )
             {
-                m_currentMarker = fillMarker( aRefSeg, track,
-                                              DRCE_TRACKS_CROSSING, m_currentMarker );
+                m_currentMarker = fillMarker( aRefSeg, aTrack,
+                                              DRCE_TRACK_ENDS2, m_currentMarker );
                 return false;
             }
+        }
 
-            // At this point the drc error is due to an end near a reference segm end
-            if( !checkMarginToCircle( segStartPoint, w_dist, m_segmLength ) )
+        if( segEndPoint.x > (-w_dist) && segEndPoint.x < (m_segmLength + w_dist) )
+        {
+            // the end point is inside the reference range
+            //  .....X
+            //    O--REF--+
+            // Fine test : we consider the rounded shape of the ends
+            if( segEndPoint.x >= 0 && segEndPoint.x <= m_segmLength )
             {
-                m_currentMarker = fillMarker( aRefSeg, track,
-                                              DRCE_ENDS_PROBLEM1, m_currentMarker );
+                m_currentMarker = fillMarker( aRefSeg, aTrack,
+                                              DRCE_TRACK_ENDS3, m_currentMarker );
                 return false;
             }
+
             if( !checkMarginToCircle( segEndPoint, w_dist, m_segmLength ) )
             {
-                m_currentMarker = fillMarker( aRefSeg, track,
-                                              DRCE_ENDS_PROBLEM2, m_currentMarker );
+                m_currentMarker = fillMarker( aRefSeg, aTrack,
+                                              DRCE_TRACK_ENDS4, m_currentMarker );
                 return false;
             }
         }
-        else    // segments quelconques entre eux
+
+        if( segStartPoint.x <=0 && segEndPoint.x >= 0 )
         {
-            // calcul de la "surface de securite du segment de reference
-            // First rought 'and fast) test : the track segment is like a rectangle
+        // the segment straddles the reference range (this actually only
+        // checks if it straddles the origin, because the other cases where already
+        // handled)
+        //  X.............X
+        //    O--REF--+
+            m_currentMarker = fillMarker( aRefSeg, aTrack,
+                                          DRCE_TRACK_SEGMENTS_TOO_CLOSE, m_currentMarker );
+            return false;
+        }
+    }
+    else if( segStartPoint.x == segEndPoint.x ) // perpendicular segments
+    {
+        if( ( segStartPoint.x <= (-w_dist) ) || ( segStartPoint.x >= (m_segmLength + w_dist) ) )
+            return true;
 
-            m_xcliplo = m_ycliplo = -w_dist;
-            m_xcliphi = m_segmLength + w_dist;
-            m_ycliphi = w_dist;
+        // Test if segments are crossing
+        if( segStartPoint.y > segEndPoint.y )
+            std::swap( segStartPoint.y, segEndPoint.y );
+
+        if( (segStartPoint.y < 0) && (segEndPoint.y > 0) )
+        {
+            m_currentMarker = fillMarker( aRefSeg, aTrack,
+                                          DRCE_TRACKS_CROSSING, m_currentMarker );
+            return false;
+        }
+
+        // At this point the drc error is due to an end near a reference segm end
+        if( !checkMarginToCircle( segStartPoint, w_dist, m_segmLength ) )
+        {
+            m_currentMarker = fillMarker( aRefSeg, aTrack,
+                                          DRCE_ENDS_PROBLEM1, m_currentMarker );
+            return false;
+        }
+        if( !checkMarginToCircle( segEndPoint, w_dist, m_segmLength ) )
+        {
+            m_currentMarker = fillMarker( aRefSeg, aTrack,
+                                          DRCE_ENDS_PROBLEM2, m_currentMarker );
+            return false;
+        }
+    }
+    else    // segments quelconques entre eux
+    {
+        // calcul de la "surface de securite du segment de reference
+        // First rought 'and fast) test : the track segment is like a rectangle
+
+        m_xcliplo = m_ycliplo = -w_dist;
+        m_xcliphi = m_segmLength + w_dist;
+        m_ycliphi = w_dist;
+
+        // A fine test is needed because a serment is not exactly a
+        // rectangle, it has rounded ends
+        if( !checkLine( segStartPoint, segEndPoint ) )
+        {
+            /* 2eme passe : the track has rounded ends.
+             * we must a fine test for each rounded end and the
+             * rectangular zone
+             */
+
+            m_xcliplo = 0;
+            m_xcliphi = m_segmLength;
 
-            // A fine test is needed because a serment is not exactly a
-            // rectangle, it has rounded ends
             if( !checkLine( segStartPoint, segEndPoint ) )
             {
-                /* 2eme passe : the track has rounded ends.
-                 * we must a fine test for each rounded end and the
-                 * rectangular zone
+                m_currentMarker = fillMarker( aRefSeg, aTrack,
+                                              DRCE_ENDS_PROBLEM3, m_currentMarker );
+                return false;
+            }
+            else    // The drc error is due to the starting or the ending point of the reference segment
+            {
+                // Test the starting and the ending point
+                segStartPoint = aTrack->GetStart();
+                segEndPoint   = aTrack->GetEnd();
+                delta = segEndPoint - segStartPoint;
+
+                // Compute the segment orientation (angle) en 0,1 degre
+                double angle = ArcTangente( delta.y, delta.x );
+
+                // Compute the segment length: delta.x = length after rotation
+                RotatePoint( &delta, angle );
+
+                /* Comute the reference segment coordinates relatives to a
+                 *  X axis = current tested segment
                  */
+                wxPoint relStartPos = aRefSeg->GetStart() - segStartPoint;
+                wxPoint relEndPos   = aRefSeg->GetEnd() - segStartPoint;
 
-                m_xcliplo = 0;
-                m_xcliphi = m_segmLength;
+                RotatePoint( &relStartPos, angle );
+                RotatePoint( &relEndPos, angle );
 
-                if( !checkLine( segStartPoint, segEndPoint ) )
+                if( !checkMarginToCircle( relStartPos, w_dist, delta.x ) )
                 {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_ENDS_PROBLEM3, m_currentMarker );
+                    m_currentMarker = fillMarker( aRefSeg, aTrack,
+                                                  DRCE_ENDS_PROBLEM4, m_currentMarker );
                     return false;
                 }
-                else    // The drc error is due to the starting or the ending point of the reference segment
+
+                if( !checkMarginToCircle( relEndPos, w_dist, delta.x ) )
                 {
-                    // Test the starting and the ending point
-                    segStartPoint = track->GetStart();
-                    segEndPoint   = track->GetEnd();
-                    delta = segEndPoint - segStartPoint;
-
-                    // Compute the segment orientation (angle) en 0,1 degre
-                    double angle = ArcTangente( delta.y, delta.x );
-
-                    // Compute the segment length: delta.x = length after rotation
-                    RotatePoint( &delta, angle );
-
-                    /* Comute the reference segment coordinates relatives to a
-                     *  X axis = current tested segment
-                     */
-                    wxPoint relStartPos = aRefSeg->GetStart() - segStartPoint;
-                    wxPoint relEndPos   = aRefSeg->GetEnd() - segStartPoint;
-
-                    RotatePoint( &relStartPos, angle );
-                    RotatePoint( &relEndPos, angle );
-
-                    if( !checkMarginToCircle( relStartPos, w_dist, delta.x ) )
-                    {
-                        m_currentMarker = fillMarker( aRefSeg, track,
-                                                      DRCE_ENDS_PROBLEM4, m_currentMarker );
-                        return false;
-                    }
-
-                    if( !checkMarginToCircle( relEndPos, w_dist, delta.x ) )
-                    {
-                        m_currentMarker = fillMarker( aRefSeg, track,
-                                                      DRCE_ENDS_PROBLEM5, m_currentMarker );
-                        return false;
-                    }
+                    m_currentMarker = fillMarker( aRefSeg, aTrack,
+                                                  DRCE_ENDS_PROBLEM5, m_currentMarker );
+                    return false;
                 }
             }
         }
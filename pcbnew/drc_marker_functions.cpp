@@ -113,11 +113,13 @@ MARKER_PCB* DRC::fillMarker( const TRACK* aTrack, BOARD_ITEM* aItem, int aErrorC
                                      textA, aTrack->GetPosition(),
                                      textB, posB );
             fillMe->SetItem( aItem );
+            fillMe->SetAuxItem( aTrack );
         }
         else
         {
             fillMe = new MARKER_PCB( aErrorCode, position,
                                      textA, aTrack->GetPosition() );
+            fillMe->SetAuxItem( aTrack );
         }
     }
 
@@ -161,6 +163,7 @@ MARKER_PCB* DRC::fillMarker( D_PAD* aPad, BOARD_ITEM* aItem, int aErrorCode, MAR
     {
         fillMe = new MARKER_PCB( aErrorCode, posA, textA, posA, textB, posB );
         fillMe->SetItem( aPad );    // TODO it has to be checked
+        fillMe->SetAuxItem( aItem );
     }
 
     return fillMe;
@@ -0,0 +1,226 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file drc_spatial_index.cpp
+ */
+
+#include <fctsys.h>
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_track.h>
+#include <class_pad.h>
+#include <class_netclass.h>
+
+#include <drc_spatial_index.h>
+
+
+/**
+ * Helper visitor for INDEX_TREE searches: collects the ordinals of the items found.
+ */
+struct DRC_INDEX_COLLECTOR
+{
+    DRC_INDEX_COLLECTOR( std::vector<int>& aResult ) :
+        m_result( aResult )
+    {
+    }
+
+    bool operator()( int aIndex )
+    {
+        m_result.push_back( aIndex );
+        return true;
+    }
+
+    std::vector<int>& m_result;
+};
+
+
+DRC_SPATIAL_INDEX::DRC_SPATIAL_INDEX() :
+    m_maxClearance( 0 )
+{
+}
+
+
+void DRC_SPATIAL_INDEX::Clear()
+{
+    m_pads.clear();
+    m_tracks.clear();
+    m_padIndices.clear();
+    m_trackIndices.clear();
+
+    m_padTree.RemoveAll();
+
+    for( int layer = 0; layer < MAX_CU_LAYERS; ++layer )
+        m_trackTrees[layer].RemoveAll();
+
+    m_maxClearance = 0;
+}
+
+
+void DRC_SPATIAL_INDEX::Build( BOARD* aBoard )
+{
+    Clear();
+
+    // The biggest clearance is given by the netclasses, but pads can have a local
+    // clearance, so the pads are examined too.
+    const NETCLASSES& netclasses = aBoard->GetDesignSettings().m_NetClasses;
+
+    m_maxClearance = netclasses.GetDefault()->GetClearance();
+
+    for( NETCLASSES::const_iterator nc = netclasses.begin(); nc != netclasses.end(); ++nc )
+        m_maxClearance = std::max( m_maxClearance, nc->second->GetClearance() );
+
+    const std::vector<D_PAD*>& pads = aBoard->GetPads();
+
+    m_pads.reserve( pads.size() );
+
+    for( unsigned ii = 0; ii < pads.size(); ++ii )
+    {
+        D_PAD* pad = pads[ii];
+
+        m_pads.push_back( pad );
+        m_padIndices[pad] = ii;
+        m_maxClearance = std::max( m_maxClearance, pad->GetClearance() );
+
+        insert( m_padTree, PadArea( pad ), ii );
+    }
+
+    int index = 0;
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next(), ++index )
+    {
+        m_tracks.push_back( track );
+        m_trackIndices[track] = index;
+        m_maxClearance = std::max( m_maxClearance, track->GetClearance() );
+
+        EDA_RECT area = TrackArea( track );
+
+        // Vias are inserted in the tree of each layer they cross
+        for( LSEQ cu = track->GetLayerSet().CuStack(); cu; ++cu )
+            insert( m_trackTrees[*cu], area, index );
+    }
+}
+
+
+int DRC_SPATIAL_INDEX::GetPadIndex( const BOARD_ITEM* aPad ) const
+{
+    boost::unordered_map<const BOARD_ITEM*, int>::const_iterator it = m_padIndices.find( aPad );
+
+    return it == m_padIndices.end() ? -1 : it->second;
+}
+
+
+int DRC_SPATIAL_INDEX::GetTrackIndex( const BOARD_ITEM* aTrack ) const
+{
+    boost::unordered_map<const BOARD_ITEM*, int>::const_iterator it =
+            m_trackIndices.find( aTrack );
+
+    return it == m_trackIndices.end() ? -1 : it->second;
+}
+
+
+EDA_RECT DRC_SPATIAL_INDEX::PadArea( const D_PAD* aPad, int aMargin )
+{
+    // The pad shape is fully inside its bounding circle
+    int      radius = aPad->GetBoundingRadius() + aMargin;
+    EDA_RECT area( aPad->ShapePos(), wxSize( 0, 0 ) );
+
+    area.Inflate( radius );
+
+    // The hole is centered on the pad position, not on the shape position, and is
+    // tested on every copper layer, even those the pad is not on.
+    if( aPad->GetDrillSize().x || aPad->GetDrillSize().y )
+    {
+        int holeRadius = std::max( aPad->GetDrillSize().x, aPad->GetDrillSize().y ) / 2;
+        EDA_RECT hole( aPad->GetPosition(), wxSize( 0, 0 ) );
+
+        hole.Inflate( holeRadius + aMargin );
+        area.Merge( hole );
+    }
+
+    return area;
+}
+
+
+EDA_RECT DRC_SPATIAL_INDEX::TrackArea( const TRACK* aTrack, int aMargin )
+{
+    EDA_RECT area( aTrack->GetStart(), wxSize( 0, 0 ) );
+
+    area.Merge( aTrack->GetEnd() );
+    area.Inflate( ( aTrack->GetWidth() + 1 ) / 2 + aMargin );
+
+    return area;
+}
+
+
+void DRC_SPATIAL_INDEX::QueryPads( const EDA_RECT& aArea, std::vector<int>& aResult )
+{
+    aResult.clear();
+    search( m_padTree, aArea, aResult );
+    std::sort( aResult.begin(), aResult.end() );
+}
+
+
+void DRC_SPATIAL_INDEX::QueryTracks( const EDA_RECT& aArea, LSET aLayers,
+                                     std::vector<int>& aResult )
+{
+    aResult.clear();
+
+    int layerCount = 0;
+
+    for( LSEQ cu = aLayers.CuStack(); cu; ++cu, ++layerCount )
+        search( m_trackTrees[*cu], aArea, aResult );
+
+    std::sort( aResult.begin(), aResult.end() );
+
+    // A via crossing several of the searched layers is found once per layer
+    if( layerCount > 1 )
+        aResult.erase( std::unique( aResult.begin(), aResult.end() ), aResult.end() );
+}
+
+
+void DRC_SPATIAL_INDEX::insert( INDEX_TREE& aTree, const EDA_RECT& aArea, int aIndex )
+{
+    EDA_RECT  area = aArea;
+    area.Normalize();
+
+    const int mmin[2] = { area.GetX(), area.GetY() };
+    const int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+    aTree.Insert( mmin, mmax, aIndex );
+}
+
+
+void DRC_SPATIAL_INDEX::search( INDEX_TREE& aTree, const EDA_RECT& aArea,
+                                std::vector<int>& aResult )
+{
+    EDA_RECT  area = aArea;
+    area.Normalize();
+
+    const int mmin[2] = { area.GetX(), area.GetY() };
+    const int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+    DRC_INDEX_COLLECTOR collector( aResult );
+    aTree.Search( mmin, mmax, collector );
+}
@@ -0,0 +1,158 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file drc_spatial_index.h
+ * @brief Spatial index of the copper items used by the DRC clearance tests.
+ */
+
+#ifndef DRC_SPATIAL_INDEX_H
+#define DRC_SPATIAL_INDEX_H
+
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include <class_eda_rect.h>
+#include <layers_id_colors_and_visibility.h>
+#include <geometry/rtree.h>
+
+class BOARD;
+class BOARD_ITEM;
+class D_PAD;
+class TRACK;
+
+
+/**
+ * Class DRC_SPATIAL_INDEX
+ * holds R-trees of the pads and of the tracks and vias of a BOARD, so the DRC
+ * clearance tests can gather their candidates with a bounded box search instead of
+ * walking every item of the board.
+ *
+ * Items are referenced by their ordinal in the board lists (BOARD::GetPads() order
+ * for pads, BOARD::m_Track order for tracks and vias) and every query returns the
+ * ordinals sorted in ascending order.  This lets the tests visit the candidates in
+ * exactly the same order as the sequential list scans do, so both produce the same
+ * markers.
+ *
+ * The index is a snapshot: it must be rebuilt by Build() if the board changes.
+ */
+class DRC_SPATIAL_INDEX
+{
+public:
+    DRC_SPATIAL_INDEX();
+
+    /**
+     * Function Build
+     * (re)creates the index from the pads, tracks and vias of aBoard.
+     */
+    void Build( BOARD* aBoard );
+
+    /**
+     * Function Clear
+     * removes all the items from the index.
+     */
+    void Clear();
+
+    /**
+     * Function GetMaxClearance
+     * @return the biggest clearance value used by any indexed item.  Inflating a search
+     * area by this amount guarantees no item violating a clearance rule is missed.
+     */
+    int GetMaxClearance() const         { return m_maxClearance; }
+
+    unsigned GetPadCount() const        { return m_pads.size(); }
+    D_PAD* GetPad( int aIndex ) const   { return m_pads[aIndex]; }
+
+    unsigned GetTrackCount() const      { return m_tracks.size(); }
+    TRACK* GetTrack( int aIndex ) const { return m_tracks[aIndex]; }
+
+    /**
+     * Function GetPadIndex
+     * @return the ordinal of aPad in the index, or -1 if it is not an indexed pad.
+     * aPad is not dereferenced, so it can be a pointer to a deleted item.
+     */
+    int GetPadIndex( const BOARD_ITEM* aPad ) const;
+
+    /**
+     * Function GetTrackIndex
+     * @return the ordinal of aTrack in the index, or -1 if it is not an indexed track.
+     * aTrack is not dereferenced, so it can be a pointer to a deleted item.
+     */
+    int GetTrackIndex( const BOARD_ITEM* aTrack ) const;
+
+    /**
+     * Function PadArea
+     * @return the area covered by aPad, including its hole (which can be off the
+     * pad shape) and aMargin.
+     */
+    static EDA_RECT PadArea( const D_PAD* aPad, int aMargin = 0 );
+
+    /**
+     * Function TrackArea
+     * @return the area covered by a track segment or a via, including its width
+     * and aMargin.
+     */
+    static EDA_RECT TrackArea( const TRACK* aTrack, int aMargin = 0 );
+
+    /**
+     * Function QueryPads
+     * collects the ordinals of the pads whose area intersects aArea.
+     * @param aArea is the search area.
+     * @param aResult receives the ordinals, sorted in ascending order.
+     */
+    void QueryPads( const EDA_RECT& aArea, std::vector<int>& aResult );
+
+    /**
+     * Function QueryTracks
+     * collects the ordinals of the tracks and vias whose area intersects aArea on
+     * at least one of aLayers.
+     * @param aArea is the search area.
+     * @param aLayers is the set of copper layers to search.
+     * @param aResult receives the ordinals, sorted in ascending order and without duplicates.
+     */
+    void QueryTracks( const EDA_RECT& aArea, LSET aLayers, std::vector<int>& aResult );
+
+private:
+    typedef RTree<int, int, 2, float> INDEX_TREE;
+
+    /// Copying the trees is not supported
+    DRC_SPATIAL_INDEX( const DRC_SPATIAL_INDEX& );
+    DRC_SPATIAL_INDEX& operator=( const DRC_SPATIAL_INDEX& );
+
+    static void insert( INDEX_TREE& aTree, const EDA_RECT& aArea, int aIndex );
+    static void search( INDEX_TREE& aTree, const EDA_RECT& aArea, std::vector<int>& aResult );
+
+    std::vector<D_PAD*>     m_pads;
+    std::vector<TRACK*>     m_tracks;
+
+    boost::unordered_map<const BOARD_ITEM*, int> m_padIndices;
+    boost::unordered_map<const BOARD_ITEM*, int> m_trackIndices;
+
+    INDEX_TREE              m_padTree;                      ///< pads are on every layer (holes)
+    INDEX_TREE              m_trackTrees[MAX_CU_LAYERS];    ///< one tree per copper layer
+
+    int                     m_maxClearance;
+};
+
+#endif // DRC_SPATIAL_INDEX_H
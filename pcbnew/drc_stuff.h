@@ -31,6 +31,10 @@
 
 #include <vector>
 #include <memory>
+#include <set>
+
+#include <profile.h>
+#include <drc_spatial_index.h>
 
 #define OK_DRC  0
 #define BAD_DRC 1
@@ -140,6 +144,19 @@ public:
 typedef std::vector<DRC_ITEM*> DRC_LIST;
 
 
+/**
+ * Struct DRC_TEST_STATS
+ * holds the run time and the results count of one of the tests run by DRC::RunTests().
+ */
+struct DRC_TEST_STATS
+{
+    wxString    m_Name;         ///< test name, as written in the reports
+    int         m_ItemCount;    ///< number of items tested
+    int         m_ErrorCount;   ///< number of markers and unconnected items found
+    double      m_Msecs;        ///< wall time of the test, in milliseconds
+};
+
+
 /**
  * Class DRC
  * is the Design Rule Checker, and performs all the DRC tests.  The output of
@@ -162,6 +179,7 @@ private:
     bool     m_doZonesTest;
     bool     m_doKeepoutTest;
     bool     m_doCreateRptFile;
+    bool     m_useSpatialIndex;
 
     wxString m_rptFilename;
 
@@ -199,6 +217,25 @@ private:
 
     DRC_LIST            m_unconnected;      ///< list of unconnected pads, as DRC_ITEMs
 
+    /// pads, tracks and vias index used by RunTests(), shared with the worker objects
+    std::shared_ptr<DRC_SPATIAL_INDEX> m_spatialIndex;
+
+    std::vector<DRC_TEST_STATS> m_testStats;    ///< timings of the last RunTests() call
+    prof_counter        m_testTimer;        ///< running timer of the current test
+    int                 m_testErrorBase;    ///< errors count when the current test started
+
+    /// the board the markers were created for by the last complete run of the tests,
+    /// or NULL.  RunIncrementalTests() can only update the results of this board.
+    BOARD*              m_testedBoard;
+
+    /**
+     * Constructor used to create the worker objects of the multithreaded tests.
+     * A worker shares the frame, the board, the settings and the spatial index of
+     * aMaster, but has its own test state (m_currentMarker, m_segm... variables) and
+     * owns no unconnected item.
+     */
+    DRC( const DRC& aMaster );
+
 
     /**
      * Function updatePointers
@@ -207,6 +244,38 @@ private:
      */
     void updatePointers();
 
+    /**
+     * Function addMarkerToPcb
+     * adds aMarker to the BOARD and to the view.
+     */
+    void addMarkerToPcb( MARKER_PCB* aMarker );
+
+    /**
+     * Function removeMarkers
+     * removes from the BOARD and from the view, and deletes, the markers found by the
+     * tests which are run again by RunIncrementalTests().
+     * @param aItems is the set of items to test again.  It is extended with the other
+     * items of the removed clearance markers, which must be tested again too.
+     * If NULL, all the markers are removed.
+     */
+    void removeMarkers( std::set<const BOARD_ITEM*>* aItems );
+
+    /**
+     * Functions beginTest and endTest
+     * measure the run time and count the errors of a test, and store them in m_testStats.
+     * @param aName is the name of the test, for the reports.
+     * @param aItemCount is the number of items the test examined.
+     */
+    void beginTest();
+    void endTest( const wxString& aName, int aItemCount );
+
+    /**
+     * Function fillAllZones
+     * refills all the zones of the board when no editor frame is available
+     * (PCB_EDIT_FRAME::Fill_All_Zones() is used otherwise).
+     */
+    void fillAllZones();
+
 
     /**
      * Function fillMarker
@@ -281,6 +350,13 @@ private:
 
     void testUnconnected();
 
+    /**
+     * Function testUnconnectedRatsnestData
+     * finds the unconnected items from the ratsnest data of the board (see RN_DATA),
+     * for the batch mode.
+     */
+    void testUnconnectedRatsnestData();
+
     void testZones();
 
     void testKeepoutAreas();
@@ -302,6 +378,21 @@ private:
      */
     bool doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_limit );
 
+    /**
+     * Function doSortedPadDrc
+     * tests the clearance between a pad of a list sorted by x coordinate and the pads
+     * following it in this list.  If the spatial index is available, only the pads
+     * found near the reference pad are tested.
+     * @param aSortedPads The list of pads sorted by x coordinate
+     * @param aRank The position in aSortedPads of each pad of the spatial index
+     * @param aRefIdx The position in aSortedPads of the pad to test
+     * @param aMaxSize The bounding radius of the biggest pad
+     * @return bool - true if no poblems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool doSortedPadDrc( std::vector<D_PAD*>& aSortedPads, const std::vector<int>& aRank,
+                         int aRefIdx, int aMaxSize );
+
     /**
      * Function DoTrackDrc
      * tests the current segment.
@@ -313,6 +404,28 @@ private:
      */
     bool doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool doPads = true );
 
+    /**
+     * Function DoTrackDrc
+     * tests the current segment against a given set of pads and tracks.
+     * @param aRefSeg The segment to test
+     * @param aPads The pads to test against, in test order
+     * @param aTracks The tracks and vias to test against, in test order
+     * @return bool - true if no poblems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool doTrackDrc( TRACK* aRefSeg, const std::vector<D_PAD*>& aPads,
+                     const std::vector<TRACK*>& aTracks );
+
+    /**
+     * Function doTrackDrcIndexed
+     * performs the same test as doTrackDrc( aRefSeg, aRefSeg->Next(), true ), but
+     * only against the pads and the next tracks found near aRefSeg in m_spatialIndex.
+     * @param aRefSeg The segment to test
+     * @return bool - true if no poblems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool doTrackDrcIndexed( TRACK* aRefSeg );
+
     /**
      * Function doTrackKeepoutDrc
      * tests the current segment or via.
@@ -362,6 +475,19 @@ private:
      */
     bool checkClearanceSegmToPad( const D_PAD* aPad, int aSegmentWidth, int aMinDist );
 
+    /**
+     * Function checkClearanceSegmToSegm
+     * tests the clearance between the reference segment and another track or via.
+     * It uses the data of the reference segment set by doTrackDrc():
+     *      m_segmLength = length of the reference segment
+     *      m_segmAngle  = angle of the reference segment with the X axis
+     * @param aRefSeg The reference segment
+     * @param aTrack The track or via to test against
+     * @return bool - true if no poblems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool checkClearanceSegmToSegm( TRACK* aRefSeg, TRACK* aTrack );
+
 
     /**
      * Helper function checkMarginToCircle
@@ -393,6 +519,13 @@ private:
 public:
     DRC( PCB_EDIT_FRAME* aPcbWindow );
 
+    /**
+     * Constructor for the batch mode: the tests are run on aBoard without any user
+     * interface.  The markers are added to aBoard only, and the unconnected pads are
+     * found from the board ratsnest data (see RN_DATA).
+     */
+    DRC( BOARD* aBoard );
+
     ~DRC();
 
     /**
@@ -484,6 +617,17 @@ public:
         m_doCreateRptFile   = aSaveReport;
     }
 
+    /**
+     * Function SetUseSpatialIndex
+     * selects how RunTests() finds the items to test against each other.
+     * @param aEnable = true to search a spatial index of the board items (the default),
+     * false to scan the board item lists.  Both modes create the same markers.
+     */
+    void SetUseSpatialIndex( bool aEnable )
+    {
+        m_useSpatialIndex = aEnable;
+    }
+
 
     /**
      * Function RunTests
@@ -500,6 +644,45 @@ public:
      */
     void ListUnconnectedPads();
 
+    /**
+     * Function RunIncrementalTests
+     * updates the results of the last RunTests() call on the current board, testing
+     * again only the pads, tracks and vias changed since then (see
+     * BOARD::GetChangedItems()) and those in conflict with them.  The board level
+     * tests (netclasses, zone outlines, unconnected pads, keepout areas, texts) are
+     * fully run again, but zones are not refilled.
+     * If the tests were never run on the current board, RunTests() is called.
+     * Design rules changes are not tracked: RunTests() must be used after them.
+     * @param aMessages = a wxTextControl where to display some activity messages. Can be NULL
+     */
+    void RunIncrementalTests( wxTextCtrl* aMessages = NULL );
+
+    /**
+     * Function GetTestStats
+     * @return the run time and errors count of each test run by the last RunTests() call.
+     */
+    const std::vector<DRC_TEST_STATS>& GetTestStats() const
+    {
+        return m_testStats;
+    }
+
+    /**
+     * Function WriteJsonReport
+     * writes the markers of the board, the unconnected items and the tests statistics
+     * of the last RunTests() call in a JSON file, for tools (continuous integration,
+     * benchmarks) which need a machine readable report.
+     * Coordinates are given in millimeters, times in milliseconds.
+     * @param aFullFileName is the name of the file to create.
+     * @return true if the file was written, false if it cannot be created.
+     */
+    bool WriteJsonReport( const wxString& aFullFileName ) const;
+
+    /**
+     * Function GetErrorCount
+     * @return the number of markers on the board plus the number of unconnected items.
+     */
+    int GetErrorCount() const;
+
     /**
      * @return a pointer to the current marker (last created marker
      */
@@ -29,18 +29,17 @@
 Pcbnew PLUGIN for Eagle 6.x XML *.brd and footprint format.
 
 XML parsing and converting:
-Getting line numbers and byte offsets from the source XML file is not
-possible using currently available XML libraries within KiCad project:
-wxXmlDocument and boost::property_tree.
-
-property_tree will give line numbers but no byte offsets, and only during
-document loading. This means that if we have a problem after the document is
-successfully loaded, there is no way to correlate back to line number and byte
-offset of the problem. So a different approach is taken, one which relies on the
-XML elements themselves using an XPATH type of reporting mechanism. The path to
-the problem is reported in the error messages. This means keeping track of that
-path as we traverse the XML document for the sole purpose of accurate error
-reporting.
+The XML file is not loaded as a whole: XML_READER streams it, and each element
+converted to KiCad items (a wire, a via, a package, ...) is read alone into a
+boost::property_tree and discarded once converted.  Only the packages of the
+libraries are kept until the end of the load, since the elements using them and
+the design rules needed to convert them come later in the file.
+
+Errors found while converting an element are reported with the line of the
+element in the file, and with an XPATH type of reporting mechanism which relies
+on the XML elements themselves. The path to the problem is reported in the
+error messages. This means keeping track of that path as we traverse the XML
+document for the sole purpose of accurate error reporting.
 
 User can load the source XML file into firefox or other xml browser and follow
 our error message.
@@ -55,7 +54,6 @@ Load() TODO's
 
 #include <wx/string.h>
 #include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/xml_parser.hpp>
 
 #include <eagle_plugin.h>
 
@@ -98,7 +96,7 @@ struct TRIPLET
 {
     const char* element;
     const char* attribute;
-    const char* value;
+    string      value;
 
     TRIPLET( const char* aElement, const char* aAttribute = "", const char* aValue = "" ) :
         element( aElement ),
@@ -113,13 +111,11 @@ struct TRIPLET
  * keeps track of what we are working on within a PTREE.
  * Then if an exception is thrown, the place within the tree that gave us
  * grief can be reported almost accurately.  To minimally impact
- * speed, merely assign const char* pointers during the tree walking
- * expedition.  The const char* pointers must be to C strings residing either in
- * the data or code segment (i.e. "compiled in") or within the XML document, but
- * not on the stack, since the stack is unwound during the throwing of the
- * exception.  The XML document will not immediately vanish since we capture
- * the xpath (using function Contents()) before the XML document tree (PTREE)
- * is destroyed.
+ * speed, merely assign const char* pointers to the element and attribute
+ * names during the tree walking expedition.  These must be C strings residing
+ * in the data or code segment (i.e. "compiled in"), not on the stack, since the
+ * stack is unwound during the throwing of the exception.  The values are copied,
+ * since the streamed XML elements they come from are destroyed by the unwinding.
  */
 class XPATH
 {
@@ -136,7 +132,7 @@ public:
     void pop()      { p.pop_back(); }
 
     /// modify the last path node's value
-    void Value( const char* aValue )
+    void Value( const string& aValue )
     {
         p.back().value = aValue;
     }
@@ -161,7 +157,7 @@ public:
 
             ret += it->element;
 
-            if( it->attribute[0] && it->value[0] )
+            if( it->attribute[0] && it->value.size() )
             {
                 ret += '[';
                 ret += it->attribute;
@@ -176,6 +172,616 @@ public:
 };
 
 
+/**
+ * Class XML_READER
+ * reads an XML document one element at a time, so an Eagle board is converted while
+ * it is read, instead of after building the PTREE of the whole document, which takes
+ * several times the size of the file.  The caller walks the elements with Next(),
+ * and reads only the elements it converts into a PTREE, the same PTREE read_xml()
+ * would give with xml_parser::no_comments: the attributes under "<xmlattr>", the
+ * child elements, and the text of the element as its data().
+ *
+ * The file is read through a fixed size buffer.  Comments, processing instructions
+ * and the DOCTYPE are skipped.
+ */
+class XML_READER
+{
+public:
+    enum EVENT
+    {
+        START,          ///< start of an element, see Name() and Element()
+        END,            ///< end of the element containing the current position
+        END_OF_FILE,    ///< end of the document
+    };
+
+    /**
+     * Constructor XML_READER
+     * opens @a aFileName.
+     * @throw IO_ERROR if the file cannot be opened.
+     */
+    XML_READER( const wxString& aFileName ) throw( IO_ERROR );
+
+    ~XML_READER();
+
+    /**
+     * Function Next
+     * reads up to the next start or end of element, skipping the text.  After a START,
+     * the next call to Next() reads the content of the started element: the caller
+     * calls it until it returns END to walk the children of the element, or else calls
+     * ReadElement() or SkipElement().
+     * @throw PARSE_ERROR if the document is not well formed.
+     */
+    EVENT Next() throw( IO_ERROR );
+
+    /// Returns the name of the element of the last START
+    const string& Name() const          { return m_name; }
+
+    /// Returns the element of the last START, with only its attributes, until it is
+    /// read by ReadElement()
+    CPTREE& Element() const             { return m_element; }
+
+    /**
+     * Function ReadElement
+     * reads the element of the last START, up to and including its end, into @a aTree.
+     * @throw PARSE_ERROR if the document is not well formed.
+     */
+    void ReadElement( PTREE& aTree ) throw( IO_ERROR );
+
+    /**
+     * Function SkipElement
+     * skips the content of the element of the last START, up to and including its end.
+     * @throw PARSE_ERROR if the document is not well formed.
+     */
+    void SkipElement() throw( IO_ERROR );
+
+    int LineNumber() const              { return m_lineNumber; }
+
+private:
+    enum TOKEN
+    {
+        T_START,
+        T_EMPTY,        ///< element without content: <name ... />
+        T_END,
+        T_TEXT,
+        T_EOF,
+    };
+
+    FILE*               m_fp;
+    wxString            m_source;       ///< the file name, for error messages
+
+    std::vector<char>   m_buffer;
+    size_t              m_pos;          ///< next char in m_buffer
+    size_t              m_len;          ///< chars in m_buffer
+    int                 m_lineNumber;
+    int                 m_column;
+
+    string              m_token;        ///< name of the last T_START, T_EMPTY or T_END
+    string              m_name;         ///< name of the element of the last START
+    PTREE               m_element;      ///< element of the last START, attributes only
+    bool                m_emptyElement; ///< the element of the last START has no content
+    std::vector<string> m_open;         ///< names of the elements containing the position
+
+    /// Fills m_buffer, returns false at the end of the file
+    bool fill() throw( IO_ERROR );
+
+    int peek() throw( IO_ERROR )
+    {
+        if( m_pos == m_len && !fill() )
+            return EOF;
+
+        return (unsigned char) m_buffer[m_pos];
+    }
+
+    int get() throw( IO_ERROR )
+    {
+        if( m_pos == m_len && !fill() )
+            return EOF;
+
+        int c = (unsigned char) m_buffer[m_pos++];
+
+        if( c == '\n' )
+        {
+            ++m_lineNumber;
+            m_column = 0;
+        }
+        else
+        {
+            ++m_column;
+        }
+
+        return c;
+    }
+
+    static bool isSpace( int c )
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    void parseError( const char* aMessage ) throw( IO_ERROR );
+
+    /// Reads the next token, with its text in aText if it is T_TEXT and aText is not NULL,
+    /// and its attributes in aElement if it is T_START or T_EMPTY.
+    TOKEN nextToken( string* aText, PTREE* aElement ) throw( IO_ERROR );
+
+    /// Reads the name of an element or of an attribute
+    void readName( string* aName ) throw( IO_ERROR );
+
+    /// Reads an attribute value, or text up to aDelimiter, translating the references
+    void readText( string* aText, int aDelimiter ) throw( IO_ERROR );
+
+    /// Reads a "&...;" reference, after its '&'
+    void readReference( string* aText ) throw( IO_ERROR );
+
+    /// Reads up to and including aEnd, into aText without aEnd if aText is not NULL
+    void readPast( const char* aEnd, string* aText = NULL ) throw( IO_ERROR );
+
+    /// Reads the content of aTree, whose start was read, up to and including its end.
+    void readContent( PTREE& aTree, const string& aName ) throw( IO_ERROR );
+};
+
+
+XML_READER::XML_READER( const wxString& aFileName ) throw( IO_ERROR ) :
+    m_source( aFileName ),
+    m_buffer( 65536 ),
+    m_pos( 0 ),
+    m_len( 0 ),
+    m_lineNumber( 1 ),
+    m_column( 0 ),
+    m_emptyElement( false )
+{
+    m_fp = wxFopen( aFileName, wxT( "rb" ) );
+
+    if( !m_fp )
+    {
+        wxString msg = wxString::Format(
+            _( "Unable to open filename '%s' for reading" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+}
+
+
+XML_READER::~XML_READER()
+{
+    fclose( m_fp );
+}
+
+
+bool XML_READER::fill() throw( IO_ERROR )
+{
+    m_pos = 0;
+    m_len = fread( &m_buffer[0], 1, m_buffer.size(), m_fp );
+
+    if( m_len == 0 && ferror( m_fp ) )
+    {
+        wxString msg = wxString::Format(
+            _( "Error reading file '%s'" ), m_source.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+    return m_len != 0;
+}
+
+
+void XML_READER::parseError( const char* aMessage ) throw( IO_ERROR )
+{
+    THROW_PARSE_ERROR( aMessage, m_source, "", m_lineNumber, m_column );
+}
+
+
+void XML_READER::readName( string* aName ) throw( IO_ERROR )
+{
+    aName->clear();
+
+    for( int c = peek();  c != EOF && !isSpace( c ) && !strchr( "=/>?", c );  c = peek() )
+        *aName += (char) get();
+
+    if( aName->empty() )
+        parseError( "expected a name" );
+}
+
+
+void XML_READER::readReference( string* aText ) throw( IO_ERROR )
+{
+    string ref;
+
+    for( int c = peek();  c != EOF && ( isalnum( c ) || c == '#' ) && ref.size() < 10;  c = peek() )
+        ref += (char) get();
+
+    if( peek() != ';' )
+    {
+        // not a reference, keep the text as it is like read_xml() does
+        if( aText )
+        {
+            *aText += '&';
+            *aText += ref;
+        }
+
+        return;
+    }
+
+    get();      // ';'
+
+    if( !aText )
+        return;
+
+    if( ref == "lt" )
+        *aText += '<';
+    else if( ref == "gt" )
+        *aText += '>';
+    else if( ref == "amp" )
+        *aText += '&';
+    else if( ref == "quot" )
+        *aText += '"';
+    else if( ref == "apos" )
+        *aText += '\'';
+    else if( ref.size() > 1 && ref[0] == '#' )
+    {
+        unsigned long code = ref[1] == 'x' ? strtoul( ref.c_str() + 2, NULL, 16 )
+                                           : strtoul( ref.c_str() + 1, NULL, 10 );
+
+        // UTF-8 encoding of the character
+        if( code < 0x80 )
+        {
+            *aText += (char) code;
+        }
+        else if( code < 0x800 )
+        {
+            *aText += (char) ( 0xC0 | ( code >> 6 ) );
+            *aText += (char) ( 0x80 | ( code & 0x3F ) );
+        }
+        else if( code < 0x10000 )
+        {
+            *aText += (char) ( 0xE0 | ( code >> 12 ) );
+            *aText += (char) ( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+            *aText += (char) ( 0x80 | ( code & 0x3F ) );
+        }
+        else if( code < 0x110000 )
+        {
+            *aText += (char) ( 0xF0 | ( code >> 18 ) );
+            *aText += (char) ( 0x80 | ( ( code >> 12 ) & 0x3F ) );
+            *aText += (char) ( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+            *aText += (char) ( 0x80 | ( code & 0x3F ) );
+        }
+        else
+        {
+            parseError( "invalid character reference" );
+        }
+    }
+    else
+    {
+        // unknown entity, keep it as it is like read_xml() does
+        *aText += '&';
+        *aText += ref;
+        *aText += ';';
+    }
+}
+
+
+void XML_READER::readText( string* aText, int aDelimiter ) throw( IO_ERROR )
+{
+    for( int c = peek();  c != aDelimiter;  c = peek() )
+    {
+        if( c == EOF )
+        {
+            if( aDelimiter == '<' )
+                return;
+
+            parseError( "unexpected end of file" );
+        }
+
+        get();
+
+        if( c == '&' )
+            readReference( aText );
+        else if( aText )
+            *aText += (char) c;
+    }
+}
+
+
+void XML_READER::readPast( const char* aEnd, string* aText ) throw( IO_ERROR )
+{
+    size_t  len = strlen( aEnd );
+    string  tail;
+
+    while( tail != aEnd )
+    {
+        int c = get();
+
+        if( c == EOF )
+            parseError( "unexpected end of file" );
+
+        if( aText )
+            *aText += (char) c;
+
+        tail += (char) c;
+
+        if( tail.size() > len )
+            tail.erase( 0, 1 );
+    }
+
+    if( aText )
+        aText->resize( aText->size() - len );
+}
+
+
+XML_READER::TOKEN XML_READER::nextToken( string* aText, PTREE* aElement ) throw( IO_ERROR )
+{
+    int c = peek();
+
+    if( c == EOF )
+        return T_EOF;
+
+    if( c != '<' )
+    {
+        readText( aText, '<' );
+        return T_TEXT;
+    }
+
+    get();      // '<'
+    c = peek();
+
+    if( c == '?' )
+    {
+        readPast( "?>" );
+        return T_TEXT;
+    }
+
+    if( c == '!' )
+    {
+        get();
+
+        if( peek() == '-' )
+        {
+            readPast( "--" );
+            readPast( "-->" );
+            return T_TEXT;
+        }
+
+        if( peek() == '[' )
+        {
+            // the text of a CDATA section is not translated
+            readPast( "[CDATA[" );
+            readPast( "]]>", aText );
+            return T_TEXT;
+        }
+
+        // <!DOCTYPE ... [ ... ]>
+        int nesting = 0;
+
+        while( ( c = get() ) != '>' || nesting )
+        {
+            if( c == EOF )
+                parseError( "unexpected end of file" );
+            else if( c == '[' )
+                ++nesting;
+            else if( c == ']' )
+                --nesting;
+        }
+
+        return T_TEXT;
+    }
+
+    if( c == '/' )
+    {
+        get();
+        readName( &m_token );
+
+        while( isSpace( peek() ) )
+            get();
+
+        if( get() != '>' )
+            parseError( "expected '>'" );
+
+        return T_END;
+    }
+
+    readName( &m_token );
+
+    PTREE*  attributes = NULL;
+    string  name;
+    string  value;
+
+    while( true )
+    {
+        while( isSpace( peek() ) )
+            get();
+
+        c = peek();
+
+        if( c == '>' )
+        {
+            get();
+            return T_START;
+        }
+
+        if( c == '/' )
+        {
+            get();
+
+            if( get() != '>' )
+                parseError( "expected '>'" );
+
+            return T_EMPTY;
+        }
+
+        if( c == EOF )
+            parseError( "unexpected end of file" );
+
+        readName( &name );
+
+        while( isSpace( peek() ) )
+            get();
+
+        if( get() != '=' )
+            parseError( "expected '='" );
+
+        while( isSpace( peek() ) )
+            get();
+
+        int quote = get();
+
+        if( quote != '"' && quote != '\'' )
+            parseError( "expected a quoted attribute value" );
+
+        value.clear();
+        readText( aElement ? &value : NULL, quote );
+        get();      // quote
+
+        if( aElement )
+        {
+            if( !attributes )
+                attributes = &aElement->push_back( std::make_pair( "<xmlattr>", PTREE() ) )->second;
+
+            attributes->push_back( std::make_pair( name, PTREE( value ) ) );
+        }
+    }
+}
+
+
+
+void XML_READER::readContent( PTREE& aTree, const string& aName ) throw( IO_ERROR )
+{
+    string  text;
+    PTREE   child;
+
+    while( true )
+    {
+        text.clear();
+
+        TOKEN token = nextToken( &text, &child );
+
+        switch( token )
+        {
+        case T_TEXT:
+            // All the text is appended to the data, even the whitespace between two child
+            // elements.  This is what read_xml( ..., xml_parser::no_comments ) did: rapidxml
+            // only drops whitespace-only data with xml_parser::trim_whitespace, which was
+            // not used for Eagle files.
+            aTree.data() += text;
+            break;
+
+        case T_START:
+        case T_EMPTY:
+            {
+                string  name = m_token;
+                PTREE&  node = aTree.push_back( std::make_pair( name, PTREE() ) )->second;
+
+                node.swap( child );
+
+                if( token == T_START )
+                    readContent( node, name );
+            }
+            break;
+
+        case T_END:
+            if( m_token != aName )
+                parseError( "unexpected end of element" );
+
+            return;
+
+        case T_EOF:
+            parseError( "unexpected end of file" );
+        }
+    }
+}
+
+
+XML_READER::EVENT XML_READER::Next() throw( IO_ERROR )
+{
+    if( m_emptyElement )
+    {
+        // the content of an element without content is its end
+        m_emptyElement = false;
+        m_open.pop_back();
+        return END;
+    }
+
+    PTREE element;
+
+    while( true )
+    {
+        TOKEN token = nextToken( NULL, &element );
+
+        switch( token )
+        {
+        case T_TEXT:
+            break;
+
+        case T_START:
+        case T_EMPTY:
+            m_name = m_token;
+            m_element.swap( element );
+            m_emptyElement = token == T_EMPTY;
+            m_open.push_back( m_name );
+            return START;
+
+        case T_END:
+            if( m_open.empty() || m_open.back() != m_token )
+                parseError( "unexpected end of element" );
+
+            m_open.pop_back();
+            return END;
+
+        case T_EOF:
+            if( !m_open.empty() )
+                parseError( "unexpected end of file" );
+
+            return END_OF_FILE;
+        }
+    }
+}
+
+
+void XML_READER::ReadElement( PTREE& aTree ) throw( IO_ERROR )
+{
+    aTree.clear();
+    aTree.swap( m_element );
+
+    if( m_emptyElement )
+        m_emptyElement = false;
+    else
+        readContent( aTree, m_open.back() );
+
+    m_open.pop_back();
+}
+
+
+void XML_READER::SkipElement() throw( IO_ERROR )
+{
+    if( m_emptyElement )
+    {
+        m_emptyElement = false;
+    }
+    else
+    {
+        int depth = 1;
+
+        while( depth )
+        {
+            switch( nextToken( NULL, NULL ) )
+            {
+            case T_START:
+                ++depth;
+                break;
+
+            case T_END:
+                --depth;
+                break;
+
+            case T_EOF:
+                parseError( "unexpected end of file" );
+
+            default:
+                break;
+            }
+        }
+    }
+
+    m_open.pop_back();
+}
+
+
 /**
  * Function parseOptionalBool
  * returns an opt_bool and sets it true or false according to the presence
@@ -1108,10 +1714,11 @@ static inline string makeKey( const string& aFirst, const string& aSecond )
 }
 
 
-/// Make a unique time stamp
+/// Make a unique time stamp for an item of a package
 static inline unsigned long timeStamp( CPTREE& aTree )
 {
-    // in this case from a unique tree memory location
+    // in this case from a unique tree memory location, the packages are kept
+    // during the whole load.
     return (unsigned long)(void*) &aTree;
 }
 
@@ -1166,6 +1773,14 @@ const wxString EAGLE_PLUGIN::GetFileExtension() const
 }
 
 
+unsigned long EAGLE_PLUGIN::newTimeStamp()
+{
+    // The trees of the streamed elements are destroyed once converted, their
+    // memory locations are not unique.
+    return ++m_time_stamp;
+}
+
+
 int inline EAGLE_PLUGIN::kicad( double d ) const
 {
     return KiROUND( biu_per_mm * d );
@@ -1183,7 +1798,6 @@ wxSize inline EAGLE_PLUGIN::kicad_fontz( double d ) const
 BOARD* EAGLE_PLUGIN::Load( const wxString& aFileName, BOARD* aAppendToMe,  const PROPERTIES* aProperties )
 {
     LOCALE_IO   toggle;     // toggles on, then off, the C locale.
-    PTREE       doc;
 
     init( aProperties );
 
@@ -1196,20 +1810,21 @@ BOARD* EAGLE_PLUGIN::Load( const wxString& aFileName, BOARD* aAppendToMe,  const
     // delete on exception, if I own m_board, according to aAppendToMe
     unique_ptr<BOARD> deleter( aAppendToMe ? NULL : m_board );
 
+    XML_READER  reader( aFileName );
+
     try
     {
-        // 8 bit "filename" should be encoded according to disk filename encoding,
-        // (maybe this is current locale, maybe not, its a filesystem issue),
-        // and is not necessarily utf8.
-        string filename = (const char*) aFileName.char_str( wxConvFile );
-
-        read_xml( filename, doc, xml_parser::no_comments );
-
         m_min_trace    = INT_MAX;
         m_min_via      = INT_MAX;
         m_min_via_hole = INT_MAX;
 
-        loadAllSections( doc );
+        if( !loadAllSections( reader ) )
+        {
+            wxString msg = wxString::Format(
+                _( "File '%s' is not an Eagle board, <board> element expected" ),
+                aFileName.GetData() );
+            THROW_IO_ERROR( msg );
+        }
 
         BOARD_DESIGN_SETTINGS& designSettings = m_board->GetDesignSettings();
 
@@ -1235,15 +1850,8 @@ BOARD* EAGLE_PLUGIN::Load( const wxString& aFileName, BOARD* aAppendToMe,  const
         wxASSERT( m_xpath->Contents().size() == 0 );
     }
 
-    catch( file_parser_error fpe )
-    {
-        // for xml_parser_error, what() has the line number in it,
-        // but no byte offset.  That should be an adequate error message.
-        THROW_IO_ERROR( fpe.what() );
-    }
-
-    // Class ptree_error is a base class for xml_parser_error & file_parser_error,
-    // so one catch should be OK for all errors.
+    // ptree_error is thrown for a missing or invalid attribute of an element, the
+    // reader is at the end of this element.
     catch( ptree_error pte )
     {
         string errmsg = pte.what();
@@ -1251,7 +1859,7 @@ BOARD* EAGLE_PLUGIN::Load( const wxString& aFileName, BOARD* aAppendToMe,  const
         errmsg += " @\n";
         errmsg += m_xpath->Contents();
 
-        THROW_IO_ERROR( errmsg );
+        THROW_PARSE_ERROR( FROM_UTF8( errmsg.c_str() ), aFileName, "", reader.LineNumber(), 0 );
     }
 
     // IO_ERROR exceptions are left uncaught, they pass upwards from here.
@@ -1277,13 +1885,15 @@ BOARD* EAGLE_PLUGIN::Load( const wxString& aFileName, BOARD* aAppendToMe,  const
 void EAGLE_PLUGIN::init( const PROPERTIES* aProperties )
 {
     m_hole_count   = 0;
+    m_time_stamp   = 0;
     m_min_trace    = 0;
     m_min_via      = 0;
     m_min_via_hole = 0;
     m_xpath->clear();
     m_pads_to_nets.clear();
+    m_elements.clear();
 
-    // m_templates.clear();     this is the FOOTPRINT cache too
+    // m_templates.clear();     this is the FOOTPRINT cache too, as m_packages
 
     m_board = NULL;
     m_props = aProperties;
@@ -1305,50 +1915,99 @@ void EAGLE_PLUGIN::clear_cu_map()
 }
 
 
-void EAGLE_PLUGIN::loadAllSections( CPTREE& aDoc )
+bool EAGLE_PLUGIN::loadAllSections( XML_READER& aReader )
 {
-    CPTREE& drawing = aDoc.get_child( "eagle.drawing" );
-    CPTREE& board   = drawing.get_child( "board" );
+    bool hasBoard = false;
+
+    if( aReader.Next() != XML_READER::START || aReader.Name() != "eagle" )
+        THROW_IO_ERROR( _( "Not an Eagle XML file, <eagle> element expected" ) );
 
     m_xpath->push( "eagle.drawing" );
 
+    while( aReader.Next() == XML_READER::START )
     {
-        m_xpath->push( "board" );
-
-        CPTREE& designrules = board.get_child( "designrules" );
-        loadDesignRules( designrules );
-
-        m_xpath->pop();
-    }
+        if( aReader.Name() != "drawing" )
+        {
+            aReader.SkipElement();
+            continue;
+        }
 
-    {
-        m_xpath->push( "layers" );
+        // (settings?, grid?, layers, (library | schematic | board))
+        while( aReader.Next() == XML_READER::START )
+        {
+            if( aReader.Name() == "layers" )
+            {
+                m_xpath->push( "layers" );
 
-        CPTREE& layers = drawing.get_child( "layers" );
-        loadLayerDefs( layers );
+                PTREE layers;
+                aReader.ReadElement( layers );
+                loadLayerDefs( layers );
 
-        m_xpath->pop();
+                m_xpath->pop();
+            }
+            else if( aReader.Name() == "library" )
+            {
+                // a *.lbr file
+                m_xpath->push( "library" );
+                loadLibrary( aReader, NULL );
+                m_xpath->pop();
+            }
+            else if( aReader.Name() == "board" && m_board )
+            {
+                m_xpath->push( "board" );
+                loadBoard( aReader );
+                m_xpath->pop();
+                hasBoard = true;
+            }
+            else
+            {
+                aReader.SkipElement();
+            }
+        }
     }
 
-    {
-        m_xpath->push( "board" );
-
-        CPTREE& plain = board.get_child( "plain" );
-        loadPlain( plain );
+    m_xpath->pop();     // "eagle.drawing"
 
-        CPTREE&  signals = board.get_child( "signals" );
-        loadSignals( signals );
+    return hasBoard;
+}
 
-        CPTREE&  libs = board.get_child( "libraries" );
-        loadLibraries( libs );
 
-        CPTREE& elems = board.get_child( "elements" );
-        loadElements( elems );
+void EAGLE_PLUGIN::loadBoard( XML_READER& aReader )
+{
+    // The sections are converted as they come, in the file order: plain, libraries,
+    // designrules, elements, signals.  The packages of the libraries are converted
+    // when an element uses them, after the design rules they depend on.
+    while( aReader.Next() == XML_READER::START )
+    {
+        const string& section = aReader.Name();
 
-        m_xpath->pop();     // "board"
+        if( section == "plain" )
+        {
+            loadPlain( aReader );
+        }
+        else if( section == "libraries" )
+        {
+            loadLibraries( aReader );
+        }
+        else if( section == "designrules" )
+        {
+            PTREE designrules;
+            aReader.ReadElement( designrules );
+            loadDesignRules( designrules );
+        }
+        else if( section == "elements" )
+        {
+            loadElements( aReader );
+        }
+        else if( section == "signals" )
+        {
+            loadSignals( aReader );
+        }
+        else
+        {
+            aReader.SkipElement();
+        }
     }
-
-    m_xpath->pop();     // "eagle.drawing"
 }
 
 
@@ -1426,18 +2085,24 @@ void EAGLE_PLUGIN::loadLayerDefs( CPTREE& aLayers )
 }
 
 
-void EAGLE_PLUGIN::loadPlain( CPTREE& aGraphics )
+void EAGLE_PLUGIN::loadPlain( XML_READER& aReader )
 {
     m_xpath->push( "plain" );
 
+    PTREE   gr;
+
     // (polygon | wire | text | circle | rectangle | frame | hole)*
-    for( CITER gr = aGraphics.begin();  gr != aGraphics.end();  ++gr )
+    while( aReader.Next() == XML_READER::START )
     {
-        if( gr->first == "wire" )
+        const string& name = aReader.Name();
+
+        aReader.ReadElement( gr );
+
+        if( name == "wire" )
         {
             m_xpath->push( "wire" );
 
-            EWIRE       w( gr->second );
+            EWIRE       w( gr );
             LAYER_ID    layer = kicad_layer( w.layer );
 
             wxPoint start( kicad_x( w.x1 ), kicad_y( w.y1 ) );
@@ -1463,16 +2128,16 @@ void EAGLE_PLUGIN::loadPlain( CPTREE& aGraphics )
                     dseg->SetAngle( *w.curve * -10.0 ); // KiCad rotates the other way
                 }
 
-                dseg->SetTimeStamp( timeStamp( gr->second ) );
+                dseg->SetTimeStamp( newTimeStamp() );
                 dseg->SetLayer( layer );
                 dseg->SetWidth( Millimeter2iu( DEFAULT_PCB_EDGE_THICKNESS ) );
             }
             m_xpath->pop();
         }
-        else if( gr->first == "text" )
+        else if( name == "text" )
         {
 #if defined(DEBUG)
-            if( gr->second.data() == "ATMEGA328" )
+            if( gr.data() == "ATMEGA328" )
             {
                 int breakhere = 1;
                 (void) breakhere;
@@ -1480,7 +2145,7 @@ void EAGLE_PLUGIN::loadPlain( CPTREE& aGraphics )
 #endif
             m_xpath->push( "text" );
 
-            ETEXT       t( gr->second );
+            ETEXT       t( gr );
             LAYER_ID    layer = kicad_layer( t.layer );
 
             if( layer != UNDEFINED_LAYER )
@@ -1489,7 +2154,7 @@ void EAGLE_PLUGIN::loadPlain( CPTREE& aGraphics )
                 m_board->Add( pcbtxt, ADD_APPEND );
 
                 pcbtxt->SetLayer( layer );
-                pcbtxt->SetTimeStamp( timeStamp( gr->second ) );
+                pcbtxt->SetTimeStamp( newTimeStamp() );
                 pcbtxt->SetText( FROM_UTF8( t.text.c_str() ) );
                 pcbtxt->SetTextPosition( wxPoint( kicad_x( t.x ), kicad_y( t.y ) ) );
 
@@ -1564,11 +2229,11 @@ void EAGLE_PLUGIN::loadPlain( CPTREE& aGraphics )
             }
             m_xpath->pop();
         }
-        else if( gr->first == "circle" )
+        else if( name == "circle" )
         {
             m_xpath->push( "circle" );
 
-            ECIRCLE     c( gr->second );
+            ECIRCLE     c( gr );
             LAYER_ID    layer = kicad_layer( c.layer );
 
             if( layer != UNDEFINED_LAYER )       // unsupported layer
@@ -1577,7 +2242,7 @@ void EAGLE_PLUGIN::loadPlain( CPTREE& aGraphics )
                 m_board->Add( dseg, ADD_APPEND );
 
                 dseg->SetShape( S_CIRCLE );
-                dseg->SetTimeStamp( timeStamp( gr->second ) );
+                dseg->SetTimeStamp( newTimeStamp() );
                 dseg->SetLayer( layer );
                 dseg->SetStart( wxPoint( kicad_x( c.x ), kicad_y( c.y ) ) );
                 dseg->SetEnd( wxPoint( kicad_x( c.x + c.radius ), kicad_y( c.y ) ) );
@@ -1585,13 +2250,13 @@ void EAGLE_PLUGIN::loadPlain( CPTREE& aGraphics )
             }
             m_xpath->pop();
         }
-        else if( gr->first == "rectangle" )
+        else if( name == "rectangle" )
         {
             // This seems to be a simplified rectangular [copper] zone, cannot find any
             // net related info on it from the DTD.
             m_xpath->push( "rectangle" );
 
-            ERECT       r( gr->second );
+            ERECT       r( gr );
             LAYER_ID    layer = kicad_layer( r.layer );
 
             if( IsCopperLayer( layer ) )
@@ -1600,7 +2265,7 @@ void EAGLE_PLUGIN::loadPlain( CPTREE& aGraphics )
                 ZONE_CONTAINER* zone = new ZONE_CONTAINER( m_board );
                 m_board->Add( zone, ADD_APPEND );
 
-                zone->SetTimeStamp( timeStamp( gr->second ) );
+                zone->SetTimeStamp( newTimeStamp() );
                 zone->SetLayer( layer );
                 zone->SetNetCode( NETINFO_LIST::UNCONNECTED );
 
@@ -1619,10 +2284,10 @@ void EAGLE_PLUGIN::loadPlain( CPTREE& aGraphics )
 
             m_xpath->pop();
         }
-        else if( gr->first == "hole" )
+        else if( name == "hole" )
         {
             m_xpath->push( "hole" );
-            EHOLE   e( gr->second );
+            EHOLE   e( gr );
 
             // Fabricate a MODULE with a single PAD_ATTRIB_HOLE_NOT_PLATED pad.
             // Use m_hole_count to gen up a unique name.
@@ -1661,18 +2326,18 @@ void EAGLE_PLUGIN::loadPlain( CPTREE& aGraphics )
             pad->SetLayerSet( LSET::AllCuMask() );
             m_xpath->pop();
         }
-        else if( gr->first == "frame" )
+        else if( name == "frame" )
         {
             // picture this
         }
-        else if( gr->first == "polygon" )
+        else if( name == "polygon" )
         {
             // could be on a copper layer, could be on another layer.
             // copper layer would be done using netCode=0 type of ZONE_CONTAINER.
         }
-        else if( gr->first == "dimension" )
+        else if( name == "dimension" )
         {
-            EDIMENSION d( gr->second );
+            EDIMENSION d( gr );
 
             DIMENSION* dimension = new DIMENSION( m_board );
             m_board->Add( dimension, ADD_APPEND );
@@ -1708,83 +2373,130 @@ void EAGLE_PLUGIN::loadPlain( CPTREE& aGraphics )
 }
 
 
-void EAGLE_PLUGIN::loadLibrary( CPTREE& aLib, const string* aLibName )
+void EAGLE_PLUGIN::loadLibrary( XML_READER& aReader, const string* aLibName )
 {
-    m_xpath->push( "packages" );
+    // library will have <xmlattr> node, skip the other nodes and get the single packages node
+    while( aReader.Next() == XML_READER::START )
+    {
+        if( aReader.Name() != "packages" )
+        {
+            aReader.SkipElement();
+            continue;
+        }
 
-    // library will have <xmlattr> node, skip that and get the single packages node
-    CPTREE& packages = aLib.get_child( "packages" );
+        m_xpath->push( "packages" );
 
-    // Create a MODULE for all the eagle packages, for use later via a copy constructor
-    // to instantiate needed MODULES in our BOARD.  Save the MODULE templates in
-    // a MODULE_MAP using a single lookup key consisting of libname+pkgname.
+        // Keep the eagle packages, a MODULE is made of a package when it is first used,
+        // for use later via a copy constructor to instantiate needed MODULES in our
+        // BOARD.  Save the packages in a PACKAGE_MAP using a single lookup key consisting
+        // of libname+pkgname.
 
-    for( CITER package = packages.begin();  package != packages.end();  ++package )
-    {
-        m_xpath->push( "package", "name" );
+        while( aReader.Next() == XML_READER::START )
+        {
+            if( aReader.Name() != "package" )
+            {
+                aReader.SkipElement();
+                continue;
+            }
 
-        const string& pack_ref = package->second.get<string>( "<xmlattr>.name" );
+            m_xpath->push( "package", "name" );
 
-        string pack_name( pack_ref );
+            std::unique_ptr<PTREE> package( new PTREE() );
 
-        ReplaceIllegalFileNameChars( &pack_name );
+            aReader.ReadElement( *package );
 
-#if 0 && defined(DEBUG)
-        if( pack_name == "TO220H" )
-        {
-            int breakhere = 1;
-            (void) breakhere;
-        }
-#endif
-        m_xpath->Value( pack_name.c_str() );
+            const string& pack_ref = package->get<string>( "<xmlattr>.name" );
 
-        string key = aLibName ? makeKey( *aLibName, pack_name ) : pack_name;
+            string pack_name( pack_ref );
 
-        MODULE* m = makeModule( package->second, pack_name );
+            ReplaceIllegalFileNameChars( &pack_name );
 
-        // add the templating MODULE to the MODULE template factory "m_templates"
-        std::pair<MODULE_ITER, bool> r = m_templates.insert( key, m );
+            m_xpath->Value( pack_name );
 
-        if( !r.second
-            // && !( m_props && m_props->Value( "ignore_duplicates" ) )
-            )
-        {
-            wxString lib = aLibName ? FROM_UTF8( aLibName->c_str() ) : m_lib_path;
-            wxString pkg = FROM_UTF8( pack_name.c_str() );
+            string key = aLibName ? makeKey( *aLibName, pack_name ) : pack_name;
 
-            wxString emsg = wxString::Format(
-                _( "<package> name: '%s' duplicated in eagle <library>: '%s'" ),
-                GetChars( pkg ),
-                GetChars( lib )
-                );
-            THROW_IO_ERROR( emsg );
+            // add the package to the package table "m_packages", which deletes it if
+            // its key is already there
+            std::pair<PACKAGE_MAP::iterator, bool> r = m_packages.insert( key, package.release() );
+
+            if( !r.second
+                // && !( m_props && m_props->Value( "ignore_duplicates" ) )
+                )
+            {
+                wxString lib = aLibName ? FROM_UTF8( aLibName->c_str() ) : m_lib_path;
+                wxString pkg = FROM_UTF8( pack_name.c_str() );
+
+                wxString emsg = wxString::Format(
+                    _( "<package> name: '%s' duplicated in eagle <library>: '%s'" ),
+                    GetChars( pkg ),
+                    GetChars( lib )
+                    );
+                THROW_IO_ERROR( emsg );
+            }
+
+            m_xpath->pop();
         }
 
-        m_xpath->pop();
+        m_xpath->pop();     // "packages"
     }
-
-    m_xpath->pop();     // "packages"
 }
 
 
-void EAGLE_PLUGIN::loadLibraries( CPTREE& aLibs )
+void EAGLE_PLUGIN::loadLibraries( XML_READER& aReader )
 {
     m_xpath->push( "libraries.library", "name" );
 
-    for( CITER library = aLibs.begin();  library != aLibs.end();  ++library )
+    while( aReader.Next() == XML_READER::START )
     {
-        const string& lib_name = library->second.get<string>( "<xmlattr>.name" );
+        if( aReader.Name() != "library" )
+        {
+            aReader.SkipElement();
+            continue;
+        }
 
-        m_xpath->Value( lib_name.c_str() );
+        const string lib_name = aReader.Element().get<string>( "<xmlattr>.name" );
 
-        loadLibrary( library->second, &lib_name );
+        m_xpath->Value( lib_name );
+
+        loadLibrary( aReader, &lib_name );
     }
 
     m_xpath->pop();
 }
 
 
-void EAGLE_PLUGIN::loadElements( CPTREE& aElements )
+MODULE* EAGLE_PLUGIN::makeTemplate( const string& aKey )
+{
+    MODULE_ITER mi = m_templates.find( aKey );
+
+    if( mi != m_templates.end() )
+        return mi->second;
+
+    PACKAGE_MAP::const_iterator pi = m_packages.find( aKey );
+
+    if( pi == m_packages.end() )
+        return NULL;
+
+    // the key is libname+pkgname, or pkgname for a *.lbr file
+    size_t  separator = aKey.find( '\x02' );
+    string  pack_name = separator == aKey.npos ? aKey : aKey.substr( separator + 1 );
+
+    m_xpath->push( "package", "name" );
+    m_xpath->Value( pack_name );
+
+    MODULE* m = makeModule( *pi->second, pack_name );
+
+    // add the templating MODULE to the MODULE template factory "m_templates"
+    string key = aKey;
+    m_templates.insert( key, m );
+
+    m_xpath->pop();
+
+    return m;
+}
+
+
+void EAGLE_PLUGIN::loadElements( XML_READER& aReader )
 {
     m_xpath->push( "elements.element", "name" );
 
@@ -1793,14 +2505,19 @@ void EAGLE_PLUGIN::loadElements( CPTREE& aElements )
     bool refanceNamePresetInPackageLayout;
     bool valueNamePresetInPackageLayout;
 
+    PTREE   element;
 
-
-    for( CITER it = aElements.begin();  it != aElements.end();  ++it )
+    while( aReader.Next() == XML_READER::START )
     {
-        if( it->first != "element" )
+        if( aReader.Name() != "element" )
+        {
+            aReader.SkipElement();
             continue;
+        }
 
-        EELEMENT    e( it->second );
+        aReader.ReadElement( element );
+
+        EELEMENT    e( element );
 
         // use "NULL-ness" as an indication of presence of the attribute:
         EATTR*      nameAttr  = 0;
@@ -1810,9 +2527,9 @@ void EAGLE_PLUGIN::loadElements( CPTREE& aElements )
 
         string pkg_key = makeKey( e.library, e.package );
 
-        MODULE_CITER mi = m_templates.find( pkg_key );
+        const MODULE* tmpl = makeTemplate( pkg_key );
 
-        if( mi == m_templates.end() )
+        if( !tmpl )
         {
             wxString emsg = wxString::Format( _( "No '%s' package in library '%s'" ),
                                               GetChars( FROM_UTF8( e.package.c_str() ) ),
@@ -1828,10 +2545,13 @@ void EAGLE_PLUGIN::loadElements( CPTREE& aElements )
         }
 #endif
         // copy constructor to clone the template
-        MODULE* m = new MODULE( *mi->second );
+        MODULE* m = new MODULE( *tmpl );
         m_board->Add( m, ADD_APPEND );
 
-        // update the nets within the pads of the clone
+        // the signals setting the nets of its pads usually come after the element
+        m_elements[e.name] = m;
+
+        // update the nets within the pads of the clone, from the signals read before it
         for( D_PAD* pad = m->Pads();  pad;  pad = pad->Next() )
         {
             string pn_key  = makeKey( e.name, TO_UTF8( pad->GetPadName() ) );
@@ -1883,7 +2603,7 @@ void EAGLE_PLUGIN::loadElements( CPTREE& aElements )
             // EATTR override the ones established in the package only if they are
             // present here (except for rot, which if not present means angle zero).
             // So the logic is a bit different than in packageText() and in plain text.
-            for( CITER ait = it->second.begin();  ait != it->second.end();  ++ait )
+            for( CITER ait = element.begin();  ait != element.end();  ++ait )
             {
 
                 if( ait->first != "attribute" )
@@ -2606,21 +3326,28 @@ void EAGLE_PLUGIN::packageSMD( MODULE* aModule, CPTREE& aTree ) const
 typedef std::vector<ZONE_CONTAINER*>    ZONES;
 
 
-void EAGLE_PLUGIN::loadSignals( CPTREE& aSignals )
+void EAGLE_PLUGIN::loadSignals( XML_READER& aReader )
 {
     ZONES   zones;      // per net
+    PTREE   item;
 
     m_xpath->push( "signals.signal", "name" );
 
     int netCode = 1;
 
-    for( CITER net = aSignals.begin();  net != aSignals.end();  ++net )
+    while( aReader.Next() == XML_READER::START )
     {
+        if( aReader.Name() != "signal" )
+        {
+            aReader.SkipElement();
+            continue;
+        }
+
         bool    sawPad = false;
 
         zones.clear();
 
-        const string& nname = net->second.get<string>( "<xmlattr>.name" );
+        const string nname = aReader.Element().get<string>( "<xmlattr>.name" );
         wxString netName = FROM_UTF8( nname.c_str() );
         m_board->AppendNet( new NETINFO_ITEM( m_board, netName, netCode ) );
 
@@ -2633,20 +3360,25 @@ void EAGLE_PLUGIN::loadSignals( CPTREE& aSignals )
             (void) breakhere;
         }
 #endif
-        // (contactref | polygon | wire | via)*
-        for( CITER it = net->second.begin();  it != net->second.end();  ++it )
+        // (contactref | polygon | wire | via)*, read one at a time since a signal can
+        // hold a large part of the board
+        while( aReader.Next() == XML_READER::START )
         {
-            if( it->first == "wire" )
+            const string& name = aReader.Name();
+
+            aReader.ReadElement( item );
+
+            if( name == "wire" )
             {
                 m_xpath->push( "wire" );
-                EWIRE   w( it->second );
+                EWIRE   w( item );
                 LAYER_ID  layer = kicad_layer( w.layer );
 
                 if( IsCopperLayer( layer ) )
                 {
                     TRACK*  t = new TRACK( m_board );
 
-                    t->SetTimeStamp( timeStamp( it->second ) );
+                    t->SetTimeStamp( newTimeStamp() );
 
                     t->SetPosition( wxPoint( kicad_x( w.x1 ), kicad_y( w.y1 ) ) );
                     t->SetEnd( wxPoint( kicad_x( w.x2 ), kicad_y( w.y2 ) ) );
@@ -2669,10 +3401,10 @@ void EAGLE_PLUGIN::loadSignals( CPTREE& aSignals )
                 m_xpath->pop();
             }
 
-            else if( it->first == "via" )
+            else if( name == "via" )
             {
                 m_xpath->push( "via" );
-                EVIA    v( it->second );
+                EVIA    v( item );
 
                 LAYER_ID  layer_front_most = kicad_layer( v.layer_front_most );
                 LAYER_ID  layer_back_most  = kicad_layer( v.layer_back_most );
@@ -2715,7 +3447,7 @@ void EAGLE_PLUGIN::loadSignals( CPTREE& aSignals )
                     else
                         via->SetViaType( VIA_BLIND_BURIED );
 
-                    via->SetTimeStamp( timeStamp( it->second ) );
+                    via->SetTimeStamp( newTimeStamp() );
 
                     wxPoint pos( kicad_x( v.x ), kicad_y( v.y ) );
 
@@ -2727,11 +3459,11 @@ void EAGLE_PLUGIN::loadSignals( CPTREE& aSignals )
                 m_xpath->pop();
             }
 
-            else if( it->first == "contactref" )
+            else if( name == "contactref" )
             {
                 m_xpath->push( "contactref" );
                 // <contactref element="RN1" pad="7"/>
-                CPTREE& attribs = it->second.get_child( "<xmlattr>" );
+                CPTREE& attribs = item.get_child( "<xmlattr>" );
 
                 const string& reference = attribs.get<string>( "element" );
                 const string& pad       = attribs.get<string>( "pad" );
@@ -2742,16 +3474,28 @@ void EAGLE_PLUGIN::loadSignals( CPTREE& aSignals )
 
                 m_pads_to_nets[ key ] = ENET( netCode, nname );
 
+                // the element was usually read before its signals
+                ELEMENT_MAP::const_iterator ei = m_elements.find( reference );
+
+                if( ei != m_elements.end() )
+                {
+                    for( D_PAD* dpad = ei->second->Pads();  dpad;  dpad = dpad->Next() )
+                    {
+                        if( pad == TO_UTF8( dpad->GetPadName() ) )
+                            dpad->SetNetCode( netCode );
+                    }
+                }
+
                 m_xpath->pop();
 
                 sawPad = true;
             }
 
-            else if( it->first == "polygon" )
+            else if( name == "polygon" )
             {
                 m_xpath->push( "polygon" );
 
-                EPOLYGON    p( it->second );
+                EPOLYGON    p( item );
                 LAYER_ID    layer = kicad_layer( p.layer );
 
                 if( IsCopperLayer( layer ) )
@@ -2761,12 +3505,12 @@ void EAGLE_PLUGIN::loadSignals( CPTREE& aSignals )
                     m_board->Add( zone, ADD_APPEND );
                     zones.push_back( zone );
 
-                    zone->SetTimeStamp( timeStamp( it->second ) );
+                    zone->SetTimeStamp( newTimeStamp() );
                     zone->SetLayer( layer );
                     zone->SetNetCode( netCode );
 
                     bool first = true;
-                    for( CITER vi = it->second.begin();  vi != it->second.end();  ++vi )
+                    for( CITER vi = item.begin();  vi != item.end();  ++vi )
                     {
                         if( vi->first != "vertex" )     // skip <xmlattr> node
                             continue;
@@ -3053,48 +3797,28 @@ void EAGLE_PLUGIN::cacheLib( const wxString& aLibPath )
 
         if( aLibPath != m_lib_path || load )
         {
-            PTREE       doc;
             LOCALE_IO   toggle;     // toggles on, then off, the C locale.
 
             m_templates.clear();
+            m_packages.clear();
 
             // Set this before completion of loading, since we rely on it for
             // text of an exception.  Delay setting m_mod_time until after successful load
             // however.
             m_lib_path = aLibPath;
 
-            // 8 bit "filename" should be encoded according to disk filename encoding,
-            // (maybe this is current locale, maybe not, its a filesystem issue),
-            // and is not necessarily utf8.
-            string filename = (const char*) aLibPath.char_str( wxConvFile );
-
-            read_xml( filename, doc, xml_parser::no_comments );
+            XML_READER  reader( aLibPath );
 
             // clear the cu map and then rebuild it.
             clear_cu_map();
 
-            m_xpath->push( "eagle.drawing.layers" );
-            CPTREE& layers  = doc.get_child( "eagle.drawing.layers" );
-            loadLayerDefs( layers );
-            m_xpath->pop();
-
-            m_xpath->push( "eagle.drawing.library" );
-            CPTREE& library = doc.get_child( "eagle.drawing.library" );
-            loadLibrary( library, NULL );
-            m_xpath->pop();
+            loadAllSections( reader );
 
             m_mod_time = modtime;
         }
     }
-    catch( file_parser_error fpe )
-    {
-        // for xml_parser_error, what() has the line number in it,
-        // but no byte offset.  That should be an adequate error message.
-        THROW_IO_ERROR( fpe.what() );
-    }
 
-    // Class ptree_error is a base class for xml_parser_error & file_parser_error,
-    // so one catch should be OK for all errors.
+    // Class ptree_error is thrown for a missing or invalid attribute.
     catch( ptree_error pte )
     {
         string errmsg = pte.what();
@@ -3115,7 +3839,7 @@ wxArrayString EAGLE_PLUGIN::FootprintEnumerate( const wxString& aLibraryPath, co
 
     wxArrayString   ret;
 
-    for( MODULE_CITER it = m_templates.begin();  it != m_templates.end();  ++it )
+    for( PACKAGE_MAP::const_iterator it = m_packages.begin();  it != m_packages.end();  ++it )
         ret.Add( FROM_UTF8( it->first.c_str() ) );
 
     return ret;
@@ -3131,13 +3855,28 @@ MODULE* EAGLE_PLUGIN::FootprintLoad( const wxString& aLibraryPath, const wxStrin
 
     string key = TO_UTF8( aFootprintName );
 
-    MODULE_CITER mi = m_templates.find( key );
+    LOCALE_IO       toggle;     // toggles on, then off, the C locale.
+    const MODULE*   tmpl;
+
+    try
+    {
+        tmpl = makeTemplate( key );
+    }
+    catch( ptree_error pte )
+    {
+        string errmsg = pte.what();
+
+        errmsg += " @\n";
+        errmsg += m_xpath->Contents();
+
+        THROW_IO_ERROR( errmsg );
+    }
 
-    if( mi == m_templates.end() )
+    if( !tmpl )
         return NULL;
 
     // copy constructor to clone the template
-    MODULE* ret = new MODULE( *mi->second );
+    MODULE* ret = new MODULE( *tmpl );
 
     return ret;
 }
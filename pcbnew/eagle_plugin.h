@@ -62,8 +62,14 @@ typedef NET_MAP::const_iterator         NET_MAP_CITER;
 typedef boost::property_tree::ptree     PTREE;
 typedef const PTREE                     CPTREE;
 
+typedef boost::ptr_map< std::string, PTREE >    PACKAGE_MAP;
+
+/// board MODULEs by Eagle element name
+typedef std::map< std::string, MODULE* >        ELEMENT_MAP;
+
 struct EELEMENT;
 class XPATH;
+class XML_READER;
 struct ERULES;
 struct EATTR;
 class TEXTE_MODULE;
@@ -125,8 +131,15 @@ private:
                                     ///< XML document during a Load().
 
     int         m_hole_count;       ///< generates unique module names from eagle "hole"s.
+    unsigned long m_time_stamp;     ///< last time stamp given by newTimeStamp()
 
     NET_MAP     m_pads_to_nets;     ///< net list
+    ELEMENT_MAP m_elements;         ///< modules loaded, to set the nets of their pads when
+                                    ///< the signals come after the elements.
+
+    PACKAGE_MAP m_packages;         ///< XML trees of the library packages, same keys as
+                                    ///< m_templates.  A template is made from a package
+                                    ///< when it is first used.
 
     MODULE_MAP  m_templates;        ///< is part of a MODULE factory that operates
                                     ///< using copy construction.
@@ -151,6 +164,9 @@ private:
 
     void    clear_cu_map();
 
+    /// Make a unique time stamp for a board item
+    unsigned long newTimeStamp();
+
     /// Convert an Eagle distance to a KiCad distance.
     int     kicad( double d ) const;
     int     kicad_y( double y ) const       { return -kicad( y ); }
@@ -173,29 +189,43 @@ private:
     /// get a file's  or dir's modification time.
     static wxDateTime getModificationTime( const wxString& aPath );
 
-    // all these loadXXX() throw IO_ERROR or ptree_error exceptions:
+    // all these loadXXX() throw IO_ERROR or ptree_error exceptions.  The ones taking
+    // an XML_READER read the content of the element the reader just started:
 
-    void loadAllSections( CPTREE& aDocument );
+    /**
+     * Function loadAllSections
+     * loads a *.brd file into m_board, or the packages of a *.lbr file if m_board
+     * is NULL.
+     * @return true if a <board> element was loaded into m_board.
+     */
+    bool loadAllSections( XML_READER& aReader );
+    void loadBoard( XML_READER& aReader );
     void loadDesignRules( CPTREE& aDesignRules );
     void loadLayerDefs( CPTREE& aLayers );
-    void loadPlain( CPTREE& aPlain );
-    void loadSignals( CPTREE& aSignals );
+    void loadPlain( XML_READER& aReader );
+    void loadSignals( XML_READER& aReader );
 
     /**
      * Function loadLibrary
-     * loads the Eagle "library" XML element, which can occur either under
-     * a "libraries" element (if a *.brd file) or under a "drawing" element if a
-     * *.lbr file.
-     * @param aLib is the portion of the loaded XML document tree that is the "library"
-     *   element.
+     * loads the packages of the Eagle "library" XML element into m_packages.  The
+     * "library" element can occur either under a "libraries" element (if a *.brd file)
+     * or under a "drawing" element if a *.lbr file.
+     * @param aReader is at the start of the "library" element.
      * @param aLibName is a pointer to the library name or NULL.  If NULL this means
-     *   we are loading a *.lbr not a *.brd file and the key used in m_templates is to exclude
+     *   we are loading a *.lbr not a *.brd file and the key used in m_packages is to exclude
      *   the library name.
      */
-    void loadLibrary( CPTREE& aLib, const std::string* aLibName );
+    void loadLibrary( XML_READER& aReader, const std::string* aLibName );
+
+    void loadLibraries( XML_READER& aReader );
+    void loadElements( XML_READER& aReader );
 
-    void loadLibraries( CPTREE& aLibs );
-    void loadElements( CPTREE& aElements );
+    /**
+     * Function makeTemplate
+     * returns the template MODULE of the package @a aKey, made from m_packages the
+     * first time, or NULL if there is no such package.
+     */
+    MODULE* makeTemplate( const std::string& aKey );
 
     void orientModuleAndText( MODULE* m, const EELEMENT& e, const EATTR* nameAttr, const EATTR* valueAttr );
     void orientModuleText( MODULE* m, const EELEMENT& e, TEXTE_MODULE* txt, const EATTR* a );
@@ -46,6 +46,7 @@
 #include <pcbnew.h>
 #include <pcbnew_id.h>
 #include <io_mgr.h>
+#include <pcb_snapshot_plugin.h>
 #include <wildcards_and_files_ext.h>
 
 #include <class_board.h>
@@ -511,7 +512,24 @@ bool PCB_EDIT_FRAME::OpenProjectFiles( const std::vector<wxString>& aFileSet, in
             unsigned startTime = GetRunningMicroSecs();
 #endif
 
-            loadedBoard = pi->Load( fullFileName, NULL, &props );
+            // A snapshot written with the current board file is much faster to load
+            if( pluginType == IO_MGR::KICAD && PCB_SNAPSHOT_PLUGIN::IsFresh( fullFileName ) )
+            {
+                PLUGIN::RELEASER snapshot( IO_MGR::PluginFind( IO_MGR::KICAD_SNAPSHOT ) );
+
+                try
+                {
+                    loadedBoard = snapshot->Load(
+                            PCB_SNAPSHOT_PLUGIN::SnapshotFileName( fullFileName ), NULL, &props );
+                }
+                catch( const IO_ERROR& )
+                {
+                    // Not fatal: the board file is loaded instead
+                }
+            }
+
+            if( !loadedBoard )
+                loadedBoard = pi->Load( fullFileName, NULL, &props );
 
 #if USE_INSTRUMENTATION
             unsigned stopTime = GetRunningMicroSecs();
@@ -720,7 +738,17 @@ bool PCB_EDIT_FRAME::SavePcbFile( const wxString& aFileName, bool aCreateBackupF
 
         wxASSERT( pcbFileName.IsAbsolute() );
 
+#if USE_INSTRUMENTATION
+        // measure the time to save a BOARD.
+        unsigned startTime = GetRunningMicroSecs();
+#endif
+
         pi->Save( pcbFileName.GetFullPath(), GetBoard(), NULL );
+
+#if USE_INSTRUMENTATION
+        unsigned stopTime = GetRunningMicroSecs();
+        printf( "PLUGIN::Save(): %u usecs\n", stopTime - startTime );
+#endif
     }
     catch( const IO_ERROR& ioe )
     {
@@ -738,6 +766,29 @@ bool PCB_EDIT_FRAME::SavePcbFile( const wxString& aFileName, bool aCreateBackupF
         return false;
     }
 
+    if( m_saveBoardSnapshot )
+    {
+        wxString snapshotFileName = PCB_SNAPSHOT_PLUGIN::SnapshotFileName(
+                pcbFileName.GetFullPath() );
+
+        try
+        {
+            PLUGIN::RELEASER    pi( IO_MGR::PluginFind( IO_MGR::KICAD_SNAPSHOT ) );
+
+            pi->Save( snapshotFileName, GetBoard(), NULL );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            // Not fatal: the board file is saved, only the next load is slower
+            wxString msg = wxString::Format( _(
+                    "Warning: unable to create board snapshot '%s'.\n%s" ),
+                    GetChars( snapshotFileName ),
+                    GetChars( ioe.errorText )
+                    );
+            DisplayError( this, msg );
+        }
+    }
+
     GetBoard()->SetFileName( pcbFileName.GetFullPath() );
     UpdateTitle();
 
@@ -756,6 +807,12 @@ bool PCB_EDIT_FRAME::SavePcbFile( const wxString& aFileName, bool aCreateBackupF
     if( autoSaveFileName.FileExists() )
         wxRemoveFile( autoSaveFileName.GetFullPath() );
 
+    wxString autoSaveSnapshot = PCB_SNAPSHOT_PLUGIN::SnapshotFileName(
+            autoSaveFileName.GetFullPath() );
+
+    if( wxFileExists( autoSaveSnapshot ) )
+        wxRemoveFile( autoSaveSnapshot );
+
     if( !!backupFileName )
         upperTxt.Printf( _( "Backup file: '%s'" ), GetChars( backupFileName ) );
 
@@ -98,7 +98,7 @@ void FOOTPRINT_WIZARD_FRAME::ReloadFootprint()
 
     SetCurItem( NULL );
     // Delete the current footprint
-    GetBoard()->m_Modules.DeleteAll();
+    GetBoard()->DeleteAllModules();
 
     // Creates the module
     wxString msg;
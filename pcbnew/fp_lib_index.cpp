@@ -0,0 +1,499 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file fp_lib_index.cpp
+ */
+
+#include <fctsys.h>
+#include <common.h>
+#include <macros.h>
+#include <wildcards_and_files_ext.h>
+#include <dsnlexer.h>
+
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include <wx/dir.h>
+
+#include <class_module.h>
+#include <pcb_parser.h>
+#include <fp_lib_index.h>
+#include <thread_pool.h>
+
+
+#define FP_LIB_INDEX_VERSION    1       ///< change it when the index file format changes
+
+
+/// A footprint file read by FP_LIB_INDEX::Update(), and the result of reading it
+struct READ_JOB
+{
+    READ_JOB( const wxFileName& aFileName ) :
+        m_fileName( aFileName )
+    {
+    }
+
+    wxFileName                  m_fileName;
+    FP_LIB_INDEX::ENTRY         m_entry;
+    std::unique_ptr<IO_ERROR>   m_error;
+};
+
+
+/**
+ * Function needList
+ * reads the beginning "(aName" of a list of an index file.
+ */
+static void needList( DSNLEXER& aLexer, const char* aName ) throw( IO_ERROR )
+{
+    aLexer.NeedLEFT();
+    aLexer.NeedSYMBOL();
+
+    if( strcmp( aLexer.CurText(), aName ) )
+        aLexer.Expecting( aName );
+}
+
+
+FP_LIB_INDEX::FP_LIB_INDEX( const wxString& aLibraryPath ) :
+    m_modified( false )
+{
+    m_libPath.SetPath( aLibraryPath );
+}
+
+
+wxString FP_LIB_INDEX::indexFileName() const
+{
+    // The index files are named by a hash of the library path
+    std::string         path = TO_UTF8( m_libPath.GetPath() );
+    unsigned long long  hash = 14695981039346656037ULL;
+
+    for( unsigned ii = 0; ii < path.size(); ++ii )
+    {
+        hash ^= (unsigned char) path[ii];
+        hash *= 1099511628211ULL;
+    }
+
+    wxFileName fn;
+
+    fn.AssignDir( GetKicadConfigPath() );
+    fn.AppendDir( wxT( "fp-lib-index" ) );
+    fn.SetFullName( wxString::Format( wxT( "%016llx.index" ), hash ) );
+
+    return fn.GetFullPath();
+}
+
+
+bool FP_LIB_INDEX::getFileStamp( const wxFileName& aFileName, long long* aSize, long long* aTime )
+{
+    if( !aFileName.FileExists() )
+        return false;
+
+    *aSize = aFileName.GetSize().GetValue();
+    *aTime = aFileName.GetModificationTime().GetValue().GetValue();
+
+    return true;
+}
+
+
+void FP_LIB_INDEX::Load()
+{
+    wxString fileName = indexFileName();
+
+    m_entries.clear();
+
+    // Without a valid stored index, Save() has to write one
+    m_modified = true;
+
+    if( !wxFileExists( fileName ) )
+        return;
+
+    try
+    {
+        FILE_LINE_READER reader( fileName );
+
+        parse( &reader );
+        m_modified = false;
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        wxLogDebug( wxT( "Ignoring footprint library index '%s': %s" ),
+                    GetChars( fileName ), GetChars( ioe.errorText ) );
+        m_entries.clear();
+    }
+}
+
+
+void FP_LIB_INDEX::parse( LINE_READER* aReader ) throw( IO_ERROR, PARSE_ERROR )
+{
+    DSNLEXER lexer( NULL, 0, aReader );
+
+    // (fp_lib_index (version 1) (path "/path/of/the/library.pretty")
+    needList( lexer, "fp_lib_index" );
+    needList( lexer, "version" );
+    lexer.NeedNUMBER( "version" );
+
+    if( atoi( lexer.CurText() ) != FP_LIB_INDEX_VERSION )
+        THROW_IO_ERROR( _( "Unsupported footprint library index version" ) );
+
+    lexer.NeedRIGHT();
+    needList( lexer, "path" );
+    lexer.NeedSYMBOLorNUMBER();
+
+    // Another library with the same index file name
+    if( lexer.FromUTF8() != m_libPath.GetPath() )
+        THROW_IO_ERROR( _( "Footprint library index of another library" ) );
+
+    lexer.NeedRIGHT();
+
+    // (footprint "name" (size 1234) (time 1456789012000) (pads 2) (unique_pads 2)
+    //            (keywords "...") (doc "..."))
+    for( int token = lexer.NextTok();  token != DSN_RIGHT;  token = lexer.NextTok() )
+    {
+        if( token != DSN_LEFT )
+            lexer.Expecting( DSN_LEFT );
+
+        lexer.NeedSYMBOL();
+
+        if( strcmp( lexer.CurText(), "footprint" ) )
+            lexer.Expecting( "footprint" );
+
+        lexer.NeedSYMBOLorNUMBER();
+
+        wxString    name = lexer.FromUTF8();
+        ENTRY       entry;
+
+        entry.m_fileSize = -1;
+        entry.m_fileTime = -1;
+        entry.m_padCount = 0;
+        entry.m_uniquePadCount = 0;
+
+        for( token = lexer.NextTok();  token != DSN_RIGHT;  token = lexer.NextTok() )
+        {
+            if( token != DSN_LEFT )
+                lexer.Expecting( DSN_LEFT );
+
+            lexer.NeedSYMBOL();
+
+            std::string field = lexer.CurStr();
+
+            if( field == "size" || field == "time" || field == "pads" || field == "unique_pads" )
+            {
+                lexer.NeedNUMBER( field.c_str() );
+
+                long long value = strtoll( lexer.CurText(), NULL, 10 );
+
+                if( field == "size" )
+                    entry.m_fileSize = value;
+                else if( field == "time" )
+                    entry.m_fileTime = value;
+                else if( field == "pads" )
+                    entry.m_padCount = value;
+                else
+                    entry.m_uniquePadCount = value;
+            }
+            else if( field == "keywords" || field == "doc" )
+            {
+                lexer.NeedSYMBOLorNUMBER();
+
+                if( field == "keywords" )
+                    entry.m_keywords = lexer.FromUTF8();
+                else
+                    entry.m_doc = lexer.FromUTF8();
+            }
+            else
+            {
+                lexer.Expecting( "size, time, pads, unique_pads, keywords or doc" );
+            }
+
+            lexer.NeedRIGHT();
+        }
+
+        m_entries[name] = entry;
+    }
+}
+
+
+void FP_LIB_INDEX::Save() throw( IO_ERROR )
+{
+    if( !m_modified )
+        return;
+
+    wxFileName fn( indexFileName() );
+
+    if( !fn.DirExists() && !fn.Mkdir( wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL ) )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Cannot create footprint library index path '%s'" ),
+                                          GetChars( fn.GetPath() ) ) );
+    }
+
+    // Several programs can update the index of the same library: write a temporary file,
+    // which is then renamed, so the index is never read half written.
+    wxString tempFileName = wxFileName::CreateTempFileName( fn.GetPathWithSep() + fn.GetName() );
+
+    if( tempFileName.IsEmpty() )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Cannot create footprint library index '%s'" ),
+                                          GetChars( fn.GetFullPath() ) ) );
+    }
+
+    try
+    {
+        FILE_OUTPUTFORMATTER formatter( tempFileName );
+
+        formatter.Print( 0, "(fp_lib_index (version %d) (path %s)\n", FP_LIB_INDEX_VERSION,
+                         formatter.Quotew( m_libPath.GetPath() ).c_str() );
+
+        for( ENTRIES::const_iterator it = m_entries.begin();  it != m_entries.end();  ++it )
+        {
+            const ENTRY& entry = it->second;
+
+            formatter.Print( 1, "(footprint %s (size %lld) (time %lld) (pads %d) (unique_pads %d)",
+                             formatter.Quotew( it->first ).c_str(),
+                             entry.m_fileSize, entry.m_fileTime,
+                             entry.m_padCount, entry.m_uniquePadCount );
+
+            formatter.Print( 0, " (keywords %s) (doc %s))\n",
+                             formatter.Quotew( entry.m_keywords ).c_str(),
+                             formatter.Quotew( entry.m_doc ).c_str() );
+        }
+
+        formatter.Print( 0, ")\n" );
+    }
+    catch( const IO_ERROR& )
+    {
+        wxRemoveFile( tempFileName );
+        throw;
+    }
+
+    if( !wxRenameFile( tempFileName, fn.GetFullPath(), true ) )
+    {
+        wxRemoveFile( tempFileName );
+
+        THROW_IO_ERROR( wxString::Format( _( "Cannot rename temporary file '%s' to '%s'" ),
+                                          GetChars( tempFileName ),
+                                          GetChars( fn.GetFullPath() ) ) );
+    }
+
+    m_modified = false;
+}
+
+
+void FP_LIB_INDEX::Update() throw( IO_ERROR, PARSE_ERROR )
+{
+    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
+    wxDir       dir( m_libPath.GetPath() );
+
+    if( !dir.IsOpened() )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Footprint library path '%s' does not exist" ),
+                                          GetChars( m_libPath.GetPath() ) ) );
+    }
+
+    Load();
+
+    ENTRIES     stored;
+    unsigned    kept = 0;
+
+    stored.swap( m_entries );
+
+    // The new or modified footprint files, read by one task each
+    boost::ptr_vector<READ_JOB> jobs;
+    wxString                    fpFileName;
+    wxString                    wildcard = wxT( "*." ) + KiCadFootprintFileExtension;
+
+    for( bool found = dir.GetFirst( &fpFileName, wildcard, wxDIR_FILES );
+         found;
+         found = dir.GetNext( &fpFileName ) )
+    {
+        wxFileName              fn( m_libPath.GetPath(), fpFileName );
+        ENTRIES::const_iterator it = stored.find( fn.GetName() );
+        long long               size;
+        long long               time;
+
+        // An unchanged file keeps its entry
+        if( it != stored.end() && getFileStamp( fn, &size, &time )
+            && size == it->second.m_fileSize && time == it->second.m_fileTime )
+        {
+            m_entries.insert( *it );
+            ++kept;
+            continue;
+        }
+
+        jobs.push_back( new READ_JOB( fn ) );
+    }
+
+    {
+        TASK_GROUP group;
+
+        for( unsigned i = 0;  i < jobs.size();  ++i )
+        {
+            READ_JOB* job = &jobs[i];
+
+            group.Add( [job]()
+                {
+                    try
+                    {
+                        readEntry( job->m_fileName, &job->m_entry );
+                    }
+                    catch( const IO_ERROR& ioe )
+                    {
+                        // Keep reading the other footprints of the library
+                        job->m_error.reset( new IO_ERROR( ioe ) );
+                    }
+                } );
+        }
+
+        group.Wait();
+    }
+
+    std::unique_ptr<IO_ERROR> error;
+
+    for( unsigned i = 0;  i < jobs.size();  ++i )
+    {
+        if( !jobs[i].m_error )
+            setEntry( jobs[i].m_fileName.GetName(), jobs[i].m_entry );
+        else if( !error )
+            error.swap( jobs[i].m_error );
+    }
+
+    // Footprint files were removed
+    if( kept != stored.size() )
+        m_modified = true;
+
+    try
+    {
+        Save();
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        // Not fatal: the index is only a cache
+        wxLogDebug( wxT( "Cannot save footprint library index: %s" ),
+                    GetChars( ioe.errorText ) );
+    }
+
+    if( error )
+        throw IO_ERROR( *error );
+}
+
+
+void FP_LIB_INDEX::makeEntry( const wxFileName& aFileName, const MODULE* aFootprint,
+                              ENTRY* aEntry )
+{
+    if( !getFileStamp( aFileName, &aEntry->m_fileSize, &aEntry->m_fileTime ) )
+    {
+        aEntry->m_fileSize = -1;
+        aEntry->m_fileTime = -1;
+    }
+
+    aEntry->m_padCount          = aFootprint->GetPadCount( DO_NOT_INCLUDE_NPTH );
+    aEntry->m_uniquePadCount    = aFootprint->GetUniquePadCount( DO_NOT_INCLUDE_NPTH );
+    aEntry->m_keywords          = aFootprint->GetKeywords();
+    aEntry->m_doc               = aFootprint->GetDescription();
+}
+
+
+void FP_LIB_INDEX::readEntry( const wxFileName& aFileName, ENTRY* aEntry )
+    throw( IO_ERROR, PARSE_ERROR )
+{
+    MMAP_LINE_READER    reader( aFileName.GetFullPath() );
+    PCB_PARSER          parser( &reader );
+
+    std::unique_ptr<BOARD_ITEM> item( parser.Parse() );
+    MODULE* footprint = dynamic_cast<MODULE*>( item.get() );
+
+    if( !footprint )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "File '%s' is not a footprint file" ),
+                                          GetChars( aFileName.GetFullPath() ) ) );
+    }
+
+    makeEntry( aFileName, footprint, aEntry );
+}
+
+
+void FP_LIB_INDEX::setEntry( const wxString& aFootprintName, const ENTRY& aEntry )
+{
+    ENTRIES::iterator it = m_entries.find( aFootprintName );
+
+    if( it != m_entries.end()
+        && it->second.m_fileSize == aEntry.m_fileSize
+        && it->second.m_fileTime == aEntry.m_fileTime
+        && it->second.m_padCount == aEntry.m_padCount
+        && it->second.m_uniquePadCount == aEntry.m_uniquePadCount
+        && it->second.m_keywords == aEntry.m_keywords
+        && it->second.m_doc == aEntry.m_doc )
+        return;
+
+    m_entries[aFootprintName] = aEntry;
+    m_modified = true;
+}
+
+
+void FP_LIB_INDEX::Set( const wxFileName& aFileName, const MODULE* aFootprint )
+{
+    ENTRY entry;
+
+    makeEntry( aFileName, aFootprint, &entry );
+    setEntry( aFileName.GetName(), entry );
+}
+
+
+void FP_LIB_INDEX::Remove( const wxString& aFootprintName )
+{
+    if( m_entries.erase( aFootprintName ) )
+        m_modified = true;
+}
+
+
+void FP_LIB_INDEX::RemoveMissing()
+{
+    for( ENTRIES::iterator it = m_entries.begin();  it != m_entries.end();  )
+    {
+        wxFileName fn( m_libPath.GetPath(), it->first, KiCadFootprintFileExtension );
+
+        if( fn.FileExists() )
+        {
+            ++it;
+        }
+        else
+        {
+            m_entries.erase( it++ );
+            m_modified = true;
+        }
+    }
+}
+
+
+bool FP_LIB_INDEX::IsModified( const wxFileName& aFileName ) const
+{
+    ENTRIES::const_iterator it = m_entries.find( aFileName.GetName() );
+    long long               size;
+    long long               time;
+
+    if( it == m_entries.end() || !getFileStamp( aFileName, &size, &time ) )
+        return true;
+
+    return size != it->second.m_fileSize || time != it->second.m_fileTime;
+}
@@ -0,0 +1,151 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file fp_lib_index.h
+ * @brief Persistent index of the footprints of a KiCad footprint library directory.
+ */
+
+#ifndef FP_LIB_INDEX_H_
+#define FP_LIB_INDEX_H_
+
+#include <map>
+
+#include <wx/filename.h>
+
+#include <richio.h>
+
+class MODULE;
+
+
+/**
+ * Class FP_LIB_INDEX
+ * holds the information listed by the footprint choosers (pad counts, keywords and
+ * description) for each footprint file of a .pretty library directory, with the size
+ * and the modification time of the file it was read from.
+ *
+ * The index is stored in the "fp-lib-index" directory of the KiCad configuration
+ * path, one file per library directory, so read only libraries are indexed too.  It is
+ * only a cache: a missing or unreadable index is rebuilt from the footprint files.
+ */
+class FP_LIB_INDEX
+{
+public:
+    struct ENTRY
+    {
+        long long   m_fileSize;
+        long long   m_fileTime;             ///< modification time of the file, in ms
+        int         m_padCount;             ///< pad count, without NPTH pads
+        int         m_uniquePadCount;       ///< unique pad count, without NPTH pads
+        wxString    m_keywords;
+        wxString    m_doc;
+    };
+
+    /// Entries by footprint name (the footprint file name, without its extension)
+    typedef std::map<wxString, ENTRY> ENTRIES;
+
+    FP_LIB_INDEX( const wxString& aLibraryPath );
+
+    const ENTRIES& GetEntries() const { return m_entries; }
+
+    /**
+     * Function Load
+     * reads the stored index of the library, if any.  An invalid index is ignored.
+     */
+    void Load();
+
+    /**
+     * Function Save
+     * stores the index, if it was modified since it was loaded or saved.
+     * @throw IO_ERROR if the index file cannot be written.
+     */
+    void Save() throw( IO_ERROR );
+
+    /**
+     * Function Update
+     * loads the stored index, and brings it up to date with the library directory: the
+     * entries of the removed footprint files are removed, and only the new or modified
+     * footprint files are read.  The updated index is stored, if possible.
+     *
+     * A footprint file which cannot be read does not prevent reading the other ones.
+     * @throw IO_ERROR or PARSE_ERROR for the first footprint file which cannot be read,
+     *        after updating the index, or if the library directory does not exist.
+     */
+    void Update() throw( IO_ERROR, PARSE_ERROR );
+
+    /**
+     * Function Set
+     * stores the information of @a aFootprint, read from or written to the footprint
+     * file @a aFileName.
+     */
+    void Set( const wxFileName& aFileName, const MODULE* aFootprint );
+
+    /**
+     * Function Remove
+     * removes the entry of the footprint @a aFootprintName.
+     */
+    void Remove( const wxString& aFootprintName );
+
+    /**
+     * Function RemoveMissing
+     * removes the entries whose footprint file no longer exists.
+     */
+    void RemoveMissing();
+
+    /**
+     * Function IsModified
+     * @return true if the footprint file @a aFileName is not in the index, was removed, or
+     * if its size or its modification time changed since its entry was stored.
+     */
+    bool IsModified( const wxFileName& aFileName ) const;
+
+private:
+    /// Gets the size and the modification time of a file, returns false if it does not exist
+    static bool getFileStamp( const wxFileName& aFileName, long long* aSize, long long* aTime );
+
+    /// The name of the file holding the index of m_libPath
+    wxString indexFileName() const;
+
+    /// Fills aEntry with the information of aFootprint, read from aFileName
+    static void makeEntry( const wxFileName& aFileName, const MODULE* aFootprint,
+                           ENTRY* aEntry );
+
+    /**
+     * Function readEntry
+     * reads the footprint file @a aFileName and fills @a aEntry.  It is thread safe, and
+     * runs as a task of the THREAD_POOL.
+     */
+    static void readEntry( const wxFileName& aFileName, ENTRY* aEntry )
+        throw( IO_ERROR, PARSE_ERROR );
+
+    /// Stores aEntry for aFootprintName, and flags the index as modified if it changed
+    void setEntry( const wxString& aFootprintName, const ENTRY& aEntry );
+
+    void parse( LINE_READER* aReader ) throw( IO_ERROR, PARSE_ERROR );
+
+    wxFileName  m_libPath;
+    ENTRIES     m_entries;
+    bool        m_modified;                 ///< the entries differ from the stored index
+};
+
+#endif  // FP_LIB_INDEX_H_
@@ -56,6 +56,7 @@ public:
         PCAD,
         GEDA_PCB,       ///< Geda PCB file formats.
         GITHUB,         ///< Read only http://github.com repo holding pretty footprints
+        KICAD_SNAPSHOT, ///< Binary snapshot of a KiCad board, see PCB_SNAPSHOT_PLUGIN.
 
         // add your type here.
 
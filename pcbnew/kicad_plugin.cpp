@@ -43,6 +43,7 @@
 #include <zones.h>
 #include <kicad_plugin.h>
 #include <pcb_parser.h>
+#include <fp_lib_index.h>
 
 #include <wx/dir.h>
 #include <wx/filename.h>
@@ -74,6 +75,52 @@ void filterNetClass( const BOARD& aBoard, NETCLASS& aNetClass )
     }
 }
 
+
+/**
+ * Functions appendText and appendIU
+ * build the lines written for the many points of zones and tracks in a char buffer,
+ * which is much faster than formatting them by OUTPUTFORMATTER::Print().
+ * @return the end of the text added to aOut, which is not nul terminated.
+ */
+static char* appendText( char* aOut, const char* aText )
+{
+    size_t len = strlen( aText );
+
+    memcpy( aOut, aText, len );
+
+    return aOut + len;
+}
+
+
+static char* appendIU( char* aOut, int aValue )
+{
+    return aOut + FMTIU( aOut, aValue );
+}
+
+
+static char* appendIU( char* aOut, const wxPoint& aPoint )
+{
+    return aOut + FMTIU( aOut, aPoint );
+}
+
+
+/**
+ * Function formatXY
+ * writes aPrefix followed by "(xy X Y)" after aNestLevel indentation levels.
+ */
+static void formatXY( OUTPUTFORMATTER* aOut, int aNestLevel, const char* aPrefix, int aX, int aY )
+{
+    char    buf[FMT_IU_BUFSIZE + 16];
+    char*   end = appendText( buf, aPrefix );
+
+    end = appendText( end, "(xy " );
+    end = appendIU( end, wxPoint( aX, aY ) );
+    *end++ = ')';
+
+    aOut->Write( aNestLevel, buf, end - buf );
+}
+
+
 /**
  * Class FP_CACHE_ITEM
  * is helper class for creating a footprint library cache.
@@ -86,7 +133,6 @@ void filterNetClass( const BOARD& aBoard, NETCLASS& aNetClass )
 class FP_CACHE_ITEM
 {
     wxFileName              m_file_name; ///< The the full file name and path of the footprint to cache.
-    wxDateTime              m_mod_time;  ///< The last file modified time stamp.
     std::unique_ptr<MODULE> m_module;
 
 public:
@@ -95,11 +141,7 @@ public:
     wxString    GetName() const { return m_file_name.GetDirs().Last(); }
     wxFileName  GetFileName() const { return m_file_name; }
 
-    /// Tell if the disk content or the lib_path has changed.
-    bool        IsModified() const;
-
     MODULE*     GetModule() const { return m_module.get(); }
-    void        UpdateModificationTime() { m_mod_time = m_file_name.GetModificationTime(); }
 };
 
 
@@ -107,26 +149,6 @@ FP_CACHE_ITEM::FP_CACHE_ITEM( MODULE* aModule, const wxFileName& aFileName ) :
     m_module( aModule )
 {
     m_file_name = aFileName;
-
-    if( m_file_name.FileExists() )
-        m_mod_time = m_file_name.GetModificationTime();
-    else
-        m_mod_time.Now();
-}
-
-
-bool FP_CACHE_ITEM::IsModified() const
-{
-    if( !m_file_name.FileExists() )
-        return false;
-
-    wxLogTrace( traceFootprintLibrary, wxT( "File '%s', m_mod_time %s-%s, file mod time: %s-%s." ),
-                GetChars( m_file_name.GetFullPath() ),
-                GetChars( m_mod_time.FormatDate() ), GetChars( m_mod_time.FormatTime() ),
-                GetChars( m_file_name.GetModificationTime().FormatDate() ),
-                GetChars( m_file_name.GetModificationTime().FormatTime() ) );
-
-    return m_file_name.GetModificationTime() != m_mod_time;
 }
 
 
@@ -141,6 +163,7 @@ class FP_CACHE
     wxFileName      m_lib_path;     /// The path of the library.
     wxDateTime      m_mod_time;     /// Footprint library path modified time stamp.
     MODULE_MAP      m_modules;      /// Map of footprint file name per MODULE*.
+    FP_LIB_INDEX    m_index;        /// Size and modification time of the footprint files.
 
 public:
     FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath );
@@ -190,10 +213,15 @@ public:
      * @return true if \a aPath is the same as the cache path.
      */
     bool IsPath( const wxString& aPath ) const;
+
+private:
+    /// Stores the index of the library, if possible
+    void saveIndex();
 };
 
 
-FP_CACHE::FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath )
+FP_CACHE::FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath ) :
+    m_index( aLibraryPath )
 {
     m_owner = aOwner;
     m_lib_path.SetPath( aLibraryPath );
@@ -224,7 +252,7 @@ void FP_CACHE::Save()
     {
         wxFileName fn = it->second->GetFileName();
 
-        if( fn.FileExists() && !it->second->IsModified() )
+        if( fn.FileExists() && !m_index.IsModified( fn ) )
             continue;
 
         wxString tempFileName =
@@ -262,9 +290,11 @@ void FP_CACHE::Save()
             THROW_IO_ERROR( msg );
         }
 #endif
-        it->second->UpdateModificationTime();
+        m_index.Set( fn, it->second->GetModule() );
         m_mod_time = GetLibModificationTime();
     }
+
+    saveIndex();
 }
 
 
@@ -285,6 +315,11 @@ void FP_CACHE::Load()
     wxString fpFileName;
     wxString wildcard = wxT( "*." ) + KiCadFootprintFileExtension;
 
+    // The footprint list and the cache share the index: the footprint list only reads the
+    // files modified since the cache was loaded.
+    m_index.Load();
+    m_index.RemoveMissing();
+
     if( dir.GetFirst( &fpFileName, wildcard, wxDIR_FILES ) )
     {
         do
@@ -292,7 +327,7 @@ void FP_CACHE::Load()
             // prepend the libpath into fullPath
             wxFileName fullPath( m_lib_path.GetPath(), fpFileName );
 
-            FILE_LINE_READER    reader( fullPath.GetFullPath() );
+            MMAP_LINE_READER    reader( fullPath.GetFullPath() );
 
             m_owner->m_parser->SetLineReader( &reader );
 
@@ -302,6 +337,7 @@ void FP_CACHE::Load()
             // The footprint name is the file name without the extension.
             footprint->SetFPID( FPID( fullPath.GetName() ) );
             m_modules.insert( name, new FP_CACHE_ITEM( footprint, fullPath ) );
+            m_index.Set( fullPath, footprint );
 
         } while( dir.GetNext( &fpFileName ) );
 
@@ -310,6 +346,23 @@ void FP_CACHE::Load()
         // reload the cache as needed.
         m_mod_time = GetLibModificationTime();
     }
+
+    saveIndex();
+}
+
+
+void FP_CACHE::saveIndex()
+{
+    try
+    {
+        m_index.Save();
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        // Not fatal: the index is only a cache
+        wxLogTrace( traceFootprintLibrary, wxT( "Cannot save footprint library index: %s" ),
+                    GetChars( ioe.errorText ) );
+    }
 }
 
 
@@ -333,6 +386,9 @@ void FP_CACHE::Remove( const wxString& aFootprintName )
     wxString fullPath = it->second->GetFileName().GetFullPath();
     m_modules.erase( footprintName );
     wxRemoveFile( fullPath );
+
+    m_index.Remove( aFootprintName );
+    saveIndex();
 }
 
 
@@ -371,7 +427,7 @@ bool FP_CACHE::IsModified( const wxString& aLibPath, const wxString& aFootprintN
                 return true;
             }
 
-            if( it->second->IsModified() )
+            if( m_index.IsModified( fn ) )
             {
                 wxLogTrace( traceFootprintLibrary,
                             wxT( "Footprint cache file '%s' has been modified." ),
@@ -384,7 +440,7 @@ bool FP_CACHE::IsModified( const wxString& aLibPath, const wxString& aFootprintN
     {
         MODULE_CITER it = m_modules.find( TO_UTF8( aFootprintName ) );
 
-        if( it == m_modules.end() || it->second->IsModified() )
+        if( it == m_modules.end() || m_index.IsModified( it->second->GetFileName() ) )
             return true;
     }
 
@@ -754,11 +810,14 @@ void PCB_IO::format( BOARD* aBoard, int aNestLevel ) const
     // Do not save MARKER_PCBs, they can be regenerated easily.
 
     // Save the tracks and vias.
-    for( TRACK* track = aBoard->m_Track;  track; track = track->Next() )
-        Format( track, aNestLevel );
+    if( !( m_ctl & CTL_OMIT_TRACKS ) )
+    {
+        for( TRACK* track = aBoard->m_Track;  track; track = track->Next() )
+            Format( track, aNestLevel );
 
-    if( aBoard->m_Track.GetCount() )
-        m_out->Print( 0, "\n" );
+        if( aBoard->m_Track.GetCount() )
+            m_out->Print( 0, "\n" );
+    }
 
     /// @todo Add warning here that the old segment filed zones are no longer supported and
     ///       will not be saved.
@@ -1463,9 +1522,17 @@ void PCB_IO::format( TRACK* aTrack, int aNestLevel ) const
     }
     else
     {
-        m_out->Print( aNestLevel, "(segment (start %s) (end %s) (width %s)",
-                      FMT_IU( aTrack->GetStart() ).c_str(), FMT_IU( aTrack->GetEnd() ).c_str(),
-                      FMT_IU( aTrack->GetWidth() ).c_str() );
+        char    buf[3 * FMT_IU_BUFSIZE + 32];
+        char*   end = appendText( buf, "(segment (start " );
+
+        end = appendIU( end, aTrack->GetStart() );
+        end = appendText( end, ") (end " );
+        end = appendIU( end, aTrack->GetEnd() );
+        end = appendText( end, ") (width " );
+        end = appendIU( end, aTrack->GetWidth() );
+        *end++ = ')';
+
+        m_out->Write( aNestLevel, buf, end - buf );
 
         m_out->Print( 0, " (layer %s)", m_out->Quotew( aTrack->GetLayerName() ).c_str() );
     }
@@ -1601,11 +1668,9 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
         for( unsigned it = 0; it < cv.GetCornersCount(); ++it )
         {
             if( newLine == 0 )
-                m_out->Print( aNestLevel+3, "(xy %s %s)",
-                              FMT_IU( cv.GetX( it ) ).c_str(), FMT_IU( cv.GetY( it ) ).c_str() );
+                formatXY( m_out, aNestLevel+3, "", cv.GetX( it ), cv.GetY( it ) );
             else
-                m_out->Print( 0, " (xy %s %s)",
-                              FMT_IU( cv.GetX( it ) ).c_str(), FMT_IU( cv.GetY( it ) ).c_str() );
+                formatXY( m_out, 0, " ", cv.GetX( it ), cv.GetY( it ) );
 
             if( newLine < 4 )
             {
@@ -1637,6 +1702,12 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
         m_out->Print( aNestLevel+1, ")\n" );
     }
 
+    if( m_ctl & CTL_OMIT_FILLS )
+    {
+        m_out->Print( aNestLevel, ")\n" );
+        return;
+    }
+
     // Save the PolysList
     const SHAPE_POLY_SET& fv = aZone->GetFilledPolysList();
     newLine = 0;
@@ -1649,11 +1720,9 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
         for( SHAPE_POLY_SET::CONST_ITERATOR it = fv.CIterate(); it; ++it )
         {
             if( newLine == 0 )
-                m_out->Print( aNestLevel+3, "(xy %s %s)",
-                              FMT_IU( it->x ).c_str(), FMT_IU( it->y ).c_str() );
+                formatXY( m_out, aNestLevel+3, "", it->x, it->y );
             else
-                m_out->Print( 0, " (xy %s %s)",
-                              FMT_IU( it->x ) .c_str(), FMT_IU( it->y ).c_str() );
+                formatXY( m_out, 0, " ", it->x, it->y );
 
             if( newLine < 4 )
             {
@@ -1694,9 +1763,15 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
 
         for( std::vector< SEGMENT >::const_iterator it = segs.begin();  it != segs.end();  ++it )
         {
-            m_out->Print( aNestLevel+2, "(pts (xy %s) (xy %s))\n",
-                          FMT_IU( it->m_Start ).c_str(),
-                          FMT_IU( it->m_End ).c_str() );
+            char    buf[2 * FMT_IU_BUFSIZE + 32];
+            char*   end = appendText( buf, "(pts (xy " );
+
+            end = appendIU( end, it->m_Start );
+            end = appendText( end, ") (xy " );
+            end = appendIU( end, it->m_End );
+            end = appendText( end, "))\n" );
+
+            m_out->Write( aNestLevel+2, buf, end - buf );
         }
 
         m_out->Print( aNestLevel+1, ")\n" );
@@ -1727,12 +1802,13 @@ PCB_IO::~PCB_IO()
 
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties )
 {
-    FILE_LINE_READER    reader( aFileName );
+    MMAP_LINE_READER    reader( aFileName );
 
     init( aProperties );
 
     m_parser->SetLineReader( &reader );
     m_parser->SetBoard( aAppendToMe );
+    m_parser->SetParallelLoad( true );
 
     BOARD* board;
 
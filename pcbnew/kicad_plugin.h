@@ -50,6 +50,8 @@ class NETINFO_MAPPING;
 #define CTL_OMIT_PATH               (1 << 4)    ///< Omit component sheet time stamp (useless in library)
 #define CTL_OMIT_AT                 (1 << 5)    ///< Omit position and rotation
                                                 // (always saved with potion 0,0 and rotation = 0 in library)
+#define CTL_OMIT_TRACKS             (1 << 6)    ///< Omit the tracks and vias of a board
+#define CTL_OMIT_FILLS              (1 << 7)    ///< Omit the filled areas of zones
 
 
 // common combinations of the above:
@@ -195,7 +195,8 @@ void Abort_MoveOrCopyModule( EDA_DRAW_PANEL* Panel, wxDC* DC )
 
         if( module->IsNew() )  // Copy command: delete new footprint
         {
-            module->DeleteStructure();
+            pcbframe->GetBoard()->Remove( module );
+            delete module;
             module = NULL;
             pcbframe->GetBoard()->m_Status_Pcb = 0;
             pcbframe->GetBoard()->BuildListOfNets();
@@ -265,7 +266,7 @@ bool PCB_EDIT_FRAME::Delete_Module( MODULE* aModule, wxDC* aDC )
     SetMsgPanel( aModule );
 
     /* Remove module from list, and put it in undo command list */
-    m_Pcb->m_Modules.Remove( aModule );
+    m_Pcb->Remove( aModule );
     aModule->SetState( IS_DELETED, true );
     SaveCopyInUndoList( aModule, UR_DELETED );
 
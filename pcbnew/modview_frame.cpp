@@ -295,6 +295,10 @@ FOOTPRINT_VIEWER_FRAME::~FOOTPRINT_VIEWER_FRAME()
 
     if( draw3DFrame )
         draw3DFrame->Destroy();
+
+    // The board is destroyed by PCB_BASE_FRAME, before the canvas
+    if( GetGalCanvas() )
+        static_cast<PCB_DRAW_PANEL_GAL*>( GetGalCanvas() )->ClearRatsnestCallback();
 }
 
 
@@ -447,7 +451,7 @@ void FOOTPRINT_VIEWER_FRAME::ClickOnFootprintList( wxCommandEvent& event )
         SetCurItem( NULL );
 
         // Delete the current footprint
-        GetBoard()->m_Modules.DeleteAll();
+        GetBoard()->DeleteAllModules();
 
         FPID id;
         id.SetLibNickname( getCurNickname() );
@@ -830,7 +834,7 @@ void FOOTPRINT_VIEWER_FRAME::SelectAndViewFootprint( int aMode )
         SetCurItem( NULL );
 
         // Delete the current footprint
-        GetBoard()->m_Modules.DeleteAll();
+        GetBoard()->DeleteAllModules();
 
         MODULE* footprint = Prj().PcbFootprintLibs()->FootprintLoad(
                                 getCurNickname(), getCurFootprintName() );
@@ -0,0 +1,143 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file netlist_lookup.cpp
+ */
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <pcb_netlist.h>
+
+#include <netlist_lookup.h>
+
+
+NETLIST_LOOKUP::NETLIST_LOOKUP( BOARD* aBoard, NETLIST& aNetlist )
+{
+    for( MODULE* module = aBoard->m_Modules;  module;  module = module->Next() )
+        AddModule( module );
+
+    for( unsigned i = 0;  i < aNetlist.GetCount();  i++ )
+    {
+        COMPONENT* component = aNetlist.GetComponent( i );
+
+        // emplace() keeps the first component of a key, as the linear searches do
+        m_componentsByReference.emplace( component->GetReference(), component );
+        m_componentsByTimeStamp.emplace( component->GetTimeStamp(), component );
+    }
+}
+
+
+MODULE* NETLIST_LOOKUP::FindModule( const wxString& aRefOrTimeStamp,
+                                    bool aSearchByTimeStamp ) const
+{
+    MODULE_MAP::const_iterator it;
+
+    if( aSearchByTimeStamp )
+    {
+        it = m_modulesByTimeStamp.find( aRefOrTimeStamp.Lower() );
+
+        if( it != m_modulesByTimeStamp.end() )
+            return it->second;
+    }
+    else
+    {
+        it = m_modulesByReference.find( aRefOrTimeStamp );
+
+        if( it != m_modulesByReference.end() )
+            return it->second;
+    }
+
+    return NULL;
+}
+
+
+COMPONENT* NETLIST_LOOKUP::FindComponent( const MODULE* aModule, bool aSearchByTimeStamp ) const
+{
+    COMPONENT_MAP::const_iterator it;
+
+    if( aSearchByTimeStamp )
+    {
+        it = m_componentsByTimeStamp.find( aModule->GetPath() );
+
+        if( it != m_componentsByTimeStamp.end() )
+            return it->second;
+    }
+    else
+    {
+        it = m_componentsByReference.find( aModule->GetReference() );
+
+        if( it != m_componentsByReference.end() )
+            return it->second;
+    }
+
+    return NULL;
+}
+
+
+void NETLIST_LOOKUP::AddModule( MODULE* aModule )
+{
+    // Footprints are appended to the board, so an existing one with the same key comes first
+    m_modulesByReference.emplace( aModule->GetReference(), aModule );
+    m_modulesByTimeStamp.emplace( aModule->GetPath().Lower(), aModule );
+}
+
+
+void NETLIST_LOOKUP::RemoveModule( MODULE* aModule )
+{
+    // A duplicate reference or path further on the board is not found anymore, but the
+    // update only removes footprints it has already matched, or has replaced.
+    MODULE_MAP::iterator it = m_modulesByReference.find( aModule->GetReference() );
+
+    if( it != m_modulesByReference.end() && it->second == aModule )
+        m_modulesByReference.erase( it );
+
+    it = m_modulesByTimeStamp.find( aModule->GetPath().Lower() );
+
+    if( it != m_modulesByTimeStamp.end() && it->second == aModule )
+        m_modulesByTimeStamp.erase( it );
+}
+
+
+void NETLIST_LOOKUP::MapPins( const COMPONENT* aComponent, PIN_MAP& aPins )
+{
+    aPins.clear();
+    aPins.reserve( aComponent->GetNetCount() );
+
+    for( unsigned i = 0;  i < aComponent->GetNetCount();  i++ )
+    {
+        const COMPONENT_NET& net = aComponent->GetNet( i );
+
+        aPins.emplace( net.GetPinName(), &net );
+    }
+}
+
+
+void NETLIST_LOOKUP::MapPadNames( const MODULE* aModule, PAD_NAMES& aNames )
+{
+    aNames.clear();
+
+    for( const D_PAD* pad = aModule->Pads();  pad;  pad = pad->Next() )
+        aNames.insert( pad->GetPadName().Lower() );
+}
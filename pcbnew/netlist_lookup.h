@@ -0,0 +1,109 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file netlist_lookup.h
+ * @brief Hashed lookups of the footprints and components matched by a netlist update.
+ */
+
+#ifndef NETLIST_LOOKUP_H_
+#define NETLIST_LOOKUP_H_
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include <hashtables.h>
+
+class BOARD;
+class MODULE;
+class NETLIST;
+class COMPONENT;
+class COMPONENT_NET;
+
+
+/**
+ * Class NETLIST_LOOKUP
+ * indexes the footprints of a #BOARD by reference and by time stamp, and the components
+ * of a #NETLIST the same way, so a netlist update matches them in constant time instead of
+ * walking the lists for each component.
+ *
+ * The lookups give the same results as BOARD::FindModule(), NETLIST::GetComponentByReference()
+ * and NETLIST::GetComponentByTimeStamp(): the first item of the list with the key is found.
+ * The footprints added or removed by the update must be given to AddModule() and
+ * RemoveModule(); a footprint is indexed with the reference and path it has at that time.
+ */
+class NETLIST_LOOKUP
+{
+public:
+    typedef std::unordered_map<wxString, const COMPONENT_NET*, WXSTRING_HASH>  PIN_MAP;
+    typedef std::unordered_set<wxString, WXSTRING_HASH>                        PAD_NAMES;
+
+    NETLIST_LOOKUP( BOARD* aBoard, NETLIST& aNetlist );
+
+    /**
+     * Function FindModule
+     * is the counterpart of BOARD::FindModule().
+     * @param aRefOrTimeStamp is the reference or the time stamp (path) of the footprint.
+     * @param aSearchByTimeStamp is true to search by time stamp, case insensitive.
+     * @return the footprint, or NULL if the board has none with this key.
+     */
+    MODULE* FindModule( const wxString& aRefOrTimeStamp, bool aSearchByTimeStamp ) const;
+
+    /**
+     * Function FindComponent
+     * @return the netlist component with the reference (or the time stamp if
+     *         \a aSearchByTimeStamp is true) of \a aModule, or NULL.
+     */
+    COMPONENT* FindComponent( const MODULE* aModule, bool aSearchByTimeStamp ) const;
+
+    /// Indexes a footprint added to the board
+    void AddModule( MODULE* aModule );
+
+    /// Forgets a footprint removed from the board
+    void RemoveModule( MODULE* aModule );
+
+    /**
+     * Function MapPins
+     * fills \a aPins with the nets of the pins of \a aComponent, by pin name, the counterpart
+     * of COMPONENT::GetNet( const wxString& ).
+     */
+    static void MapPins( const COMPONENT* aComponent, PIN_MAP& aPins );
+
+    /**
+     * Function MapPadNames
+     * fills \a aNames with the pad names of \a aModule, lower case for the case insensitive
+     * comparison of MODULE::FindPadByName().
+     */
+    static void MapPadNames( const MODULE* aModule, PAD_NAMES& aNames );
+
+private:
+    typedef std::unordered_map<wxString, MODULE*, WXSTRING_HASH>       MODULE_MAP;
+    typedef std::unordered_map<wxString, COMPONENT*, WXSTRING_HASH>    COMPONENT_MAP;
+
+    MODULE_MAP      m_modulesByReference;
+    MODULE_MAP      m_modulesByTimeStamp;       ///< keys are lower case
+    COMPONENT_MAP   m_componentsByReference;
+    COMPONENT_MAP   m_componentsByTimeStamp;
+};
+
+#endif  // NETLIST_LOOKUP_H_
@@ -28,6 +28,14 @@
 #include <gal/graphics_abstraction_layer.h>
 #include <class_board.h>
 
+PCB_BASE_EDIT_FRAME::~PCB_BASE_EDIT_FRAME()
+{
+    // The board is destroyed by PCB_BASE_FRAME, before the canvas
+    if( GetGalCanvas() )
+        static_cast<PCB_DRAW_PANEL_GAL*>( GetGalCanvas() )->ClearRatsnestCallback();
+}
+
+
 void PCB_BASE_EDIT_FRAME::SetRotationAngle( int aRotationAngle )
 {
     wxCHECK2_MSG( aRotationAngle > 0 && aRotationAngle <= 900, aRotationAngle = 900,
@@ -74,7 +82,12 @@ void PCB_BASE_EDIT_FRAME::SetBoard( BOARD* aBoard )
 
     // It has to be done before the previous board is destroyed by SetBoard()
     if( new_board )
-        GetGalCanvas()->GetView()->Clear();
+    {
+        PCB_DRAW_PANEL_GAL* drawPanel = static_cast<PCB_DRAW_PANEL_GAL*>( GetGalCanvas() );
+
+        drawPanel->GetView()->Clear();
+        drawPanel->ClearRatsnestCallback();
+    }
 
     PCB_BASE_FRAME::SetBoard( aBoard );
 
@@ -40,7 +40,7 @@ public:
     m_rotationAngle( 900 ), m_undoRedoBlocked( false )
     {}
 
-    virtual ~PCB_BASE_EDIT_FRAME() {};
+    virtual ~PCB_BASE_EDIT_FRAME();
 
     /**
      * Function CreateNewLibrary
@@ -103,6 +103,7 @@ EDA_DRAW_PANEL_GAL( aParentWindow, aWindowId, aPosition, aSize, aGalType )
 {
     m_worksheet = NULL;
     m_ratsnest = NULL;
+    m_ratsnestData = NULL;
 
     setDefaultLayerOrder();
     setDefaultLayerDeps();
@@ -122,6 +123,8 @@ EDA_DRAW_PANEL_GAL( aParentWindow, aWindowId, aPosition, aSize, aGalType )
 
 PCB_DRAW_PANEL_GAL::~PCB_DRAW_PANEL_GAL()
 {
+    ClearRatsnestCallback();
+
     delete m_worksheet;
     delete m_ratsnest;
 }
@@ -164,11 +167,29 @@ void PCB_DRAW_PANEL_GAL::DisplayBoard( const BOARD* aBoard )
     m_ratsnest = new KIGFX::RATSNEST_VIEWITEM( aBoard->GetRatsnest() );
     m_view->Add( m_ratsnest );
 
+    // Ratsnest computed in the background is applied in the GUI thread
+    ClearRatsnestCallback();
+
+    m_ratsnestData = aBoard->GetRatsnest();
+    m_ratsnestData->SetResultsCallback( [this]() {
+        CallAfter( &PCB_DRAW_PANEL_GAL::onRatsnestResults );
+    } );
+
     // Display settings
     UseColorScheme( aBoard->GetColorsSettings() );
 }
 
 
+void PCB_DRAW_PANEL_GAL::ClearRatsnestCallback()
+{
+    if( m_ratsnestData )
+    {
+        m_ratsnestData->SetResultsCallback( std::function<void()>() );
+        m_ratsnestData = NULL;
+    }
+}
+
+
 void PCB_DRAW_PANEL_GAL::SetWorksheet( KIGFX::WORKSHEET_VIEWITEM* aWorksheet )
 {
     if( m_worksheet )
@@ -439,3 +460,13 @@ void PCB_DRAW_PANEL_GAL::setDefaultLayerDeps()
     m_view->SetLayerDisplayOnly( ITEM_GAL_LAYER( GRID_VISIBLE ) );
     m_view->SetLayerDisplayOnly( ITEM_GAL_LAYER( DRC_VISIBLE ) );
 }
+
+
+void PCB_DRAW_PANEL_GAL::onRatsnestResults()
+{
+    if( m_ratsnest && m_ratsnest->UpdateResults() )
+    {
+        m_view->MarkTargetDirty( KIGFX::TARGET_OVERLAY );
+        Refresh();
+    }
+}
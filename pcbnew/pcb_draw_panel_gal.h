@@ -33,6 +33,7 @@ namespace KIGFX
     class RATSNEST_VIEWITEM;
 }
 class COLORS_DESIGN_SETTINGS;
+class RN_DATA;
 
 class PCB_DRAW_PANEL_GAL : public EDA_DRAW_PANEL_GAL
 {
@@ -49,6 +50,14 @@ public:
      */
     void DisplayBoard( const BOARD* aBoard );
 
+    /**
+     * Function ClearRatsnestCallback
+     * removes the callback DisplayBoard() sets on the ratsnest of the board, so the
+     * ratsnest worker does not notify the panel anymore.  It has to be called before the
+     * displayed board is destroyed.
+     */
+    void ClearRatsnestCallback();
+
     /**
      * Function SetWorksheet
      * Sets (or updates) worksheet used by the draw panel.
@@ -90,11 +99,17 @@ protected:
     ///> Sets rendering targets & dependencies for layers.
     void setDefaultLayerDeps();
 
+    ///> Applies the ratsnest computed in the background and redraws it.
+    void onRatsnestResults();
+
     ///> Currently used worksheet
     KIGFX::WORKSHEET_VIEWITEM* m_worksheet;
 
     ///> Ratsnest view item
     KIGFX::RATSNEST_VIEWITEM* m_ratsnest;
+
+    ///> Ratsnest notifying the panel of its background results
+    RN_DATA* m_ratsnestData;
 };
 
 #endif /* PCB_DRAW_PANEL_GAL_H_ */
@@ -127,7 +127,9 @@ double PCB_PARSER::parseDouble() throw( IO_ERROR )
 
     errno = 0;
 
-    double fval = strtod( CurText(), &tmp );
+    // the token is not copied: the lexer ensures it ends with a separator
+    const char* text = CurTextInPlace();
+    double fval = strtod( text, &tmp );
 
     if( errno )
     {
@@ -138,7 +140,7 @@ double PCB_PARSER::parseDouble() throw( IO_ERROR )
         THROW_IO_ERROR( error );
     }
 
-    if( CurText() == tmp )
+    if( text == tmp )
     {
         wxString error;
         error.Printf( _( "missing floating point number in\nfile: <%s>\nline: %d\noffset: %d" ),
@@ -463,6 +465,7 @@ BOARD* PCB_PARSER::parseBOARD() throw( IO_ERROR, PARSE_ERROR, FUTURE_FORMAT_ERRO
 BOARD* PCB_PARSER::parseBOARD_unchecked() throw( IO_ERROR, PARSE_ERROR )
 {
     T token;
+    std::vector<BOARD_SECTION> sections;
 
     parseHeader();
 
@@ -473,6 +476,23 @@ BOARD* PCB_PARSER::parseBOARD_unchecked() throw( IO_ERROR, PARSE_ERROR )
 
         token = NextTok();
 
+        // Items standing alone once the layers and the nets are known are only
+        // copied here, and parsed when the whole file is read.
+        if( m_parallelLoad &&
+            ( token == T_module || token == T_segment || token == T_via || token == T_zone ) )
+        {
+            sections.push_back( BOARD_SECTION() );
+
+            BOARD_SECTION& section = sections.back();
+
+            section.m_token      = token;
+            section.m_lineNumber = CurLineNumber();
+            section.m_item       = NULL;
+
+            CopyList( &section.m_text );
+            continue;
+        }
+
         switch( token )
         {
         case T_general:
@@ -546,10 +566,101 @@ BOARD* PCB_PARSER::parseBOARD_unchecked() throw( IO_ERROR, PARSE_ERROR )
         }
     }
 
+    if( !sections.empty() )
+        parseSections( sections );
+
     return m_board;
 }
 
 
+void PCB_PARSER::parseSections( std::vector<BOARD_SECTION>& aSections )
+    throw( IO_ERROR, PARSE_ERROR )
+{
+    const wxString& source = CurSource();
+    const int       count = aSections.size();
+    int             ii;
+
+#ifdef USE_OPENMP
+    #pragma omp parallel private(ii)
+#endif
+    {
+        // Each thread has its own parser, sharing the layer and net tables of this one.
+        // The board is only read while the items are parsed.
+        PCB_PARSER parser;
+
+        parser.m_board           = m_board;
+        parser.m_layerIndices    = m_layerIndices;
+        parser.m_layerMasks      = m_layerMasks;
+        parser.m_netCodes        = m_netCodes;
+        parser.m_tooRecent       = m_tooRecent;
+        parser.m_requiredVersion = m_requiredVersion;
+
+#ifdef USE_OPENMP
+        #pragma omp for schedule(dynamic, 1)
+#endif
+        for( ii = 0; ii < count; ++ii )
+        {
+            BOARD_SECTION&      section = aSections[ii];
+            STRING_LINE_READER  reader( section.m_text, source, section.m_lineNumber - 1 );
+
+            // Exceptions cannot leave a parallel section: they are thrown again below
+            try
+            {
+                parser.SetLineReader( &reader );
+                parser.NeedLEFT();
+                parser.NextTok();
+
+                switch( section.m_token )
+                {
+                case T_module:
+                    section.m_item = parser.parseMODULE();
+                    break;
+
+                case T_segment:
+                    section.m_item = parser.parseTRACK();
+                    break;
+
+                case T_via:
+                    section.m_item = parser.parseVIA();
+                    break;
+
+                default:
+                    section.m_item = parser.parseZONE_CONTAINER( &section.m_zoneNetName );
+                    break;
+                }
+            }
+            catch( ... )
+            {
+                section.m_error = std::current_exception();
+            }
+        }
+    }
+
+    // Report the first error of the file, and then give up all the items
+    for( ii = 0; ii < count; ++ii )
+    {
+        if( aSections[ii].m_error )
+        {
+            for( int jj = 0; jj < count; ++jj )
+                delete aSections[jj].m_item;
+
+            std::rethrow_exception( aSections[ii].m_error );
+        }
+    }
+
+    // Add the items in file order
+    for( ii = 0; ii < count; ++ii )
+    {
+        BOARD_SECTION& section = aSections[ii];
+
+        if( section.m_token == T_zone )
+            checkZoneNetName( (ZONE_CONTAINER*) section.m_item, section.m_zoneNetName );
+
+        m_board->Add( section.m_item, ADD_APPEND );
+    }
+}
+
+
 void PCB_PARSER::parseHeader() throw( IO_ERROR, PARSE_ERROR )
 {
     wxCHECK_RET( CurTok() == T_kicad_pcb,
@@ -929,7 +1040,7 @@ template<class T, class M>
 T PCB_PARSER::lookUpLayer( const M& aMap ) throw( PARSE_ERROR, IO_ERROR )
 {
     // avoid constructing another std::string, use lexer's directly
-    typename M::const_iterator it = aMap.find( curText );
+    typename M::const_iterator it = aMap.find( CurStr() );
 
     if( it == aMap.end() )
     {
@@ -2642,7 +2753,7 @@ VIA* PCB_PARSER::parseVIA() throw( IO_ERROR, PARSE_ERROR )
 }
 
 
-ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER() throw( IO_ERROR, PARSE_ERROR )
+ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( wxString* aNetName ) throw( IO_ERROR, PARSE_ERROR )
 {
     wxCHECK_MSG( CurTok() == T_zone, NULL,
                  wxT( "Cannot parse " ) + GetTokenString( CurTok() ) +
@@ -2974,38 +3085,49 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER() throw( IO_ERROR, PARSE_ERROR )
     if( !zone_has_net )
         zone->SetNetCode( NETINFO_LIST::UNCONNECTED );
 
+    if( aNetName )
+        *aNetName = netnameFromfile;
+    else
+        checkZoneNetName( zone.get(), netnameFromfile );
+
+    return zone.release();
+}
+
+
+void PCB_PARSER::checkZoneNetName( ZONE_CONTAINER* aZone, const wxString& aNetName )
+{
+    bool zone_has_net = aZone->IsOnCopperLayer() && !aZone->GetIsKeepout();
+
     // Ensure the zone net name is valid, and matches the net code, for copper zones
-    if( zone_has_net && ( zone->GetNet()->GetNetname() != netnameFromfile ) )
+    if( zone_has_net && ( aZone->GetNet()->GetNetname() != aNetName ) )
     {
         // Can happens which old boards, with nonexistent nets ...
         // or after being edited by hand
         // We try to fix the mismatch.
-        NETINFO_ITEM* net = m_board->FindNet( netnameFromfile );
+        NETINFO_ITEM* net = m_board->FindNet( aNetName );
 
         if( net )   // An existing net has the same net name. use it for the zone
-            zone->SetNetCode( net->GetNet() );
+            aZone->SetNetCode( net->GetNet() );
         else    // Not existing net: add a new net to keep trace of the zone netname
         {
             int newnetcode = m_board->GetNetCount();
-            net = new NETINFO_ITEM( m_board, netnameFromfile, newnetcode );
+            net = new NETINFO_ITEM( m_board, aNetName, newnetcode );
             m_board->AppendNet( net );
 
             // Store the new code mapping
             pushValueIntoMap( newnetcode, net->GetNet() );
             // and update the zone netcode
-            zone->SetNetCode( net->GetNet() );
+            aZone->SetNetCode( net->GetNet() );
 
             // Prompt the user
             wxString msg;
             msg.Printf( _( "There is a zone that belongs to a not existing net\n"
                            "\"%s\"\n"
                            "you should verify and edit it (run DRC test)." ),
-                           GetChars( netnameFromfile ) );
+                           GetChars( aNetName ) );
             DisplayError( NULL, msg );
         }
     }
-
-    return zone.release();
 }
 
 
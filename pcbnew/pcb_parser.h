@@ -40,6 +40,9 @@
 #include <boost/unordered_map.hpp>
 #include <boost/unordered_set.hpp>
 
+#include <exception>
+#include <vector>
+
 
 class BOARD;
 class BOARD_ITEM;
@@ -74,6 +77,22 @@ class PCB_PARSER : public PCB_LEXER
     std::vector<int>    m_netCodes;         ///< net codes mapping for boards being loaded
     bool                m_tooRecent;        ///< true if version parses as later than supported
     int                 m_requiredVersion;  ///< set to the KiCad format version this board requires
+    bool                m_parallelLoad;     ///< parse the board items on several threads
+
+    /**
+     * Struct BOARD_SECTION
+     * is a top level list of a board file (a module, track, via or zone), copied by
+     * parseBOARD_unchecked() to be parsed when the whole file is read.
+     */
+    struct BOARD_SECTION
+    {
+        PCB_KEYS_T::T       m_token;        ///< T_module, T_segment, T_via or T_zone
+        int                 m_lineNumber;   ///< line of the list in the file
+        std::string         m_text;         ///< the text of the list
+        BOARD_ITEM*         m_item;         ///< the parsed item
+        wxString            m_zoneNetName;  ///< the net name read for a zone
+        std::exception_ptr  m_error;        ///< the exception thrown by the parser, if any
+    };
 
     ///> Converts net code using the mapping table if available,
     ///> otherwise returns unchanged net code if < 0 or if is is out of range
@@ -138,7 +157,30 @@ class PCB_PARSER : public PCB_LEXER
     D_PAD*          parseD_PAD( MODULE* aParent = NULL ) throw( IO_ERROR, PARSE_ERROR );
     TRACK*          parseTRACK() throw( IO_ERROR, PARSE_ERROR );
     VIA*            parseVIA() throw( IO_ERROR, PARSE_ERROR );
-    ZONE_CONTAINER* parseZONE_CONTAINER() throw( IO_ERROR, PARSE_ERROR );
+    /**
+     * Function parseZONE_CONTAINER
+     * @param aNetName, if not NULL, receives the net name read in the file, which is then
+     *   not checked against the net code: checkZoneNetName() must be called later, since
+     *   it can modify the board.
+     */
+    ZONE_CONTAINER* parseZONE_CONTAINER( wxString* aNetName = NULL )
+                        throw( IO_ERROR, PARSE_ERROR );
+
+    /**
+     * Function checkZoneNetName
+     * ensures the net of a copper zone matches the net name read in the file, and
+     * creates this net if it does not exist.
+     */
+    void checkZoneNetName( ZONE_CONTAINER* aZone, const wxString& aNetName );
+
+    /**
+     * Function parseSections
+     * parses the lists copied by parseBOARD_unchecked(), on several threads when
+     * OpenMP is available, and adds the items to the board in file order.
+     * @throw the error of the first list of the file which cannot be parsed.
+     */
+    void parseSections( std::vector<BOARD_SECTION>& aSections )
+                        throw( IO_ERROR, PARSE_ERROR );
     PCB_TARGET*     parsePCB_TARGET() throw( IO_ERROR, PARSE_ERROR );
     BOARD*          parseBOARD() throw( IO_ERROR, PARSE_ERROR, FUTURE_FORMAT_ERROR );
 
@@ -255,7 +297,7 @@ class PCB_PARSER : public PCB_LEXER
 
     inline int parseInt() throw( PARSE_ERROR )
     {
-        return (int)strtol( CurText(), NULL, 10 );
+        return (int)strtol( CurTextInPlace(), NULL, 10 );
     }
 
     inline int parseInt( const char* aExpected ) throw( PARSE_ERROR )
@@ -267,7 +309,7 @@ class PCB_PARSER : public PCB_LEXER
     inline long parseHex() throw( PARSE_ERROR )
     {
         NextTok();
-        return strtol( CurText(), NULL, 16 );
+        return strtol( CurTextInPlace(), NULL, 16 );
     }
 
     bool parseBool() throw( PARSE_ERROR );
@@ -282,7 +324,8 @@ public:
 
     PCB_PARSER( LINE_READER* aReader = NULL ) :
         PCB_LEXER( aReader ),
-        m_board( 0 )
+        m_board( 0 ),
+        m_parallelLoad( false )
     {
         init();
     }
@@ -308,8 +351,30 @@ public:
         m_board = aBoard;
     }
 
+    /**
+     * Function SetParallelLoad
+     * enables or disables the parallel parsing of boards: the modules, tracks, vias and
+     * zones are first copied while the file is read, then parsed on several threads.
+     * The errors are reported the same way, but the items are added to the board after
+     * the other ones.
+     */
+    void SetParallelLoad( bool aEnable )
+    {
+        m_parallelLoad = aEnable;
+    }
+
     BOARD_ITEM* Parse() throw( IO_ERROR, PARSE_ERROR );
 
+    /**
+     * Function MapNetCode
+     * @return the code in the board last parsed of the net \a aNetCode of the file,
+     *         as used for its pads, tracks and zones.
+     */
+    int MapNetCode( int aNetCode )
+    {
+        return getNetCode( aNetCode );
+    }
+
     /**
      * Return whether a version number, if any was parsed, was too recent
      */
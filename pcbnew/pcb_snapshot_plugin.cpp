@@ -0,0 +1,602 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pcb_snapshot_plugin.cpp
+ */
+
+#include <fctsys.h>
+#include <common.h>
+#include <build_version.h>
+#include <macros.h>
+
+#include <stdint.h>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <wx/filename.h>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <class_board.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <class_netinfo.h>
+#include <pcb_parser.h>
+#include <pcb_snapshot_plugin.h>
+
+
+#define SNAPSHOT_MAGIC          "KICADSNP"
+#define SNAPSHOT_VERSION        1
+#define SNAPSHOT_BYTE_ORDER     0x01020304      ///< reads differently with another byte order
+
+
+/// Position and number of records of an array of the snapshot file
+struct SNAPSHOT_ARRAY
+{
+    uint64_t    m_offset;
+    uint64_t    m_count;
+};
+
+
+struct SNAPSHOT_HEADER
+{
+    char            m_magic[8];
+    uint32_t        m_version;
+    uint32_t        m_byteOrder;
+    uint64_t        m_sourceSize;       ///< size of the board file
+    uint64_t        m_sourceChecksum;   ///< checksum of the board file
+    SNAPSHOT_ARRAY  m_text;             ///< s-expression of the board, without tracks and fills
+    SNAPSHOT_ARRAY  m_tracks;           ///< SNAPSHOT_TRACK records
+    SNAPSHOT_ARRAY  m_zones;            ///< SNAPSHOT_ZONE records, one per zone of the board
+    SNAPSHOT_ARRAY  m_contours;         ///< uint32_t point count of each filled polygon
+    SNAPSHOT_ARRAY  m_points;           ///< SNAPSHOT_POINT records of the filled polygons
+    SNAPSHOT_ARRAY  m_segments;         ///< SNAPSHOT_SEGMENT records of the fill segments
+};
+
+
+struct SNAPSHOT_TRACK
+{
+    int64_t     m_timeStamp;
+    int32_t     m_type;                 ///< PCB_TRACE_T or PCB_VIA_T
+    int32_t     m_startX;
+    int32_t     m_startY;
+    int32_t     m_endX;
+    int32_t     m_endY;
+    int32_t     m_width;
+    int32_t     m_drill;                ///< via drill, UNDEFINED_DRILL_DIAMETER for the default
+    int32_t     m_layer;                ///< layer of a track, top layer of a via
+    int32_t     m_bottomLayer;          ///< bottom layer of a via
+    int32_t     m_viaType;
+    int32_t     m_netCode;              ///< net code in the s-expression of the board
+    uint32_t    m_status;
+};
+
+
+/// The filled polygons and the fill segments of a zone follow the ones of the previous zone
+struct SNAPSHOT_ZONE
+{
+    uint32_t    m_contourCount;
+    uint32_t    m_segmentCount;
+};
+
+
+struct SNAPSHOT_POINT
+{
+    int32_t     m_x;
+    int32_t     m_y;
+};
+
+
+struct SNAPSHOT_SEGMENT
+{
+    int32_t     m_startX;
+    int32_t     m_startY;
+    int32_t     m_endX;
+    int32_t     m_endY;
+};
+
+
+/**
+ * Function checksumFile
+ * computes the size and the FNV-1a checksum of a file.
+ * @return false if the file cannot be read.
+ */
+static bool checksumFile( const wxString& aFileName, uint64_t* aSize, uint64_t* aChecksum )
+{
+    FILE* fp = wxFopen( aFileName, wxT( "rb" ) );
+
+    if( !fp )
+        return false;
+
+    std::vector<unsigned char> buffer( 1 << 20 );
+    uint64_t    hash = 14695981039346656037ULL;
+    uint64_t    size = 0;
+    size_t      count;
+
+    while( ( count = fread( &buffer[0], 1, buffer.size(), fp ) ) > 0 )
+    {
+        for( size_t ii = 0; ii < count; ++ii )
+        {
+            hash ^= buffer[ii];
+            hash *= 1099511628211ULL;
+        }
+
+        size += count;
+    }
+
+    bool ok = !ferror( fp );
+
+    fclose( fp );
+
+    *aSize = size;
+    *aChecksum = hash;
+
+    return ok;
+}
+
+
+/// Checks the identification of a snapshot file
+static bool isValidHeader( const SNAPSHOT_HEADER& aHeader )
+{
+    return !memcmp( aHeader.m_magic, SNAPSHOT_MAGIC, sizeof( aHeader.m_magic ) )
+            && aHeader.m_version == SNAPSHOT_VERSION
+            && aHeader.m_byteOrder == SNAPSHOT_BYTE_ORDER;
+}
+
+
+/// Checks an array of a snapshot file of aFileSize bytes is in the file
+static bool isValidArray( const SNAPSHOT_ARRAY& aArray, size_t aRecordSize, uint64_t aFileSize )
+{
+    return aArray.m_offset <= aFileSize
+            && aArray.m_count <= ( aFileSize - aArray.m_offset ) / aRecordSize;
+}
+
+
+/// Gives the next position (aligned for any record) to an array of aCount records
+static void placeArray( SNAPSHOT_ARRAY& aArray, uint64_t aCount, size_t aRecordSize,
+                        uint64_t& aOffset )
+{
+    aOffset = ( aOffset + 7 ) & ~uint64_t( 7 );
+
+    aArray.m_offset = aOffset;
+    aArray.m_count  = aCount;
+
+    aOffset += aCount * aRecordSize;
+}
+
+
+/// Writes an array at its position, after the previous one
+static bool writeArray( FILE* aFile, const SNAPSHOT_ARRAY& aArray, const void* aData,
+                        size_t aRecordSize, uint64_t& aPosition )
+{
+    static const char padding[8] = {};
+
+    if( aArray.m_offset > aPosition )
+    {
+        if( fwrite( padding, 1, aArray.m_offset - aPosition, aFile ) != aArray.m_offset - aPosition )
+            return false;
+    }
+
+    size_t size = aArray.m_count * aRecordSize;
+
+    aPosition = aArray.m_offset + size;
+
+    return !size || fwrite( aData, 1, size, aFile ) == size;
+}
+
+
+PCB_SNAPSHOT_PLUGIN::PCB_SNAPSHOT_PLUGIN() :
+    PCB_IO( CTL_FOR_BOARD | CTL_OMIT_TRACKS | CTL_OMIT_FILLS )
+{
+}
+
+
+wxString PCB_SNAPSHOT_PLUGIN::SnapshotFileName( const wxString& aBoardFileName )
+{
+    return aBoardFileName + wxT( ".bin" );
+}
+
+
+wxString PCB_SNAPSHOT_PLUGIN::SnapshotSource( const wxString& aSnapshotFileName )
+{
+    wxString source = aSnapshotFileName;
+
+    source.EndsWith( wxT( ".bin" ), &source );
+
+    return source;
+}
+
+
+bool PCB_SNAPSHOT_PLUGIN::IsFresh( const wxString& aBoardFileName )
+{
+    wxFileName  boardFile( aBoardFileName );
+    wxFileName  snapshotFile( SnapshotFileName( aBoardFileName ) );
+
+    if( !boardFile.FileExists() || !snapshotFile.FileExists() )
+        return false;
+
+    if( snapshotFile.GetModificationTime() < boardFile.GetModificationTime() )
+        return false;
+
+    SNAPSHOT_HEADER header;
+    FILE*           fp = wxFopen( snapshotFile.GetFullPath(), wxT( "rb" ) );
+
+    if( !fp )
+        return false;
+
+    bool ok = fread( &header, sizeof( header ), 1, fp ) == 1;
+
+    fclose( fp );
+
+    if( !ok || !isValidHeader( header ) )
+        return false;
+
+    uint64_t size;
+    uint64_t checksum;
+
+    if( !checksumFile( aBoardFileName, &size, &checksum ) )
+        return false;
+
+    return size == header.m_sourceSize && checksum == header.m_sourceChecksum;
+}
+
+
+void PCB_SNAPSHOT_PLUGIN::Save( const wxString& aFileName, BOARD* aBoard,
+                                const PROPERTIES* aProperties )
+{
+    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
+
+    init( aProperties );
+
+    m_board = aBoard;       // after init()
+
+    // Same net codes as in the board file
+    m_mapping->SetBoard( aBoard );
+
+    SNAPSHOT_HEADER header;
+
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.m_magic, SNAPSHOT_MAGIC, sizeof( header.m_magic ) );
+    header.m_version   = SNAPSHOT_VERSION;
+    header.m_byteOrder = SNAPSHOT_BYTE_ORDER;
+
+    wxString source = SnapshotSource( aFileName );
+
+    if( !checksumFile( source, &header.m_sourceSize, &header.m_sourceChecksum ) )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Unable to open filename '%s' for reading" ),
+                                          GetChars( source ) ) );
+    }
+
+    // The board without its tracks and zone fills (see m_ctl)
+    STRING_FORMATTER    formatter;
+
+    m_out = &formatter;     // no ownership
+
+    m_out->Print( 0, "(kicad_pcb (version %d) (host pcbnew %s)\n", SEXPR_BOARD_FILE_VERSION,
+                  formatter.Quotew( GetBuildVersion() ).c_str() );
+
+    Format( aBoard, 1 );
+
+    m_out->Print( 0, ")\n" );
+
+    m_out = &m_sf;
+
+    const std::string& text = formatter.GetString();
+
+    // The tracks and the zone fills, in flat arrays
+    std::vector<SNAPSHOT_TRACK>     tracks;
+    std::vector<SNAPSHOT_ZONE>      zones;
+    std::vector<uint32_t>           contours;
+    std::vector<SNAPSHOT_POINT>     points;
+    std::vector<SNAPSHOT_SEGMENT>   segments;
+
+    tracks.reserve( aBoard->m_Track.GetCount() );
+
+    for( TRACK* track = aBoard->m_Track;  track;  track = track->Next() )
+    {
+        SNAPSHOT_TRACK rec;
+
+        memset( &rec, 0, sizeof( rec ) );
+
+        rec.m_timeStamp = track->GetTimeStamp();
+        rec.m_type      = track->Type();
+        rec.m_startX    = track->GetStart().x;
+        rec.m_startY    = track->GetStart().y;
+        rec.m_endX      = track->GetEnd().x;
+        rec.m_endY      = track->GetEnd().y;
+        rec.m_width     = track->GetWidth();
+        rec.m_layer     = track->GetLayer();
+        rec.m_netCode   = m_mapping->Translate( track->GetNetCode() );
+        rec.m_status    = track->GetStatus();
+
+        if( track->Type() == PCB_VIA_T )
+        {
+            const VIA*  via = static_cast<const VIA*>( track );
+            LAYER_ID    top, bottom;
+
+            via->LayerPair( &top, &bottom );
+
+            rec.m_layer       = top;
+            rec.m_bottomLayer = bottom;
+            rec.m_drill       = via->GetDrill();
+            rec.m_viaType     = via->GetViaType();
+        }
+
+        tracks.push_back( rec );
+    }
+
+    for( int ii = 0; ii < aBoard->GetAreaCount(); ++ii )
+    {
+        ZONE_CONTAINER*         zone = aBoard->GetArea( ii );
+        const SHAPE_POLY_SET&   fill = zone->GetFilledPolysList();
+        SNAPSHOT_ZONE           rec = { 0, 0 };
+
+        // Each contour is stored as an outline, as in the board file
+        if( !fill.IsEmpty() )
+        {
+            uint32_t count = 0;
+
+            for( SHAPE_POLY_SET::CONST_ITERATOR it = fill.CIterate(); it; ++it )
+            {
+                SNAPSHOT_POINT point = { it->x, it->y };
+
+                points.push_back( point );
+                ++count;
+
+                if( it.IsEndContour() )
+                {
+                    contours.push_back( count );
+                    ++rec.m_contourCount;
+                    count = 0;
+                }
+            }
+        }
+
+        const std::vector<SEGMENT>& segs = zone->FillSegments();
+
+        for( unsigned jj = 0; jj < segs.size(); ++jj )
+        {
+            SNAPSHOT_SEGMENT seg = { segs[jj].m_Start.x, segs[jj].m_Start.y,
+                                     segs[jj].m_End.x, segs[jj].m_End.y };
+
+            segments.push_back( seg );
+        }
+
+        rec.m_segmentCount = segs.size();
+        zones.push_back( rec );
+    }
+
+    uint64_t offset = sizeof( header );
+
+    placeArray( header.m_text, text.size(), 1, offset );
+    placeArray( header.m_tracks, tracks.size(), sizeof( SNAPSHOT_TRACK ), offset );
+    placeArray( header.m_zones, zones.size(), sizeof( SNAPSHOT_ZONE ), offset );
+    placeArray( header.m_contours, contours.size(), sizeof( uint32_t ), offset );
+    placeArray( header.m_points, points.size(), sizeof( SNAPSHOT_POINT ), offset );
+    placeArray( header.m_segments, segments.size(), sizeof( SNAPSHOT_SEGMENT ), offset );
+
+    // Write a temporary file, so an interrupted save does not leave a truncated snapshot
+    wxString    tempFileName = aFileName + wxT( ".tmp" );
+    FILE*       fp = wxFopen( tempFileName, wxT( "wb" ) );
+
+    if( !fp )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Unable to open file '%s' for writing" ),
+                                          GetChars( tempFileName ) ) );
+    }
+
+    uint64_t    position = sizeof( header );
+    bool        ok = fwrite( &header, sizeof( header ), 1, fp ) == 1;
+
+    ok = ok && writeArray( fp, header.m_text, text.data(), 1, position );
+    ok = ok && writeArray( fp, header.m_tracks, tracks.data(), sizeof( SNAPSHOT_TRACK ), position );
+    ok = ok && writeArray( fp, header.m_zones, zones.data(), sizeof( SNAPSHOT_ZONE ), position );
+    ok = ok && writeArray( fp, header.m_contours, contours.data(), sizeof( uint32_t ), position );
+    ok = ok && writeArray( fp, header.m_points, points.data(), sizeof( SNAPSHOT_POINT ), position );
+    ok = ok && writeArray( fp, header.m_segments, segments.data(), sizeof( SNAPSHOT_SEGMENT ),
+                           position );
+
+    ok = ( fclose( fp ) == 0 ) && ok;
+
+    if( !ok || !wxRenameFile( tempFileName, aFileName, true ) )
+    {
+        wxRemoveFile( tempFileName );
+
+        THROW_IO_ERROR( wxString::Format( _( "Error writing file '%s'" ),
+                                          GetChars( aFileName ) ) );
+    }
+}
+
+
+BOARD* PCB_SNAPSHOT_PLUGIN::Load( const wxString& aFileName, BOARD* aAppendToMe,
+                                  const PROPERTIES* aProperties )
+{
+    using namespace boost::interprocess;
+
+    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
+
+    // The tracks and fills are added to the board parsed from the text of the snapshot
+    if( aAppendToMe )
+        THROW_IO_ERROR( _( "A board snapshot cannot be appended to another board" ) );
+
+    init( aProperties );
+
+    file_mapping    mapping;
+    mapped_region   region;
+
+    try
+    {
+        file_mapping( aFileName.fn_str(), read_only ).swap( mapping );
+        mapped_region( mapping, read_only ).swap( region );
+    }
+    catch( const interprocess_exception& )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Unable to open filename '%s' for reading" ),
+                                          GetChars( aFileName ) ) );
+    }
+
+    const char*     data = static_cast<const char*>( region.get_address() );
+    uint64_t        size = region.get_size();
+    SNAPSHOT_HEADER header;
+
+    if( size >= sizeof( header ) )
+        memcpy( &header, data, sizeof( header ) );
+
+    if( size < sizeof( header ) || !isValidHeader( header )
+        || !isValidArray( header.m_text, 1, size )
+        || !isValidArray( header.m_tracks, sizeof( SNAPSHOT_TRACK ), size )
+        || !isValidArray( header.m_zones, sizeof( SNAPSHOT_ZONE ), size )
+        || !isValidArray( header.m_contours, sizeof( uint32_t ), size )
+        || !isValidArray( header.m_points, sizeof( SNAPSHOT_POINT ), size )
+        || !isValidArray( header.m_segments, sizeof( SNAPSHOT_SEGMENT ), size ) )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "File '%s' is not a valid board snapshot" ),
+                                          GetChars( aFileName ) ) );
+    }
+
+    // The records are aligned by Save(): they are used in place
+    const SNAPSHOT_TRACK*   tracks = (const SNAPSHOT_TRACK*) ( data + header.m_tracks.m_offset );
+    const SNAPSHOT_ZONE*    zones = (const SNAPSHOT_ZONE*) ( data + header.m_zones.m_offset );
+    const uint32_t*         contours = (const uint32_t*) ( data + header.m_contours.m_offset );
+    const SNAPSHOT_POINT*   points = (const SNAPSHOT_POINT*) ( data + header.m_points.m_offset );
+    const SNAPSHOT_SEGMENT* segments =
+            (const SNAPSHOT_SEGMENT*) ( data + header.m_segments.m_offset );
+
+    STRING_LINE_READER reader( std::string( data + header.m_text.m_offset, header.m_text.m_count ),
+                               aFileName );
+
+    m_parser->SetLineReader( &reader );
+    m_parser->SetBoard( NULL );
+    m_parser->SetParallelLoad( true );
+
+    std::unique_ptr<BOARD> board( dynamic_cast<BOARD*>( m_parser->Parse() ) );
+
+    if( !board || header.m_zones.m_count != (uint64_t) board->GetAreaCount() )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "File '%s' is not a valid board snapshot" ),
+                                          GetChars( aFileName ) ) );
+    }
+
+    for( uint64_t ii = 0; ii < header.m_tracks.m_count; ++ii )
+    {
+        const SNAPSHOT_TRACK&   rec = tracks[ii];
+        wxPoint                 start( rec.m_startX, rec.m_startY );
+        TRACK*                  track;
+
+        if( rec.m_type == PCB_VIA_T )
+        {
+            VIA* via = new VIA( board.get() );
+
+            via->SetViaType( VIATYPE_T( rec.m_viaType ) );
+            via->SetStart( start );
+            via->SetEnd( start );
+            via->SetDrill( rec.m_drill );
+            via->SetLayerPair( LAYER_ID( rec.m_layer ), LAYER_ID( rec.m_bottomLayer ) );
+            track = via;
+        }
+        else
+        {
+            track = new TRACK( board.get() );
+
+            track->SetStart( start );
+            track->SetEnd( wxPoint( rec.m_endX, rec.m_endY ) );
+            track->SetLayer( LAYER_ID( rec.m_layer ) );
+        }
+
+        track->SetWidth( rec.m_width );
+        track->SetTimeStamp( rec.m_timeStamp );
+        track->SetStatus( static_cast<STATUS_FLAGS>( rec.m_status ) );
+
+        // Owned by the board from now on, even if its net is invalid
+        board->Add( track, ADD_APPEND );
+
+        // Same mapping as the net codes of the pads and zones of the text
+        if( !track->SetNetCode( m_parser->MapNetCode( rec.m_netCode ), /* aNoAssert */ true ) )
+        {
+            THROW_IO_ERROR( wxString::Format( _( "invalid net ID in\nfile: <%s>" ),
+                                              GetChars( aFileName ) ) );
+        }
+    }
+
+    uint64_t contour = 0;
+    uint64_t point = 0;
+    uint64_t segment = 0;
+
+    for( int ii = 0; ii < board->GetAreaCount(); ++ii )
+    {
+        ZONE_CONTAINER*         zone = board->GetArea( ii );
+        const SNAPSHOT_ZONE&    rec = zones[ii];
+        SHAPE_POLY_SET          fill;
+
+        if( rec.m_contourCount > header.m_contours.m_count - contour
+            || rec.m_segmentCount > header.m_segments.m_count - segment )
+        {
+            THROW_IO_ERROR( wxString::Format( _( "File '%s' is not a valid board snapshot" ),
+                                              GetChars( aFileName ) ) );
+        }
+
+        for( uint32_t jj = 0; jj < rec.m_contourCount; ++jj, ++contour )
+        {
+            uint32_t count = contours[contour];
+
+            if( count > header.m_points.m_count - point )
+            {
+                THROW_IO_ERROR( wxString::Format( _( "File '%s' is not a valid board snapshot" ),
+                                                  GetChars( aFileName ) ) );
+            }
+
+            fill.NewOutline();
+
+            for( uint32_t kk = 0; kk < count; ++kk, ++point )
+                fill.Append( points[point].m_x, points[point].m_y );
+        }
+
+        if( !fill.IsEmpty() )
+            zone->AddFilledPolysList( fill );
+
+        if( rec.m_segmentCount )
+        {
+            std::vector<SEGMENT> segs;
+
+            segs.reserve( rec.m_segmentCount );
+
+            for( uint32_t jj = 0; jj < rec.m_segmentCount; ++jj, ++segment )
+            {
+                const SNAPSHOT_SEGMENT& seg = segments[segment];
+
+                segs.push_back( SEGMENT( wxPoint( seg.m_startX, seg.m_startY ),
+                                         wxPoint( seg.m_endX, seg.m_endY ) ) );
+            }
+
+            zone->AddFillSegments( segs );
+        }
+    }
+
+    board->SetFileName( SnapshotSource( aFileName ) );
+
+    return board.release();
+}
@@ -0,0 +1,105 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pcb_snapshot_plugin.h
+ * @brief Binary snapshot of a board, written next to its .kicad_pcb file.
+ */
+
+#ifndef PCB_SNAPSHOT_PLUGIN_H_
+#define PCB_SNAPSHOT_PLUGIN_H_
+
+#include <kicad_plugin.h>
+
+
+/**
+ * Class PCB_SNAPSHOT_PLUGIN
+ * saves and loads a binary snapshot of a board, to reload big boards quickly.
+ *
+ * The snapshot of "board.kicad_pcb" is "board.kicad_pcb.bin".  It holds:
+ * - a header with the size and a checksum of the .kicad_pcb file it was written
+ *   with, so a snapshot is only used if the board file was not modified since,
+ * - the tracks and vias, and the filled areas and fill segments of the zones, in
+ *   flat arrays of fixed size records, which are read in place from the memory
+ *   mapped file,
+ * - the rest of the board (setup, nets, modules, drawings, zone outlines) in
+ *   s-expression format, without the tracks and the zone fills, which is parsed by
+ *   the PCB_IO parser.
+ *
+ * The snapshot is a cache for the machine which wrote it: it uses the byte order and
+ * the record layout of this machine, and is ignored elsewhere.  The footprint library
+ * functions are the PCB_IO ones.
+ */
+class PCB_SNAPSHOT_PLUGIN : public PCB_IO
+{
+public:
+
+    //-----<PLUGIN API>---------------------------------------------------------
+
+    const wxString PluginName() const
+    {
+        return wxT( "KiCad-Snapshot" );
+    }
+
+    const wxString GetFileExtension() const
+    {
+        return wxT( "kicad_pcb.bin" );
+    }
+
+    /**
+     * Function Save
+     * writes the snapshot @a aFileName of @a aBoard, which must have been just saved
+     * in the board file named by SnapshotSource( aFileName ).
+     */
+    void Save( const wxString& aFileName, BOARD* aBoard,
+               const PROPERTIES* aProperties = NULL );          // overload
+
+    BOARD* Load( const wxString& aFileName, BOARD* aAppendToMe,
+                 const PROPERTIES* aProperties = NULL );
+
+    //-----</PLUGIN API>--------------------------------------------------------
+
+    PCB_SNAPSHOT_PLUGIN();
+
+    /**
+     * Function SnapshotFileName
+     * @return the name of the snapshot of the board file @a aBoardFileName.
+     */
+    static wxString SnapshotFileName( const wxString& aBoardFileName );
+
+    /**
+     * Function SnapshotSource
+     * @return the name of the board file of the snapshot @a aSnapshotFileName.
+     */
+    static wxString SnapshotSource( const wxString& aSnapshotFileName );
+
+    /**
+     * Function IsFresh
+     * tests if the snapshot of @a aBoardFileName can be loaded instead of this file:
+     * the snapshot must be newer than the board file, written by this version of the
+     * plugin on a compatible machine, and with the same board file contents.
+     */
+    static bool IsFresh( const wxString& aBoardFileName );
+};
+
+#endif  // PCB_SNAPSHOT_PLUGIN_H_
@@ -32,6 +32,7 @@
 #endif /* USE_OPENMP */
 
 #include <ratsnest_data.h>
+#include <ratsnest_worker.h>
 
 #include <class_board.h>
 #include <class_module.h>
@@ -114,8 +115,45 @@ static bool isEdgeConnectingNode( const RN_EDGE_PTR& aEdge, const RN_NODE_PTR& a
 }
 
 
+///> Pair of nodes, stored in the same order whatever the edge direction is.
+typedef std::pair<const RN_NODE*, const RN_NODE*> RN_NODE_PAIR;
+
+static RN_NODE_PAIR nodePair( const RN_NODE_PTR& aNode1, const RN_NODE_PTR& aNode2 )
+{
+    if( aNode1.get() < aNode2.get() )
+        return RN_NODE_PAIR( aNode1.get(), aNode2.get() );
+
+    return RN_NODE_PAIR( aNode2.get(), aNode1.get() );
+}
+
+
+///> Finds the representative of a set in a union-find forest.
+static int findRoot( std::vector<int>& aParents, int aIndex )
+{
+    while( aParents[aIndex] != aIndex )
+    {
+        aParents[aIndex] = aParents[aParents[aIndex]];     // path halving
+        aIndex = aParents[aIndex];
+    }
+
+    return aIndex;
+}
+
+
+/**
+ * Function kruskalMST()
+ * Computes the ratsnest edges of a net.
+ * @param aEdges is the list of edges to choose from (it is sorted and emptied).
+ * @param aNodes is the list of nodes of the net.
+ * @param aNodeTags receives the tags identifying connected items, in the aNodes order.
+ * @param aSpanningTree (optional) receives all edges of the spanning tree, including the
+ * existing connections.
+ * @return missing connections (the caller takes the ownership).
+ */
 static std::vector<RN_EDGE_MST_PTR>* kruskalMST( RN_LINKS::RN_EDGE_LIST& aEdges,
-                                                 std::vector<RN_NODE_PTR>& aNodes )
+                                                 const std::vector<RN_NODE_PTR>& aNodes,
+                                                 std::vector<int>& aNodeTags,
+                                                 std::vector<RN_EDGE_MST_PTR>* aSpanningTree = NULL )
 {
     unsigned int nodeNumber = aNodes.size();
     unsigned int mstExpectedSize = nodeNumber - 1;
@@ -129,9 +167,10 @@ static std::vector<RN_EDGE_MST_PTR>* kruskalMST( RN_LINKS::RN_EDGE_LIST& aEdges,
     // Set tags for marking cycles
     boost::unordered_map<RN_NODE_PTR, int> tags;
     unsigned int tag = 0;
-    for( RN_NODE_PTR& node : aNodes )
+    aNodeTags.resize( nodeNumber );
+    for( const RN_NODE_PTR& node : aNodes )
     {
-        node->SetTag( tag );
+        aNodeTags[tag] = tag;
         tags[node] = tag++;
     }
 
@@ -171,7 +210,7 @@ static std::vector<RN_EDGE_MST_PTR>* kruskalMST( RN_LINKS::RN_EDGE_LIST& aEdges,
             {
                 for( it = cycles[trgTag].begin(), itEnd = cycles[trgTag].end(); it != itEnd; ++it ) {
                     tags[aNodes[*it]] = srcTag;
-                    aNodes[*it]->SetTag( srcTag );
+                    aNodeTags[*it] = srcTag;
                 }
             }
 
@@ -188,11 +227,19 @@ static std::vector<RN_EDGE_MST_PTR>* kruskalMST( RN_LINKS::RN_EDGE_LIST& aEdges,
                                                                          dt->GetWeight() );
                 mst->push_back( newEdge );
                 ++mstSize;
+
+                if( aSpanningTree )
+                    aSpanningTree->push_back( newEdge );
             }
             else
             {
                 // Processing a connection, decrease the expected size of the ratsnest MST
                 --mstExpectedSize;
+
+                if( aSpanningTree )
+                    aSpanningTree->push_back( std::make_shared<RN_EDGE_MST>( dt->GetSourceNode(),
+                                                                             dt->GetTargetNode(),
+                                                                             0 ) );
             }
         }
 
@@ -258,7 +305,7 @@ void RN_NET::removeNode( RN_NODE_PTR& aNode, const BOARD_CONNECTED_ITEM* aParent
     if( m_links.RemoveNode( aNode ) )
     {
         clearNode( aNode );
-        m_dirty = true;
+        MarkDirty();
     }
 }
 
@@ -284,7 +331,7 @@ void RN_NET::removeEdge( RN_EDGE_MST_PTR& aEdge, const BOARD_CONNECTED_ITEM* aPa
     if( m_links.RemoveNode( end ) )
         clearNode( end );
 
-    m_dirty = true;
+    MarkDirty();
 }
 
 
@@ -324,49 +371,253 @@ RN_EDGE_MST_PTR RN_LINKS::AddConnection( const RN_NODE_PTR& aNode1, const RN_NOD
 
 
 void RN_NET::compute()
+{
+    std::vector<RN_NODE_PTR> nodes;
+    std::vector<int> tags;
+
+    getSortedNodes( nodes );
+
+    std::shared_ptr< std::vector<RN_EDGE_MST_PTR> > edges(
+            m_spanningTree->Compute( nodes, m_links.GetConnections(), tags ) );
+
+    setResults( nodes, tags, edges );
+}
+
+
+void RN_NET::getSortedNodes( std::vector<RN_NODE_PTR>& aNodes ) const
 {
     const RN_LINKS::RN_NODE_SET& boardNodes = m_links.GetNodes();
-    const RN_LINKS::RN_EDGE_LIST& boardEdges = m_links.GetConnections();
+
+    // Move and sort (sorting speeds up) all nodes to a vector for the Delaunay triangulation
+    aNodes.resize( boardNodes.size() );
+    std::partial_sort_copy( boardNodes.begin(), boardNodes.end(), aNodes.begin(), aNodes.end() );
+}
+
+
+void RN_NET::setResults( const std::vector<RN_NODE_PTR>& aNodes, const std::vector<int>& aTags,
+                         const std::shared_ptr< std::vector<RN_EDGE_MST_PTR> >& aEdges )
+{
+    for( unsigned int i = 0; i < aNodes.size(); ++i )
+        aNodes[i]->SetTag( aTags[i] );
+
+    m_rnEdges = aEdges;
+}
+
+
+std::vector<RN_EDGE_MST_PTR>* RN_SPANNING_TREE::Compute( std::vector<RN_NODE_PTR>& aNodes,
+                                                         const RN_LINKS::RN_EDGE_LIST& aConnections,
+                                                         std::vector<int>& aTags )
+{
+    MUTLOCK lock( m_lock );
 
     // Special cases do not need complicated algorithms
-    if( boardNodes.size() <= 2 )
+    if( aNodes.size() <= 2 )
     {
-        m_rnEdges.reset( new std::vector<RN_EDGE_MST_PTR>( 0 ) );
+        m_triangulator.reset();
+        m_triangulatedNodes.clear();
+        m_spanningTree.clear();
+
+        std::vector<RN_EDGE_MST_PTR>* edges = new std::vector<RN_EDGE_MST_PTR>( 0 );
 
         // Check if the only possible connection exists
-        if( boardEdges.size() == 0 && boardNodes.size() == 2 )
+        if( aConnections.size() == 0 && aNodes.size() == 2 )
         {
-            RN_LINKS::RN_NODE_SET::iterator last = ++boardNodes.begin();
-
             // There can be only one possible connection, but it is missing
-            m_rnEdges->push_back( std::make_shared<RN_EDGE_MST>( *boardNodes.begin(), *last ) );
+            edges->push_back( std::make_shared<RN_EDGE_MST>( aNodes[0], aNodes[1] ) );
         }
 
         // Set tags to nodes as connected
-        for( RN_NODE_PTR node : boardNodes )
-            node->SetTag( 0 );
+        aTags.assign( aNodes.size(), 0 );
 
-        return;
+        return edges;
     }
 
-    // Move and sort (sorting speeds up) all nodes to a vector for the Delaunay triangulation
-    std::vector<RN_NODE_PTR> nodes( boardNodes.size() );
-    std::partial_sort_copy( boardNodes.begin(), boardNodes.end(), nodes.begin(), nodes.end() );
+    // Find the nodes which were added or removed since the last computation
+    boost::unordered_set<const RN_NODE*> currentNodes;
+    std::vector<RN_NODE_PTR> added;
+    std::vector<const RN_NODE*> removed;
 
-    TRIANGULATOR triangulator;
-    triangulator.CreateDelaunay( nodes.begin(), nodes.end() );
-    boost::scoped_ptr<RN_LINKS::RN_EDGE_LIST> triangEdges( triangulator.GetEdges() );
+    for( const RN_NODE_PTR& node : aNodes )
+    {
+        currentNodes.insert( node.get() );
+
+        if( m_triangulatedNodes.find( node.get() ) == m_triangulatedNodes.end() )
+            added.push_back( node );
+    }
 
-    // Compute weight/distance for edges resulting from triangulation
-    RN_LINKS::RN_EDGE_LIST::iterator eit, eitEnd;
-    for( eit = (*triangEdges).begin(), eitEnd = (*triangEdges).end(); eit != eitEnd; ++eit )
-        (*eit)->SetWeight( getDistance( (*eit)->GetSourceNode(), (*eit)->GetTargetNode() ) );
+    for( const RN_NODE* node : m_triangulatedNodes )
+    {
+        if( currentNodes.find( node ) == currentNodes.end() )
+            removed.push_back( node );
+    }
 
-    // Add the currently existing connections list to the results of triangulation
-    std::copy( boardEdges.begin(), boardEdges.end(), std::front_inserter( *triangEdges ) );
+    m_triangulatedNodes.swap( currentNodes );
+
+    RN_LINKS::RN_EDGE_LIST candidates;
+
+    if( updateTriangulation( added, removed ) )
+    {
+        getUpdateCandidates( aNodes, aConnections, candidates );
+    }
+    else
+    {
+        m_triangulator.reset( new TRIANGULATOR );
+        m_triangulator->CreateDelaunay( aNodes.begin(), aNodes.end() );
+        boost::scoped_ptr<RN_LINKS::RN_EDGE_LIST> triangEdges( m_triangulator->GetEdges() );
+
+        // Compute weight/distance for edges resulting from triangulation
+        RN_LINKS::RN_EDGE_LIST::iterator eit, eitEnd;
+        for( eit = (*triangEdges).begin(), eitEnd = (*triangEdges).end(); eit != eitEnd; ++eit )
+            (*eit)->SetWeight( getDistance( (*eit)->GetSourceNode(), (*eit)->GetTargetNode() ) );
+
+        candidates.swap( *triangEdges );
+
+        // Add the currently existing connections list to the results of triangulation
+        std::copy( aConnections.begin(), aConnections.end(), std::front_inserter( candidates ) );
+    }
 
     // Get the minimal spanning tree
-    m_rnEdges.reset( kruskalMST( *triangEdges, nodes ) );
+    m_spanningTree.clear();
+
+    return kruskalMST( candidates, aNodes, aTags, &m_spanningTree );
+}
+
+
+///> The triangulation of a net is rebuilt if more than 1/RN_UPDATE_RATIO of its nodes changed.
+static const unsigned int RN_UPDATE_RATIO = 8;
+
+
+///> Finds a half-edge starting at each node that is a key of aEdges.
+static void findNodeEdges( const TRIANGULATOR& aTriangulator,
+                           boost::unordered_map<const RN_NODE*, RN_EDGE_PTR>& aEdges )
+{
+    for( const RN_EDGE_PTR& leadingEdge : aTriangulator.GetLeadingEdges() )
+    {
+        RN_EDGE_PTR edge = leadingEdge;
+
+        for( int i = 0; i < 3; ++i )
+        {
+            boost::unordered_map<const RN_NODE*, RN_EDGE_PTR>::iterator it =
+                    aEdges.find( edge->GetSourceNode().get() );
+
+            if( it != aEdges.end() )
+                it->second = edge;
+
+            edge = edge->GetNextEdgeInFace();
+        }
+    }
+}
+
+
+bool RN_SPANNING_TREE::updateTriangulation( const std::vector<RN_NODE_PTR>& aAdded,
+                                            const std::vector<const RN_NODE*>& aRemoved )
+{
+    if( !m_triangulator || m_spanningTree.empty() ||
+            ( aAdded.size() + aRemoved.size() ) * RN_UPDATE_RATIO > m_triangulatedNodes.size() )
+        return false;
+
+    if( !aRemoved.empty() )
+    {
+        boost::unordered_map<const RN_NODE*, RN_EDGE_PTR> edges;
+
+        for( const RN_NODE* node : aRemoved )
+            edges[node] = RN_EDGE_PTR();
+
+        findNodeEdges( *m_triangulator, edges );
+
+        for( const RN_NODE* node : aRemoved )
+        {
+            RN_EDGE_PTR edge = edges[node];
+
+            // Removing the previous nodes might have swapped or deleted the edge
+            if( !edge || edge->GetSourceNode().get() != node )
+            {
+                boost::unordered_map<const RN_NODE*, RN_EDGE_PTR> nodeEdge;
+                nodeEdge[node] = RN_EDGE_PTR();
+
+                findNodeEdges( *m_triangulator, nodeEdge );
+                edge = nodeEdge[node];
+
+                if( !edge )
+                    return false;
+            }
+
+            m_triangulator->RemoveNode( edge );
+        }
+    }
+
+    // Nodes outside of the current triangulation boundary require a new triangulation
+    for( const RN_NODE_PTR& node : aAdded )
+    {
+        if( !m_triangulator->InsertNode( node ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+void RN_SPANNING_TREE::getUpdateCandidates( const std::vector<RN_NODE_PTR>& aNodes,
+                                            const RN_LINKS::RN_EDGE_LIST& aConnections,
+                                            RN_LINKS::RN_EDGE_LIST& aCandidates )
+{
+    // The previous spanning tree was minimal, so an edge joining two nodes that are still
+    // linked by a path of its remaining edges cannot be shorter than any edge of the path.
+    // Only edges between the parts the tree was split into (or leading to added nodes) and
+    // the connections may change the result.
+    boost::unordered_map<const RN_NODE*, int> indices;
+
+    for( unsigned int i = 0; i < aNodes.size(); ++i )
+        indices[aNodes[i].get()] = i;
+
+    boost::unordered_set<RN_NODE_PAIR> connections;
+
+    for( const RN_EDGE_PTR& edge : aConnections )
+        connections.insert( nodePair( edge->GetSourceNode(), edge->GetTargetNode() ) );
+
+    std::vector<int> parts( aNodes.size() );
+
+    for( unsigned int i = 0; i < parts.size(); ++i )
+        parts[i] = i;
+
+    for( const RN_EDGE_MST_PTR& edge : m_spanningTree )
+    {
+        const RN_NODE_PTR& source = edge->GetSourceNode();
+        const RN_NODE_PTR& target = edge->GetTargetNode();
+
+        boost::unordered_map<const RN_NODE*, int>::const_iterator src = indices.find( source.get() );
+        boost::unordered_map<const RN_NODE*, int>::const_iterator trg = indices.find( target.get() );
+
+        if( src == indices.end() || trg == indices.end() )
+            continue;
+
+        unsigned int weight = getDistance( source, target );
+
+        if( connections.find( nodePair( source, target ) ) != connections.end() )
+            weight = 0;
+        else if( edge->GetWeight() == 0 && weight != 0 )
+            continue;       // the connection does not exist anymore
+
+        aCandidates.push_back( std::make_shared<RN_EDGE_MST>( source, target, weight ) );
+
+        parts[findRoot( parts, src->second )] = findRoot( parts, trg->second );
+    }
+
+    boost::scoped_ptr<RN_LINKS::RN_EDGE_LIST> triangEdges( m_triangulator->GetEdges() );
+
+    for( const RN_EDGE_PTR& edge : *triangEdges )
+    {
+        const RN_NODE_PTR& source = edge->GetSourceNode();
+        const RN_NODE_PTR& target = edge->GetTargetNode();
+
+        if( findRoot( parts, indices[source.get()] ) != findRoot( parts, indices[target.get()] ) )
+        {
+            edge->SetWeight( getDistance( source, target ) );
+            aCandidates.push_back( edge );
+        }
+    }
+
+    std::copy( aConnections.begin(), aConnections.end(), std::front_inserter( aCandidates ) );
 }
 
 
@@ -425,6 +676,39 @@ void RN_NET::Update()
 }
 
 
+void RN_NET::PrepareJob( int aNetCode, RN_NET_JOB& aJob )
+{
+    // Zones and pads are processed here, as they need the board items
+    processZones();
+    processPads();
+
+    aJob.m_netCode = aNetCode;
+    aJob.m_revision = m_revision;
+    aJob.m_tree = m_spanningTree;
+    getSortedNodes( aJob.m_nodes );
+    aJob.m_connections = m_links.GetConnections();
+
+    m_postedRevision = m_revision;
+}
+
+
+bool RN_NET::ApplyJob( const RN_NET_JOB& aJob )
+{
+    // The net has been modified or recomputed since the job was prepared
+    if( !m_dirty || aJob.m_revision != m_revision || !aJob.m_edges )
+        return false;
+
+    setResults( aJob.m_nodes, aJob.m_tags, aJob.m_edges );
+
+    for( RN_EDGE_MST_PTR& edge : *m_rnEdges )
+        validateEdge( edge );
+
+    m_dirty = false;
+
+    return true;
+}
+
+
 void RN_NET::AddItem( const D_PAD* aPad )
 {
     // Ratsnest is not computed for non-copper pads
@@ -435,7 +719,7 @@ void RN_NET::AddItem( const D_PAD* aPad )
     node->AddParent( aPad );
     m_pads[aPad].m_Node = node;
 
-    m_dirty = true;
+    MarkDirty();
 }
 
 
@@ -445,7 +729,7 @@ void RN_NET::AddItem( const VIA* aVia )
     node->AddParent( aVia );
     m_vias[aVia] = node;
 
-    m_dirty = true;
+    MarkDirty();
 }
 
 
@@ -461,7 +745,7 @@ void RN_NET::AddItem( const TRACK* aTrack )
     end->AddParent( aTrack );
     m_tracks[aTrack] = m_links.AddConnection( start, end );
 
-    m_dirty = true;
+    MarkDirty();
 }
 
 
@@ -478,7 +762,7 @@ void RN_NET::AddItem( const ZONE_CONTAINER* aZone )
         m_zones[aZone].m_Polygons.push_back( poly );
     }
 
-    m_dirty = true;
+    MarkDirty();
 }
 
 
@@ -1223,6 +1507,20 @@ void RN_DATA::ProcessBoard()
 }
 
 
+RN_DATA::RN_DATA( const BOARD* aBoard ) :
+    m_board( aBoard ),
+    m_worker( new RN_WORKER )
+{
+}
+
+
+RN_DATA::~RN_DATA()
+{
+    // Stop the worker before the nets are destroyed
+    m_worker.reset();
+}
+
+
 void RN_DATA::Recalculate( int aNet )
 {
     unsigned int netCount = m_board->GetNetCount();
@@ -1266,6 +1564,52 @@ void RN_DATA::Recalculate( int aNet )
 }
 
 
+void RN_DATA::RecalculateAsync()
+{
+    unsigned int netCount = m_board->GetNetCount();
+
+    if( netCount > m_nets.size() )
+        m_nets.resize( netCount );
+
+    // Start with net number 1, as 0 stands for not connected
+    for( unsigned int i = 1; i < netCount; ++i )
+    {
+        RN_NET& net = m_nets[i];
+
+        if( net.IsDirty() && !net.IsPosted() )
+        {
+            std::shared_ptr<RN_NET_JOB> job = std::make_shared<RN_NET_JOB>();
+
+            net.PrepareJob( i, *job );
+            m_worker->Post( job );
+        }
+    }
+}
+
+
+bool RN_DATA::ApplyResults()
+{
+    std::vector< std::shared_ptr<RN_NET_JOB> > results;
+    bool updated = false;
+
+    m_worker->TakeResults( results );
+
+    for( const std::shared_ptr<RN_NET_JOB>& job : results )
+    {
+        if( job->m_netCode < (int) m_nets.size() && m_nets[job->m_netCode].ApplyJob( *job ) )
+            updated = true;
+    }
+
+    return updated;
+}
+
+
+void RN_DATA::SetResultsCallback( std::function<void()> aCallback )
+{
+    m_worker->SetResultsCallback( aCallback );
+}
+
+
 void RN_DATA::updateNet( int aNetCode )
 {
     assert( aNetCode < (int) m_nets.size() );
@@ -37,8 +37,12 @@
 
 #include <boost/unordered_set.hpp>
 #include <boost/unordered_map.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include <deque>
+#include <functional>
+
+#include <ki_mutex.h>
 
 class BOARD;
 class BOARD_ITEM;
@@ -49,6 +53,8 @@ class VIA;
 class TRACK;
 class ZONE_CONTAINER;
 class SHAPE_POLY_SET;
+class RN_WORKER;
+struct RN_NET_JOB;
 
 ///> Types of items that are handled by the class
 enum RN_ITEM_TYPE
@@ -312,6 +318,58 @@ private:
 };
 
 
+/**
+ * Class RN_SPANNING_TREE
+ * Computes the missing connections of a net as a minimum spanning tree of its nodes.
+ * The triangulation and the spanning tree of the previous computation are kept, so they can
+ * be repaired locally when only a few nodes change (e.g. while dragging an item).
+ * Computations are serialized, so the same tree can be used by the ratsnest worker thread
+ * and the thread that owns the board.
+ */
+class RN_SPANNING_TREE
+{
+public:
+    /**
+     * Function Compute()
+     * Computes the missing connections between nodes.
+     * Nodes are not modified, so they can be shared with another thread.
+     * @param aNodes are the nodes of a net.
+     * @param aConnections are the existing connections between the nodes.
+     * @param aTags receives a tag for each node in aNodes, nodes connected together share
+     * the same tag.
+     * @return the missing connections (the caller takes the ownership).
+     */
+    std::vector<RN_EDGE_MST_PTR>* Compute( std::vector<RN_NODE_PTR>& aNodes,
+                                           const RN_LINKS::RN_EDGE_LIST& aConnections,
+                                           std::vector<int>& aTags );
+
+protected:
+    ///> Adds the nodes in aAdded to the stored triangulation and removes the ones in aRemoved.
+    ///> Returns false if the triangulation could not be updated and has to be rebuilt.
+    bool updateTriangulation( const std::vector<RN_NODE_PTR>& aAdded,
+                              const std::vector<const RN_NODE*>& aRemoved );
+
+    ///> Builds the list of edges which may belong to the new spanning tree: the connections,
+    ///> the edges kept from the previous spanning tree and the triangulation edges joining
+    ///> parts of the tree that were split or the added nodes.
+    void getUpdateCandidates( const std::vector<RN_NODE_PTR>& aNodes,
+                              const RN_LINKS::RN_EDGE_LIST& aConnections,
+                              RN_LINKS::RN_EDGE_LIST& aCandidates );
+
+    ///> Delaunay triangulation of the nodes used by the last computation.
+    boost::scoped_ptr<TRIANGULATOR> m_triangulator;
+
+    ///> Nodes stored in m_triangulator (the triangulation holds references to them).
+    boost::unordered_set<const RN_NODE*> m_triangulatedNodes;
+
+    ///> Spanning tree from the last computation, including the existing connections.
+    std::vector<RN_EDGE_MST_PTR> m_spanningTree;
+
+    ///> Serializes the computations.
+    MUTEX m_lock;
+};
+
+
 /**
  * Class RN_NET
  * Describes ratsnest for a single net.
@@ -320,7 +378,8 @@ class RN_NET
 {
 public:
     ///> Default constructor.
-    RN_NET() : m_dirty( true ), m_visible( true )
+    RN_NET() : m_dirty( true ), m_revision( 0 ), m_postedRevision( -1 ), m_visible( true ),
+        m_spanningTree( std::make_shared<RN_SPANNING_TREE>() )
     {}
 
     /**
@@ -351,6 +410,7 @@ public:
     void MarkDirty()
     {
         m_dirty = true;
+        ++m_revision;
     }
 
     /**
@@ -380,6 +440,34 @@ public:
      */
     void Update();
 
+    /**
+     * Function IsPosted()
+     * Returns true if the current state of the net has been posted to the ratsnest worker
+     * and its results are not applied yet.
+     */
+    bool IsPosted() const
+    {
+        return m_dirty && m_postedRevision == m_revision;
+    }
+
+    /**
+     * Function PrepareJob()
+     * Updates the connections made by zones and pads and stores a snapshot of the nodes and
+     * connections of the net, so its ratsnest can be computed by another thread.
+     * @param aNetCode is the net code of the net.
+     * @param aJob is the job to be filled.
+     */
+    void PrepareJob( int aNetCode, RN_NET_JOB& aJob );
+
+    /**
+     * Function ApplyJob()
+     * Uses the ratsnest computed by a job, unless the net has been modified after the job
+     * was prepared.
+     * @param aJob is a job prepared by PrepareJob() and then run.
+     * @return True if the ratsnest was updated, false if the results were stale and dropped.
+     */
+    bool ApplyJob( const RN_NET_JOB& aJob );
+
     /**
      * Function AddItem()
      * Adds an appropriate node associated with selected pad, so it is
@@ -568,9 +656,18 @@ protected:
     ///> Adds additional edges to account for connections made by items located in pads areas.
     void processPads();
 
-    ///> Recomputes ratsnset from scratch.
+    ///> Recomputes ratsnest. If only a few nodes were added or removed since the previous
+    ///> computation, the triangulation and the spanning tree are repaired locally instead of
+    ///> being built from scratch.
     void compute();
 
+    ///> Sorts the nodes for the Delaunay triangulation.
+    void getSortedNodes( std::vector<RN_NODE_PTR>& aNodes ) const;
+
+    ///> Sets the node tags and the ratsnest edges resulting from a computation.
+    void setResults( const std::vector<RN_NODE_PTR>& aNodes, const std::vector<int>& aTags,
+                     const std::shared_ptr< std::vector<RN_EDGE_MST_PTR> >& aEdges );
+
     ////> Stores information about connections for a given net.
     RN_LINKS m_links;
 
@@ -586,6 +683,12 @@ protected:
     ///> Flag indicating necessity of recalculation of ratsnest for a net.
     bool m_dirty;
 
+    ///> Counter of the modifications, used to recognize stale results of the ratsnest worker.
+    int m_revision;
+
+    ///> Revision posted to the ratsnest worker.
+    int m_postedRevision;
+
     ///> Structure to hold ratsnest data for ZONE_CONTAINER objects.
     typedef struct
     {
@@ -626,6 +729,9 @@ protected:
 
     ///> Visibility flag.
     bool m_visible;
+
+    ///> Spanning tree of the net, shared with the jobs of the ratsnest worker.
+    std::shared_ptr<RN_SPANNING_TREE> m_spanningTree;
 };
 
 
@@ -641,7 +747,9 @@ public:
      * Default constructor
      * @param aBoard is the board to be processed in order to look for unconnected items.
      */
-    RN_DATA( const BOARD* aBoard ) : m_board( aBoard ) {}
+    RN_DATA( const BOARD* aBoard );
+
+    ~RN_DATA();
 
     /**
      * Function Add()
@@ -704,6 +812,30 @@ public:
      */
     void Recalculate( int aNet = -1 );
 
+    /**
+     * Function RecalculateAsync()
+     * Posts the recomputation of the nets that need updating to a background thread, so the
+     * caller does not wait for the results. Nets modified again before their results are
+     * ready are recomputed, the stale results are dropped.
+     */
+    void RecalculateAsync();
+
+    /**
+     * Function ApplyResults()
+     * Updates the ratsnest with all results computed in the background so far. It has to be
+     * called by the thread that modifies the board.
+     * @return True if the ratsnest of any net was updated.
+     */
+    bool ApplyResults();
+
+    /**
+     * Function SetResultsCallback()
+     * Sets a function called when background results are ready to be applied. The function
+     * is called from the worker thread, so it has only to schedule a call to ApplyResults().
+     * @param aCallback is the function, or an empty one to remove it.
+     */
+    void SetResultsCallback( std::function<void()> aCallback );
+
     /**
      * Function GetNetCount()
      * Returns the number of nets handled by the ratsnest.
@@ -777,6 +909,9 @@ protected:
 
     ///> Stores information about ratsnest grouped by net numbers.
     std::vector<RN_NET> m_nets;
+
+    ///> Computes the ratsnest in the background.
+    boost::scoped_ptr<RN_WORKER> m_worker;
 };
 
 #endif /* RATSNEST_DATA_H */
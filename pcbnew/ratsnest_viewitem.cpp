@@ -112,6 +112,12 @@ void RATSNEST_VIEWITEM::ViewDraw( int aLayer, GAL* aGal ) const
 }
 
 
+bool RATSNEST_VIEWITEM::UpdateResults()
+{
+    return m_data->ApplyResults();
+}
+
+
 void RATSNEST_VIEWITEM::ViewGetLayers( int aLayers[], int& aCount ) const
 {
     aCount = 1;
@@ -52,6 +52,13 @@ public:
     /// @copydoc VIEW_ITEM::ViewGetLayers()
     void ViewGetLayers( int aLayers[], int& aCount ) const;
 
+    /**
+     * Function UpdateResults()
+     * Applies all ratsnest results computed in the background so far, so they are drawn at once.
+     * @return True if the ratsnest has changed and has to be redrawn.
+     */
+    bool UpdateResults();
+
 #if defined(DEBUG)
     /// @copydoc EDA_ITEM::Show()
     void Show( int x, std::ostream& st ) const
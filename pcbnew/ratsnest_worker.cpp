@@ -0,0 +1,116 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file ratsnest_worker.cpp
+ * @brief Background computation of the ratsnest.
+ */
+
+#include <ratsnest_worker.h>
+
+
+RN_WORKER::RN_WORKER() :
+    m_stop( false )
+{
+}
+
+
+RN_WORKER::~RN_WORKER()
+{
+    {
+        boost::lock_guard<boost::mutex> lock( m_lock );
+        m_stop = true;
+        m_resultsCallback = std::function<void()>();
+    }
+
+    m_jobPosted.notify_all();
+
+    if( m_thread.joinable() )
+        m_thread.join();
+}
+
+
+void RN_WORKER::Post( const std::shared_ptr<RN_NET_JOB>& aJob )
+{
+    {
+        boost::lock_guard<boost::mutex> lock( m_lock );
+
+        // Results of a previous job for the net are stale now
+        m_jobs[aJob->m_netCode] = aJob;
+        m_results.erase( aJob->m_netCode );
+
+        if( !m_thread.joinable() )
+            m_thread = boost::thread( &RN_WORKER::run, this );
+    }
+
+    m_jobPosted.notify_one();
+}
+
+
+void RN_WORKER::TakeResults( std::vector< std::shared_ptr<RN_NET_JOB> >& aResults )
+{
+    boost::lock_guard<boost::mutex> lock( m_lock );
+
+    for( JOB_MAP::iterator it = m_results.begin(); it != m_results.end(); ++it )
+        aResults.push_back( it->second );
+
+    m_results.clear();
+}
+
+
+void RN_WORKER::SetResultsCallback( std::function<void()> aCallback )
+{
+    boost::lock_guard<boost::mutex> lock( m_lock );
+    m_resultsCallback = aCallback;
+}
+
+
+void RN_WORKER::run()
+{
+    boost::unique_lock<boost::mutex> lock( m_lock );
+
+    while( true )
+    {
+        while( m_jobs.empty() && !m_stop )
+            m_jobPosted.wait( lock );
+
+        if( m_stop )
+            break;
+
+        std::shared_ptr<RN_NET_JOB> job = m_jobs.begin()->second;
+        m_jobs.erase( m_jobs.begin() );
+
+        lock.unlock();
+        job->Run();
+        lock.lock();
+
+        // Drop the results if the net has been posted again in the meantime
+        if( m_jobs.find( job->m_netCode ) == m_jobs.end() )
+            m_results[job->m_netCode] = job;
+
+        // Notify once all the queued jobs are done. The callback is called with the lock
+        // held, so it cannot be called after SetResultsCallback() has removed it.
+        if( m_jobs.empty() && !m_results.empty() && m_resultsCallback )
+            m_resultsCallback();
+    }
+}
@@ -0,0 +1,134 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file ratsnest_worker.h
+ * @brief Background computation of the ratsnest.
+ */
+
+#ifndef RATSNEST_WORKER_H
+#define RATSNEST_WORKER_H
+
+#include <ratsnest_data.h>
+
+#include <map>
+#include <memory>
+#include <functional>
+
+#include <boost/thread.hpp>
+
+
+/**
+ * Struct RN_NET_JOB
+ * holds a snapshot of the nodes and connections of a net, and the ratsnest computed for them
+ * by RN_WORKER.
+ */
+struct RN_NET_JOB
+{
+    RN_NET_JOB() : m_netCode( 0 ), m_revision( 0 )
+    {}
+
+    ///> Net the job was prepared for.
+    int m_netCode;
+
+    ///> RN_NET revision the snapshot was taken from.
+    int m_revision;
+
+    ///> Spanning tree of the net, shared with the RN_NET.
+    std::shared_ptr<RN_SPANNING_TREE> m_tree;
+
+    ///> Nodes of the net.
+    std::vector<RN_NODE_PTR> m_nodes;
+
+    ///> Existing connections between the nodes.
+    RN_LINKS::RN_EDGE_LIST m_connections;
+
+    ///> Results: tags of the nodes, in m_nodes order.
+    std::vector<int> m_tags;
+
+    ///> Results: missing connections.
+    std::shared_ptr< std::vector<RN_EDGE_MST_PTR> > m_edges;
+
+    ///> Computes the results.
+    void Run()
+    {
+        m_edges.reset( m_tree->Compute( m_nodes, m_connections, m_tags ) );
+    }
+};
+
+
+/**
+ * Class RN_WORKER
+ * computes the ratsnest of nets in a background thread.
+ *
+ * Jobs are queued by net: a job posted for a net replaces a queued job for the same net,
+ * and the results of a job are dropped if a newer job for the same net was posted while it
+ * was running, so only the last state of a modified net is computed.
+ * The thread is started by the first posted job and stopped by the destructor.
+ */
+class RN_WORKER
+{
+public:
+    RN_WORKER();
+    ~RN_WORKER();
+
+    /**
+     * Function Post()
+     * Queues a job, replacing a queued job for the same net.
+     */
+    void Post( const std::shared_ptr<RN_NET_JOB>& aJob );
+
+    /**
+     * Function TakeResults()
+     * Moves all finished jobs to aResults.
+     */
+    void TakeResults( std::vector< std::shared_ptr<RN_NET_JOB> >& aResults );
+
+    /**
+     * Function SetResultsCallback()
+     * Sets a function called by the worker thread when results are ready.
+     */
+    void SetResultsCallback( std::function<void()> aCallback );
+
+private:
+    typedef std::map< int, std::shared_ptr<RN_NET_JOB> > JOB_MAP;
+
+    ///> Thread function.
+    void run();
+
+    boost::thread               m_thread;
+    boost::mutex                m_lock;
+    boost::condition_variable   m_jobPosted;
+
+    ///> Jobs waiting for the worker, by net code.
+    JOB_MAP                     m_jobs;
+
+    ///> Finished jobs, by net code.
+    JOB_MAP                     m_results;
+
+    std::function<void()>       m_resultsCallback;
+
+    bool                        m_stop;
+};
+
+#endif /* RATSNEST_WORKER_H */
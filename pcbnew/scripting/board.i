@@ -71,6 +71,7 @@
 
 %template(VIA_DIMENSION_Vector) std::vector<VIA_DIMENSION>;
 %template(RATSNEST_Vector)      std::vector<RATSNEST_ITEM>;
+%template(BOARD_CONNECTED_ITEM_Vector) std::vector<BOARD_CONNECTED_ITEM*>;
 
 
 %extend BOARD
@@ -0,0 +1,26 @@
+#!/usr/bin/env python
+#
+# Runs the design rules checks on a board without user interface.
+#
+# usage: batchDrc.py board.kicad_pcb report.json
+#
+# The errors and the run time of each test are written in report.json.
+# The exit status is 0 if the board has no error, 1 otherwise.
+
+import sys
+from pcbnew import *
+
+filename = sys.argv[1]
+report = sys.argv[2]
+
+pcb = LoadBoard(filename)
+
+errors = RunDRC(pcb, report)
+
+if errors < 0:
+    print "Unable to write the report file %s" % report
+    sys.exit(2)
+
+print "%d DRC errors found, see %s" % (errors, report)
+
+sys.exit(1 if errors else 0)
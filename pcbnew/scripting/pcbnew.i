@@ -118,6 +118,7 @@ class BASE_SET {};
   #include <exporters/gendrill_Excellon_writer.h>
 
   #include <class_board.h>
+  #include <connectivity_graph.h>
 
   BOARD *GetBoard(); /* get current editor board */
 %}
@@ -157,6 +158,7 @@ class BASE_SET {};
 %include <colors.h>
 
 %include <class_board.h>
+%include <connectivity_graph.h>
 
 %include "board_item.i"
 
@@ -34,6 +34,7 @@
 #include <pcbnew_id.h>
 #include <build_version.h>
 #include <class_board.h>
+#include <drc_stuff.h>
 #include <kicad_string.h>
 #include <io_mgr.h>
 #include <macros.h>
@@ -107,3 +108,16 @@ bool SaveBoard( wxString& aFileName, BOARD* aBoard,
 #endif
     return true;
 }
+
+
+int RunDRC( BOARD* aBoard, wxString& aReportFileName )
+{
+    DRC drc( aBoard );
+
+    drc.RunTests();
+
+    if( !drc.WriteJsonReport( aReportFileName ) )
+        return -1;
+
+    return drc.GetErrorCount();
+}
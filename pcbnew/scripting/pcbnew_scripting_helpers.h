@@ -43,5 +43,15 @@ BOARD*  LoadBoard( wxString& aFileName );
 bool    SaveBoard( wxString& aFileName, BOARD* aBoard, IO_MGR::PCB_FILE_T aFormat );
 bool    SaveBoard( wxString& aFileName, BOARD* aBoard );
 
+/**
+ * Function RunDRC
+ * runs the design rules checks on aBoard without user interface, and writes the
+ * errors found and the run time of each test in aReportFileName, as JSON.
+ * The DRC markers are added to aBoard.
+ * @return the number of errors (markers and unconnected items) found, or -1 if the
+ * report cannot be written.
+ */
+int     RunDRC( BOARD* aBoard, wxString& aReportFileName );
+
 
 #endif
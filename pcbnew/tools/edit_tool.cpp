@@ -926,6 +926,10 @@ void EDIT_TOOL::updateRatsnest( bool aRedraw )
         if( aRedraw )
             ratsnest->AddSimple( item );
     }
+
+    // While dragging, the ratsnest is computed in the background to keep the cursor responsive
+    if( aRedraw )
+        ratsnest->RecalculateAsync();
 }
 
 
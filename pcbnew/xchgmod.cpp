@@ -413,7 +413,8 @@ void PCB_EDIT_FRAME::Exchange_Module( MODULE*            aOldModule,
     else
     {
         GetGalCanvas()->GetView()->Remove( aOldModule );
-        aOldModule->DeleteStructure();
+        GetBoard()->Remove( aOldModule );
+        delete aOldModule;
     }
 
     GetBoard()->m_Status_Pcb = 0;
@@ -39,6 +39,27 @@
 #include <pcbnew.h>
 #include <zones.h>
 
+CPolyLine* ZONE_CONTAINER::BuildSmoothedPoly() const
+{
+    switch( m_cornerSmoothingType )
+    {
+    case ZONE_SETTINGS::SMOOTHING_CHAMFER:
+        return m_Poly->Chamfer( m_cornerRadius );
+
+    case ZONE_SETTINGS::SMOOTHING_FILLET:
+        return m_Poly->Fillet( m_cornerRadius, m_ArcToSegmentsCount );
+
+    default:
+        // Acute angles between adjacent edges can create issues in calculations,
+        // in inflate/deflate outlines transforms, especially when the angle is very small.
+        // We can avoid issues by creating a very small chamfer which remove acute angles,
+        // or left it without chamfer and use only CPOLYGONS_LIST::InflateOutline to create
+        // clearance areas
+        return m_Poly->Chamfer( Millimeter2iu( 0.0 ) );
+    }
+}
+
+
 /* Build the filled solid areas data from real outlines (stored in m_Poly)
  * The solid areas can be more than one on copper layers, and do not have holes
   ( holes are linked by overlapping segments to the main outline)
@@ -55,7 +76,8 @@
  * to add holes for pads and tracks and other items not in net.
  */
 
-bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET* aOutlineBuffer )
+bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET* aOutlineBuffer,
+                                                    ZONE_OBSTACLE_INDEX* aObstacles )
 {
     /* convert outlines + holes to outlines without holes (adding extra segments if necessary)
      * m_Poly data is expected normalized, i.e. NormalizeAreaOutlines was used after building
@@ -66,31 +88,8 @@ bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET*
         return false;
 
     // Make a smoothed polygon out of the user-drawn polygon if required
-    if( m_smoothedPoly )
-    {
-        delete m_smoothedPoly;
-        m_smoothedPoly = NULL;
-    }
-
-    switch( m_cornerSmoothingType )
-    {
-    case ZONE_SETTINGS::SMOOTHING_CHAMFER:
-        m_smoothedPoly = m_Poly->Chamfer( m_cornerRadius );
-        break;
-
-    case ZONE_SETTINGS::SMOOTHING_FILLET:
-        m_smoothedPoly = m_Poly->Fillet( m_cornerRadius, m_ArcToSegmentsCount );
-        break;
-
-    default:
-        // Acute angles between adjacent edges can create issues in calculations,
-        // in inflate/deflate outlines transforms, especially when the angle is very small.
-        // We can avoid issues by creating a very small chamfer which remove acute angles,
-        // or left it without chamfer and use only CPOLYGONS_LIST::InflateOutline to create
-        // clearance areas
-        m_smoothedPoly = m_Poly->Chamfer( Millimeter2iu( 0.0 ) );
-        break;
-    }
+    delete m_smoothedPoly;
+    m_smoothedPoly = BuildSmoothedPoly();
 
     if( aOutlineBuffer )
         aOutlineBuffer->Append( ConvertPolyListToPolySet( m_smoothedPoly->m_CornersList ) );
@@ -106,7 +105,7 @@ bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET*
 
         if( IsOnCopperLayer() )
         {
-            AddClearanceAreasPolygonsToPolysList_NG( aPcb );
+            AddClearanceAreasPolygonsToPolysList_NG( aPcb, aObstacles );
 
             if( m_FillMode )   // if fill mode uses segments, create them:
             {
@@ -0,0 +1,235 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file zone_obstacle_index.cpp
+ */
+
+#include <fctsys.h>
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_pad.h>
+#include <class_edge_mod.h>
+
+#include <zone_obstacle_index.h>
+
+
+/**
+ * Helper visitor for INDEX_TREE searches: collects the ordinals of the items found.
+ */
+struct ZONE_OBSTACLE_COLLECTOR
+{
+    ZONE_OBSTACLE_COLLECTOR( std::vector<int>& aResult ) :
+        m_result( aResult )
+    {
+    }
+
+    bool operator()( int aIndex )
+    {
+        m_result.push_back( aIndex );
+        return true;
+    }
+
+    std::vector<int>& m_result;
+};
+
+
+bool ZONE_OBSTACLE_INDEX::POLYGON_KEY::operator<( const POLYGON_KEY& aOther ) const
+{
+    if( m_item != aOther.m_item )
+        return m_item < aOther.m_item;
+
+    if( m_holeOnly != aOther.m_holeOnly )
+        return m_holeOnly < aOther.m_holeOnly;
+
+    if( m_clearance != aOther.m_clearance )
+        return m_clearance < aOther.m_clearance;
+
+    return m_segsPerCircle < aOther.m_segsPerCircle;
+}
+
+
+ZONE_OBSTACLE_INDEX::ZONE_OBSTACLE_INDEX( BOARD* aBoard )
+{
+    m_maxInflation = aBoard->GetDesignSettings().GetBiggestClearanceValue();
+
+    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+            m_pads.push_back( pad );
+
+        for( BOARD_ITEM* item = module->GraphicalItems(); item; item = item->Next() )
+        {
+            if( item->Type() == PCB_MODULE_EDGE_T )
+                m_moduleEdges.push_back( static_cast<EDGE_MODULE*>( item ) );
+        }
+    }
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+        m_tracks.push_back( track );
+
+    int index = 0;
+    LSET allCu = LSET::AllCuMask();
+
+    for( unsigned ii = 0; ii < m_pads.size(); ++ii, ++index )
+    {
+        D_PAD*   pad = m_pads[ii];
+        EDA_RECT area = pad->GetBoundingBox();
+        LSET     layers = pad->GetLayerSet() & allCu;
+
+        m_maxInflation = std::max( m_maxInflation, pad->GetClearance() );
+        m_maxInflation = std::max( m_maxInflation, pad->GetThermalGap() );
+
+        // The hole of a pad is a hole in the zones of every copper layer
+        if( pad->GetDrillSize().x || pad->GetDrillSize().y )
+        {
+            int      radius = std::max( pad->GetDrillSize().x, pad->GetDrillSize().y ) / 2;
+            EDA_RECT hole( pad->GetPosition(), wxSize( 0, 0 ) );
+
+            hole.Inflate( radius );
+            area.Merge( hole );
+            layers = allCu;
+        }
+
+        for( LSEQ cu = layers.CuStack(); cu; ++cu )
+            insert( *cu, area, index );
+    }
+
+    for( unsigned ii = 0; ii < m_tracks.size(); ++ii, ++index )
+    {
+        TRACK* track = m_tracks[ii];
+
+        for( LSEQ cu = track->GetLayerSet().CuStack(); cu; ++cu )
+            insert( *cu, track->GetBoundingBox(), index );
+    }
+
+    for( unsigned ii = 0; ii < m_moduleEdges.size(); ++ii, ++index )
+    {
+        EDGE_MODULE* edge = m_moduleEdges[ii];
+
+        // Board edges are holes in the zones of every copper layer
+        LSET layers = edge->GetLayer() == Edge_Cuts ? allCu : ( edge->GetLayerSet() & allCu );
+
+        for( LSEQ cu = layers.CuStack(); cu; ++cu )
+            insert( *cu, edge->GetBoundingBox(), index );
+    }
+}
+
+
+void ZONE_OBSTACLE_INDEX::Query( LAYER_ID aLayer, const EDA_RECT& aArea,
+                                 std::vector<D_PAD*>& aPads, std::vector<TRACK*>& aTracks,
+                                 std::vector<EDGE_MODULE*>& aModuleEdges ) const
+{
+    aPads.clear();
+    aTracks.clear();
+    aModuleEdges.clear();
+
+    if( !IsCopperLayer( aLayer ) )
+        return;
+
+    EDA_RECT  area = aArea;
+    area.Normalize();
+
+    const int mmin[2] = { area.GetX(), area.GetY() };
+    const int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+    std::vector<int>        found;
+    ZONE_OBSTACLE_COLLECTOR collector( found );
+
+    m_trees[aLayer].Search( mmin, mmax, collector );
+
+    std::sort( found.begin(), found.end() );
+
+    const int trackBase = m_pads.size();
+    const int edgeBase  = trackBase + m_tracks.size();
+
+    for( unsigned ii = 0; ii < found.size(); ++ii )
+    {
+        int index = found[ii];
+
+        if( index < trackBase )
+            aPads.push_back( m_pads[index] );
+        else if( index < edgeBase )
+            aTracks.push_back( m_tracks[index - trackBase] );
+        else
+            aModuleEdges.push_back( m_moduleEdges[index - edgeBase] );
+    }
+}
+
+
+bool ZONE_OBSTACLE_INDEX::GetCachedPolygon( const BOARD_ITEM* aItem, bool aHoleOnly,
+                                            int aClearance, int aSegsPerCircle,
+                                            SHAPE_POLY_SET& aBuffer ) const
+{
+    POLYGON_KEY key = { aItem, aHoleOnly, aClearance, aSegsPerCircle };
+    std::shared_ptr<const SHAPE_POLY_SET> polygon;
+
+#ifdef USE_OPENMP
+    #pragma omp critical(zoneObstacleCache)
+#endif
+    {
+        POLYGON_CACHE::const_iterator it = m_polygons.find( key );
+
+        if( it != m_polygons.end() )
+            polygon = it->second;
+    }
+
+    if( !polygon )
+        return false;
+
+    aBuffer.Append( *polygon );
+
+    return true;
+}
+
+
+void ZONE_OBSTACLE_INDEX::CachePolygon( const BOARD_ITEM* aItem, bool aHoleOnly,
+                                        int aClearance, int aSegsPerCircle,
+                                        const SHAPE_POLY_SET& aPolygon )
+{
+    POLYGON_KEY key = { aItem, aHoleOnly, aClearance, aSegsPerCircle };
+    std::shared_ptr<const SHAPE_POLY_SET> polygon( new SHAPE_POLY_SET( aPolygon ) );
+
+#ifdef USE_OPENMP
+    #pragma omp critical(zoneObstacleCache)
+#endif
+    {
+        // Another thread can have stored the same polygon meanwhile: keep the first one
+        m_polygons.insert( std::make_pair( key, polygon ) );
+    }
+}
+
+
+void ZONE_OBSTACLE_INDEX::insert( LAYER_ID aLayer, const EDA_RECT& aArea, int aIndex )
+{
+    EDA_RECT  area = aArea;
+    area.Normalize();
+
+    const int mmin[2] = { area.GetX(), area.GetY() };
+    const int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+    m_trees[aLayer].Insert( mmin, mmax, aIndex );
+}
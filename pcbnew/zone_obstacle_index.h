@@ -0,0 +1,140 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file zone_obstacle_index.h
+ * @brief Index of the board items which can cut the filled areas of copper zones.
+ */
+
+#ifndef ZONE_OBSTACLE_INDEX_H
+#define ZONE_OBSTACLE_INDEX_H
+
+#include <vector>
+#include <map>
+#include <memory>
+
+#include <class_eda_rect.h>
+#include <layers_id_colors_and_visibility.h>
+#include <geometry/rtree.h>
+#include <geometry/shape_poly_set.h>
+
+class BOARD;
+class BOARD_ITEM;
+class D_PAD;
+class TRACK;
+class EDGE_MODULE;
+
+
+/**
+ * Class ZONE_OBSTACLE_INDEX
+ * holds, for each copper layer, an R-tree of the pads, tracks, vias and footprint
+ * graphic items which can create holes in the zones of this layer, and a cache of
+ * the clearance polygons of these items.
+ *
+ * It is built once by BuildZonesFilledAreas() and shared by all the zones filled
+ * in the same pass, so each zone only examines the items near it, and the clearance
+ * polygon of an item shared by several zones (with the same clearance) is only
+ * built once.  The queries and the cache can be used from several threads.
+ *
+ * The index is a snapshot: the board must not be modified while it is used.
+ */
+class ZONE_OBSTACLE_INDEX
+{
+public:
+    ZONE_OBSTACLE_INDEX( BOARD* aBoard );
+
+    /**
+     * Function GetMaxInflation
+     * @return the biggest clearance or thermal gap used by a pad of the board, or
+     * by a netclass.  Query() areas must be inflated by this amount (plus the zone's
+     * own clearance settings) to find every item a zone can have to avoid.
+     */
+    int GetMaxInflation() const     { return m_maxInflation; }
+
+    /**
+     * Function Query
+     * collects the items of aLayer whose area intersects aArea, in the order of the
+     * board lists (so holes are built in the same order as by a full scan).
+     * Pads with a hole are found on all the copper layers.  Footprint graphic items
+     * on the Edge_Cuts layer are found on all the copper layers.
+     * @param aLayer is the copper layer to search.
+     * @param aArea is the search area.
+     * @param aPads, aTracks, aModuleEdges receive the items found.
+     */
+    void Query( LAYER_ID aLayer, const EDA_RECT& aArea, std::vector<D_PAD*>& aPads,
+                std::vector<TRACK*>& aTracks, std::vector<EDGE_MODULE*>& aModuleEdges ) const;
+
+    /**
+     * Function GetCachedPolygon
+     * appends to aBuffer the clearance polygon of aItem, if it is in the cache.
+     * @param aItem is the item.
+     * @param aHoleOnly is true for the polygon of the hole of a pad.
+     * @param aClearance is the clearance used to build the polygon.
+     * @param aSegsPerCircle is the number of segments used to approximate circles.
+     * @return true if the polygon was found, false if it must be built.
+     */
+    bool GetCachedPolygon( const BOARD_ITEM* aItem, bool aHoleOnly, int aClearance,
+                           int aSegsPerCircle, SHAPE_POLY_SET& aBuffer ) const;
+
+    /**
+     * Function CachePolygon
+     * stores the clearance polygon of aItem, for the next GetCachedPolygon() calls.
+     * The parameters are the same as the GetCachedPolygon() ones.
+     */
+    void CachePolygon( const BOARD_ITEM* aItem, bool aHoleOnly, int aClearance,
+                       int aSegsPerCircle, const SHAPE_POLY_SET& aPolygon );
+
+private:
+    typedef RTree<int, int, 2, float> INDEX_TREE;
+
+    struct POLYGON_KEY
+    {
+        const BOARD_ITEM*   m_item;
+        bool                m_holeOnly;
+        int                 m_clearance;
+        int                 m_segsPerCircle;
+
+        bool operator<( const POLYGON_KEY& aOther ) const;
+    };
+
+    typedef std::map< POLYGON_KEY, std::shared_ptr<const SHAPE_POLY_SET> > POLYGON_CACHE;
+
+    /// Copying the trees is not supported
+    ZONE_OBSTACLE_INDEX( const ZONE_OBSTACLE_INDEX& );
+    ZONE_OBSTACLE_INDEX& operator=( const ZONE_OBSTACLE_INDEX& );
+
+    void insert( LAYER_ID aLayer, const EDA_RECT& aArea, int aIndex );
+
+    // Items are referenced by an ordinal: pads first, then tracks, then footprint edges
+    std::vector<D_PAD*>         m_pads;
+    std::vector<TRACK*>         m_tracks;
+    std::vector<EDGE_MODULE*>   m_moduleEdges;
+
+    mutable INDEX_TREE          m_trees[MAX_CU_LAYERS];     ///< RTree::Search() is not const
+
+    int                         m_maxInflation;
+
+    POLYGON_CACHE               m_polygons;
+};
+
+#endif // ZONE_OBSTACLE_INDEX_H
@@ -25,6 +25,8 @@
 #ifndef ZONES_H_
 #define ZONES_H_
 
+#include <vector>
+
 // keys used to store net sort option in config file :
 #define ZONE_NET_OUTLINES_HATCH_OPTION_KEY          wxT( "Zone_Ouline_Hatch_Opt" )
 #define ZONE_NET_SORT_OPTION_KEY                    wxT( "Zone_NetSort_Opt" )
@@ -63,6 +65,25 @@ enum ZoneConnection {
 class ZONE_CONTAINER;
 class ZONE_SETTINGS;
 class PCB_BASE_FRAME;
+class BOARD;
+class ZONE_OBSTACLE_INDEX;
+
+/**
+ * Function BuildZonesFilledAreas
+ * computes the filled areas of a set of zones, on several threads when OpenMP is enabled.
+ * Each zone only reads the board and writes its own filled areas, so the zones can
+ * be filled in any order.  The view and the ratsnest are not updated: this is the
+ * job of the caller, which should run on the main thread.
+ *
+ * @param aPcb is the board owning the zones.
+ * @param aZones is the list of zones to fill.  Keepout areas are only unfilled.
+ * @param aObstacles is the index of the items which cut the zones, built from aPcb,
+ * or NULL to build a temporary one.  Passing the same index to several calls lets
+ * them share its cached clearance polygons, as long as the board is not modified.
+ * @return the number of zones which could not be filled (0 = no error).
+ */
+int BuildZonesFilledAreas( BOARD* aPcb, const std::vector<ZONE_CONTAINER*>& aZones,
+                           ZONE_OBSTACLE_INDEX* aObstacles = NULL );
 
 /**
  * Function InvokeNonCopperZonesEditor
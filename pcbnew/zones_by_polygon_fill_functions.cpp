@@ -26,6 +26,9 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <algorithm>
+#include <memory>
+
 #include <wx/progdlg.h>
 
 #include <fctsys.h>
@@ -37,8 +40,10 @@
 #include <macros.h>
 
 #include <class_board.h>
+#include <class_module.h>
 #include <class_track.h>
 #include <class_zone.h>
+#include <zone_obstacle_index.h>
 
 #include <pcbnew.h>
 #include <zones.h>
@@ -124,8 +129,53 @@ int PCB_EDIT_FRAME::Fill_Zone( ZONE_CONTAINER* aZone )
 }
 
 
+int BuildZonesFilledAreas( BOARD* aPcb, const std::vector<ZONE_CONTAINER*>& aZones,
+                           ZONE_OBSTACLE_INDEX* aObstacles )
+{
+    // The pads cache their bounding radius: compute it now, not in the threads
+    for( MODULE* module = aPcb->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+            pad->GetBoundingRadius();
+    }
+
+    std::unique_ptr<ZONE_OBSTACLE_INDEX> localObstacles;
+
+    if( !aObstacles )
+    {
+        localObstacles.reset( new ZONE_OBSTACLE_INDEX( aPcb ) );
+        aObstacles = localObstacles.get();
+    }
+
+    int count = aZones.size();
+    int errors = 0;
+    int ii;
+
+#ifdef USE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 1) private(ii) reduction(+:errors)
+#endif
+    for( ii = 0; ii < count; ++ii )
+    {
+        ZONE_CONTAINER* zone = aZones[ii];
+
+        zone->ClearFilledPolysList();
+        zone->UnFill();
+
+        // Cannot fill keepout zones:
+        if( !zone->GetIsKeepout()
+            && !zone->BuildFilledSolidAreasPolygons( aPcb, NULL, aObstacles ) )
+            ++errors;
+    }
+
+    return errors;
+}
+
+
 int PCB_EDIT_FRAME::Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose )
 {
+    // Number of zones filled between two updates of the progress bar
+    const unsigned ZONES_BY_STEP = 16;
+
     int errorLevel = 0;
     int areaCount = GetBoard()->GetAreaCount();
     wxBusyCursor dummyCursor;
@@ -148,31 +198,58 @@ int PCB_EDIT_FRAME::Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose )
     // Remove segment zones
     GetBoard()->m_Zone.DeleteAll();
 
-    int ii;
+    std::vector<ZONE_CONTAINER*> zones;
 
-    for( ii = 0; ii < areaCount; ii++ )
+    for( int ii = 0; ii < areaCount; ii++ )
     {
         ZONE_CONTAINER* zoneContainer = GetBoard()->GetArea( ii );
-        if( zoneContainer->GetIsKeepout() )
-            continue;
 
-        msg.Printf( FORMAT_STRING, ii + 1, areaCount, GetChars( zoneContainer->GetNetname() ) );
+        if( !zoneContainer->GetIsKeepout() )
+            zones.push_back( zoneContainer );
+    }
+
+    // The zones are filled in parallel, by blocks, so the progress bar can be updated
+    // (from the main thread) and the fill aborted between two blocks.
+    // Filling a zone does not modify the items which cut the zones, so all the blocks
+    // share the same obstacle index.
+    ZONE_OBSTACLE_INDEX obstacles( GetBoard() );
+    unsigned filled = 0;
+
+    while( filled < zones.size() )
+    {
+        unsigned last = std::min( filled + ZONES_BY_STEP, (unsigned) zones.size() );
+
+        msg.Printf( FORMAT_STRING, filled + 1, (int) zones.size(),
+                    GetChars( zones[filled]->GetNetname() ) );
 
         if( progressDialog )
         {
-            if( !progressDialog->Update( ii+1, msg ) )
+            if( !progressDialog->Update( filled + 1, msg ) )
                 break;  // Aborted by user
         }
 
-        errorLevel = Fill_Zone( zoneContainer );
+        std::vector<ZONE_CONTAINER*> block( zones.begin() + filled, zones.begin() + last );
+
+        errorLevel = BuildZonesFilledAreas( GetBoard(), block, &obstacles );
+
+        for( unsigned ii = 0; ii < block.size(); ii++ )
+        {
+            block[ii]->ViewUpdate( KIGFX::VIEW_ITEM::ALL );
+            GetBoard()->GetRatsnest()->Update( block[ii] );
+        }
+
+        filled = last;
 
         if( errorLevel && !aVerbose )
             break;
     }
 
+    if( filled )
+        OnModify();
+
     if( progressDialog )
     {
-        progressDialog->Update( ii+2, _( "Updating ratsnest..." ) );
+        progressDialog->Update( areaCount+2, _( "Updating ratsnest..." ) );
 #ifdef __WXMAC__
         // Work around a dialog z-order issue on OS X
         aActiveWindow->Raise();
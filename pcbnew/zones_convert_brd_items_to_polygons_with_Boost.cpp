@@ -48,6 +48,7 @@
 
 #include <cmath>
 #include <sstream>
+#include <vector>
 
 #include <fctsys.h>
 #include <wxPcbStruct.h>
@@ -60,6 +61,7 @@
 #include <class_drawsegment.h>
 #include <class_pcb_text.h>
 #include <class_zone.h>
+#include <zone_obstacle_index.h>
 #include <project.h>
 
 #include <pcbnew.h>
@@ -95,7 +97,66 @@ extern void CreateThermalReliefPadPolygon( SHAPE_POLY_SET&       aCornerBuffer,
 // Local Variables:
 static double s_thermalRot = 450;  // angle of stubs in thermal reliefs for round pads
 
-void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeatures )
+
+/**
+ * Helper function addItemHole
+ * appends the clearance polygon of aItem to aFeatures, using the polygon cache of
+ * aObstacles (when not NULL), and records it in aFillData (when not NULL).
+ * @param aKey is the item the polygon is cached for (aItem itself, or the pad
+ * a dummy hole pad is built from).
+ * @param aHoleOnly is true when aItem is the dummy pad of a hole.
+ */
+template <class T>
+static void addItemHole( ZONE_OBSTACLE_INDEX* aObstacles, ZONE_FILL_CACHE* aFillData,
+                         const T* aItem, const BOARD_ITEM* aKey, bool aHoleOnly,
+                         SHAPE_POLY_SET& aFeatures, int aClearance, int aSegsPerCircle,
+                         double aCorrectionFactor )
+{
+    int first = aFeatures.OutlineCount();
+
+    if( !aObstacles )
+    {
+        aItem->TransformShapeWithClearanceToPolygon( aFeatures, aClearance,
+                                                     aSegsPerCircle, aCorrectionFactor );
+    }
+    else if( !aObstacles->GetCachedPolygon( aKey, aHoleOnly, aClearance, aSegsPerCircle,
+                                            aFeatures ) )
+    {
+        SHAPE_POLY_SET polygon;
+
+        aItem->TransformShapeWithClearanceToPolygon( polygon, aClearance,
+                                                     aSegsPerCircle, aCorrectionFactor );
+        aObstacles->CachePolygon( aKey, aHoleOnly, aClearance, aSegsPerCircle, polygon );
+        aFeatures.Append( polygon );
+    }
+
+    if( aFillData )
+        aFillData->AddFeature( aKey, ZONE_FILL_CACHE::FEATURE_CLEARANCE, aFeatures, first );
+}
+
+
+void ZONE_FILL_CACHE::AddFeature( const BOARD_ITEM* aItem, FEATURE_KIND aKind,
+                                  const SHAPE_POLY_SET& aFeatures, int aFirst )
+{
+    if( aFirst >= aFeatures.OutlineCount() )
+        return;     // the item does not cut the zone
+
+    SHAPE_POLY_SET& feature = m_features[ FEATURE_KEY( aItem, aKind ) ];
+
+    for( int ii = aFirst; ii < aFeatures.OutlineCount(); ii++ )
+    {
+        const SHAPE_POLY_SET::POLYGON& polygon = aFeatures.CPolygon( ii );
+        int outline = feature.AddOutline( polygon[0] );
+
+        for( unsigned jj = 1; jj < polygon.size(); jj++ )
+            feature.AddHole( polygon[jj], outline );
+    }
+}
+
+
+void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeatures,
+                                           ZONE_OBSTACLE_INDEX* aObstacles,
+                                           ZONE_FILL_CACHE* aFillData )
 {
     int segsPerCircle;
     double correctionFactor;
@@ -133,6 +194,44 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
     biggest_clearance = std::max( biggest_clearance, zone_clearance );
     zone_boundingbox.Inflate( biggest_clearance );
 
+    /* Gather the pads, tracks and footprint edges to examine, in the board lists order.
+     * With an obstacle index, only the items close to the zone are examined: an item
+     * can only cut the zone if its bounding box, inflated by its clearance or thermal
+     * gap, intersects zone_boundingbox.
+     */
+    std::vector<D_PAD*>         pads;
+    std::vector<TRACK*>         tracks;
+    std::vector<EDGE_MODULE*>   moduleEdges;
+
+    if( aObstacles )
+    {
+        int margin = aObstacles->GetMaxInflation() + outline_half_thickness;
+        margin = std::max( margin, zone_clearance );
+        margin = std::max( margin, m_ThermalReliefGap );
+
+        EDA_RECT searchArea = zone_boundingbox;
+        searchArea.Inflate( margin + 1 );
+
+        aObstacles->Query( GetLayer(), searchArea, pads, tracks, moduleEdges );
+    }
+    else
+    {
+        for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
+        {
+            for( D_PAD* pad = module->Pads(); pad != NULL; pad = pad->Next() )
+                pads.push_back( pad );
+
+            for( BOARD_ITEM* item = module->GraphicalItems();  item;  item = item->Next() )
+            {
+                if( item->Type() == PCB_MODULE_EDGE_T )
+                    moduleEdges.push_back( (EDGE_MODULE*) item );
+            }
+        }
+
+        for( TRACK* track = aPcb->m_Track;  track;  track = track->Next() )
+            tracks.push_back( track );
+    }
+
     /*
      * First : Add pads. Note: pads having the same net as zone are left in zone.
      * Thermal shapes will be created later if necessary
@@ -149,71 +248,64 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
     MODULE dummymodule( aPcb );    // Creates a dummy parent
     D_PAD dummypad( &dummymodule );
 
-    for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
+    for( unsigned ii = 0; ii < pads.size(); ii++ )
     {
-        D_PAD* nextpad;
+        D_PAD* boardPad = pads[ii];
+        D_PAD* pad = boardPad;
 
-        for( D_PAD* pad = module->Pads(); pad != NULL; pad = nextpad )
+        if( !pad->IsOnLayer( GetLayer() ) )
         {
-            nextpad = pad->Next();  // pad pointer can be modified by next code, so
-                                    // calculate the next pad here
+            /* Test for pads that are on top or bottom only and have a hole.
+             * There are curious pads but they can be used for some components that are
+             * inside the board (in fact inside the hole. Some photo diodes and Leds are
+             * like this)
+             */
+            if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
+                continue;
+
+            // Use a dummy pad to calculate a hole shape that have the same dimension as
+            // the pad hole
+            dummypad.SetSize( pad->GetDrillSize() );
+            dummypad.SetOrientation( pad->GetOrientation() );
+            dummypad.SetShape( pad->GetDrillShape() == PAD_DRILL_SHAPE_OBLONG ?
+                               PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
+            dummypad.SetPosition( pad->GetPosition() );
 
-            if( !pad->IsOnLayer( GetLayer() ) )
+            pad = &dummypad;
+        }
+
+        bool holeOnly = pad != boardPad;
+
+        // Note: netcode <=0 means not connected item
+        if( ( pad->GetNetCode() != GetNetCode() ) || ( pad->GetNetCode() <= 0 ) )
+        {
+            item_clearance   = pad->GetClearance() + outline_half_thickness;
+            item_boundingbox = pad->GetBoundingBox();
+            item_boundingbox.Inflate( item_clearance );
+
+            if( item_boundingbox.Intersects( zone_boundingbox ) )
             {
-                /* Test for pads that are on top or bottom only and have a hole.
-                 * There are curious pads but they can be used for some components that are
-                 * inside the board (in fact inside the hole. Some photo diodes and Leds are
-                 * like this)
-                 */
-                if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
-                    continue;
-
-                // Use a dummy pad to calculate a hole shape that have the same dimension as
-                // the pad hole
-                dummypad.SetSize( pad->GetDrillSize() );
-                dummypad.SetOrientation( pad->GetOrientation() );
-                dummypad.SetShape( pad->GetDrillShape() == PAD_DRILL_SHAPE_OBLONG ?
-                                   PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
-                dummypad.SetPosition( pad->GetPosition() );
-
-                pad = &dummypad;
+                int clearance = std::max( zone_clearance, item_clearance );
+                addItemHole( aObstacles, aFillData, pad, boardPad, holeOnly, aFeatures,
+                             clearance, segsPerCircle, correctionFactor );
             }
 
-            // Note: netcode <=0 means not connected item
-            if( ( pad->GetNetCode() != GetNetCode() ) || ( pad->GetNetCode() <= 0 ) )
-            {
-                item_clearance   = pad->GetClearance() + outline_half_thickness;
-                item_boundingbox = pad->GetBoundingBox();
-                item_boundingbox.Inflate( item_clearance );
-
-                if( item_boundingbox.Intersects( zone_boundingbox ) )
-                {
-                    int clearance = std::max( zone_clearance, item_clearance );
-                    pad->TransformShapeWithClearanceToPolygon( aFeatures,
-                                                               clearance,
-                                                               segsPerCircle,
-                                                               correctionFactor );
-                }
+            continue;
+        }
 
-                continue;
-            }
+        // Pads are removed from zone if the setup is PAD_ZONE_CONN_NONE
+        if( GetPadConnection( pad ) == PAD_ZONE_CONN_NONE )
+        {
+            int gap = zone_clearance;
+            int thermalGap = GetThermalReliefGap( pad );
+            gap = std::max( gap, thermalGap );
+            item_boundingbox = pad->GetBoundingBox();
+            item_boundingbox.Inflate( gap );
 
-            // Pads are removed from zone if the setup is PAD_ZONE_CONN_NONE
-            if( GetPadConnection( pad ) == PAD_ZONE_CONN_NONE )
+            if( item_boundingbox.Intersects( zone_boundingbox ) )
             {
-                int gap = zone_clearance;
-                int thermalGap = GetThermalReliefGap( pad );
-                gap = std::max( gap, thermalGap );
-                item_boundingbox = pad->GetBoundingBox();
-                item_boundingbox.Inflate( gap );
-
-                if( item_boundingbox.Intersects( zone_boundingbox ) )
-                {
-                    pad->TransformShapeWithClearanceToPolygon( aFeatures,
-                                                               gap,
-                                                               segsPerCircle,
-                                                               correctionFactor );
-                }
+                addItemHole( aObstacles, aFillData, pad, boardPad, holeOnly, aFeatures,
+                             gap, segsPerCircle, correctionFactor );
             }
         }
     }
@@ -221,8 +313,10 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
     /* Add holes (i.e. tracks and vias areas as polygons outlines)
      * in cornerBufferPolysToSubstract
      */
-    for( TRACK* track = aPcb->m_Track;  track;  track = track->Next() )
+    for( unsigned ii = 0; ii < tracks.size(); ii++ )
     {
+        TRACK* track = tracks[ii];
+
         if( !track->IsOnLayer( GetLayer() ) )
             continue;
 
@@ -235,10 +329,8 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
         if( item_boundingbox.Intersects( zone_boundingbox ) )
         {
             int clearance = std::max( zone_clearance, item_clearance );
-            track->TransformShapeWithClearanceToPolygon( aFeatures,
-                                                         clearance,
-                                                         segsPerCircle,
-                                                         correctionFactor );
+            addItemHole( aObstacles, aFillData, track, track, false, aFeatures,
+                         clearance, segsPerCircle, correctionFactor );
         }
     }
 
@@ -246,24 +338,19 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
      * Pcbnew allows these items to be on copper layers in microwave applictions
      * This is a bad thing, but must be handled here, until a better way is found
      */
-    for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
+    for( unsigned ii = 0; ii < moduleEdges.size(); ii++ )
     {
-        for( BOARD_ITEM* item = module->GraphicalItems();  item;  item = item->Next() )
-        {
-            if( !item->IsOnLayer( GetLayer() ) && !item->IsOnLayer( Edge_Cuts ) )
-                continue;
+        EDGE_MODULE* item = moduleEdges[ii];
 
-            if( item->Type() != PCB_MODULE_EDGE_T )
-                continue;
+        if( !item->IsOnLayer( GetLayer() ) && !item->IsOnLayer( Edge_Cuts ) )
+            continue;
 
-            item_boundingbox = item->GetBoundingBox();
+        item_boundingbox = item->GetBoundingBox();
 
-            if( item_boundingbox.Intersects( zone_boundingbox ) )
-            {
-                ( (EDGE_MODULE*) item )->TransformShapeWithClearanceToPolygon(
-                    aFeatures, zone_clearance,
-                    segsPerCircle, correctionFactor );
-            }
+        if( item_boundingbox.Intersects( zone_boundingbox ) )
+        {
+            addItemHole( aObstacles, aFillData, item, item, false, aFeatures,
+                         zone_clearance, segsPerCircle, correctionFactor );
         }
     }
 
@@ -273,6 +360,8 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
         if( item->GetLayer() != GetLayer() && item->GetLayer() != Edge_Cuts )
             continue;
 
+        int first = aFeatures.OutlineCount();
+
         switch( item->Type() )
         {
         case PCB_LINE_T:
@@ -289,6 +378,9 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
         default:
             break;
         }
+
+        if( aFillData )
+            aFillData->AddFeature( item, ZONE_FILL_CACHE::FEATURE_CLEARANCE, aFeatures, first );
     }
 
     // Add zones outlines having an higher priority and keepout
@@ -333,46 +425,202 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
             use_net_clearance = false;
         }
 
+        int first = aFeatures.OutlineCount();
+
         zone->TransformOutlinesShapeWithClearanceToPolygon(
                     aFeatures,
                     min_clearance, use_net_clearance );
+
+        if( aFillData )
+            aFillData->AddFeature( zone, ZONE_FILL_CACHE::FEATURE_CLEARANCE, aFeatures, first );
     }
 
    // Remove thermal symbols
-    for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
+    for( unsigned ii = 0; ii < pads.size(); ii++ )
     {
-        for( D_PAD* pad = module->Pads(); pad != NULL; pad = pad->Next() )
+        D_PAD* pad = pads[ii];
+
+        // Rejects non-standard pads with tht-only thermal reliefs
+        if( GetPadConnection( pad ) == PAD_ZONE_CONN_THT_THERMAL
+         && pad->GetAttribute() != PAD_ATTRIB_STANDARD )
+            continue;
+
+        if( GetPadConnection( pad ) != PAD_ZONE_CONN_THERMAL
+         && GetPadConnection( pad ) != PAD_ZONE_CONN_THT_THERMAL )
+            continue;
+
+        if( !pad->IsOnLayer( GetLayer() ) )
+            continue;
+
+        if( pad->GetNetCode() != GetNetCode() )
+            continue;
+        item_boundingbox = pad->GetBoundingBox();
+        int thermalGap = GetThermalReliefGap( pad );
+        item_boundingbox.Inflate( thermalGap, thermalGap );
+
+        if( item_boundingbox.Intersects( zone_boundingbox ) )
         {
-            // Rejects non-standard pads with tht-only thermal reliefs
-            if( GetPadConnection( pad ) == PAD_ZONE_CONN_THT_THERMAL
-             && pad->GetAttribute() != PAD_ATTRIB_STANDARD )
-                continue;
+            int first = aFeatures.OutlineCount();
 
-            if( GetPadConnection( pad ) != PAD_ZONE_CONN_THERMAL
-             && GetPadConnection( pad ) != PAD_ZONE_CONN_THT_THERMAL )
-                continue;
+            CreateThermalReliefPadPolygon( aFeatures,
+                                           *pad, thermalGap,
+                                           GetThermalReliefCopperBridge( pad ),
+                                           m_ZoneMinThickness,
+                                           segsPerCircle,
+                                           correctionFactor, s_thermalRot );
 
-            if( !pad->IsOnLayer( GetLayer() ) )
-                continue;
+            if( aFillData )
+                aFillData->AddFeature( pad, ZONE_FILL_CACHE::FEATURE_THERMAL, aFeatures, first );
+        }
+    }
 
-            if( pad->GetNetCode() != GetNetCode() )
-                continue;
-            item_boundingbox = pad->GetBoundingBox();
-            int thermalGap = GetThermalReliefGap( pad );
-            item_boundingbox.Inflate( thermalGap, thermalGap );
+}
 
-            if( item_boundingbox.Intersects( zone_boundingbox ) )
+
+/**
+ * Helper function samePolygons
+ * @return true if aFirst and aSecond have exactly the same polygons, in the same order.
+ */
+static bool samePolygons( const SHAPE_POLY_SET& aFirst, const SHAPE_POLY_SET& aSecond )
+{
+    if( aFirst.OutlineCount() != aSecond.OutlineCount() )
+        return false;
+
+    for( int ii = 0; ii < aFirst.OutlineCount(); ii++ )
+    {
+        const SHAPE_POLY_SET::POLYGON& first  = aFirst.CPolygon( ii );
+        const SHAPE_POLY_SET::POLYGON& second = aSecond.CPolygon( ii );
+
+        if( first.size() != second.size() )
+            return false;
+
+        for( unsigned jj = 0; jj < first.size(); jj++ )
+        {
+            if( first[jj].PointCount() != second[jj].PointCount() )
+                return false;
+
+            for( int kk = 0; kk < first[jj].PointCount(); kk++ )
+            {
+                if( first[jj].CPoint( kk ) != second[jj].CPoint( kk ) )
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * Helper function refillChangedAreas
+ * rebuilds the solid areas minus the holes of a zone from the ones of its previous
+ * fill, when the zone outline has not changed.  Only the areas covered by the holes
+ * which have been added, removed or modified since the previous fill are recomputed:
+ * everywhere else, the previous result is still valid.
+ * @param aPrevious is the data of the previous fill.
+ * @param aCurrent is the data of this fill (outline and holes).
+ * @param aRawFill receives the solid areas minus the holes.
+ * @return false if too much of the zone has changed, and a full fill is faster.
+ */
+static bool refillChangedAreas( const ZONE_FILL_CACHE& aPrevious,
+                                const ZONE_FILL_CACHE& aCurrent, SHAPE_POLY_SET& aRawFill )
+{
+    typedef ZONE_FILL_CACHE::FEATURE_MAP::const_iterator FEATURE_ITER;
+
+    // Above this ratio of changed area to zone area, the zone is filled from scratch
+    const double maxChangedRatio = 0.25;
+
+    const ZONE_FILL_CACHE::FEATURE_MAP& previous = aPrevious.m_features;
+    const ZONE_FILL_CACHE::FEATURE_MAP& current  = aCurrent.m_features;
+
+    // Both maps are sorted by item: walk them together to find the holes which
+    // have appeared, disappeared or changed
+    std::vector<BOX2I> changedAreas;
+    FEATURE_ITER prev = previous.begin();
+    FEATURE_ITER curr = current.begin();
+
+    while( prev != previous.end() || curr != current.end() )
+    {
+        if( curr == current.end() || ( prev != previous.end() && prev->first < curr->first ) )
+        {
+            changedAreas.push_back( prev->second.BBox() );
+            ++prev;
+        }
+        else if( prev == previous.end() || curr->first < prev->first )
+        {
+            changedAreas.push_back( curr->second.BBox() );
+            ++curr;
+        }
+        else
+        {
+            if( !samePolygons( prev->second, curr->second ) )
+            {
+                changedAreas.push_back( prev->second.BBox() );
+                changedAreas.push_back( curr->second.BBox() );
+            }
+
+            ++prev;
+            ++curr;
+        }
+    }
+
+    if( changedAreas.empty() )
+    {
+        aRawFill = aPrevious.m_rawFill;
+        return true;
+    }
+
+    BOX2I  zoneArea = aCurrent.m_solidAreas.BBox();
+    double changedArea = 0.0;
+
+    for( unsigned ii = 0; ii < changedAreas.size(); ii++ )
+        changedArea += (double) changedAreas[ii].GetWidth() * changedAreas[ii].GetHeight();
+
+    if( changedArea > maxChangedRatio * (double) zoneArea.GetWidth() * zoneArea.GetHeight() )
+        return false;
+
+    SHAPE_POLY_SET changedRegion;
+
+    for( unsigned ii = 0; ii < changedAreas.size(); ii++ )
+    {
+        const BOX2I& area = changedAreas[ii];
+
+        changedRegion.NewOutline();
+        changedRegion.Append( area.GetLeft(), area.GetTop() );
+        changedRegion.Append( area.GetRight(), area.GetTop() );
+        changedRegion.Append( area.GetRight(), area.GetBottom() );
+        changedRegion.Append( area.GetLeft(), area.GetBottom() );
+    }
+
+    changedRegion.Simplify( POLY_CALC_MODE );
+
+    // Only the holes reaching the changed region are needed to rebuild it
+    SHAPE_POLY_SET holes;
+
+    for( curr = current.begin(); curr != current.end(); ++curr )
+    {
+        BOX2I bbox = curr->second.BBox();
+
+        for( unsigned ii = 0; ii < changedAreas.size(); ii++ )
+        {
+            if( bbox.Intersects( changedAreas[ii] ) )
             {
-                CreateThermalReliefPadPolygon( aFeatures,
-                                               *pad, thermalGap,
-                                               GetThermalReliefCopperBridge( pad ),
-                                               m_ZoneMinThickness,
-                                               segsPerCircle,
-                                               correctionFactor, s_thermalRot );
+                holes.Append( curr->second );
+                break;
             }
         }
     }
 
+    SHAPE_POLY_SET changedFill = aCurrent.m_solidAreas;
+
+    changedFill.BooleanIntersection( changedRegion, POLY_CALC_MODE );
+    changedFill.BooleanSubtract( holes, POLY_CALC_MODE );
+
+    aRawFill = aPrevious.m_rawFill;
+    aRawFill.BooleanSubtract( changedRegion, POLY_CALC_MODE );
+    aRawFill.BooleanAdd( changedFill, POLY_CALC_MODE );
+
+    return true;
 }
 
 
@@ -406,7 +654,8 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
  *     Remove new insulated copper islands
  */
 
-void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb )
+void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb,
+                                                              ZONE_OBSTACLE_INDEX* aObstacles )
 {
     int segsPerCircle;
     double correctionFactor;
@@ -434,10 +683,33 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb )
     if(g_DumpZonesWhenFilling)
         dumper->BeginGroup("clipper-zone");
 
-    SHAPE_POLY_SET solidAreas = ConvertPolyListToPolySet( m_smoothedPoly->m_CornersList );
+    // The data of this fill is kept for the next one, which will only recompute the
+    // areas around the items changed meanwhile, if the zone outline is the same.
+    ZONE_FILL_CACHE* fillData = new ZONE_FILL_CACHE;
+
+    fillData->m_outline = m_smoothedPoly->m_CornersList.GetList();
+    fillData->m_minThickness = m_ZoneMinThickness;
+    fillData->m_segsPerCircle = segsPerCircle;
+
+    bool sameOutline = m_fillCache && !g_DumpZonesWhenFilling
+                       && m_fillCache->m_outline == fillData->m_outline
+                       && m_fillCache->m_minThickness == fillData->m_minThickness
+                       && m_fillCache->m_segsPerCircle == fillData->m_segsPerCircle;
+
+    SHAPE_POLY_SET solidAreas;
 
-    solidAreas.Inflate( -outline_half_thickness, segsPerCircle );
-    solidAreas.Simplify( POLY_CALC_MODE );
+    if( sameOutline )
+    {
+        solidAreas = m_fillCache->m_solidAreas;
+    }
+    else
+    {
+        solidAreas = ConvertPolyListToPolySet( m_smoothedPoly->m_CornersList );
+        solidAreas.Inflate( -outline_half_thickness, segsPerCircle );
+        solidAreas.Simplify( POLY_CALC_MODE );
+    }
+
+    fillData->m_solidAreas = solidAreas;
 
     SHAPE_POLY_SET holes;
 
@@ -445,21 +717,28 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb )
         dumper->Write( &solidAreas, "solid-areas" );
 
     tmp.RemoveAllContours();
-    buildFeatureHoleList( aPcb, holes );
+    buildFeatureHoleList( aPcb, holes, aObstacles, fillData );
 
     if(g_DumpZonesWhenFilling)
         dumper->Write( &holes, "feature-holes" );
 
-    holes.Simplify( POLY_CALC_MODE );
+    if( !sameOutline || !refillChangedAreas( *m_fillCache, *fillData, solidAreas ) )
+    {
+        holes.Simplify( POLY_CALC_MODE );
 
-    if (g_DumpZonesWhenFilling)
-        dumper->Write( &holes, "feature-holes-postsimplify" );
+        if (g_DumpZonesWhenFilling)
+            dumper->Write( &holes, "feature-holes-postsimplify" );
 
-    solidAreas.BooleanSubtract( holes, POLY_CALC_MODE );
+        solidAreas.BooleanSubtract( holes, POLY_CALC_MODE );
+    }
 
     if (g_DumpZonesWhenFilling)
         dumper->Write( &solidAreas, "solid-areas-minus-holes" );
 
+    fillData->m_rawFill = solidAreas;
+    delete m_fillCache;
+    m_fillCache = fillData;
+
     SHAPE_POLY_SET areas_fractured = solidAreas;
     areas_fractured.Fracture( POLY_CALC_MODE );
 
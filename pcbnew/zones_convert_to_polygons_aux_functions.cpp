@@ -26,6 +26,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <memory>
+
 #include <fctsys.h>
 #include <PolyLine.h>
 #include <wxPcbStruct.h>
@@ -49,9 +51,14 @@
 void ZONE_CONTAINER::TransformOutlinesShapeWithClearanceToPolygon(
         SHAPE_POLY_SET& aCornerBuffer, int aMinClearanceValue, bool aUseNetClearance )
 {
-    // Creates the zone outline polygon (with holes if any)
-    SHAPE_POLY_SET polybuffer;
-    BuildFilledSolidAreasPolygons( NULL, &polybuffer );
+    // Creates the zone outline polygon (with holes if any).
+    // The zone itself is not modified: this function is used by the fill of other
+    // zones, which can run in parallel with the fill of this one.
+    if( GetNumCorners() <= 2 )  // malformed zone. polygon calculations do not like it ...
+        return;
+
+    std::unique_ptr<CPolyLine> smoothedPoly( BuildSmoothedPoly() );
+    SHAPE_POLY_SET polybuffer = ConvertPolyListToPolySet( smoothedPoly->m_CornersList );
 
     // add clearance to outline
     int clearance = aMinClearanceValue;
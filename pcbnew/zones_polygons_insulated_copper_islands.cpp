@@ -27,6 +27,8 @@
 
 #include <fctsys.h>
 #include <common.h>
+#include <algorithm>
+#include <memory>
 
 #include <class_board.h>
 #include <class_module.h>
@@ -36,6 +38,126 @@
 #include <pcbnew.h>
 #include <zones.h>
 #include <polygon_test_point_inside.h>
+#include <geometry/rtree.h>
+
+
+/**
+ * Class OUTLINE_EDGE_GRID
+ * sorts the edges of a polygon outline in horizontal bands, so a point in polygon
+ * test only examines the edges which can cross the horizontal line of the point,
+ * instead of all the edges of the outline.  It gives exactly the same results as
+ * SHAPE_POLY_SET::Contains() (points on the outline are inside).
+ */
+class OUTLINE_EDGE_GRID
+{
+public:
+    OUTLINE_EDGE_GRID( const SHAPE_LINE_CHAIN& aOutline ) :
+        m_outline( aOutline )
+    {
+        int cnt = m_outline.PointCount();
+
+        m_bbox = m_outline.BBox();
+
+        // About 4 edges by band for a regular outline
+        int bandCount = std::max( 1, std::min( cnt / 4, 1024 ) );
+
+        m_bandHeight = m_bbox.GetHeight() / bandCount + 1;
+        m_bands.resize( bandCount );
+
+        // Edge ii goes from corner ii - 1 to corner ii (corner cnt is corner 0), as in
+        // SHAPE_POLY_SET::pointInPolygon()
+        for( int ii = 1; ii <= cnt; ii++ )
+        {
+            int y0 = m_outline.CPoint( ii - 1 ).y;
+            int y1 = m_outline.CPoint( ii == cnt ? 0 : ii ).y;
+
+            int first = band( std::min( y0, y1 ) );
+            int last  = band( std::max( y0, y1 ) );
+
+            for( int b = first; b <= last; b++ )
+                m_bands[b].push_back( ii );
+        }
+    }
+
+    bool Contains( const VECTOR2I& aP ) const
+    {
+        int cnt = m_outline.PointCount();
+
+        if( cnt < 3 || !m_bbox.Contains( aP ) )
+            return false;
+
+        const std::vector<int>& edges = m_bands[ band( aP.y ) ];
+        int result = 0;
+
+        // The edges which do not reach the line of aP do not change the result, so
+        // only the edges of its band are tested, with the pointInPolygon() algorithm
+        for( unsigned jj = 0; jj < edges.size(); jj++ )
+        {
+            int      ii = edges[jj];
+            VECTOR2I ip = m_outline.CPoint( ii - 1 );
+            VECTOR2I ipNext = m_outline.CPoint( ii == cnt ? 0 : ii );
+
+            if( ipNext.y == aP.y )
+            {
+                if( ( ipNext.x == aP.x ) || ( ip.y == aP.y &&
+                    ( ( ipNext.x > aP.x ) == ( ip.x < aP.x ) ) ) )
+                    return true;
+            }
+
+            if( ( ip.y < aP.y ) != ( ipNext.y < aP.y ) )
+            {
+                if( ip.x >= aP.x && ipNext.x > aP.x )
+                {
+                    result = 1 - result;
+                }
+                else if( ip.x >= aP.x || ipNext.x > aP.x )
+                {
+                    int64_t d = (int64_t)( ip.x - aP.x ) * (int64_t)( ipNext.y - aP.y ) -
+                                (int64_t)( ipNext.x - aP.x ) * (int64_t)( ip.y - aP.y );
+
+                    if( !d )
+                        return true;
+
+                    if( ( d > 0 ) == ( ipNext.y > ip.y ) )
+                        result = 1 - result;
+                }
+            }
+        }
+
+        return result ? true : false;
+    }
+
+private:
+    int band( int aY ) const
+    {
+        return ( aY - m_bbox.GetY() ) / m_bandHeight;
+    }
+
+    const SHAPE_LINE_CHAIN&         m_outline;
+    BOX2I                           m_bbox;
+    int                             m_bandHeight;
+    std::vector< std::vector<int> > m_bands;
+};
+
+
+/**
+ * Helper visitor for outline tree searches: collects the indices of the outlines found.
+ */
+struct OUTLINE_COLLECTOR
+{
+    OUTLINE_COLLECTOR( std::vector<int>& aResult ) :
+        m_result( aResult )
+    {
+    }
+
+    bool operator()( int aIndex )
+    {
+        m_result.push_back( aIndex );
+        return true;
+    }
+
+    std::vector<int>& m_result;
+};
 
 
 void ZONE_CONTAINER::TestForCopperIslandAndRemoveInsulatedIslands( BOARD* aPcb )
@@ -75,28 +197,74 @@ void ZONE_CONTAINER::TestForCopperIslandAndRemoveInsulatedIslands( BOARD* aPcb )
             listPointsCandidates.push_back( track->GetEnd() );
     }
 
-    // test if a point is inside
+    // Index the outlines by their bounding box, so each point is only tested against
+    // the outlines which can contain it.  Outlines with many corners get an edge grid
+    // (built on the first test) to avoid walking all their edges for each point.
+    const int MIN_CORNERS_FOR_GRID = 64;
+
+    int outlineCount = m_FilledPolysList.OutlineCount();
+    RTree<int, int, 2, float> outlineTree;
+    std::vector< std::unique_ptr<OUTLINE_EDGE_GRID> > grids( outlineCount );
+    std::vector<bool> connected( outlineCount, false );
+    int unconnectedCount = outlineCount;
+
+    for( int outline = 0; outline < outlineCount; outline++ )
+    {
+        BOX2I     bbox = m_FilledPolysList.COutline( outline ).BBox();
+        const int mmin[2] = { bbox.GetLeft(), bbox.GetTop() };
+        const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+        outlineTree.Insert( mmin, mmax, outline );
+    }
+
+    std::vector<int> candidates;
 
-    for( int outline = 0; outline < m_FilledPolysList.OutlineCount(); outline++ )
+    for( unsigned ic = 0; ic < listPointsCandidates.size() && unconnectedCount; ic++ )
     {
-        bool connected = false;
+        // test if this point is inside an area not yet connected to a board item:
+        VECTOR2I  pos( listPointsCandidates[ic].x, listPointsCandidates[ic].y );
+        const int mpos[2] = { pos.x, pos.y };
+
+        candidates.clear();
+        OUTLINE_COLLECTOR collector( candidates );
+        outlineTree.Search( mpos, mpos, collector );
 
-        for( unsigned ic = 0; ic < listPointsCandidates.size(); ic++ )
+        for( unsigned jj = 0; jj < candidates.size(); jj++ )
         {
-            // test if this area is connected to a board item:
-            wxPoint pos = listPointsCandidates[ic];
+            int outline = candidates[jj];
+
+            if( connected[outline] )
+                continue;
 
-            if( m_FilledPolysList.Contains( VECTOR2I( pos.x, pos.y ), outline ) )
+            const SHAPE_LINE_CHAIN& chain = m_FilledPolysList.COutline( outline );
+            bool inside;
+
+            if( chain.PointCount() < MIN_CORNERS_FOR_GRID )
+            {
+                inside = m_FilledPolysList.Contains( pos, outline );
+            }
+            else
             {
-                connected = true;
-                break;
+                if( !grids[outline] )
+                    grids[outline].reset( new OUTLINE_EDGE_GRID( chain ) );
+
+                inside = grids[outline]->Contains( pos );
+            }
+
+            if( inside )
+            {
+                connected[outline] = true;
+                unconnectedCount--;
             }
         }
+    }
 
-        if( !connected )                 // this polygon is connected: analyse next polygon
-        {
+    // Remove the insulated outlines, from the last one so the indices stay valid
+    grids.clear();
+
+    for( int outline = outlineCount - 1; outline >= 0; outline-- )
+    {
+        if( !connected[outline] )
             m_FilledPolysList.DeletePolygon( outline );
-            outline--;
-        }
     }
 }
@@ -0,0 +1,73 @@
+import os
+import re
+import tempfile
+import unittest
+
+from pcbnew import *
+
+
+def old_format_iu(value):
+    # text written for a coordinate of value nanometers by the sprintf() based writer
+    mm = value / 1e6
+
+    if mm != 0.0 and abs(mm) <= 0.0001:
+        text = ('%.10f' % mm).rstrip('0')
+        return text.rstrip('.')
+
+    return '%.10g' % mm
+
+
+def item_section(text):
+    # the drawings, tracks and zones, after the header and the net classes
+    return text[text.index(b'\n  (gr_line'):]
+
+
+class TestPCBSave(unittest.TestCase):
+
+    def setUp(self):
+        self.pcb = LoadBoard("data/complex_hierarchy.kicad_pcb")
+        self.FILENAME = self.tempFile()
+        self.FILENAME2 = self.tempFile()
+
+    def tempFile(self):
+        fd, name = tempfile.mkstemp(suffix=".kicad_pcb")
+        os.close(fd)
+        return name
+
+    def tearDown(self):
+        for name in (self.FILENAME, self.FILENAME2):
+            if os.path.exists(name):
+                os.remove(name)
+
+    def test_pcb_save_golden(self):
+        # data/save_golden.kicad_pcb holds the items as written by the previous,
+        # sprintf() based writer
+        golden = open("data/save_golden.kicad_pcb", 'rb').read()
+
+        LoadBoard("data/save_golden.kicad_pcb").Save(self.FILENAME)
+
+        self.assertEqual(item_section(open(self.FILENAME, 'rb').read()),
+                         item_section(golden))
+
+    def test_pcb_save_reload(self):
+        self.pcb.Save(self.FILENAME)
+        LoadBoard(self.FILENAME).Save(self.FILENAME2)
+
+        self.assertEqual(open(self.FILENAME, 'rb').read(),
+                         open(self.FILENAME2, 'rb').read())
+
+    def test_pcb_save_coordinates(self):
+        self.pcb.Save(self.FILENAME)
+
+        text = open(self.FILENAME).read()
+        coords = re.findall(r'\((?:xy|at|start|end) (-?[0-9.]+) (-?[0-9.]+)', text)
+
+        self.assertTrue(len(coords) > 0)
+
+        for pair in coords:
+            for number in pair:
+                self.assertEqual(number, old_format_iu(int(round(float(number) * 1e6))))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,48 @@
+import unittest
+
+from pcbnew import *
+
+
+class TestEagleImport(unittest.TestCase):
+
+    def setUp(self):
+        self.pcb = LoadBoard("data/eagle_minimal.brd", IO_MGR.EAGLE)
+
+    def test_eagle_modules(self):
+        refs = sorted(module.GetReference() for module in self.pcb.GetModules())
+        self.assertEqual(refs, [u'R1', u'R2'])
+
+    def test_eagle_pad_nets(self):
+        # the elements come before the signals setting the nets of their pads
+        nets = {}
+
+        for module in self.pcb.GetModules():
+            for pad in module.Pads():
+                nets[module.GetReference() + '.' + pad.GetPadName()] = pad.GetNetname()
+
+        self.assertEqual(nets, {u'R1.1': u'GND', u'R1.2': u'N$1',
+                                u'R2.1': u'N$1', u'R2.2': u'GND'})
+
+    def test_eagle_tracks(self):
+        tracks = list(self.pcb.GetTracks())
+        vias = [t for t in tracks if t.Type() == PCB_VIA_T]
+
+        self.assertEqual(len(tracks), 3)
+        self.assertEqual(len(vias), 1)
+
+        for track in tracks:
+            self.assertEqual(track.GetNetname(), u'N$1')
+
+    def test_eagle_drawings(self):
+        texts = [d for d in self.pcb.GetDrawings() if d.Type() == PCB_TEXT_T]
+
+        self.assertEqual(len(texts), 1)
+        self.assertEqual(texts[0].GetText(), u'Resistors & vias')
+
+    def test_eagle_bad_file(self):
+        self.assertRaises(IOError, LoadBoard, "data/complex_hierarchy.kicad_pcb",
+                          IO_MGR.EAGLE)
+
+
+if __name__ == '__main__':
+    unittest.main()
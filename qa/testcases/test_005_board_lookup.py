@@ -0,0 +1,61 @@
+import unittest
+import pcbnew
+
+from pcbnew import *
+
+
+class TestBoardLookup(unittest.TestCase):
+
+    def setUp(self):
+        self.pcb = LoadBoard("data/complex_hierarchy.kicad_pcb")
+
+    def test_find_module_after_reference_change(self):
+        module = self.pcb.FindModule('P1')
+        module.SetReference('P1000')
+
+        self.assertIsNone(self.pcb.FindModule('P1'))
+        self.assertEqual(self.pcb.FindModule('P1000').GetReference(), 'P1000')
+
+    def test_find_module_after_remove(self):
+        module = self.pcb.FindModule('P1')
+        self.pcb.Remove(module)
+
+        self.assertIsNone(self.pcb.FindModule('P1'))
+
+    def test_find_module_after_undo_remove(self):
+        # Undoing a delete adds the same footprint to the board again
+        module = self.pcb.FindModule('P1')
+        self.pcb.Remove(module)
+        self.pcb.Add(module)
+
+        self.pcb.ResetLookupCounts()
+
+        self.assertEqual(self.pcb.FindModule('P1').GetReference(), 'P1')
+        self.assertEqual(self.pcb.GetLookupCount(LOOKUP_REFERENCE, True), 0)
+
+    def test_lookup_counts(self):
+        self.pcb.ResetLookupCounts()
+
+        self.pcb.FindModule('P1')
+        self.pcb.FindModule('P1')
+
+        self.assertEqual(self.pcb.GetLookupCount(LOOKUP_REFERENCE, False), 2)
+        self.assertEqual(self.pcb.GetLookupCount(LOOKUP_REFERENCE, True), 0)
+
+    def test_get_pad_after_move(self):
+        pcb = BOARD()
+        module = MODULE(pcb)
+        pcb.Add(module)
+        pad = D_PAD(module)
+        module.Add(pad)
+
+        pad.SetShape(PAD_SHAPE_RECT)
+        pad.SetSize(wxSizeMM(1.0, 1.0))
+        pad.SetPosition(wxPointMM(0, 0))
+
+        self.assertIsNotNone(pcb.GetPad(wxPointMM(0, 0)))
+
+        pad.SetPosition(wxPointMM(10, 10))
+
+        self.assertIsNone(pcb.GetPad(wxPointMM(0, 0)))
+        self.assertIsNotNone(pcb.GetPad(wxPointMM(10, 10)))
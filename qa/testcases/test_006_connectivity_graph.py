@@ -0,0 +1,73 @@
+import unittest
+import pcbnew
+
+from pcbnew import *
+
+
+class TestConnectivityGraph(unittest.TestCase):
+
+    def setUp(self):
+        # Two pads of the same net joined by a track
+        self.pcb = BOARD()
+
+        net = NETINFO_ITEM(self.pcb, "N1")
+        self.pcb.Add(net)
+        self.netcode = net.GetNet()
+
+        module = MODULE(self.pcb)
+        self.pcb.Add(module)
+
+        self.pads = []
+
+        for x in (0, 10):
+            pad = D_PAD(module)
+            module.Add(pad)
+            pad.SetShape(PAD_SHAPE_RECT)
+            pad.SetSize(wxSizeMM(1.0, 1.0))
+            pad.SetPosition(wxPointMM(x, 0))
+            pad.SetNetCode(self.netcode)
+            self.pads.append(pad)
+
+        self.track = TRACK(self.pcb)
+        self.pcb.Add(self.track)
+        self.track.SetStart(wxPointMM(0, 0))
+        self.track.SetEnd(wxPointMM(10, 0))
+        self.track.SetWidth(FromMM(0.25))
+        self.track.SetNetCode(self.netcode)
+
+        self.graph = self.pcb.GetConnectivity()
+        self.graph.Build(self.pcb)
+
+    def test_connected(self):
+        self.assertTrue(self.graph.IsConnected(self.pads[0], self.pads[1]))
+        self.assertEqual(self.graph.GetUnconnectedCount(self.netcode), 0)
+        self.assertEqual(self.graph.GetUnconnectedCount(), 0)
+
+        items = BOARD_CONNECTED_ITEM_Vector()
+        self.graph.GetConnectedItems(self.pads[0], items)
+        self.assertEqual(len(items), 3)
+
+    def test_remove_and_add_track(self):
+        # BOARD::Remove() removes the track from the graph
+        self.pcb.Remove(self.track)
+
+        self.assertFalse(self.graph.IsConnected(self.pads[0], self.pads[1]))
+        self.assertEqual(self.graph.GetUnconnectedCount(self.netcode), 1)
+
+        self.pcb.Add(self.track)
+        self.graph.Add(self.track)
+
+        self.assertTrue(self.graph.IsConnected(self.pads[0], self.pads[1]))
+        self.assertEqual(self.graph.GetUnconnectedCount(self.netcode), 0)
+
+    def test_moved_track(self):
+        self.track.SetEnd(wxPointMM(5, 0))
+        self.graph.Add(self.track)
+
+        self.assertFalse(self.graph.IsConnected(self.pads[0], self.pads[1]))
+        self.assertTrue(self.graph.IsConnected(self.pads[0], self.track))
+
+        self.graph.UpdateNet(self.pcb, self.netcode)
+
+        self.assertFalse(self.graph.IsConnected(self.pads[0], self.pads[1]))
+        self.assertEqual(self.graph.GetUnconnectedCount(self.netcode), 1)
@@ -0,0 +1,43 @@
+import os
+import tempfile
+import unittest
+
+from pcbnew import *
+
+
+def track_list(pcb):
+    return [(track.GetClass(), track.GetNetname(),
+             track.GetStart().x, track.GetStart().y,
+             track.GetEnd().x, track.GetEnd().y) for track in pcb.GetTracks()]
+
+
+class TestPCBSnapshot(unittest.TestCase):
+
+    def setUp(self):
+        self.pcb = LoadBoard("data/complex_hierarchy.kicad_pcb")
+
+        fd, self.FILENAME = tempfile.mkstemp(suffix=".kicad_pcb")
+        os.close(fd)
+
+        # a snapshot is only written next to the board file it was made from
+        self.SNAPSHOT = self.FILENAME + ".bin"
+
+    def tearDown(self):
+        for name in (self.FILENAME, self.SNAPSHOT):
+            if os.path.exists(name):
+                os.remove(name)
+
+    def test_snapshot_tracks(self):
+        self.pcb.Save(self.FILENAME)
+        IO_MGR.Save(IO_MGR.KICAD_SNAPSHOT, self.SNAPSHOT, self.pcb)
+
+        snapshot = IO_MGR.Load(IO_MGR.KICAD_SNAPSHOT, self.SNAPSHOT)
+        tracks = track_list(self.pcb)
+
+        # the net names are found from the net codes read for the tracks
+        self.assertTrue(len(tracks) > 0)
+        self.assertEqual(track_list(snapshot), tracks)
+
+
+if __name__ == '__main__':
+    unittest.main()